@@ -0,0 +1,35 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Runs fn `runs` times and returns the median wall time in milliseconds
+template <typename F>
+double measureMs(F&& fn, int runs = 15)
+{
+  std::vector<double> times;
+  times.reserve(runs);
+  for (int i = 0; i < runs; i++)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  std::sort(times.begin(), times.end());
+  return times[times.size() / 2];
+}
+
+// Keeps the optimiser from discarding a result
+template <typename T>
+void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static const volatile void* sink;
+  sink = &value;
+#endif
+}
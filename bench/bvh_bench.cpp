@@ -0,0 +1,154 @@
+// DynamicBvh build, refit and query throughput
+#include "bench_util.h"
+
+#include "bvh.h"
+#include "job_system.h"
+
+#include <random>
+
+namespace
+{
+constexpr std::size_t QUERY_COUNT = 100'000;
+
+std::vector<AABB> randomBoxes(std::size_t count, float worldSize, std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> position(-worldSize, worldSize);
+  std::uniform_real_distribution<float> size(0.5f, 2.0f);
+
+  std::vector<AABB> boxes;
+  boxes.reserve(count);
+  for (std::size_t i = 0; i < count; i++)
+  {
+    const glm::vec3 center(position(rng), position(rng), position(rng));
+    const glm::vec3 half(size(rng), size(rng), size(rng));
+    boxes.emplace_back(center - half, center + half);
+  }
+  return boxes;
+}
+
+float rayBox(const AABB& box, const glm::vec3& origin, const glm::vec3& inverseDirection)
+{
+  const glm::vec3 t1 = (box.min - origin) * inverseDirection;
+  const glm::vec3 t2 = (box.max - origin) * inverseDirection;
+  const glm::vec3 tNear = glm::min(t1, t2);
+  const glm::vec3 tFar = glm::max(t1, t2);
+  const float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+  const float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+  return entry <= exit ? entry : -1.0f;
+}
+}  // namespace
+
+int main()
+{
+  JobSystem jobs;
+
+  for (std::size_t count : {100'000u, 1'000'000u})
+  {
+    std::mt19937 rng(42);
+    // Keep density roughly constant so queries touch a similar number of objects
+    const float worldSize = 50.0f * std::cbrt(count / 1000.0f);
+    auto boxes = randomBoxes(count, worldSize, rng);
+
+    DynamicBvh bvh;
+    std::vector<std::int32_t> proxies(count);
+    const double insertMs = measureMs(
+        [&]()
+        {
+          for (std::uint32_t i = 0; i < count; i++)
+            proxies[i] = bvh.createProxy(boxes[i], i);
+        },
+        1);
+    const float insertedCost = bvh.computeCost();
+    const double rebuildMs = measureMs([&]() { bvh.rebuild(); }, 3);
+
+    // Move a tenth of the objects by up to a couple of units per frame
+    std::uniform_real_distribution<float> jitter(-2.0f, 2.0f);
+    const double refitMs = measureMs(
+        [&]()
+        {
+          for (std::size_t i = 0; i < count; i += 10)
+          {
+            const glm::vec3 offset(jitter(rng), jitter(rng), jitter(rng));
+            boxes[i] = AABB(boxes[i].min + offset, boxes[i].max + offset);
+            bvh.updateProxy(proxies[i], boxes[i]);
+          }
+          bvh.refit();
+        },
+        5);
+
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+    std::size_t hits = 0;
+    const double rayMs = measureMs(
+        [&]()
+        {
+          for (std::size_t q = 0; q < QUERY_COUNT; q++)
+          {
+            const glm::vec3 origin(position(rng), position(rng), position(rng));
+            const glm::vec3 dir =
+                glm::normalize(glm::vec3(direction(rng), direction(rng), direction(rng)) + 1e-4f);
+            const glm::vec3 inverse = 1.0f / dir;
+            auto intersect = [&](std::int32_t proxy, float)
+            { return rayBox(boxes[bvh.getUserData(proxy)], origin, inverse); };
+            auto hit = bvh.raycast(origin, dir, worldSize, intersect);
+            hits += hit ? 1 : 0;
+          }
+        },
+        3);
+
+    std::size_t overlaps = 0;
+    const double overlapMs = measureMs(
+        [&]()
+        {
+          for (std::size_t q = 0; q < QUERY_COUNT; q++)
+          {
+            const glm::vec3 center(position(rng), position(rng), position(rng));
+            bvh.queryOverlap(AABB(center - glm::vec3(5.0f), center + glm::vec3(5.0f)),
+                             [&](std::int32_t)
+                             {
+                               ++overlaps;
+                               return true;
+                             });
+          }
+        },
+        3);
+
+    const double nearestMs = measureMs(
+        [&]()
+        {
+          for (std::size_t q = 0; q < QUERY_COUNT; q++)
+          {
+            const glm::vec3 point(position(rng), position(rng), position(rng));
+            auto hit = bvh.nearest(point,
+                                   worldSize,
+                                   [&](std::int32_t proxy)
+                                   {
+                                     const AABB& box = boxes[bvh.getUserData(proxy)];
+                                     const glm::vec3 d = glm::max(box.min - point, point - box.max);
+                                     return glm::length(glm::max(d, glm::vec3(0.0f)));
+                                   });
+            doNotOptimize(hit.distance);
+          }
+        },
+        3);
+    doNotOptimize(hits + overlaps);
+
+    auto perSecond = [](double ms) { return QUERY_COUNT / (ms / 1000.0) / 1e6; };
+    std::printf("%zu objects, height %d, SAH cost %.1f (incremental %.1f)\n",
+                count,
+                bvh.getHeight(),
+                bvh.computeCost(),
+                insertedCost);
+    std::printf("  insert %8.2f ms | SAH rebuild %8.2f ms | refit 10%% moved %7.2f ms\n",
+                insertMs,
+                rebuildMs,
+                refitMs);
+    std::printf("  raycast %6.2f Mq/s | overlap %6.2f Mq/s | nearest %6.2f Mq/s\n",
+                perSecond(rayMs),
+                perSecond(overlapMs),
+                perSecond(nearestMs));
+  }
+
+  return 0;
+}
@@ -0,0 +1,64 @@
+// Frustum culling throughput: scalar vs SIMD vs SIMD across the job system
+#include "bench_util.h"
+
+#include "cpu_features.h"
+#include "frustum.h"
+#include "job_system.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <random>
+
+int main()
+{
+  const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+  const glm::mat4 view =
+      glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  const Frustum frustum = Frustum::fromMatrix(projection * view);
+
+  JobSystem jobs;
+  std::printf("SSE4.1: %s, AVX2: %s, threads: %u\n",
+              CpuFeatures::hasSSE41() ? "yes" : "no",
+              CpuFeatures::hasAVX2() ? "yes" : "no",
+              jobs.getConcurrency());
+
+  for (std::size_t count : {100'000u, 1'000'000u})
+  {
+    // Objects scattered around the camera, so roughly a tenth end up visible
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> radius(0.5f, 5.0f);
+
+    SphereBatch spheres;
+    spheres.reserve(count);
+    for (std::size_t i = 0; i < count; i++)
+      spheres.push({position(rng), position(rng), position(rng)}, radius(rng));
+
+    std::vector<std::uint32_t> visible(count);
+    std::size_t visibleCount = 0;
+
+    const double scalar = measureMs(
+        [&]()
+        { visibleCount = Culling::cullSpheresScalar(frustum, spheres, 0, count, visible.data()); });
+    const double simd = measureMs(
+        [&]() { visibleCount = Culling::cullSpheres(frustum, spheres, 0, count, visible.data()); });
+    const double parallel = measureMs(
+        [&]()
+        {
+          Culling::cullSpheres(frustum, spheres, visible, &jobs);
+          doNotOptimize(visible.data());
+        });
+
+    std::printf("%8zu objects, %7zu visible | scalar %7.3f ms | simd %7.3f ms (%4.1fx) | "
+                "simd+threads %7.3f ms (%4.1fx)\n",
+                count,
+                visibleCount,
+                scalar,
+                simd,
+                scalar / simd,
+                parallel,
+                scalar / parallel);
+  }
+
+  return 0;
+}
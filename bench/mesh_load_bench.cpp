@@ -0,0 +1,103 @@
+// Parsing an OBJ (what loading models at runtime would cost) vs mapping a cooked .mesh
+#include "bench_util.h"
+
+#include "mesh_container.h"
+#include "mesh_cooker.h"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+
+namespace
+{
+// UV sphere with positions, UVs and normals, written the way exporters write them
+void writeSphere(const std::string& path, int rings, int segments)
+{
+  std::ofstream out(path);
+  for (int r = 0; r <= rings; r++)
+  {
+    const float phi = 3.14159265f * r / rings;
+    for (int s = 0; s <= segments; s++)
+    {
+      const float theta = 6.28318531f * s / segments;
+      const float x = std::sin(phi) * std::cos(theta);
+      const float y = std::cos(phi);
+      const float z = std::sin(phi) * std::sin(theta);
+      out << "v " << x << ' ' << y << ' ' << z << '\n';
+      out << "vt " << float(s) / segments << ' ' << float(r) / rings << '\n';
+      out << "vn " << x << ' ' << y << ' ' << z << '\n';
+    }
+  }
+  for (int r = 0; r < rings; r++)
+  {
+    for (int s = 0; s < segments; s++)
+    {
+      const int a = r * (segments + 1) + s + 1;
+      const int b = a + segments + 1;
+      out << "f " << a << '/' << a << '/' << a << ' ' << b << '/' << b << '/' << b << ' '
+          << b + 1 << '/' << b + 1 << '/' << b + 1 << ' ' << a + 1 << '/' << a + 1 << '/'
+          << a + 1 << '\n';
+    }
+  }
+}
+
+// Map the container and touch every byte, roughly what the driver does when uploading it
+std::size_t loadCooked(const std::string& path)
+{
+  MeshContainer::View view;
+  view.open(path);
+  const auto vertices = view.getVertexData();
+  const auto indices = view.getIndexData();
+  std::size_t sum = std::accumulate(vertices.begin(), vertices.end(), std::size_t(0));
+  return std::accumulate(indices.begin(), indices.end(), sum);
+}
+}  // namespace
+
+int main()
+{
+  const auto dir = std::filesystem::temp_directory_path() / "mesh_load_bench";
+  std::filesystem::create_directories(dir);
+
+  for (int rings : {64, 256, 512})
+  {
+    const std::string source = (dir / ("sphere" + std::to_string(rings) + ".obj")).string();
+    const std::string cooked = (dir / ("sphere" + std::to_string(rings) + ".mesh")).string();
+    writeSphere(source, rings, rings * 2);
+    std::printf("sphere %d x %d (obj %ju bytes)\n",
+                rings,
+                rings * 2,
+                std::filesystem::file_size(source));
+
+    const double importMs = measureMs(
+        [&]()
+        {
+          ImportedMesh mesh;
+          MeshCooker::import(source, mesh);
+          doNotOptimize(mesh.submeshes.size());
+        },
+        5);
+    std::printf("  obj parse only            %8.3f ms\n", importMs);
+
+    // Only LOD 0 so the cooked file holds the same geometry as the OBJ
+    MeshCookOptions options;
+    options.lods = 1;
+    const double cookMs = measureMs(
+        [&]()
+        {
+          ImportedMesh mesh;
+          MeshCooker::import(source, mesh);
+          MeshContainer::write(cooked, MeshCooker::build(mesh, options));
+        },
+        3);
+    const double loadMs = measureMs([&]() { doNotOptimize(loadCooked(cooked)); });
+    std::printf("  cooked map + read         %8.3f ms  (%8ju bytes, cook %7.1f ms)\n",
+                loadMs,
+                std::filesystem::file_size(cooked),
+                cookMs);
+  }
+
+  std::filesystem::remove_all(dir);
+  return 0;
+}
@@ -0,0 +1,105 @@
+// Sphere and capsule movers against SDF shapes, one at a time and batched across threads
+#include "bench_util.h"
+
+#include "job_system.h"
+#include "sdf_collision.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr std::size_t MOVER_COUNT = 10'000;
+
+// A floor with a grid of the blobs and crowns main draws on it
+void fillWorld(SDFCollisionWorld& world)
+{
+  SDFObject floor;
+  floor.box(glm::vec3(20.0f, 0.5f, 20.0f));
+  Transform floorTransform{};
+  floorTransform.position = glm::vec3(0.0f, -0.5f, 0.0f);
+  world.add(floor, floorTransform);
+
+  SDFObject blob;
+  Transform offset{};
+  offset.position = glm::vec3(0.0f, 0.5f, 0.0f);
+  blob.unite(blob.box(glm::vec3(0.4f)), blob.sphere(0.4f, offset), 0.3f);
+
+  SDFObject crown;
+  SDFNodeId node = crown.torus(0.8f, 0.15f);
+  for (int i = 0; i < 12; i++)
+  {
+    const float angle = glm::radians(30.0f * i);
+    Transform spike{};
+    spike.position = glm::vec3(std::cos(angle) * 0.8f, 0.3f, std::sin(angle) * 0.8f);
+    node = crown.unite(node, crown.capsule(0.25f, 0.08f, spike), 0.1f);
+    spike.position.y = 0.6f;
+    node = crown.unite(node, crown.sphere(0.12f, spike), 0.05f);
+  }
+
+  for (int x = -4; x <= 4; x++)
+    for (int z = -4; z <= 4; z++)
+    {
+      Transform transform{};
+      transform.position = glm::vec3(x * 4.0f, 0.5f, z * 4.0f);
+      world.add((x + z) % 2 ? blob : crown, transform);
+    }
+}
+}  // namespace
+
+int main()
+{
+  SDFCollisionWorld world;
+  fillWorld(world);
+  JobSystem jobs;
+
+  // A frame's worth of motion for a crowd walking and falling about the shapes
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> coord(-18.0f, 18.0f);
+  std::uniform_real_distribution<float> height(0.0f, 2.0f);
+  std::uniform_real_distribution<float> step(-0.1f, 0.1f);
+  std::vector<SDFCollisionWorld::Mover> start(MOVER_COUNT);
+  for (std::size_t i = 0; i < MOVER_COUNT; i++)
+  {
+    start[i].position = glm::vec3(coord(rng), height(rng), coord(rng));
+    start[i].motion = glm::vec3(step(rng), step(rng) - 0.1f, step(rng));
+    start[i].radius = 0.2f;
+    start[i].halfHeight = i % 2 ? 0.4f : 0.0f;
+  }
+
+  std::vector<SDFCollisionWorld::Mover> movers;
+  const double singleMs = measureMs(
+      [&]()
+      {
+        movers = start;
+        for (auto& mover : movers)
+          world.move(mover);
+        doNotOptimize(movers.data());
+      },
+      5);
+  std::size_t collided = 0;
+  for (const auto& mover : movers)
+    collided += mover.collided;
+
+  const double batchedMs = measureMs(
+      [&]()
+      {
+        movers = start;
+        world.move(movers, jobs);
+        doNotOptimize(movers.data());
+      },
+      5);
+
+  std::printf("%zu movers against %zu shapes, %zu in contact\n",
+              MOVER_COUNT,
+              world.getShapeCount(),
+              collided);
+  std::printf("one by one       | %8.2f ms | %6.2f M queries/s\n",
+              singleMs,
+              MOVER_COUNT / singleMs / 1000.0);
+  std::printf("batched, %2u thr  | %8.2f ms | %6.2f M queries/s\n",
+              jobs.getConcurrency(),
+              batchedMs,
+              MOVER_COUNT / batchedMs / 1000.0);
+  return 0;
+}
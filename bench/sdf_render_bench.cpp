@@ -0,0 +1,41 @@
+// CPU raymarching of the demo SDF shapes at 1080p, scaling with the number of threads
+#include "bench_util.h"
+
+#include "cpu_features.h"
+#include "demo_scene.h"
+#include "job_system.h"
+
+int main()
+{
+  JobSystem jobs;
+  SDFReferenceRenderer renderer(jobs);
+  DemoScene::addShapes(renderer);
+  std::printf("SSE4.1: %s, AVX2: %s, threads: %u\n",
+              CpuFeatures::hasSSE41() ? "yes" : "no",
+              CpuFeatures::hasAVX2() ? "yes" : "no",
+              jobs.getConcurrency());
+
+  double single = 0.0;
+  for (unsigned int threads = 1;; threads = std::min(threads * 2, jobs.getConcurrency()))
+  {
+    renderer.setMaxThreads(threads);
+    const double ms = measureMs(
+        [&]()
+        {
+          const std::vector<float> image =
+              renderer.render(Camera{}, DemoScene::cameraTransform(), 1920, 1080);
+          doNotOptimize(image.data());
+        },
+        5);
+    if (threads == 1)
+      single = ms;
+    std::printf("%3u threads | %8.1f ms | %5.2fx | %4zu steals\n",
+                threads,
+                ms,
+                single / ms,
+                renderer.getStealCount());
+    if (threads == jobs.getConcurrency())
+      break;
+  }
+  return 0;
+}
@@ -0,0 +1,78 @@
+// Source image decode (the runtime Texture/TextureLoader path) vs mapping a cooked container
+#include "bench_util.h"
+
+#include "image_util.h"
+#include "texture_container.h"
+#include "texture_cooker.h"
+
+#include <filesystem>
+#include <numeric>
+#include <string>
+
+#include "stb_image.h"
+
+namespace
+{
+// What the runtime pays before any GL call: decode plus building the mip chain
+std::size_t decodeSource(const std::string& path)
+{
+  int width, height, channels;
+  stbi_set_flip_vertically_on_load(true);
+  unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 0);
+  std::vector<unsigned char> base(pixels, pixels + width * height * channels);
+  auto mips = ImageUtil::buildMipChain(std::move(base), width, height, channels);
+  stbi_image_free(pixels);
+  return mips.size();
+}
+
+// Map the container and touch every byte, roughly what the driver does when uploading it
+std::size_t loadCooked(const std::string& path)
+{
+  TextureContainer::View view;
+  view.open(path);
+  std::size_t sum = 0;
+  const auto& header = view.getHeader();
+  for (std::uint32_t level = 0; level < header.mipCount; level++)
+  {
+    const unsigned char* data = view.getMipData(level);
+    sum = std::accumulate(data, data + header.mips[level].size, sum);
+  }
+  return sum;
+}
+}  // namespace
+
+int main()
+{
+  using TextureContainer::Format;
+  const auto textures = std::filesystem::path(PROJECT_SOURCE_DIR) / "res/textures";
+  const auto cookDir = std::filesystem::temp_directory_path() / "texture_load_bench";
+  std::filesystem::create_directories(cookDir);
+
+  for (const char* name : {"container.jpg", "awesomeface.png"})
+  {
+    const std::string source = (textures / name).string();
+    std::printf("%s (%ju bytes)\n", name, std::filesystem::file_size(source));
+
+    const double decodeMs = measureMs([&]() { doNotOptimize(decodeSource(source)); });
+    std::printf("  stb_image decode + mips   %8.3f ms\n", decodeMs);
+
+    for (auto [format, label] : {std::pair{Format::RGBA8, "rgba8"},
+                                 std::pair{Format::BC1, "bc1  "},
+                                 std::pair{Format::BC3, "bc3  "}})
+    {
+      const std::string cooked = (cookDir / (std::string(name) + "." + label + ".tex")).string();
+      CookOptions options;
+      options.format = format;
+      const double cookMs = measureMs([&]() { TextureCooker::cook(source, cooked, options); }, 3);
+      const double loadMs = measureMs([&]() { doNotOptimize(loadCooked(cooked)); });
+      std::printf("  cooked %s map + read  %8.3f ms  (%8ju bytes, cook %7.1f ms)\n",
+                  label,
+                  loadMs,
+                  std::filesystem::file_size(cooked),
+                  cookMs);
+    }
+  }
+
+  std::filesystem::remove_all(cookDir);
+  return 0;
+}
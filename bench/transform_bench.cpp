@@ -0,0 +1,92 @@
+// Instance matrix generation: Transform::matrix() per entity vs the batched TRS kernels
+#include "bench_util.h"
+
+#include "cpu_features.h"
+#include "job_system.h"
+#include "transform_batch.h"
+
+#include <cstring>
+#include <random>
+
+int main()
+{
+  using TransformMatrices::Layout;
+
+  JobSystem jobs;
+  std::printf("SSE4.1: %s, AVX2: %s, threads: %u\n",
+              CpuFeatures::hasSSE41() ? "yes" : "no",
+              CpuFeatures::hasAVX2() ? "yes" : "no",
+              jobs.getConcurrency());
+
+  for (std::size_t count : {10'000u, 100'000u, 1'000'000u})
+  {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<Transform> transforms(count);
+    TransformBatch batch;
+    batch.reserve(count);
+    for (Transform& transform : transforms)
+    {
+      transform.position = glm::vec3(value(rng), value(rng), value(rng)) * 100.0f;
+      transform.rotation =
+          glm::normalize(glm::quat(value(rng), value(rng), value(rng), value(rng)));
+      transform.scale = glm::vec3(1.0f + 0.5f * value(rng));
+      batch.push(transform);
+    }
+
+    // Stands in for the mapped instance buffer
+    std::vector<float> out(count * 16);
+
+    const double glmLoop = measureMs(
+        [&]()
+        {
+          float* dst = out.data();
+          for (const Transform& transform : transforms)
+          {
+            const glm::mat4 matrix = transform.matrix();
+            std::memcpy(dst, &matrix, sizeof(matrix));
+            dst += 16;
+          }
+          doNotOptimize(out.data());
+        });
+    const double scalar = measureMs(
+        [&]()
+        {
+          TransformMatrices::writeScalar(batch, 0, count, Layout::MAT4, out.data());
+          doNotOptimize(out.data());
+        });
+    const double simd = measureMs(
+        [&]()
+        {
+          TransformMatrices::write(batch, 0, count, Layout::MAT4, out.data());
+          doNotOptimize(out.data());
+        });
+    const double affine = measureMs(
+        [&]()
+        {
+          TransformMatrices::write(batch, 0, count, Layout::AFFINE, out.data());
+          doNotOptimize(out.data());
+        });
+    const double parallel = measureMs(
+        [&]()
+        {
+          TransformMatrices::write(batch, Layout::AFFINE, out.data(), &jobs);
+          doNotOptimize(out.data());
+        });
+
+    std::printf("%8zu transforms | glm %7.3f ms | scalar %7.3f ms (%4.1fx) | simd mat4 %7.3f ms "
+                "(%4.1fx) | simd affine %7.3f ms (%4.1fx) | affine+threads %7.3f ms (%4.1fx)\n",
+                count,
+                glmLoop,
+                scalar,
+                glmLoop / scalar,
+                simd,
+                glmLoop / simd,
+                affine,
+                glmLoop / affine,
+                parallel,
+                glmLoop / parallel);
+  }
+
+  return 0;
+}
@@ -3,14 +3,12 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 out vec2 TexCoord;
-  
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+#include "include/transform.glsl"
 
 void main()
 {
-  gl_Position = projection * view * model * vec4(aPos, 1.0f);
+  gl_Position = toClip(toWorld(aPos));
   TexCoord = vec2(aTexCoord.x, aTexCoord.y);
 }
 
@@ -19,16 +17,24 @@ void main()
 out vec4 FragColor;
 in vec2 TexCoord;
 
-uniform sampler2D texture1;
-uniform sampler2D texture2;
-
 uniform vec3 objectColor;
-uniform vec3 lightColor;
+
+#include "include/lighting.glsl"
+#include "include/lod_fade.glsl"
+#include "include/material.glsl"
+
+uniform TextureRegion albedo;
+uniform TextureRegion overlay;
+uniform float overlayMix;
+uniform sampler2D detail;
+uniform float detailTiling;
 
 void main()
 {
-  float ambientStrength = 0.1;
-  vec3 ambient = ambientStrength * lightColor;
-  vec3 temp = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2).rgb;
-  FragColor = vec4(ambient * temp, 1.0);
+  lodFadeDiscard();
+  vec3 temp = mix(sampleRegion(albedo, TexCoord), sampleRegion(overlay, TexCoord), overlayMix).rgb;
+  // Only the brightness of the detail counts, the grey placeholder leaves the surface as is
+  float detailLuma = dot(texture(detail, TexCoord * detailTiling).rgb, vec3(0.299, 0.587, 0.114));
+  temp *= mix(1.0, detailLuma * 2.0, 0.3);
+  FragColor = vec4(ambientLight() * temp, 1.0);
 }
@@ -0,0 +1,13 @@
+uniform vec3 lightColor;
+
+const float AMBIENT_STRENGTH = 0.1;
+
+vec3 ambientLight()
+{
+  return AMBIENT_STRENGTH * lightColor;
+}
+
+vec3 diffuseLight(vec3 normal, vec3 lightDir)
+{
+  return max(dot(normal, lightDir), 0.0) * lightColor;
+}
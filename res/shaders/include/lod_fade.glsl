@@ -0,0 +1,16 @@
+// Screen-door cross-fade between the levels of a LodGroup (see LodSystem::Draw). 0 keeps every
+// pixel. Fading out, f in (0, 1) drops the pixels under f in a 4x4 Bayer pattern; fading in,
+// f in [-1, 0) drops the ones at or over 1 + f, so both levels together cover each pixel once.
+uniform float lodFade;
+
+void lodFadeDiscard()
+{
+  const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0,
+                                    12.0, 4.0, 14.0, 6.0,
+                                    3.0, 11.0, 1.0, 9.0,
+                                    15.0, 7.0, 13.0, 5.0);
+  ivec2 cell = ivec2(gl_FragCoord.xy) & 3;
+  float threshold = (bayer[cell.y * 4 + cell.x] + 0.5) / 16.0;
+  if (lodFade > 0.0 ? threshold < lodFade : threshold >= 1.0 + lodFade)
+    discard;
+}
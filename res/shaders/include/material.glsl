@@ -0,0 +1,13 @@
+// Every texture lives in one array, a region is its layer plus the rect it covers
+struct TextureRegion
+{
+  vec4 rect;  // xy offset, zw scale
+  float layer;
+};
+
+uniform sampler2DArray textures;
+
+vec4 sampleRegion(TextureRegion region, vec2 uv)
+{
+  return texture(textures, vec3(region.rect.xy + uv * region.rect.zw, region.layer));
+}
@@ -0,0 +1,34 @@
+// sceneSDF() read from a baked SDFBrickMap, uploaded and bound by SDFBrickTexture.
+// Constants match SDFBrickMap.
+const int BRICK_CELLS = 7;
+const int BRICK_SAMPLES = 8;
+const uint ATLAS_BRICKS = 32u;
+const uint EMPTY_INSIDE = 0xFFFFFFFEu;
+
+uniform sampler3D brickAtlas;
+uniform usampler3D brickIndirection;
+uniform vec3 brickOrigin;
+uniform vec3 brickGridSize;
+uniform float brickVoxelSize;
+uniform float brickBand;
+
+float sceneSDF(vec3 p)
+{
+  vec3 grid = (p - brickOrigin) / brickVoxelSize;
+
+  // Everything outside the bake is at least a band from the surface
+  vec3 outside = max(max(-grid, grid - brickGridSize * float(BRICK_CELLS)), 0.0);
+  if (any(greaterThan(outside, vec3(0.0))))
+    return length(outside) * brickVoxelSize + brickBand;
+
+  ivec3 brick = min(ivec3(grid) / BRICK_CELLS, ivec3(brickGridSize) - 1);
+  uint slot = texelFetch(brickIndirection, brick, 0).r;
+  if (slot >= EMPTY_INSIDE)
+    return slot == EMPTY_INSIDE ? -brickBand : brickBand;
+
+  uvec3 atlasBrick = uvec3(slot % ATLAS_BRICKS, (slot / ATLAS_BRICKS) % ATLAS_BRICKS,
+                           slot / (ATLAS_BRICKS * ATLAS_BRICKS));
+  vec3 texel = vec3(atlasBrick) * float(BRICK_SAMPLES) + (grid - vec3(brick * BRICK_CELLS)) + 0.5;
+  float value = texture(brickAtlas, texel / vec3(textureSize(brickAtlas, 0))).r;
+  return (value * 2.0 - 1.0) * brickBand;
+}
@@ -0,0 +1,43 @@
+float sdSphere(vec3 p, float radius)
+{
+  return length(p) - radius;
+}
+
+float sdBox(vec3 p, vec3 halfSize)
+{
+  vec3 q = abs(p) - halfSize;
+  return length(max(q, 0.0)) + min(max(q.x, max(q.y, q.z)), 0.0);
+}
+
+float sdTorus(vec3 p, vec2 radii)
+{
+  vec2 q = vec2(length(p.xz) - radii.x, p.y);
+  return length(q) - radii.y;
+}
+
+// Along Y, the straight part runs from -halfHeight to halfHeight
+float sdCapsule(vec3 p, float halfHeight, float radius)
+{
+  p.y -= clamp(p.y, -halfHeight, halfHeight);
+  return length(p) - radius;
+}
+
+// Polynomial smooth min/max, k is the blend radius. Mirrored in SDFObject on the CPU.
+float opSmoothUnion(float a, float b, float k)
+{
+  float h = clamp(0.5 + 0.5 * (b - a) / k, 0.0, 1.0);
+  return mix(b, a, h) - k * h * (1.0 - h);
+}
+
+// a with b carved out of it
+float opSmoothSubtract(float a, float b, float k)
+{
+  float h = clamp(0.5 - 0.5 * (a + b) / k, 0.0, 1.0);
+  return mix(a, -b, h) + k * h * (1.0 - h);
+}
+
+float opSmoothIntersect(float a, float b, float k)
+{
+  float h = clamp(0.5 - 0.5 * (b - a) / k, 0.0, 1.0);
+  return mix(b, a, h) + k * h * (1.0 - h);
+}
@@ -0,0 +1,13 @@
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+vec3 toWorld(vec3 localPos)
+{
+  return vec3(model * vec4(localPos, 1.0));
+}
+
+vec4 toClip(vec3 worldPos)
+{
+  return projection * view * vec4(worldPos, 1.0);
+}
@@ -2,13 +2,11 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "include/transform.glsl"
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = toClip(toWorld(aPos));
 }
 
 #shader fragment
@@ -16,7 +14,8 @@ void main()
 out vec4 FragColor;
   
 uniform vec3 objectColor;
-uniform vec3 lightColor;
+
+#include "include/lighting.glsl"
 
 void main()
 {
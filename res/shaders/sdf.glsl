@@ -2,88 +2,134 @@
 #version 330 core
 layout(location = 0) in vec3 aPos;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "include/transform.glsl"
 
-out vec3 worldPos;
+// Object-space box around the shape, the unit cube is stretched over it
+uniform vec3 boundsCenter;
+uniform vec3 boundsSize;
+
+out vec3 objectPos;
 
 void main()
 {
-  worldPos = vec3(model * vec4(aPos, 1.0));
-  gl_Position = projection * view * vec4(worldPos, 1.0);
+  objectPos = boundsCenter + aPos * boundsSize;
+  gl_Position = toClip(toWorld(objectPos));
 }
 
 #shader fragment
 #version 330 core
-in vec3 worldPos;
+in vec3 objectPos;
 out vec4 FragColor;
 
+uniform mat4 inverseModel;
 uniform vec3 cameraPos;
-uniform vec3 sphereCenter;
-uniform float sphereRadius;
-uniform mat4 view;
-uniform mat4 projection;
-uniform float time;
+uniform vec3 boundsCenter;
+uniform vec3 boundsSize;
+uniform vec3 objectColor;
+// World distance rays give up at
+uniform float farPlane;
 
-float sdSphere(vec3 p, vec3 center, float radius)
-{
-    return length(p - center) - radius;
-}
+#ifdef SDF_PREPASS
+// Radius per unit of t of the cone around a prepass texel, in object units
+uniform float coneRadius;
+#else
+// World distances the prepass cone marched up to, at half resolution
+uniform sampler2D prepassDistance;
+// Depth of the meshes drawn so far, rays stop there
+uniform sampler2D sceneDepth;
+uniform mat4 inverseProjection;
+#endif
+
+#include "include/transform.glsl"
+#include "include/sdf_primitives.glsl"
+
+#ifdef SDF_BRICKS
+#include "include/sdf_bricks.glsl"
+#else
+// sceneSDF(vec3 p) is generated from the entity's SDFShape by SDFCompiler
+#pragma sdf_scene
+#endif
+
+const int MAX_STEPS = 128;
 
+// Gradient from four samples on a tetrahedron, instead of six along the axes
 vec3 calcNormal(vec3 p)
 {
     const float eps = 0.001;
-    vec2 h = vec2(eps, 0.0);
-    return normalize(vec3(
-        sdSphere(p + h.xyy, sphereCenter, sphereRadius) - sdSphere(p - h.xyy, sphereCenter, sphereRadius),
-        sdSphere(p + h.yxy, sphereCenter, sphereRadius) - sdSphere(p - h.yxy, sphereCenter, sphereRadius),
-        sdSphere(p + h.yyx, sphereCenter, sphereRadius) - sdSphere(p - h.yyx, sphereCenter, sphereRadius)
-    ));
+    const vec2 k = vec2(1.0, -1.0);
+    return normalize(k.xyy * sceneSDF(p + k.xyy * eps) + k.yyx * sceneSDF(p + k.yyx * eps) +
+                     k.yxy * sceneSDF(p + k.yxy * eps) + k.xxx * sceneSDF(p + k.xxx * eps));
 }
 
 void main()
 {
-    vec3 rayDir = normalize(worldPos - cameraPos);
-    vec3 rayOrigin = cameraPos;
-    
-    float t = 0.1;
+    // March in object space, the generated code works there
+    vec3 rayOrigin = vec3(inverseModel * vec4(cameraPos, 1.0));
+    vec3 rayDir = normalize(objectPos - rayOrigin);
+    // World units per object unit along this ray
+    float worldScale = length(mat3(model) * rayDir);
+
+    // Start on the box face unless the camera is already inside it
+    bool inside = all(lessThan(abs(rayOrigin - boundsCenter), boundsSize * 0.5));
+    float t = inside ? 0.0 : length(objectPos - rayOrigin);
+    float tMax = min(t + length(boundsSize), farPlane / worldScale);
+
+#ifdef SDF_PREPASS
+    // Only step as far as is safe for every ray through the texel, so the full resolution
+    // pass can start wherever this stops
+    for (int i = 0; i < MAX_STEPS && t < tMax; i++)
+    {
+        float d = sceneSDF(rayOrigin + rayDir * t);
+        float r = coneRadius * t;
+        if (d - r < max(r, 0.001))
+            break;
+        t += d - r;
+    }
+    FragColor = vec4(min(t, tMax) * worldScale);
+#else
+    // Every shape covering this pixel wrote into the prepass texel, the nearest won
+    float coneStart = texelFetch(prepassDistance, ivec2(gl_FragCoord.xy) / 2, 0).r;
+    t = max(t, coneStart / worldScale);
+
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(sceneDepth, pixel, 0).r;
+    vec2 ndc = gl_FragCoord.xy / vec2(textureSize(sceneDepth, 0)) * 2.0 - 1.0;
+    vec4 scenePos = inverseProjection * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+    tMax = min(tMax, length(scenePos.xyz / scenePos.w) / worldScale);
+
     bool hit = false;
     vec3 hitPos;
-    
-    for (int i = 0; i < 128; i++)
+
+    for (int i = 0; i < MAX_STEPS && t < tMax; i++)
     {
         vec3 p = rayOrigin + rayDir * t;
-        float d = sdSphere(p, sphereCenter, sphereRadius);
-        
+        float d = sceneSDF(p);
+
         if (d < 0.001)
         {
             hit = true;
             hitPos = p;
             break;
         }
-        
-        // This should probably be the range of the camera in the first place
-        if (t > 100.0)
-            break;
-            
+
         t += d;
     }
-    
+
     if (!hit)
         discard;
-    
-    // Calculate lighting
-    vec3 normal = calcNormal(hitPos);
+
+    // Calculate lighting, normals go back to world space with the inverse transpose
+    vec3 normal = normalize(transpose(mat3(inverseModel)) * calcNormal(hitPos));
     vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));
-    
+
     float diff = max(dot(normal, lightDir), 0.0);
-    vec3 color = vec3(0.2, 0.6, 0.8) * (0.3 + 0.7 * diff);
-    
+    vec3 color = objectColor * (0.3 + 0.7 * diff);
+
     FragColor = vec4(color, 1.0);
-    
+
     // Write depth
-    vec4 clipSpacePos = projection * view * vec4(hitPos, 1.0);
+    vec4 clipSpacePos = toClip(toWorld(hitPos));
     float ndcDepth = clipSpacePos.z / clipSpacePos.w;
     gl_FragDepth = (ndcDepth + 1.0) * 0.5;
+#endif
 }
@@ -0,0 +1,31 @@
+#shader vertex
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 2) in vec4 aNormal;
+
+#include "include/transform.glsl"
+
+uniform mat4 inverseModel;
+
+out vec3 normal;
+
+void main()
+{
+  normal = transpose(mat3(inverseModel)) * aNormal.xyz;
+  gl_Position = toClip(toWorld(aPos));
+}
+
+#shader fragment
+#version 330 core
+in vec3 normal;
+out vec4 FragColor;
+
+uniform vec3 objectColor;
+
+// Meshed stand-in for a raymarched shape, lit the same way as sdf.glsl
+void main()
+{
+  vec3 lightDir = normalize(vec3(1.0, 1.0, 1.0));
+  float diff = max(dot(normalize(normal), lightDir), 0.0);
+  FragColor = vec4(objectColor * (0.3 + 0.7 * diff), 1.0);
+}
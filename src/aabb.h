@@ -0,0 +1,61 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <limits>
+
+// Axis-aligned bounding box. Default constructed boxes are empty and grow with expand().
+struct AABB
+{
+  glm::vec3 min{std::numeric_limits<float>::max()};
+  glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+  AABB() = default;
+  AABB(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+
+  static AABB fromSphere(const glm::vec3& center, float radius)
+  {
+    return {center - glm::vec3(radius), center + glm::vec3(radius)};
+  }
+
+  bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+  void expand(const glm::vec3& point)
+  {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+  }
+
+  void expand(const AABB& other)
+  {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+  }
+
+  glm::vec3 center() const { return (min + max) * 0.5f; }
+  glm::vec3 size() const { return max - min; }
+  glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+  float surfaceArea() const
+  {
+    const glm::vec3 d = size();
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+  }
+
+  bool contains(const AABB& other) const
+  {
+    return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+           max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+  }
+
+  bool intersects(const AABB& other) const
+  {
+    return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y &&
+           max.y >= other.min.y && min.z <= other.max.z && max.z >= other.min.z;
+  }
+
+  static AABB merge(const AABB& a, const AABB& b)
+  {
+    return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+  }
+};
@@ -0,0 +1,320 @@
+#include "block_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+using Color = std::array<int, 3>;
+
+std::uint16_t packColor565(const float rgb[3])
+{
+  const auto quantize = [](float value, int maxValue)
+  { return std::clamp(static_cast<int>(std::lround(value / 255.0f * maxValue)), 0, maxValue); };
+  return static_cast<std::uint16_t>((quantize(rgb[0], 31) << 11) | (quantize(rgb[1], 63) << 5) |
+                                    quantize(rgb[2], 31));
+}
+
+Color unpackColor565(std::uint16_t color)
+{
+  const int r = (color >> 11) & 31;
+  const int g = (color >> 5) & 63;
+  const int b = color & 31;
+  return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+void colorPalette(std::uint16_t c0, std::uint16_t c1, bool fourColor, std::array<Color, 4>& out)
+{
+  out[0] = unpackColor565(c0);
+  out[1] = unpackColor565(c1);
+  for (int k = 0; k < 3; k++)
+  {
+    if (fourColor)
+    {
+      out[2][k] = (2 * out[0][k] + out[1][k]) / 3;
+      out[3][k] = (out[0][k] + 2 * out[1][k]) / 3;
+    }
+    else
+    {
+      out[2][k] = (out[0][k] + out[1][k]) / 2;
+      out[3][k] = 0;
+    }
+  }
+}
+
+// Quantizes the endpoints, orders them for four-colour mode and picks the closest palette entry
+// for every pixel
+void fitColorIndices(const unsigned char rgba[64],
+                     const float high[3],
+                     const float low[3],
+                     std::uint16_t& c0,
+                     std::uint16_t& c1,
+                     std::uint32_t& indices)
+{
+  c0 = packColor565(high);
+  c1 = packColor565(low);
+  if (c0 < c1)
+    std::swap(c0, c1);
+
+  std::array<Color, 4> palette;
+  colorPalette(c0, c1, true, palette);
+
+  // Equal endpoints would decode as three-colour mode, index 0 is right for both
+  const int paletteSize = c0 == c1 ? 1 : 4;
+  indices = 0;
+  for (int i = 0; i < 16; i++)
+  {
+    int best = 0;
+    int bestError = std::numeric_limits<int>::max();
+    for (int p = 0; p < paletteSize; p++)
+    {
+      int error = 0;
+      for (int k = 0; k < 3; k++)
+      {
+        const int d = rgba[i * 4 + k] - palette[p][k];
+        error += d * d;
+      }
+      if (error < bestError)
+      {
+        bestError = error;
+        best = p;
+      }
+    }
+    indices |= static_cast<std::uint32_t>(best) << (i * 2);
+  }
+}
+
+// Endpoints along the principal axis of the block's colours, always in four-colour order
+void encodeColorBlock(const unsigned char rgba[64], unsigned char out[8])
+{
+  float mean[3] = {0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < 16; i++)
+  {
+    for (int k = 0; k < 3; k++)
+      mean[k] += rgba[i * 4 + k] / 16.0f;
+  }
+
+  float covariance[6] = {};
+  for (int i = 0; i < 16; i++)
+  {
+    const float r = rgba[i * 4] - mean[0];
+    const float g = rgba[i * 4 + 1] - mean[1];
+    const float b = rgba[i * 4 + 2] - mean[2];
+    covariance[0] += r * r;
+    covariance[1] += r * g;
+    covariance[2] += r * b;
+    covariance[3] += g * g;
+    covariance[4] += g * b;
+    covariance[5] += b * b;
+  }
+
+  // A few power iterations are plenty for a 3x3 matrix
+  float axis[3] = {1.0f, 1.0f, 1.0f};
+  for (int iteration = 0; iteration < 8; iteration++)
+  {
+    const float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+    const float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+    const float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+    const float length = std::sqrt(x * x + y * y + z * z);
+    if (length < 1e-6f)
+      break;
+    axis[0] = x / length;
+    axis[1] = y / length;
+    axis[2] = z / length;
+  }
+
+  float minT = 0.0f;
+  float maxT = 0.0f;
+  for (int i = 0; i < 16; i++)
+  {
+    float t = 0.0f;
+    for (int k = 0; k < 3; k++)
+      t += (rgba[i * 4 + k] - mean[k]) * axis[k];
+    minT = std::min(minT, t);
+    maxT = std::max(maxT, t);
+  }
+
+  // Pull the endpoints in slightly, the extremes are usually outliers
+  const float inset = (maxT - minT) / 16.0f;
+  minT += inset;
+  maxT -= inset;
+
+  float high[3], low[3];
+  for (int k = 0; k < 3; k++)
+  {
+    high[k] = mean[k] + axis[k] * maxT;
+    low[k] = mean[k] + axis[k] * minT;
+  }
+
+  std::uint16_t c0, c1;
+  std::uint32_t indices;
+  fitColorIndices(rgba, high, low, c0, c1, indices);
+
+  std::memcpy(out, &c0, 2);
+  std::memcpy(out + 2, &c1, 2);
+  std::memcpy(out + 4, &indices, 4);
+}
+
+void decodeColorBlock(const unsigned char in[8], bool allowTransparent, unsigned char rgba[64])
+{
+  std::uint16_t c0, c1;
+  std::uint32_t indices;
+  std::memcpy(&c0, in, 2);
+  std::memcpy(&c1, in + 2, 2);
+  std::memcpy(&indices, in + 4, 4);
+
+  const bool fourColor = !allowTransparent || c0 > c1;
+  std::array<Color, 4> palette;
+  colorPalette(c0, c1, fourColor, palette);
+
+  for (int i = 0; i < 16; i++)
+  {
+    const int index = (indices >> (i * 2)) & 3;
+    for (int k = 0; k < 3; k++)
+      rgba[i * 4 + k] = static_cast<unsigned char>(palette[index][k]);
+    rgba[i * 4 + 3] = (!fourColor && index == 3) ? 0 : 255;
+  }
+}
+
+void alphaPalette(int a0, int a1, int out[8])
+{
+  out[0] = a0;
+  out[1] = a1;
+  if (a0 > a1)
+  {
+    for (int i = 1; i < 7; i++)
+      out[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+  }
+  else
+  {
+    for (int i = 1; i < 5; i++)
+      out[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+    out[6] = 0;
+    out[7] = 255;
+  }
+}
+}  // namespace
+
+namespace BlockCompression
+{
+void encodeBC1Block(const unsigned char rgba[64], unsigned char out[8])
+{
+  encodeColorBlock(rgba, out);
+}
+
+void encodeBC3Block(const unsigned char rgba[64], unsigned char out[16])
+{
+  int a0 = 0;
+  int a1 = 255;
+  for (int i = 0; i < 16; i++)
+  {
+    a0 = std::max<int>(a0, rgba[i * 4 + 3]);
+    a1 = std::min<int>(a1, rgba[i * 4 + 3]);
+  }
+
+  // Eight-value mode needs a0 > a1, a flat block just uses index 0 everywhere
+  std::uint64_t indices = 0;
+  if (a0 > a1)
+  {
+    int palette[8];
+    alphaPalette(a0, a1, palette);
+    for (int i = 0; i < 16; i++)
+    {
+      int best = 0;
+      for (int p = 1; p < 8; p++)
+      {
+        if (std::abs(rgba[i * 4 + 3] - palette[p]) < std::abs(rgba[i * 4 + 3] - palette[best]))
+          best = p;
+      }
+      indices |= static_cast<std::uint64_t>(best) << (i * 3);
+    }
+  }
+
+  out[0] = static_cast<unsigned char>(a0);
+  out[1] = static_cast<unsigned char>(a1);
+  for (int i = 0; i < 6; i++)
+    out[2 + i] = static_cast<unsigned char>(indices >> (i * 8));
+  encodeColorBlock(rgba, out + 8);
+}
+
+void decodeBC1Block(const unsigned char in[8], unsigned char rgba[64])
+{
+  decodeColorBlock(in, true, rgba);
+}
+
+void decodeBC3Block(const unsigned char in[16], unsigned char rgba[64])
+{
+  decodeColorBlock(in + 8, false, rgba);
+
+  int palette[8];
+  alphaPalette(in[0], in[1], palette);
+  std::uint64_t indices = 0;
+  for (int i = 0; i < 6; i++)
+    indices |= static_cast<std::uint64_t>(in[2 + i]) << (i * 8);
+  for (int i = 0; i < 16; i++)
+    rgba[i * 4 + 3] = static_cast<unsigned char>(palette[(indices >> (i * 3)) & 7]);
+}
+
+std::vector<unsigned char> compress(Format format,
+                                    const unsigned char* rgba,
+                                    int width,
+                                    int height)
+{
+  std::vector<unsigned char> blocks(compressedSize(format, width, height));
+  unsigned char block[64];
+  unsigned char* out = blocks.data();
+  for (int by = 0; by < height; by += 4)
+  {
+    for (int bx = 0; bx < width; bx += 4)
+    {
+      for (int y = 0; y < 4; y++)
+      {
+        for (int x = 0; x < 4; x++)
+        {
+          const int sx = std::min(bx + x, width - 1);
+          const int sy = std::min(by + y, height - 1);
+          std::memcpy(&block[(y * 4 + x) * 4], &rgba[(sy * width + sx) * 4], 4);
+        }
+      }
+
+      if (format == Format::BC1)
+        encodeBC1Block(block, out);
+      else
+        encodeBC3Block(block, out);
+      out += blockSize(format);
+    }
+  }
+  return blocks;
+}
+
+std::vector<unsigned char> decompress(Format format,
+                                      const unsigned char* blocks,
+                                      int width,
+                                      int height)
+{
+  std::vector<unsigned char> rgba(static_cast<size_t>(width) * height * 4);
+  unsigned char block[64];
+  for (int by = 0; by < height; by += 4)
+  {
+    for (int bx = 0; bx < width; bx += 4)
+    {
+      if (format == Format::BC1)
+        decodeBC1Block(blocks, block);
+      else
+        decodeBC3Block(blocks, block);
+      blocks += blockSize(format);
+
+      for (int y = 0; y < 4 && by + y < height; y++)
+      {
+        const int count = std::min(4, width - bx);
+        std::memcpy(&rgba[((by + y) * width + bx) * 4], &block[y * 16], count * 4);
+      }
+    }
+  }
+  return rgba;
+}
+}  // namespace BlockCompression
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Software S3TC encoder/decoder. The cooker uses the encoder offline; the decoder lets the
+// runtime fall back to plain RGBA8 when the driver lacks EXT_texture_compression_s3tc.
+// Blocks are 4x4 RGBA8 pixels, row-major.
+namespace BlockCompression
+{
+enum class Format
+{
+  BC1,  // 8 bytes per block, opaque colour
+  BC3   // 16 bytes per block, colour plus interpolated alpha
+};
+
+void encodeBC1Block(const unsigned char rgba[64], unsigned char out[8]);
+void encodeBC3Block(const unsigned char rgba[64], unsigned char out[16]);
+void decodeBC1Block(const unsigned char in[8], unsigned char rgba[64]);
+void decodeBC3Block(const unsigned char in[16], unsigned char rgba[64]);
+
+inline std::size_t blockSize(Format format)
+{
+  return format == Format::BC1 ? 8 : 16;
+}
+
+inline std::size_t compressedSize(Format format, int width, int height)
+{
+  return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * blockSize(format);
+}
+
+// Whole images, partial edge blocks are padded by repeating the last row/column
+std::vector<unsigned char> compress(Format format,
+                                    const unsigned char* rgba,
+                                    int width,
+                                    int height);
+std::vector<unsigned char> decompress(Format format,
+                                      const unsigned char* blocks,
+                                      int width,
+                                      int height);
+}  // namespace BlockCompression
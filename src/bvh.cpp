@@ -0,0 +1,567 @@
+#include "bvh.h"
+
+#include "job_system.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+
+namespace
+{
+constexpr int SAH_BINS = 16;
+
+// Small trees rebuild inline, the job system round trip isn't worth it
+constexpr std::size_t ASYNC_REBUILD_MIN_PROXIES = 4096;
+}  // namespace
+
+DynamicBvh::DynamicBvh() = default;
+
+DynamicBvh::~DynamicBvh() = default;
+
+std::int32_t DynamicBvh::allocateNode()
+{
+  if (m_freeNode == NULL_NODE)
+  {
+    m_nodes.emplace_back();
+    return static_cast<std::int32_t>(m_nodes.size() - 1);
+  }
+
+  const std::int32_t node = m_freeNode;
+  m_freeNode = m_nodes[node].parent;
+  m_nodes[node] = Node{};
+  return node;
+}
+
+void DynamicBvh::freeNode(std::int32_t node)
+{
+  m_nodes[node].parent = m_freeNode;
+  m_nodes[node].height = -1;
+  m_freeNode = node;
+}
+
+std::int32_t DynamicBvh::createProxy(const AABB& bounds, std::uint32_t userData)
+{
+  std::int32_t proxy;
+  if (m_freeProxy == NULL_NODE)
+  {
+    m_proxies.emplace_back();
+    proxy = static_cast<std::int32_t>(m_proxies.size() - 1);
+  }
+  else
+  {
+    proxy = m_freeProxy;
+    m_freeProxy = m_proxies[proxy].node;
+  }
+
+  const std::int32_t leaf = allocateNode();
+  m_proxies[proxy] = {AABB(bounds.min - glm::vec3(FAT_MARGIN), bounds.max + glm::vec3(FAT_MARGIN)),
+                      userData,
+                      leaf};
+  m_nodes[leaf].bounds = m_proxies[proxy].bounds;
+  m_nodes[leaf].proxy = proxy;
+  insertLeaf(leaf);
+
+  ++m_proxyCount;
+  m_pendingStale = m_pendingBuild.valid();
+  return proxy;
+}
+
+void DynamicBvh::destroyProxy(std::int32_t proxy)
+{
+  const std::int32_t leaf = m_proxies[proxy].node;
+  removeLeaf(leaf);
+  freeNode(leaf);
+
+  m_proxies[proxy].node = m_freeProxy;
+  m_freeProxy = proxy;
+
+  --m_proxyCount;
+  m_pendingStale = m_pendingBuild.valid();
+}
+
+bool DynamicBvh::updateProxy(std::int32_t proxy, const AABB& bounds)
+{
+  Proxy& p = m_proxies[proxy];
+  if (p.bounds.contains(bounds))
+    return false;
+
+  p.bounds = AABB(bounds.min - glm::vec3(FAT_MARGIN), bounds.max + glm::vec3(FAT_MARGIN));
+  m_nodes[p.node].bounds = p.bounds;
+  m_needsRefit = true;
+  return true;
+}
+
+void DynamicBvh::insertLeaf(std::int32_t leaf)
+{
+  if (m_root == NULL_NODE)
+  {
+    m_root = leaf;
+    m_nodes[leaf].parent = NULL_NODE;
+    return;
+  }
+
+  // Walk down picking the child whose bounds grow the least (Box2D's b2DynamicTree heuristic)
+  const AABB leafBounds = m_nodes[leaf].bounds;
+  std::int32_t index = m_root;
+  while (!m_nodes[index].isLeaf())
+  {
+    const Node& node = m_nodes[index];
+    const float area = node.bounds.surfaceArea();
+    const float combinedArea = AABB::merge(node.bounds, leafBounds).surfaceArea();
+
+    // Cost of making a new parent for this node and the leaf
+    const float cost = 2.0f * combinedArea;
+    // Minimum cost of pushing the leaf further down
+    const float inheritanceCost = 2.0f * (combinedArea - area);
+
+    auto descendCost = [&](std::int32_t child)
+    {
+      const AABB& childBounds = m_nodes[child].bounds;
+      const float merged = AABB::merge(childBounds, leafBounds).surfaceArea();
+      return (m_nodes[child].isLeaf() ? merged : merged - childBounds.surfaceArea()) +
+             inheritanceCost;
+    };
+
+    const float leftCost = descendCost(node.left);
+    const float rightCost = descendCost(node.right);
+    if (cost < leftCost && cost < rightCost)
+      break;
+
+    index = leftCost < rightCost ? node.left : node.right;
+  }
+
+  const std::int32_t sibling = index;
+  const std::int32_t oldParent = m_nodes[sibling].parent;
+  const std::int32_t newParent = allocateNode();
+  m_nodes[newParent].parent = oldParent;
+  m_nodes[newParent].bounds = AABB::merge(leafBounds, m_nodes[sibling].bounds);
+  m_nodes[newParent].height = m_nodes[sibling].height + 1;
+  m_nodes[newParent].left = sibling;
+  m_nodes[newParent].right = leaf;
+  m_nodes[sibling].parent = newParent;
+  m_nodes[leaf].parent = newParent;
+
+  if (oldParent == NULL_NODE)
+  {
+    m_root = newParent;
+  }
+  else if (m_nodes[oldParent].left == sibling)
+  {
+    m_nodes[oldParent].left = newParent;
+  }
+  else
+  {
+    m_nodes[oldParent].right = newParent;
+  }
+
+  fixUpwards(m_nodes[leaf].parent);
+}
+
+void DynamicBvh::removeLeaf(std::int32_t leaf)
+{
+  if (leaf == m_root)
+  {
+    m_root = NULL_NODE;
+    return;
+  }
+
+  const std::int32_t parent = m_nodes[leaf].parent;
+  const std::int32_t grandParent = m_nodes[parent].parent;
+  const std::int32_t sibling =
+      m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+  if (grandParent == NULL_NODE)
+  {
+    m_root = sibling;
+    m_nodes[sibling].parent = NULL_NODE;
+    freeNode(parent);
+    return;
+  }
+
+  if (m_nodes[grandParent].left == parent)
+    m_nodes[grandParent].left = sibling;
+  else
+    m_nodes[grandParent].right = sibling;
+  m_nodes[sibling].parent = grandParent;
+  freeNode(parent);
+
+  fixUpwards(grandParent);
+}
+
+void DynamicBvh::fixUpwards(std::int32_t index)
+{
+  while (index != NULL_NODE)
+  {
+    index = balance(index);
+
+    Node& node = m_nodes[index];
+    node.height = 1 + std::max(m_nodes[node.left].height, m_nodes[node.right].height);
+    node.bounds = AABB::merge(m_nodes[node.left].bounds, m_nodes[node.right].bounds);
+
+    index = node.parent;
+  }
+}
+
+std::int32_t DynamicBvh::balance(std::int32_t iA)
+{
+  Node& A = m_nodes[iA];
+  if (A.isLeaf() || A.height < 2)
+    return iA;
+
+  const std::int32_t iB = A.left;
+  const std::int32_t iC = A.right;
+  const int heightDifference = m_nodes[iC].height - m_nodes[iB].height;
+
+  // Promotes child iHigh (the taller one) above iA, iA keeps the shorter grandchild
+  auto rotate = [&](std::int32_t iHigh, std::int32_t iLow)
+  {
+    Node& high = m_nodes[iHigh];
+    const std::int32_t iF = high.left;
+    const std::int32_t iG = high.right;
+    Node& F = m_nodes[iF];
+    Node& G = m_nodes[iG];
+
+    high.left = iA;
+    high.parent = A.parent;
+    A.parent = iHigh;
+
+    if (high.parent == NULL_NODE)
+      m_root = iHigh;
+    else if (m_nodes[high.parent].left == iA)
+      m_nodes[high.parent].left = iHigh;
+    else
+      m_nodes[high.parent].right = iHigh;
+
+    // The taller grandchild stays with iHigh, the other one replaces iHigh under iA
+    const bool keepF = F.height > G.height;
+    const std::int32_t iKeep = keepF ? iF : iG;
+    const std::int32_t iMove = keepF ? iG : iF;
+
+    high.right = iKeep;
+    if (A.left == iHigh)
+      A.left = iMove;
+    else
+      A.right = iMove;
+    m_nodes[iMove].parent = iA;
+
+    A.bounds = AABB::merge(m_nodes[iLow].bounds, m_nodes[iMove].bounds);
+    A.height = 1 + std::max(m_nodes[iLow].height, m_nodes[iMove].height);
+    high.bounds = AABB::merge(A.bounds, m_nodes[iKeep].bounds);
+    high.height = 1 + std::max(A.height, m_nodes[iKeep].height);
+    return iHigh;
+  };
+
+  if (heightDifference > 1)
+    return rotate(iC, iB);
+  if (heightDifference < -1)
+    return rotate(iB, iC);
+  return iA;
+}
+
+void DynamicBvh::refit()
+{
+  m_needsRefit = false;
+  if (m_root == NULL_NODE)
+  {
+    m_cost = 0.0f;
+    return;
+  }
+
+  // Preorder list, walked backwards so children are always fixed before their parents
+  m_refitOrder.clear();
+  m_refitOrder.push_back(m_root);
+  for (std::size_t i = 0; i < m_refitOrder.size(); i++)
+  {
+    const Node& node = m_nodes[m_refitOrder[i]];
+    if (!node.isLeaf())
+    {
+      m_refitOrder.push_back(node.left);
+      m_refitOrder.push_back(node.right);
+    }
+  }
+
+  float internalArea = 0.0f;
+  for (auto it = m_refitOrder.rbegin(); it != m_refitOrder.rend(); ++it)
+  {
+    Node& node = m_nodes[*it];
+    if (node.isLeaf())
+      continue;
+    node.bounds = AABB::merge(m_nodes[node.left].bounds, m_nodes[node.right].bounds);
+    internalArea += node.bounds.surfaceArea();
+  }
+
+  const float rootArea = m_nodes[m_root].bounds.surfaceArea();
+  m_cost = rootArea > 0.0f ? internalArea / rootArea : 0.0f;
+}
+
+float DynamicBvh::computeCost() const
+{
+  if (m_root == NULL_NODE)
+    return 0.0f;
+
+  float internalArea = 0.0f;
+  std::vector<std::int32_t> stack{m_root};
+  while (!stack.empty())
+  {
+    const Node& node = m_nodes[stack.back()];
+    stack.pop_back();
+    if (node.isLeaf())
+      continue;
+    internalArea += node.bounds.surfaceArea();
+    stack.push_back(node.left);
+    stack.push_back(node.right);
+  }
+
+  const float rootArea = m_nodes[m_root].bounds.surfaceArea();
+  return rootArea > 0.0f ? internalArea / rootArea : 0.0f;
+}
+
+void DynamicBvh::update(JobSystem* jobs)
+{
+  if (m_needsRefit)
+    refit();
+
+  if (m_pendingBuild.valid() &&
+      m_pendingBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+  {
+    BuildResult result = m_pendingBuild.get();
+    if (!m_pendingStale)
+      adopt(std::move(result));
+    m_pendingStale = false;
+  }
+
+  if (m_pendingBuild.valid() || m_proxyCount < 2)
+    return;
+
+  const bool neverBuilt = m_buildCost == 0.0f;
+  if (!neverBuilt && m_cost <= m_buildCost * REBUILD_THRESHOLD)
+    return;
+
+  if (!jobs || m_proxyCount < ASYNC_REBUILD_MIN_PROXIES)
+  {
+    rebuild();
+    return;
+  }
+
+  // Snapshot the proxies, the build only ever sees its own copy
+  std::vector<std::int32_t> ids;
+  std::vector<AABB> bounds;
+  ids.reserve(m_proxyCount);
+  bounds.reserve(m_proxyCount);
+  for (const Node& node : m_nodes)
+  {
+    if (node.height == 0 && node.proxy != NULL_NODE)
+    {
+      ids.push_back(node.proxy);
+      bounds.push_back(m_proxies[node.proxy].bounds);
+    }
+  }
+
+  m_pendingStale = false;
+  m_pendingBuild = jobs->submit([ids = std::move(ids), bounds = std::move(bounds)]() mutable
+                                { return build(std::move(ids), std::move(bounds)); });
+}
+
+void DynamicBvh::rebuild()
+{
+  std::vector<std::int32_t> ids;
+  std::vector<AABB> bounds;
+  ids.reserve(m_proxyCount);
+  bounds.reserve(m_proxyCount);
+  for (const Node& node : m_nodes)
+  {
+    if (node.height == 0 && node.proxy != NULL_NODE)
+    {
+      ids.push_back(node.proxy);
+      bounds.push_back(m_proxies[node.proxy].bounds);
+    }
+  }
+
+  adopt(build(std::move(ids), std::move(bounds)));
+}
+
+void DynamicBvh::adopt(BuildResult result)
+{
+  m_nodes = std::move(result.nodes);
+  m_root = result.root;
+  m_freeNode = NULL_NODE;
+
+  // Proxies may have moved since the snapshot was taken
+  for (std::size_t i = 0; i < m_nodes.size(); i++)
+  {
+    Node& node = m_nodes[i];
+    if (node.isLeaf())
+    {
+      node.bounds = m_proxies[node.proxy].bounds;
+      m_proxies[node.proxy].node = static_cast<std::int32_t>(i);
+    }
+  }
+
+  refit();
+  m_buildCost = m_cost;
+}
+
+DynamicBvh::BuildResult DynamicBvh::build(std::vector<std::int32_t> proxyIds,
+                                          std::vector<AABB> bounds)
+{
+  BuildResult result;
+  const std::size_t count = proxyIds.size();
+  if (count == 0)
+    return result;
+
+  std::vector<glm::vec3> centroids(count);
+  std::vector<std::uint32_t> order(count);
+  for (std::size_t i = 0; i < count; i++)
+  {
+    centroids[i] = bounds[i].center();
+    order[i] = static_cast<std::uint32_t>(i);
+  }
+
+  struct Task
+  {
+    std::int32_t node;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  result.nodes.reserve(count * 2 - 1);
+  result.nodes.emplace_back();
+  result.root = 0;
+  std::vector<Task> tasks{{0, 0, count}};
+
+  while (!tasks.empty())
+  {
+    const Task task = tasks.back();
+    tasks.pop_back();
+
+    if (task.end - task.begin == 1)
+    {
+      Node& leaf = result.nodes[task.node];
+      leaf.bounds = bounds[order[task.begin]];
+      leaf.proxy = proxyIds[order[task.begin]];
+      continue;
+    }
+
+    AABB centroidBounds;
+    for (std::size_t i = task.begin; i < task.end; i++)
+      centroidBounds.expand(centroids[order[i]]);
+
+    const glm::vec3 extent = centroidBounds.size();
+    int axis = 0;
+    if (extent.y > extent[axis])
+      axis = 1;
+    if (extent.z > extent[axis])
+      axis = 2;
+
+    std::size_t mid = task.begin + (task.end - task.begin) / 2;
+    if (extent[axis] > 0.0f)
+    {
+      // Binned SAH: bucket centroids along the widest axis and pick the cheapest boundary
+      std::array<AABB, SAH_BINS> binBounds;
+      std::array<std::size_t, SAH_BINS> binCounts{};
+      const float scale = SAH_BINS / extent[axis];
+      auto binOf = [&](std::uint32_t i)
+      {
+        const int bin = static_cast<int>((centroids[i][axis] - centroidBounds.min[axis]) * scale);
+        return std::min(bin, SAH_BINS - 1);
+      };
+
+      for (std::size_t i = task.begin; i < task.end; i++)
+      {
+        const int bin = binOf(order[i]);
+        binBounds[bin].expand(bounds[order[i]]);
+        ++binCounts[bin];
+      }
+
+      std::array<float, SAH_BINS - 1> leftCost;
+      AABB accumulated;
+      std::size_t accumulatedCount = 0;
+      for (int b = 0; b < SAH_BINS - 1; b++)
+      {
+        accumulated.expand(binBounds[b]);
+        accumulatedCount += binCounts[b];
+        leftCost[b] = accumulatedCount ? accumulated.surfaceArea() * accumulatedCount : 0.0f;
+      }
+
+      float bestCost = std::numeric_limits<float>::max();
+      int bestSplit = -1;
+      accumulated = AABB();
+      accumulatedCount = 0;
+      for (int b = SAH_BINS - 1; b > 0; b--)
+      {
+        accumulated.expand(binBounds[b]);
+        accumulatedCount += binCounts[b];
+        const float rightCost =
+            accumulatedCount ? accumulated.surfaceArea() * accumulatedCount : 0.0f;
+        const float cost = leftCost[b - 1] + rightCost;
+        if (accumulatedCount > 0 && accumulatedCount < task.end - task.begin && cost < bestCost)
+        {
+          bestCost = cost;
+          bestSplit = b;
+        }
+      }
+
+      if (bestSplit > 0)
+      {
+        auto split = std::partition(order.begin() + task.begin,
+                                    order.begin() + task.end,
+                                    [&](std::uint32_t i) { return binOf(i) < bestSplit; });
+        mid = static_cast<std::size_t>(split - order.begin());
+      }
+    }
+
+    if (mid == task.begin || mid == task.end)
+      mid = task.begin + (task.end - task.begin) / 2;
+
+    // Children are always allocated after their parent, the bottom-up pass below relies on it
+    const auto left = static_cast<std::int32_t>(result.nodes.size());
+    result.nodes.emplace_back();
+    result.nodes.emplace_back();
+    result.nodes[task.node].left = left;
+    result.nodes[task.node].right = left + 1;
+    result.nodes[left].parent = task.node;
+    result.nodes[left + 1].parent = task.node;
+
+    tasks.push_back({left, task.begin, mid});
+    tasks.push_back({left + 1, mid, task.end});
+  }
+
+  float internalArea = 0.0f;
+  for (auto it = result.nodes.rbegin(); it != result.nodes.rend(); ++it)
+  {
+    if (it->isLeaf())
+      continue;
+    const Node& left = result.nodes[it->left];
+    const Node& right = result.nodes[it->right];
+    it->bounds = AABB::merge(left.bounds, right.bounds);
+    it->height = 1 + std::max(left.height, right.height);
+    internalArea += it->bounds.surfaceArea();
+  }
+
+  const float rootArea = result.nodes[0].bounds.surfaceArea();
+  result.cost = rootArea > 0.0f ? internalArea / rootArea : 0.0f;
+  return result;
+}
+
+float DynamicBvh::distanceToAABB(const AABB& box, const glm::vec3& point)
+{
+  const glm::vec3 outside = glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.0f));
+  return glm::length(outside);
+}
+
+bool DynamicBvh::rayAABB(const AABB& box,
+                         const glm::vec3& origin,
+                         const glm::vec3& inverseDirection,
+                         float maxDistance,
+                         float& entry)
+{
+  const glm::vec3 t1 = (box.min - origin) * inverseDirection;
+  const glm::vec3 t2 = (box.max - origin) * inverseDirection;
+  const glm::vec3 tNear = glm::min(t1, t2);
+  const glm::vec3 tFar = glm::max(t1, t2);
+
+  entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+  const float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+  return entry <= exit;
+}
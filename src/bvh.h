@@ -0,0 +1,341 @@
+#pragma once
+
+#include "aabb.h"
+#include "frustum.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <queue>
+#include <vector>
+
+class JobSystem;
+
+// Dynamic AABB tree over proxies (one per object). Nodes live in a flat array, reference each
+// other by index and are padded to a cache line. Leaves store slightly fattened bounds so small
+// movements only need a refit; when refits have degraded the tree too far compared to its last
+// SAH build, a fresh binned-SAH tree is built on the job system and swapped in.
+class DynamicBvh
+{
+  public:
+  static constexpr std::int32_t NULL_NODE = -1;
+  // Traversal stack entries kept on the stack, deeper trees spill to the heap
+  static constexpr int MAX_STACK = 128;
+
+  struct alignas(64) Node
+  {
+    AABB bounds;
+    std::int32_t parent{NULL_NODE};  // next free node while on the free list
+    std::int32_t left{NULL_NODE};
+    std::int32_t right{NULL_NODE};
+    std::int32_t proxy{NULL_NODE};  // leaves only
+    std::int32_t height{0};
+
+    bool isLeaf() const { return left == NULL_NODE; }
+  };
+
+  struct RayHit
+  {
+    std::int32_t proxy{NULL_NODE};
+    float distance{std::numeric_limits<float>::max()};
+
+    explicit operator bool() const { return proxy != NULL_NODE; }
+  };
+
+  // Leaves are enlarged by this much on every side
+  static constexpr float FAT_MARGIN = 0.1f;
+  // Rebuild once the SAH cost has grown this much since the last build
+  static constexpr float REBUILD_THRESHOLD = 1.5f;
+
+  DynamicBvh();
+  ~DynamicBvh();
+
+  DynamicBvh(const DynamicBvh&) = delete;
+  DynamicBvh& operator=(const DynamicBvh&) = delete;
+
+  std::int32_t createProxy(const AABB& bounds, std::uint32_t userData);
+  void destroyProxy(std::int32_t proxy);
+  // Updates the proxy's bounds in place, internal nodes are fixed up by the next refit().
+  // Returns false when the fat bounds still contain the new ones and nothing changed.
+  bool updateProxy(std::int32_t proxy, const AABB& bounds);
+
+  // Recomputes internal bounds along every path touched by updateProxy
+  void refit();
+  // Per-frame housekeeping: refits, swaps in a finished background build and starts a new one
+  // when the tree quality has degraded. Without a job system the rebuild runs inline.
+  void update(JobSystem* jobs);
+  // Full binned-SAH rebuild, blocking
+  void rebuild();
+
+  inline std::uint32_t getUserData(std::int32_t proxy) const { return m_proxies[proxy].userData; }
+  inline const AABB& getFatBounds(std::int32_t proxy) const { return m_proxies[proxy].bounds; }
+  inline std::size_t getProxyCount() const { return m_proxyCount; }
+  inline const std::vector<Node>& getNodes() const { return m_nodes; }
+  inline std::int32_t getRoot() const { return m_root; }
+
+  // Sum of internal node areas relative to the root area, what SAH minimises
+  float computeCost() const;
+  inline float getCost() const { return m_cost; }
+  inline float getBuildCost() const { return m_buildCost; }
+  int getHeight() const { return m_root == NULL_NODE ? 0 : m_nodes[m_root].height; }
+
+  // fn(proxy) is called for every proxy whose fat bounds overlap; return false to stop early
+  template <typename F>
+  void queryOverlap(const AABB& bounds, F&& fn) const;
+
+  // fn(proxy) for every proxy whose fat bounds touch the frustum
+  template <typename F>
+  void queryFrustum(const Frustum& frustum, F&& fn) const;
+
+  // intersect(proxy, maxDistance) returns the exact hit distance along the ray, or a negative
+  // value for a miss. Nodes farther than the closest hit so far are skipped.
+  template <typename F>
+  RayHit raycast(const glm::vec3& origin,
+                 const glm::vec3& direction,
+                 float maxDistance,
+                 F&& intersect) const;
+
+  // distance(proxy) returns the exact distance from the query point. Visits nodes closest first
+  // and stops once no node can beat the best result.
+  template <typename F>
+  RayHit nearest(const glm::vec3& point, float maxDistance, F&& distance) const;
+
+  private:
+  // Fixed array for the usual depths, refits can leave the tree unbalanced so it may not be enough
+  class TraversalStack
+  {
+    public:
+    void push(std::int32_t node)
+    {
+      if (m_top < MAX_STACK)
+        m_fixed[m_top] = node;
+      else
+        m_spill.push_back(node);
+      m_top++;
+    }
+
+    std::int32_t pop()
+    {
+      m_top--;
+      if (m_top < MAX_STACK)
+        return m_fixed[m_top];
+      const std::int32_t node = m_spill.back();
+      m_spill.pop_back();
+      return node;
+    }
+
+    bool empty() const { return m_top == 0; }
+
+    private:
+    std::int32_t m_fixed[MAX_STACK];
+    int m_top{0};
+    std::vector<std::int32_t> m_spill;
+  };
+
+  struct Proxy
+  {
+    AABB bounds;
+    std::uint32_t userData{0};
+    std::int32_t node{NULL_NODE};  // next free proxy while on the free list
+  };
+
+  struct BuildResult
+  {
+    std::vector<Node> nodes;
+    std::int32_t root{NULL_NODE};
+    float cost{0.0f};
+  };
+
+  std::int32_t allocateNode();
+  void freeNode(std::int32_t node);
+  void insertLeaf(std::int32_t leaf);
+  void removeLeaf(std::int32_t leaf);
+  // AVL-style rotation keeping incremental inserts from degenerating into a list
+  std::int32_t balance(std::int32_t node);
+  void fixUpwards(std::int32_t node);
+
+  // Builds a compact tree over the given proxies, proxies' node fields are not touched
+  static BuildResult build(std::vector<std::int32_t> proxyIds, std::vector<AABB> bounds);
+  void adopt(BuildResult result);
+
+  static float distanceToAABB(const AABB& box, const glm::vec3& point);
+  static bool rayAABB(const AABB& box,
+                      const glm::vec3& origin,
+                      const glm::vec3& inverseDirection,
+                      float maxDistance,
+                      float& entry);
+
+  std::vector<Node> m_nodes;
+  std::int32_t m_root{NULL_NODE};
+  std::int32_t m_freeNode{NULL_NODE};
+
+  std::vector<Proxy> m_proxies;
+  std::int32_t m_freeProxy{NULL_NODE};
+  std::size_t m_proxyCount{0};
+
+  bool m_needsRefit{false};
+  float m_cost{0.0f};
+  float m_buildCost{0.0f};
+  std::vector<std::int32_t> m_refitOrder;
+
+  // Background rebuild, discarded if proxies were created or destroyed while it ran
+  std::future<BuildResult> m_pendingBuild;
+  bool m_pendingStale{false};
+};
+
+template <typename F>
+void DynamicBvh::queryOverlap(const AABB& bounds, F&& fn) const
+{
+  if (m_root == NULL_NODE)
+    return;
+
+  TraversalStack stack;
+  stack.push(m_root);
+  while (!stack.empty())
+  {
+    const Node& node = m_nodes[stack.pop()];
+    if (!node.bounds.intersects(bounds))
+      continue;
+
+    if (node.isLeaf())
+    {
+      if (!fn(node.proxy))
+        return;
+    }
+    else
+    {
+      stack.push(node.left);
+      stack.push(node.right);
+    }
+  }
+}
+
+template <typename F>
+void DynamicBvh::queryFrustum(const Frustum& frustum, F&& fn) const
+{
+  if (m_root == NULL_NODE)
+    return;
+
+  TraversalStack stack;
+  stack.push(m_root);
+  while (!stack.empty())
+  {
+    const Node& node = m_nodes[stack.pop()];
+    if (!frustum.intersectsAABB(node.bounds))
+      continue;
+
+    if (node.isLeaf())
+    {
+      fn(node.proxy);
+    }
+    else
+    {
+      stack.push(node.left);
+      stack.push(node.right);
+    }
+  }
+}
+
+template <typename F>
+DynamicBvh::RayHit DynamicBvh::raycast(const glm::vec3& origin,
+                                       const glm::vec3& direction,
+                                       float maxDistance,
+                                       F&& intersect) const
+{
+  RayHit hit;
+  hit.distance = maxDistance;
+  if (m_root == NULL_NODE)
+    return hit;
+
+  const glm::vec3 inverseDirection = 1.0f / direction;
+
+  TraversalStack stack;
+  stack.push(m_root);
+  while (!stack.empty())
+  {
+    const Node& node = m_nodes[stack.pop()];
+    float entry;
+    if (!rayAABB(node.bounds, origin, inverseDirection, hit.distance, entry))
+      continue;
+
+    if (node.isLeaf())
+    {
+      const float distance = intersect(node.proxy, hit.distance);
+      if (distance >= 0.0f && distance < hit.distance)
+      {
+        hit.distance = distance;
+        hit.proxy = node.proxy;
+      }
+      continue;
+    }
+
+    // Push the farther child first so the nearer one is visited first and shrinks the ray
+    float leftEntry, rightEntry;
+    const bool left = rayAABB(
+        m_nodes[node.left].bounds, origin, inverseDirection, hit.distance, leftEntry);
+    const bool right = rayAABB(
+        m_nodes[node.right].bounds, origin, inverseDirection, hit.distance, rightEntry);
+    if (left && right)
+    {
+      const bool leftFirst = leftEntry <= rightEntry;
+      stack.push(leftFirst ? node.right : node.left);
+      stack.push(leftFirst ? node.left : node.right);
+    }
+    else if (left)
+    {
+      stack.push(node.left);
+    }
+    else if (right)
+    {
+      stack.push(node.right);
+    }
+  }
+
+  return hit;
+}
+
+template <typename F>
+DynamicBvh::RayHit DynamicBvh::nearest(const glm::vec3& point,
+                                       float maxDistance,
+                                       F&& distance) const
+{
+  RayHit best;
+  best.distance = maxDistance;
+  if (m_root == NULL_NODE)
+    return best;
+
+  using Entry = std::pair<float, std::int32_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+  open.emplace(distanceToAABB(m_nodes[m_root].bounds, point), m_root);
+
+  while (!open.empty())
+  {
+    const auto [lowerBound, index] = open.top();
+    open.pop();
+    if (lowerBound >= best.distance)
+      break;
+
+    const Node& node = m_nodes[index];
+    if (node.isLeaf())
+    {
+      const float d = distance(node.proxy);
+      if (d < best.distance)
+      {
+        best.distance = d;
+        best.proxy = node.proxy;
+      }
+      continue;
+    }
+
+    for (std::int32_t child : {node.left, node.right})
+    {
+      const float d = distanceToAABB(m_nodes[child].bounds, point);
+      if (d < best.distance)
+        open.emplace(d, child);
+    }
+  }
+
+  return best;
+}
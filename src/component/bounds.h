@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../aabb.h"
+
+#include <glm/glm.hpp>
+#include "glm/mat4x3.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Local-space bounding volume of a renderable entity, transformed by its WorldTransform for
+// culling and the spatial index
+struct Bounds
+{
+  glm::vec3 center{0.0f};
+  float radius{0.5f};
+  glm::vec3 extents{0.5f};  // AABB half size around center
+
+  struct Sphere
+  {
+    glm::vec3 center;
+    float radius;
+  };
+
+  // Scaled by the longest axis, exact as long as no parent shears it
+  Sphere worldSphere(const glm::mat4x3& world) const
+  {
+    const float scale = std::sqrt(std::max(glm::dot(world[0], world[0]),
+                                           std::max(glm::dot(world[1], world[1]),
+                                                    glm::dot(world[2], world[2]))));
+    return {world * glm::vec4(center, 1.0f), radius * scale};
+  }
+
+  // Box around the transformed extents box, the absolute matrix applied to the extents
+  AABB worldBox(const glm::mat4x3& world) const
+  {
+    const glm::vec3 worldCenter = world * glm::vec4(center, 1.0f);
+    const glm::vec3 worldExtents = glm::abs(world[0]) * extents.x +
+                                   glm::abs(world[1]) * extents.y +
+                                   glm::abs(world[2]) * extents.z;
+    return {worldCenter - worldExtents, worldCenter + worldExtents};
+  }
+
+  // Encloses both the box and the sphere, so a tree storing it never prunes a query that tests
+  // either of them
+  AABB worldEnclosing(const glm::mat4x3& world) const
+  {
+    const Sphere sphere = worldSphere(world);
+    return AABB::merge(worldBox(world), AABB::fromSphere(sphere.center, sphere.radius));
+  }
+};
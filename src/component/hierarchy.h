@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../ecs_constants.h"
+
+#include <vector>
+
+// Parent/child links between entities with transforms. Both sides are kept in sync by
+// TransformSystem::setParent/detach, don't add or edit them directly.
+struct Parent
+{
+  Entity entity{0};
+};
+
+struct Children
+{
+  std::vector<Entity> entities;
+};
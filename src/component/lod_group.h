@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../resource_manager.h"
+
+#include <cstdint>
+#include <vector>
+
+class Mesh;
+
+// Meshes an entity is drawn with depending on how much of the view its Bounds sphere covers.
+// LodSystem picks the level, with some hysteresis around each threshold so an object sitting on
+// one doesn't flip every frame, and screen-door dithers from the old level to the new one.
+struct LodGroup
+{
+  struct Level
+  {
+    Handle<Mesh> mesh;
+    // A cooked mesh can carry its own LODs, a level can be any one of them
+    int meshLod{0};
+    // Fraction of the view height below which this level is good enough, like
+    // MeshContainer::lodScreenSize. The first level's is never looked at.
+    float screenSize{1.0f};
+  };
+
+  // Finest first
+  std::vector<Level> levels;
+  // Smaller than this it isn't drawn at all
+  float cullScreenSize{0.0f};
+  // Seconds a switch cross-fades over, 0 switches straight away
+  float fadeTime{0.25f};
+
+  // Written by LodSystem. current == levels.size() is hidden, previous is the level fading out.
+  std::uint32_t current{0};
+  std::uint32_t previous{0};
+  float fade{1.0f};
+  std::uint64_t selectedFrame{0};
+};
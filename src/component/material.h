@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../resource_manager.h"
+#include "../texture_atlas.h"
+
+// What an entity samples from the shared TextureArray. Both regions can sit in any layer, so
+// switching materials is a couple of uniforms rather than a texture bind.
+struct Material
+{
+  TextureRegion albedo{};
+  TextureRegion overlay{};
+  float overlayMix{0.2f};
+  // Tiled over the surface and streamed by a TextureManager, so it's a texture of its own. The
+  // ResourceManager owns it, components live in g_coordinator past the GL context.
+  Handle<Texture> detail{};
+  float detailTiling{4.0f};
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../resource_manager.h"
+#include "../sdf_brick_texture.h"
+#include "../sdf_object.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+
+// Raymarched surface of an entity, in the space of its Transform.
+// Static shapes have their parameters baked into their own program. Dynamic ones share a
+// program with every shape of the same structure and may change sizes and offsets freely.
+struct SDFShape
+{
+  SDFObject sdf;
+  bool isStatic{false};
+  glm::vec3 color{0.2f, 0.6f, 0.8f};
+  // When set the shape is drawn from this bake instead, at the same cost however big sdf is
+  std::shared_ptr<const SDFBrickTexture> bricks;
+  // Meshed version (see SDFMesher), rasterised instead of marching once the shape covers less
+  // than meshScreenSize of the view height. Owned by the ResourceManager, like LodGroup meshes.
+  Handle<Mesh> mesh;
+  float meshScreenSize{0.15f};
+};
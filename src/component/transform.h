@@ -2,6 +2,7 @@
 
 #include "glm/fwd.hpp"
 #include "glm/gtc/quaternion.hpp"
+#include "glm/mat4x3.hpp"
 
 struct Transform
 {
@@ -9,14 +10,21 @@ struct Transform
   glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
   glm::vec3 scale{1.0f};
 
-  glm::mat4 matrix() const
+  // Translate * rotate * scale without the 4x4 products, the rotation columns are scaled in
+  // place and the translation is the last column
+  glm::mat4x3 affine() const
   {
-    glm::mat4 translation = glm::translate(glm::mat4(1.0f), position);
-    glm::mat4 rotationMat = glm::mat4_cast(rotation);
-    glm::mat4 scaleMat = glm::scale(glm::mat4(1.0f), scale);
-    return translation * rotationMat * scaleMat;
+    const glm::mat3 rotationMat = glm::mat3_cast(rotation);
+    glm::mat4x3 result;
+    result[0] = rotationMat[0] * scale.x;
+    result[1] = rotationMat[1] * scale.y;
+    result[2] = rotationMat[2] * scale.z;
+    result[3] = position;
+    return result;
   }
 
+  glm::mat4 matrix() const { return glm::mat4(affine()); }
+
   glm::vec3 forward() const { return rotation * glm::vec3(0, 0, -1); }
   glm::vec3 right() const { return rotation * glm::vec3(1, 0, 0); }
   glm::vec3 up() const { return rotation * glm::vec3(0, 1, 0); }
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "glm/mat4x3.hpp"
+
+// Transform of an entity composed with every parent's, kept up to date by TransformSystem
+struct WorldTransform
+{
+  glm::mat4x3 matrix{1.0f};
+
+  glm::mat4 toMat4() const { return glm::mat4(matrix); }
+  glm::vec3 position() const { return matrix[3]; }
+};
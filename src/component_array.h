@@ -59,6 +59,8 @@ class ComponentArray : public IComponentArray
     return m_componentArray[m_entityToIndexMap.at(entity)];
   }
 
+  [[nodiscard]] bool HasData(Entity entity) const { return m_entityToIndexMap.contains(entity); }
+
   void entityDestroyed(Entity entity) override
   {
     if (m_entityToIndexMap.contains(entity))
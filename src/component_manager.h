@@ -61,6 +61,12 @@ class ComponentManager
     return getComponentArray<T>()->GetData(entity);
   }
 
+  template <typename T>
+  bool HasComponent(Entity entity)
+  {
+    return getComponentArray<T>()->HasData(entity);
+  }
+
   void EntityDestroyed(Entity entity)
   {
     // Notify each component array that an entity has been destroyed
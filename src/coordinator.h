@@ -65,6 +65,12 @@ class Coordinator
     return m_componentManager->GetComponent<T>(entity);
   }
 
+  template <typename T>
+  bool HasComponent(Entity entity)
+  {
+    return m_componentManager->HasComponent<T>(entity);
+  }
+
   template <typename T>
   ComponentType GetComponentType()
   {
@@ -0,0 +1,51 @@
+#include "cpu_features.h"
+
+#if defined(CPU_X86_64) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+struct Features
+{
+  bool sse41{false};
+  bool avx2{false};
+
+  Features()
+  {
+#if defined(CPU_X86_64) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    sse41 = __builtin_cpu_supports("sse4.1");
+    avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(CPU_X86_64) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    sse41 = (info[2] & (1 << 19)) != 0;
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avxState = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    avx2 = avxState && fma && (info[1] & (1 << 5)) != 0;
+#endif
+  }
+};
+
+const Features& features()
+{
+  static const Features s_features;
+  return s_features;
+}
+}  // namespace
+
+namespace CpuFeatures
+{
+bool hasSSE41()
+{
+  return features().sse41;
+}
+
+bool hasAVX2()
+{
+  return features().avx2;
+}
+}  // namespace CpuFeatures
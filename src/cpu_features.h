@@ -0,0 +1,21 @@
+#pragma once
+
+// Runtime CPU feature detection for the SIMD kernels. Kernels are compiled for their
+// instruction set with CPU_TARGET_* so the rest of the build stays at the baseline ISA.
+#if defined(__x86_64__) || defined(_M_X64)
+#define CPU_X86_64 1
+#endif
+
+#if defined(CPU_X86_64) && (defined(__GNUC__) || defined(__clang__))
+#define CPU_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define CPU_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define CPU_TARGET_SSE41
+#define CPU_TARGET_AVX2
+#endif
+
+namespace CpuFeatures
+{
+bool hasSSE41();
+bool hasAVX2();  // AVX2 and FMA, the kernels assume both
+}  // namespace CpuFeatures
@@ -0,0 +1,120 @@
+#include "framebuffer.h"
+
+#include <iostream>
+
+namespace
+{
+GLenum pixelFormat(GLenum internalFormat)
+{
+  switch (internalFormat)
+  {
+    case GL_R8:
+    case GL_R16F:
+    case GL_R32F:
+      return GL_RED;
+    case GL_RG16F:
+    case GL_RG32F:
+      return GL_RG;
+    default:
+      return GL_RGBA;
+  }
+}
+
+unsigned int createTexture(int width, int height, GLenum internalFormat, GLenum format, GLenum type)
+{
+  unsigned int id;
+  glGenTextures(1, &id);
+  glBindTexture(GL_TEXTURE_2D, id);
+  glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+  // Later passes read these texel for texel
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  return id;
+}
+}  // namespace
+
+Framebuffer::Framebuffer(int width, int height, GLenum colorFormat, bool hasDepth)
+    : m_rendererID(0), m_colorID(0), m_depthID(0), m_width(width), m_height(height)
+{
+  glGenFramebuffers(1, &m_rendererID);
+  glBindFramebuffer(GL_FRAMEBUFFER, m_rendererID);
+
+  if (colorFormat != GL_NONE)
+  {
+    m_colorID = createTexture(width, height, colorFormat, pixelFormat(colorFormat), GL_FLOAT);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorID, 0);
+  }
+  else
+  {
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+  }
+
+  if (hasDepth)
+  {
+    m_depthID =
+        createTexture(width, height, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthID, 0);
+  }
+
+  m_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+  if (!m_complete)
+    std::cerr << "ERROR::FRAMEBUFFER::INCOMPLETE " << width << "x" << height << std::endl;
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+Framebuffer::~Framebuffer()
+{
+  glDeleteFramebuffers(1, &m_rendererID);
+  if (m_colorID)
+    glDeleteTextures(1, &m_colorID);
+  if (m_depthID)
+    glDeleteTextures(1, &m_depthID);
+}
+
+void Framebuffer::bind() const
+{
+  glBindFramebuffer(GL_FRAMEBUFFER, m_rendererID);
+  glViewport(0, 0, m_width, m_height);
+}
+
+void Framebuffer::unbind(int windowWidth, int windowHeight)
+{
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glViewport(0, 0, windowWidth, windowHeight);
+}
+
+void Framebuffer::bindColorTexture(unsigned int slot) const
+{
+  glActiveTexture(GL_TEXTURE0 + slot);
+  glBindTexture(GL_TEXTURE_2D, m_colorID);
+}
+
+void Framebuffer::bindDepthTexture(unsigned int slot) const
+{
+  glActiveTexture(GL_TEXTURE0 + slot);
+  glBindTexture(GL_TEXTURE_2D, m_depthID);
+}
+
+void Framebuffer::blit(const Framebuffer* target,
+                       GLbitfield mask,
+                       int targetWidth,
+                       int targetHeight) const
+{
+  if (target)
+  {
+    targetWidth = target->m_width;
+    targetHeight = target->m_height;
+  }
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_rendererID);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target ? target->m_rendererID : 0);
+  // Depth can't be filtered, only a same size copy is allowed
+  const GLenum filter = (mask & GL_DEPTH_BUFFER_BIT) ? GL_NEAREST : GL_LINEAR;
+  glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, targetWidth, targetHeight, mask, filter);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Offscreen render target with a color and/or depth texture that later passes can sample.
+// GL_NONE as the color format gives a depth only target.
+class Framebuffer
+{
+  public:
+  Framebuffer(int width, int height, GLenum colorFormat, bool hasDepth);
+  ~Framebuffer();
+
+  Framebuffer(const Framebuffer&) = delete;
+  Framebuffer& operator=(const Framebuffer&) = delete;
+
+  // Also sets the viewport to cover it
+  void bind() const;
+  // Back to the window's framebuffer
+  static void unbind(int windowWidth, int windowHeight);
+
+  void bindColorTexture(unsigned int slot) const;
+  void bindDepthTexture(unsigned int slot) const;
+
+  // Copies to target, or to the window's framebuffer when it's null. Depth is only copied
+  // between targets of the same size. Leaves the window's framebuffer bound.
+  void blit(const Framebuffer* target,
+            GLbitfield mask,
+            int targetWidth = 0,
+            int targetHeight = 0) const;
+
+  inline bool isComplete() const { return m_complete; }
+  inline int getWidth() const { return m_width; }
+  inline int getHeight() const { return m_height; }
+
+  private:
+  unsigned int m_rendererID;
+  unsigned int m_colorID;
+  unsigned int m_depthID;
+  int m_width, m_height;
+  bool m_complete;
+};
@@ -0,0 +1,250 @@
+#include "frustum.h"
+
+#include "component/camera.h"
+#include "component/transform.h"
+#include "cpu_features.h"
+#include "job_system.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstring>
+
+#ifdef CPU_X86_64
+#include <immintrin.h>
+#endif
+
+namespace
+{
+// Below this many spheres the job system costs more than it saves
+constexpr std::size_t PARALLEL_THRESHOLD = 32 * 1024;
+constexpr std::size_t PARALLEL_GRAIN = 16 * 1024;
+}  // namespace
+
+namespace Culling
+{
+#ifdef CPU_X86_64
+CPU_TARGET_AVX2 std::size_t cullSpheresAVX2(const Frustum& frustum,
+                                            const SphereBatch& spheres,
+                                            std::size_t first,
+                                            std::size_t count,
+                                            std::uint32_t* visible)
+{
+  __m256 nx[6], ny[6], nz[6], nd[6];
+  for (int p = 0; p < 6; p++)
+  {
+    nx[p] = _mm256_set1_ps(frustum.planes[p].x);
+    ny[p] = _mm256_set1_ps(frustum.planes[p].y);
+    nz[p] = _mm256_set1_ps(frustum.planes[p].z);
+    nd[p] = _mm256_set1_ps(frustum.planes[p].w);
+  }
+
+  const std::size_t end = first + count;
+  const std::size_t simdEnd = first + count / 8 * 8;
+  std::size_t written = 0;
+
+  for (std::size_t i = first; i < simdEnd; i += 8)
+  {
+    const __m256 x = _mm256_loadu_ps(&spheres.x[i]);
+    const __m256 y = _mm256_loadu_ps(&spheres.y[i]);
+    const __m256 z = _mm256_loadu_ps(&spheres.z[i]);
+    const __m256 negRadius =
+        _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+
+    // A sphere is culled as soon as it is fully behind any plane
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < 6; p++)
+    {
+      __m256 dist = _mm256_fmadd_ps(nx[p], x, nd[p]);
+      dist = _mm256_fmadd_ps(ny[p], y, dist);
+      dist = _mm256_fmadd_ps(nz[p], z, dist);
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, negRadius, _CMP_GE_OQ));
+    }
+
+    // Branchless compaction: always store, only advance on visible lanes
+    const unsigned int mask = static_cast<unsigned int>(_mm256_movemask_ps(inside));
+    for (unsigned int lane = 0; lane < 8; lane++)
+    {
+      visible[written] = static_cast<std::uint32_t>(i + lane);
+      written += (mask >> lane) & 1u;
+    }
+  }
+
+  return written +
+         Culling::cullSpheresScalar(frustum, spheres, simdEnd, end - simdEnd, visible + written);
+}
+
+CPU_TARGET_SSE41 std::size_t cullSpheresSSE41(const Frustum& frustum,
+                                              const SphereBatch& spheres,
+                                              std::size_t first,
+                                              std::size_t count,
+                                              std::uint32_t* visible)
+{
+  __m128 nx[6], ny[6], nz[6], nd[6];
+  for (int p = 0; p < 6; p++)
+  {
+    nx[p] = _mm_set1_ps(frustum.planes[p].x);
+    ny[p] = _mm_set1_ps(frustum.planes[p].y);
+    nz[p] = _mm_set1_ps(frustum.planes[p].z);
+    nd[p] = _mm_set1_ps(frustum.planes[p].w);
+  }
+
+  const std::size_t end = first + count;
+  const std::size_t simdEnd = first + count / 4 * 4;
+  std::size_t written = 0;
+
+  for (std::size_t i = first; i < simdEnd; i += 4)
+  {
+    const __m128 x = _mm_loadu_ps(&spheres.x[i]);
+    const __m128 y = _mm_loadu_ps(&spheres.y[i]);
+    const __m128 z = _mm_loadu_ps(&spheres.z[i]);
+    const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < 6; p++)
+    {
+      __m128 dist = _mm_add_ps(_mm_mul_ps(nx[p], x), nd[p]);
+      dist = _mm_add_ps(_mm_mul_ps(ny[p], y), dist);
+      dist = _mm_add_ps(_mm_mul_ps(nz[p], z), dist);
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, negRadius));
+    }
+
+    const unsigned int mask = static_cast<unsigned int>(_mm_movemask_ps(inside));
+    for (unsigned int lane = 0; lane < 4; lane++)
+    {
+      visible[written] = static_cast<std::uint32_t>(i + lane);
+      written += (mask >> lane) & 1u;
+    }
+  }
+
+  return written +
+         Culling::cullSpheresScalar(frustum, spheres, simdEnd, end - simdEnd, visible + written);
+}
+#endif
+}  // namespace Culling
+
+Frustum Frustum::fromMatrix(const glm::mat4& m)
+{
+  // Rows of the matrix, glm is column-major
+  const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+  const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+  const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+  const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+  Frustum frustum;
+  frustum.planes[PLANE_LEFT] = row3 + row0;
+  frustum.planes[PLANE_RIGHT] = row3 - row0;
+  frustum.planes[PLANE_BOTTOM] = row3 + row1;
+  frustum.planes[PLANE_TOP] = row3 - row1;
+  frustum.planes[PLANE_NEAR] = row3 + row2;
+  frustum.planes[PLANE_FAR] = row3 - row2;
+
+  for (auto& plane : frustum.planes)
+  {
+    plane /= glm::length(glm::vec3(plane.x, plane.y, plane.z));
+  }
+  return frustum;
+}
+
+Frustum Frustum::fromCamera(const Camera& camera, const Transform& transform, float aspect)
+{
+  const glm::mat4 projection =
+      glm::perspective(glm::radians(camera.fov), aspect, camera.nearPlane, camera.farPlane);
+  const glm::mat4 view = glm::lookAt(
+      transform.position, transform.position + transform.forward(), transform.up());
+  return fromMatrix(projection * view);
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const
+{
+  for (const auto& plane : planes)
+  {
+    if (glm::dot(glm::vec3(plane.x, plane.y, plane.z), center) + plane.w < -radius)
+      return false;
+  }
+  return true;
+}
+
+bool Frustum::intersectsAABB(const AABB& box) const
+{
+  const glm::vec3 center = box.center();
+  const glm::vec3 extents = box.extents();
+  for (const auto& plane : planes)
+  {
+    const glm::vec3 normal(plane.x, plane.y, plane.z);
+    // Projected radius of the box onto the plane normal
+    const float radius = glm::dot(extents, glm::abs(normal));
+    if (glm::dot(normal, center) + plane.w < -radius)
+      return false;
+  }
+  return true;
+}
+
+namespace Culling
+{
+std::size_t cullSpheresScalar(const Frustum& frustum,
+                              const SphereBatch& spheres,
+                              std::size_t first,
+                              std::size_t count,
+                              std::uint32_t* visible)
+{
+  std::size_t written = 0;
+  for (std::size_t i = first; i < first + count; i++)
+  {
+    const glm::vec3 center(spheres.x[i], spheres.y[i], spheres.z[i]);
+    visible[written] = static_cast<std::uint32_t>(i);
+    written += frustum.intersectsSphere(center, spheres.radius[i]) ? 1 : 0;
+  }
+  return written;
+}
+
+std::size_t cullSpheres(const Frustum& frustum,
+                        const SphereBatch& spheres,
+                        std::size_t first,
+                        std::size_t count,
+                        std::uint32_t* visible)
+{
+#ifdef CPU_X86_64
+  if (CpuFeatures::hasAVX2())
+    return cullSpheresAVX2(frustum, spheres, first, count, visible);
+  if (CpuFeatures::hasSSE41())
+    return cullSpheresSSE41(frustum, spheres, first, count, visible);
+#endif
+  return cullSpheresScalar(frustum, spheres, first, count, visible);
+}
+
+void cullSpheres(const Frustum& frustum,
+                 const SphereBatch& spheres,
+                 std::vector<std::uint32_t>& visible,
+                 JobSystem* jobs)
+{
+  const std::size_t count = spheres.size();
+  visible.resize(count);
+
+  if (!jobs || count < PARALLEL_THRESHOLD)
+  {
+    visible.resize(cullSpheres(frustum, spheres, 0, count, visible.data()));
+    return;
+  }
+
+  // Each chunk compacts into its own slice of the output, the slices are joined afterwards
+  const std::size_t chunks = (count + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+  std::vector<std::size_t> chunkCounts(chunks);
+  jobs->parallelFor(count,
+                    PARALLEL_GRAIN,
+                    [&](std::size_t begin, std::size_t end)
+                    {
+                      chunkCounts[begin / PARALLEL_GRAIN] =
+                          cullSpheres(frustum, spheres, begin, end - begin, &visible[begin]);
+                    });
+
+  std::size_t written = chunkCounts[0];
+  for (std::size_t chunk = 1; chunk < chunks; chunk++)
+  {
+    std::memmove(&visible[written],
+                 &visible[chunk * PARALLEL_GRAIN],
+                 chunkCounts[chunk] * sizeof(std::uint32_t));
+    written += chunkCounts[chunk];
+  }
+  visible.resize(written);
+}
+}  // namespace Culling
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "aabb.h"
+#include "cpu_features.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Camera;
+struct Transform;
+class JobSystem;
+
+// Six planes with normals pointing inwards: a point p is inside when dot(n, p) + d >= 0
+struct Frustum
+{
+  enum Plane
+  {
+    PLANE_LEFT,
+    PLANE_RIGHT,
+    PLANE_BOTTOM,
+    PLANE_TOP,
+    PLANE_NEAR,
+    PLANE_FAR
+  };
+
+  std::array<glm::vec4, 6> planes;
+
+  // Gribb/Hartmann extraction from a combined projection * view matrix
+  static Frustum fromMatrix(const glm::mat4& viewProjection);
+  static Frustum fromCamera(const Camera& camera, const Transform& transform, float aspect);
+
+  bool intersectsSphere(const glm::vec3& center, float radius) const;
+  bool intersectsAABB(const AABB& box) const;
+};
+
+// World-space bounding spheres in structure-of-arrays form for the batched tests
+struct SphereBatch
+{
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<float> radius;
+
+  std::size_t size() const { return x.size(); }
+
+  void clear()
+  {
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+  }
+
+  void reserve(std::size_t count)
+  {
+    x.reserve(count);
+    y.reserve(count);
+    z.reserve(count);
+    radius.reserve(count);
+  }
+
+  void push(const glm::vec3& center, float r)
+  {
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(r);
+  }
+};
+
+namespace Culling
+{
+// Writes the indices (offset by first) of the spheres in [first, first + count) that touch the
+// frustum into visible, which must have room for count entries. Returns how many were written.
+// Uses AVX2 (8 spheres per step) or SSE4.1 (4 per step) when the CPU has them.
+std::size_t cullSpheres(const Frustum& frustum,
+                        const SphereBatch& spheres,
+                        std::size_t first,
+                        std::size_t count,
+                        std::uint32_t* visible);
+
+// Same as above across the whole batch, split over the job system for large counts
+void cullSpheres(const Frustum& frustum,
+                 const SphereBatch& spheres,
+                 std::vector<std::uint32_t>& visible,
+                 JobSystem* jobs = nullptr);
+
+// Reference implementation, also used for the tails the SIMD paths can't fill
+std::size_t cullSpheresScalar(const Frustum& frustum,
+                              const SphereBatch& spheres,
+                              std::size_t first,
+                              std::size_t count,
+                              std::uint32_t* visible);
+
+#ifdef CPU_X86_64
+// The kernels cullSpheres() picks between, only call them when CpuFeatures reports support
+CPU_TARGET_AVX2 std::size_t cullSpheresAVX2(const Frustum& frustum,
+                                            const SphereBatch& spheres,
+                                            std::size_t first,
+                                            std::size_t count,
+                                            std::uint32_t* visible);
+CPU_TARGET_SSE41 std::size_t cullSpheresSSE41(const Frustum& frustum,
+                                              const SphereBatch& spheres,
+                                              std::size_t first,
+                                              std::size_t count,
+                                              std::uint32_t* visible);
+#endif
+}  // namespace Culling
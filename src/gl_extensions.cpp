@@ -0,0 +1,77 @@
+#include "gl_extensions.h"
+
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <unordered_set>
+
+namespace
+{
+std::unordered_set<std::string> s_extensions;
+}
+
+int GLExtensions::s_major = 0;
+int GLExtensions::s_minor = 0;
+GLExtensions::BufferStorageProc GLExtensions::s_bufferStorage = nullptr;
+GLExtensions::GetProgramBinaryProc GLExtensions::s_getProgramBinary = nullptr;
+GLExtensions::ProgramBinaryProc GLExtensions::s_programBinary = nullptr;
+GLExtensions::ProgramParameteriProc GLExtensions::s_programParameteri = nullptr;
+bool GLExtensions::s_parallelShaderCompile = false;
+
+void GLExtensions::init()
+{
+  glGetIntegerv(GL_MAJOR_VERSION, &s_major);
+  glGetIntegerv(GL_MINOR_VERSION, &s_minor);
+
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  s_extensions.clear();
+  for (GLint i = 0; i < count; i++)
+  {
+    s_extensions.emplace(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)));
+  }
+
+  if (hasVersion(4, 4) || isSupported("GL_ARB_buffer_storage"))
+  {
+    s_bufferStorage = reinterpret_cast<BufferStorageProc>(glfwGetProcAddress("glBufferStorage"));
+  }
+
+  GLint binaryFormats = 0;
+  if (hasVersion(4, 1) || isSupported("GL_ARB_get_program_binary"))
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+  if (binaryFormats > 0)
+  {
+    s_getProgramBinary =
+        reinterpret_cast<GetProgramBinaryProc>(glfwGetProcAddress("glGetProgramBinary"));
+    s_programBinary = reinterpret_cast<ProgramBinaryProc>(glfwGetProcAddress("glProgramBinary"));
+    s_programParameteri =
+        reinterpret_cast<ProgramParameteriProc>(glfwGetProcAddress("glProgramParameteri"));
+    if (!s_getProgramBinary || !s_programParameteri)
+      s_programBinary = nullptr;
+  }
+
+  // Both extensions share the COMPLETION_STATUS token, only the entry point name differs
+  MaxShaderCompilerThreadsProc maxCompilerThreads = nullptr;
+  if (isSupported("GL_KHR_parallel_shader_compile"))
+    maxCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+        glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+  else if (isSupported("GL_ARB_parallel_shader_compile"))
+    maxCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+        glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+  s_parallelShaderCompile = maxCompilerThreads != nullptr;
+  if (maxCompilerThreads)
+  {
+    // Let the driver pick how many compiler threads to spin up
+    maxCompilerThreads(0xFFFFFFFF);
+  }
+}
+
+bool GLExtensions::isSupported(std::string_view name)
+{
+  return s_extensions.contains(std::string(name));
+}
+
+bool GLExtensions::hasVersion(int major, int minor)
+{
+  return s_major > major || (s_major == major && s_minor >= minor);
+}
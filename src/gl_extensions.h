@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string_view>
+
+// Tokens from post-3.3 extensions. The glad loader may or may not have been generated with them.
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+#ifndef GL_CLIENT_STORAGE_BIT
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// Static extension registry - queried once after the context is created.
+// Entry points are fetched through GLFW so we don't depend on what glad was generated with.
+class GLExtensions
+{
+  public:
+  using BufferStorageProc = void(APIENTRYP)(GLenum target,
+                                            GLsizeiptr size,
+                                            const void* data,
+                                            GLbitfield flags);
+  using GetProgramBinaryProc = void(APIENTRYP)(GLuint program,
+                                               GLsizei bufSize,
+                                               GLsizei* length,
+                                               GLenum* binaryFormat,
+                                               void* binary);
+  using ProgramBinaryProc = void(APIENTRYP)(GLuint program,
+                                            GLenum binaryFormat,
+                                            const void* binary,
+                                            GLsizei length);
+  using ProgramParameteriProc = void(APIENTRYP)(GLuint program, GLenum pname, GLint value);
+  using MaxShaderCompilerThreadsProc = void(APIENTRYP)(GLuint count);
+
+  // Call once the context is current and glad is loaded
+  static void init();
+
+  static bool isSupported(std::string_view name);
+  static bool hasVersion(int major, int minor);
+
+  // ARB_buffer_storage (core in 4.4)
+  static bool hasBufferStorage() { return s_bufferStorage != nullptr; }
+  static BufferStorageProc bufferStorage() { return s_bufferStorage; }
+
+  // ARB_get_program_binary (core in 4.1). Drivers may expose it with zero binary formats,
+  // in which case there is nothing we can store.
+  static bool hasProgramBinary() { return s_programBinary != nullptr; }
+  static GetProgramBinaryProc getProgramBinary() { return s_getProgramBinary; }
+  static ProgramBinaryProc programBinary() { return s_programBinary; }
+  static ProgramParameteriProc programParameteri() { return s_programParameteri; }
+
+  // KHR/ARB_parallel_shader_compile - GL_COMPLETION_STATUS_KHR can be polled without blocking
+  static bool hasParallelShaderCompile() { return s_parallelShaderCompile; }
+
+  private:
+  static int s_major;
+  static int s_minor;
+  static BufferStorageProc s_bufferStorage;
+  static GetProgramBinaryProc s_getProgramBinary;
+  static ProgramBinaryProc s_programBinary;
+  static ProgramParameteriProc s_programParameteri;
+  static bool s_parallelShaderCompile;
+};
@@ -0,0 +1,66 @@
+#include "gpu_timer.h"
+
+#include <glad/glad.h>
+
+GpuTimer::GpuTimer()
+    : m_issued(0), m_collected(0), m_lastMs(-1.0), m_totalMs(0.0), m_sampleCount(0)
+{
+  glGenQueries(LATENCY, m_queries);
+}
+
+GpuTimer::~GpuTimer()
+{
+  glDeleteQueries(LATENCY, m_queries);
+}
+
+void GpuTimer::begin()
+{
+  // Every query busy, wait for the oldest rather than overwrite it
+  if (m_issued - m_collected == LATENCY)
+    collect(true);
+  glBeginQuery(GL_TIME_ELAPSED, m_queries[m_issued % LATENCY]);
+}
+
+void GpuTimer::end()
+{
+  glEndQuery(GL_TIME_ELAPSED);
+  m_issued++;
+  collect(false);
+}
+
+void GpuTimer::finish()
+{
+  while (m_collected < m_issued)
+    collect(true);
+}
+
+void GpuTimer::reset()
+{
+  finish();
+  m_lastMs = -1.0;
+  m_totalMs = 0.0;
+  m_sampleCount = 0;
+}
+
+void GpuTimer::collect(bool wait)
+{
+  while (m_collected < m_issued)
+  {
+    const unsigned int query = m_queries[m_collected % LATENCY];
+    GLint available = GL_FALSE;
+    if (!wait)
+      glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!wait && !available)
+      return;
+
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+    m_collected++;
+    m_lastMs = static_cast<double>(nanoseconds) * 1e-6;
+    m_totalMs += m_lastMs;
+    m_sampleCount++;
+    // Only the oldest one was needed to free a query
+    if (wait)
+      return;
+  }
+}
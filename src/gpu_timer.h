@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+
+// GPU time spent between begin() and end(), from GL_TIME_ELAPSED queries.
+// Results are picked up LATENCY frames later so reading them never stalls the pipeline.
+class GpuTimer
+{
+  public:
+  static constexpr int LATENCY = 4;
+
+  GpuTimer();
+  ~GpuTimer();
+
+  GpuTimer(const GpuTimer&) = delete;
+  GpuTimer& operator=(const GpuTimer&) = delete;
+
+  // Once per frame, not nested with another timer
+  void begin();
+  void end();
+
+  // Blocks until every query in flight has a result, for the end of a benchmark run
+  void finish();
+  // Waits for the queries in flight and forgets every result, e.g. after warming up
+  void reset();
+
+  // Of the latest result, negative until there is one
+  inline double getMilliseconds() const { return m_lastMs; }
+  inline double getAverageMilliseconds() const
+  {
+    return m_sampleCount ? m_totalMs / m_sampleCount : -1.0;
+  }
+  inline std::size_t getSampleCount() const { return m_sampleCount; }
+
+  private:
+  void collect(bool wait);
+
+  unsigned int m_queries[LATENCY];
+  // Queries issued and queries read back, the difference is what's in flight
+  std::size_t m_issued;
+  std::size_t m_collected;
+
+  double m_lastMs;
+  double m_totalMs;
+  std::size_t m_sampleCount;
+};
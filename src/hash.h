@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Runtime FNV-1a for hashing blobs (vertex bytes, shader sources, file paths).
+// See ecs_constants.h for the compile-time 32-bit version used for event ids.
+inline constexpr std::uint64_t FNV1A_64_OFFSET = 14695981039346656037ull;
+
+inline std::uint64_t fnv1a_64(const void* data, std::size_t size, std::uint64_t hash = FNV1A_64_OFFSET)
+{
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < size; i++)
+  {
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+inline std::uint64_t fnv1a_64(std::string_view str, std::uint64_t hash = FNV1A_64_OFFSET)
+{
+  return fnv1a_64(str.data(), str.size(), hash);
+}
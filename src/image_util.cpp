@@ -0,0 +1,181 @@
+#include "image_util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+namespace
+{
+template <typename T>
+void put(std::string& out, const T& value)
+{
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void putAttribute(std::string& out, const char* name, const char* type, const std::string& value)
+{
+  out.append(name, std::strlen(name) + 1);
+  out.append(type, std::strlen(type) + 1);
+  put(out, static_cast<std::int32_t>(value.size()));
+  out += value;
+}
+}  // namespace
+
+namespace ImageUtil
+{
+std::vector<unsigned char> halve(const unsigned char* pixels, int width, int height, int channels)
+{
+  const int mipWidth = std::max(1, width / 2);
+  const int mipHeight = std::max(1, height / 2);
+  std::vector<unsigned char> mip(static_cast<size_t>(mipWidth) * mipHeight * channels);
+
+  for (int y = 0; y < mipHeight; y++)
+  {
+    const int y0 = std::min(y * 2, height - 1);
+    const int y1 = std::min(y * 2 + 1, height - 1);
+    for (int x = 0; x < mipWidth; x++)
+    {
+      const int x0 = std::min(x * 2, width - 1);
+      const int x1 = std::min(x * 2 + 1, width - 1);
+      for (int c = 0; c < channels; c++)
+      {
+        const int sum = pixels[(y0 * width + x0) * channels + c] +
+                        pixels[(y0 * width + x1) * channels + c] +
+                        pixels[(y1 * width + x0) * channels + c] +
+                        pixels[(y1 * width + x1) * channels + c];
+        mip[(y * mipWidth + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+      }
+    }
+  }
+  return mip;
+}
+
+std::vector<std::vector<unsigned char>> buildMipChain(std::vector<unsigned char> base,
+                                                      int width,
+                                                      int height,
+                                                      int channels)
+{
+  std::vector<std::vector<unsigned char>> mips;
+  mips.reserve(mipCount(width, height));
+  mips.push_back(std::move(base));
+  while (width > 1 || height > 1)
+  {
+    mips.push_back(halve(mips.back().data(), width, height, channels));
+    width = std::max(1, width / 2);
+    height = std::max(1, height / 2);
+  }
+  return mips;
+}
+
+std::vector<unsigned char> toRGBA(const unsigned char* pixels, int width, int height, int channels)
+{
+  const size_t count = static_cast<size_t>(width) * height;
+  std::vector<unsigned char> rgba(count * 4);
+  for (size_t i = 0; i < count; i++)
+  {
+    const unsigned char* src = pixels + i * channels;
+    unsigned char* dst = &rgba[i * 4];
+    if (channels >= 3)
+    {
+      dst[0] = src[0];
+      dst[1] = src[1];
+      dst[2] = src[2];
+    }
+    else
+    {
+      dst[0] = dst[1] = dst[2] = src[0];
+    }
+    dst[3] = channels == 4 ? src[3] : channels == 2 ? src[1] : 255;
+  }
+  return rgba;
+}
+std::vector<unsigned char> toUnorm8(const float* values, std::size_t count)
+{
+  std::vector<unsigned char> out(count);
+  for (std::size_t i = 0; i < count; i++)
+    out[i] = static_cast<unsigned char>(std::lround(std::clamp(values[i], 0.0f, 1.0f) * 255.0f));
+  return out;
+}
+
+bool writePNG(const std::string& filepath,
+              const unsigned char* pixels,
+              int width,
+              int height,
+              int channels)
+{
+  return stbi_write_png(filepath.c_str(), width, height, channels, pixels, width * channels) != 0;
+}
+
+bool writeEXR(const std::string& filepath, const float* rgb, int width, int height)
+{
+  // Single part scanline file, one line per block. Everything is little endian like the hosts
+  // we run on.
+  std::string header;
+  put(header, std::uint32_t{20000630});  // magic
+  put(header, std::uint32_t{2});         // version, no flags
+
+  // Channels are stored in alphabetical order
+  std::string channels;
+  for (const char* name : {"B", "G", "R"})
+  {
+    channels.append(name, 2);
+    put(channels, std::int32_t{2});  // FLOAT
+    put(channels, std::uint32_t{0});  // pLinear and reserved
+    put(channels, std::int32_t{1});  // x sampling
+    put(channels, std::int32_t{1});  // y sampling
+  }
+  channels += '\0';
+  putAttribute(header, "channels", "chlist", channels);
+  putAttribute(header, "compression", "compression", std::string(1, '\0'));
+
+  std::string window;
+  for (std::int32_t value : {0, 0, width - 1, height - 1})
+    put(window, value);
+  putAttribute(header, "dataWindow", "box2i", window);
+  putAttribute(header, "displayWindow", "box2i", window);
+  putAttribute(header, "lineOrder", "lineOrder", std::string(1, '\0'));
+
+  std::string value;
+  put(value, 1.0f);
+  putAttribute(header, "pixelAspectRatio", "float", value);
+  putAttribute(header, "screenWindowWidth", "float", value);
+  value.clear();
+  put(value, 0.0f);
+  put(value, 0.0f);
+  putAttribute(header, "screenWindowCenter", "v2f", value);
+  header += '\0';
+
+  const std::size_t lineBytes = static_cast<std::size_t>(width) * 3 * sizeof(float);
+  const std::size_t blockBytes = 2 * sizeof(std::int32_t) + lineBytes;
+  const std::uint64_t firstBlock = header.size() + static_cast<std::uint64_t>(height) * 8;
+  for (int y = 0; y < height; y++)
+    put(header, firstBlock + y * blockBytes);
+
+  std::ofstream file(filepath, std::ios::binary);
+  if (!file)
+    return false;
+  file.write(header.data(), header.size());
+
+  std::vector<float> line(static_cast<std::size_t>(width) * 3);
+  for (int y = 0; y < height; y++)
+  {
+    const float* row = rgb + static_cast<std::size_t>(y) * width * 3;
+    for (int x = 0; x < width; x++)
+    {
+      line[x] = row[x * 3 + 2];
+      line[width + x] = row[x * 3 + 1];
+      line[2 * width + x] = row[x * 3];
+    }
+    const std::int32_t coordinates[2] = {y, static_cast<std::int32_t>(lineBytes)};
+    file.write(reinterpret_cast<const char*>(coordinates), sizeof(coordinates));
+    file.write(reinterpret_cast<const char*>(line.data()), lineBytes);
+  }
+  return static_cast<bool>(file);
+}
+}  // namespace ImageUtil
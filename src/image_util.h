@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// CPU-side pixel helpers shared by the texture loader and the offline cooker.
+// All images are tightly packed rows, 8-bit unless they're float renders.
+namespace ImageUtil
+{
+// Half-size image using a 2x2 box filter, odd edges clamp onto the last row/column
+std::vector<unsigned char> halve(const unsigned char* pixels, int width, int height, int channels);
+
+// Full chain from the given level down to 1x1, level 0 included
+std::vector<std::vector<unsigned char>> buildMipChain(std::vector<unsigned char> base,
+                                                      int width,
+                                                      int height,
+                                                      int channels);
+
+// Widens 1-4 channel pixels to RGBA (grey replicated, alpha 255 when missing)
+std::vector<unsigned char> toRGBA(const unsigned char* pixels, int width, int height, int channels);
+
+// Clamps float channels to [0, 1] and rounds them to 8 bits
+std::vector<unsigned char> toUnorm8(const float* values, std::size_t count);
+
+bool writePNG(const std::string& filepath,
+              const unsigned char* pixels,
+              int width,
+              int height,
+              int channels);
+// Uncompressed 32-bit float RGB, rows top to bottom
+bool writeEXR(const std::string& filepath, const float* rgb, int width, int height);
+
+inline int mipCount(int width, int height)
+{
+  int count = 1;
+  while (width > 1 || height > 1)
+  {
+    width = width > 1 ? width / 2 : 1;
+    height = height > 1 ? height / 2 : 1;
+    count++;
+  }
+  return count;
+}
+}  // namespace ImageUtil
@@ -1,12 +1,18 @@
 #include "index_buffer.h"
 
-#include "glad/glad.h"
+#include <cassert>
+#include <cstdint>
 
-IndexBuffer::IndexBuffer(const void* data, unsigned int count) : m_count(count)
+IndexBuffer::IndexBuffer(const void* data, unsigned int count, unsigned int type)
+    : m_count(count), m_type(type)
 {
+  assert((type == GL_UNSIGNED_SHORT || type == GL_UNSIGNED_INT) && "Unsupported index type.");
+  const unsigned int indexSize =
+      type == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+
   glGenBuffers(1, &m_rendererID);
   glBindBuffer(GL_ARRAY_BUFFER, m_rendererID);
-  glBufferData(GL_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW);
+  glBufferData(GL_ARRAY_BUFFER, count * indexSize, data, GL_STATIC_DRAW);
 }
 
 IndexBuffer::~IndexBuffer()
@@ -1,17 +1,22 @@
 #pragma once
 
+#include <glad/glad.h>
+
 class IndexBuffer
 {
   public:
-  IndexBuffer(const void* data, unsigned int size);
+  // type is GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+  IndexBuffer(const void* data, unsigned int count, unsigned int type = GL_UNSIGNED_INT);
   ~IndexBuffer();
 
   void bind() const;
   void unbind() const;
 
   inline unsigned int getCount() const { return m_count; }
+  inline unsigned int getType() const { return m_type; }
 
   private:
   unsigned int m_rendererID;
   unsigned int m_count;
+  unsigned int m_type;
 };
@@ -0,0 +1,114 @@
+#include "job_system.h"
+
+#include <algorithm>
+
+JobSystem::JobSystem(unsigned int threadCount)
+{
+  if (threadCount == 0)
+    threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+  m_workers.reserve(threadCount);
+  for (unsigned int i = 0; i < threadCount; i++)
+  {
+    m_workers.emplace_back(&JobSystem::workerLoop, this);
+  }
+}
+
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard lock(m_mutex);
+    m_stopping = true;
+  }
+  m_condition.notify_all();
+
+  for (auto& worker : m_workers)
+  {
+    worker.join();
+  }
+}
+
+void JobSystem::parallelFor(std::size_t count,
+                            std::size_t grainSize,
+                            const std::function<void(std::size_t, std::size_t)>& fn)
+{
+  grainSize = std::max<std::size_t>(grainSize, 1);
+  const std::size_t chunks = (count + grainSize - 1) / grainSize;
+  if (chunks <= 1 || m_workers.empty())
+  {
+    if (count > 0)
+      fn(0, count);
+    return;
+  }
+
+  // Helpers pull chunks off a shared counter, so uneven chunks balance themselves
+  struct State
+  {
+    std::atomic<std::size_t> nextChunk{0};
+    std::atomic<std::size_t> finishedChunks{0};
+    std::mutex mutex;
+    std::condition_variable done;
+  };
+  auto state = std::make_shared<State>();
+
+  auto work = [state, count, grainSize, chunks, &fn]()
+  {
+    std::size_t chunk;
+    while ((chunk = state->nextChunk.fetch_add(1)) < chunks)
+    {
+      const std::size_t begin = chunk * grainSize;
+      fn(begin, std::min(begin + grainSize, count));
+
+      if (state->finishedChunks.fetch_add(1) + 1 == chunks)
+      {
+        std::lock_guard lock(state->mutex);
+        state->done.notify_all();
+      }
+    }
+  };
+
+  const std::size_t helpers = std::min<std::size_t>(m_workers.size(), chunks - 1);
+  for (std::size_t i = 0; i < helpers; i++)
+  {
+    enqueue(work);
+  }
+
+  work();
+
+  std::unique_lock lock(state->mutex);
+  state->done.wait(lock, [&]() { return state->finishedChunks.load() == chunks; });
+}
+
+void JobSystem::enqueue(std::function<void()> job)
+{
+  // Single core machine, nobody would ever pick the job up
+  if (m_workers.empty())
+  {
+    job();
+    return;
+  }
+
+  {
+    std::lock_guard lock(m_mutex);
+    m_queue.push_back(std::move(job));
+  }
+  m_condition.notify_one();
+}
+
+void JobSystem::workerLoop()
+{
+  while (true)
+  {
+    std::function<void()> job;
+    {
+      std::unique_lock lock(m_mutex);
+      m_condition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+      if (m_stopping && m_queue.empty())
+        return;
+
+      job = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+    job();
+  }
+}
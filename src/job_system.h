@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed pool of worker threads for CPU work that can run off the main thread.
+class JobSystem
+{
+  public:
+  // 0 picks one worker per hardware thread, minus the calling thread
+  explicit JobSystem(unsigned int threadCount = 0);
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  // Runs fn on a worker, the future carries its result or exception
+  template <typename F>
+  auto submit(F&& fn) -> std::future<std::invoke_result_t<F>>
+  {
+    using Result = std::invoke_result_t<F>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+    std::future<Result> future = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return future;
+  }
+
+  // Splits [0, count) into chunks of grainSize and runs fn(begin, end) on them in parallel.
+  // The calling thread works too and the call returns once every chunk has finished.
+  void parallelFor(std::size_t count,
+                   std::size_t grainSize,
+                   const std::function<void(std::size_t, std::size_t)>& fn);
+
+  // Workers plus the calling thread
+  inline unsigned int getConcurrency() const { return m_workers.size() + 1; }
+
+  private:
+  void enqueue(std::function<void()> job);
+  void workerLoop();
+
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void()>> m_queue;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_stopping{false};
+};
@@ -0,0 +1,76 @@
+#include "lod_selection.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Coarsest level whose threshold the size is under, after scaling every threshold
+std::uint32_t pick(std::span<const float> thresholds, float cullSize, float size, float scale)
+{
+  const std::uint32_t count = static_cast<std::uint32_t>(thresholds.size());
+  std::uint32_t level = 0;
+  while (level < count)
+  {
+    const float next = level + 1 < count ? thresholds[level + 1] : cullSize;
+    if (size >= next * scale)
+      break;
+    level++;
+  }
+  return level;
+}
+}  // namespace
+
+namespace LodSelection
+{
+float projectionScale(float fovDegrees)
+{
+  return 1.0f / std::tan(glm::radians(fovDegrees) * 0.5f);
+}
+
+float screenSize(const glm::vec3& center,
+                 float radius,
+                 const glm::vec3& cameraPosition,
+                 float projectionScale)
+{
+  const float distance = glm::length(center - cameraPosition);
+  if (distance <= radius)
+    return 1.0f;
+  return radius * projectionScale / distance;
+}
+
+void screenSizes(const SphereBatch& spheres,
+                 const std::uint32_t* indices,
+                 std::size_t count,
+                 const glm::vec3& cameraPosition,
+                 float projectionScale,
+                 float* sizes)
+{
+  for (std::size_t i = 0; i < count; i++)
+  {
+    const std::uint32_t sphere = indices[i];
+    const float dx = spheres.x[sphere] - cameraPosition.x;
+    const float dy = spheres.y[sphere] - cameraPosition.y;
+    const float dz = spheres.z[sphere] - cameraPosition.z;
+    const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+    const float radius = spheres.radius[sphere];
+    sizes[i] = distance <= radius ? 1.0f : radius * projectionScale / distance;
+  }
+}
+
+std::uint32_t select(std::span<const float> thresholds,
+                     float cullSize,
+                     float size,
+                     std::int64_t current,
+                     float hysteresis)
+{
+  if (current < 0)
+    return pick(thresholds, cullSize, size, 1.0f);
+
+  // Going coarser needs the size under the threshold by the margin, going finer over it, and
+  // anything in between keeps the current level
+  const std::uint32_t minLevel = pick(thresholds, cullSize, size, 1.0f - hysteresis);
+  const std::uint32_t maxLevel = pick(thresholds, cullSize, size, 1.0f + hysteresis);
+  return std::clamp(static_cast<std::uint32_t>(current), minLevel, maxLevel);
+}
+}  // namespace LodSelection
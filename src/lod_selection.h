@@ -0,0 +1,44 @@
+#pragma once
+
+#include "frustum.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Screen-size based level selection for LodGroup, split out of LodSystem so it runs without
+// the ECS
+namespace LodSelection
+{
+// How far past a threshold the size has to go before the level changes, as a fraction of it
+inline constexpr float HYSTERESIS = 0.15f;
+
+// 1 / tan(fov / 2), a sphere of radius r at distance d covers r * scale / d of the view height
+float projectionScale(float fovDegrees);
+
+// Fraction of the view height covered by the sphere, 1 from inside it
+float screenSize(const glm::vec3& center,
+                 float radius,
+                 const glm::vec3& cameraPosition,
+                 float projectionScale);
+
+// screenSize() of spheres[indices[i]] into sizes[i], for the visible list culling leaves behind
+void screenSizes(const SphereBatch& spheres,
+                 const std::uint32_t* indices,
+                 std::size_t count,
+                 const glm::vec3& cameraPosition,
+                 float projectionScale,
+                 float* sizes);
+
+// Level for an object covering size of the view. thresholds[i] is the size below which level i
+// is good enough (thresholds[0] is ignored), below cullSize the result is thresholds.size(),
+// meaning hidden. Staying on current wins as long as size is within hysteresis of the
+// thresholds around it, pass current = -1 for a plain pick.
+std::uint32_t select(std::span<const float> thresholds,
+                     float cullSize,
+                     float size,
+                     std::int64_t current,
+                     float hysteresis = HYSTERESIS);
+}  // namespace LodSelection
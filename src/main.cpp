@@ -1,13 +1,34 @@
+#include "component/bounds.h"
 #include "component/camera.h"
+#include "component/hierarchy.h"
+#include "component/lod_group.h"
+#include "component/material.h"
+#include "component/sdf_shape.h"
 #include "component/transform.h"
+#include "component/world_transform.h"
 #include "coordinator.h"
+#include "framebuffer.h"
+#include "frustum.h"
+#include "gpu_timer.h"
 #include "input.h"
+#include "job_system.h"
+#include "mesh.h"
+#include "program_cache.h"
 #include "renderer.h"
+#include "resource_manager.h"
+#include "sdf_brick_map.h"
+#include "sdf_collision.h"
+#include "sdf_mesher.h"
 #include "shader.h"
+#include "shader_watcher.h"
 #include "system/camera_system.h"
-#include "texture.h"
-#include "vertex_array.h"
-#include "vertex_buffer.h"
+#include "system/culling_system.h"
+#include "system/lod_system.h"
+#include "system/sdf_render_system.h"
+#include "system/spatial_index_system.h"
+#include "system/transform_system.h"
+#include "texture_array.h"
+#include "texture_manager.h"
 #include "window.h"
 
 #include <GLFW/glfw3.h>
@@ -17,6 +38,15 @@
 #include <glm/gtc/type_ptr.hpp>
 #include "glm/fwd.hpp"
 
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
 const unsigned int SCR_WIDTH = 1920;
 const unsigned int SCR_HEIGHT = 1080;
 
@@ -27,38 +57,39 @@ const glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 // Global coordinator definition (declared extern in ecs_constants.h)
 Coordinator g_coordinator;
 
-int main()
-{
-  Window window(SCR_WIDTH, SCR_HEIGHT, "OpenGL");
-  window.captureMouse(true);
+// Frames rendered before timing starts, on top of waiting for everything to load
+const int WARMUP_FRAMES = 60;
 
-  Input::init(window.getWindow());
+int main(int argc, char** argv)
+{
+  // --headless [frames] renders offscreen at SCR_WIDTH x SCR_HEIGHT with a fixed camera and
+  // time step, then prints the average GPU time of each pass
+  const bool headless = argc > 1 && std::string(argv[1]) == "--headless";
+  const int benchmarkFrames = headless && argc > 2 ? std::atoi(argv[2]) : 600;
 
-  // Could likely abstract this away into a shape file that I could specify what kind
-  // of shape that I want to spawn.
-  float vertices[] = {-0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 0.5f,  -0.5f, -0.5f, 1.0f, 0.0f,
-                      0.5f,  0.5f,  -0.5f, 1.0f, 1.0f, 0.5f,  0.5f,  -0.5f, 1.0f, 1.0f,
-                      -0.5f, 0.5f,  -0.5f, 0.0f, 1.0f, -0.5f, -0.5f, -0.5f, 0.0f, 0.0f,
+  Window window(SCR_WIDTH, SCR_HEIGHT, "OpenGL", !headless);
+  if (headless)
+    glfwSwapInterval(0);
+  else
+    window.captureMouse(true);
 
-                      -0.5f, -0.5f, 0.5f,  0.0f, 0.0f, 0.5f,  -0.5f, 0.5f,  1.0f, 0.0f,
-                      0.5f,  0.5f,  0.5f,  1.0f, 1.0f, 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-                      -0.5f, 0.5f,  0.5f,  0.0f, 1.0f, -0.5f, -0.5f, 0.5f,  0.0f, 0.0f,
+  Input::init(window.getWindow());
 
-                      -0.5f, 0.5f,  0.5f,  1.0f, 0.0f, -0.5f, 0.5f,  -0.5f, 1.0f, 1.0f,
-                      -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, -0.5f, -0.5f, -0.5f, 0.0f, 1.0f,
-                      -0.5f, -0.5f, 0.5f,  0.0f, 0.0f, -0.5f, 0.5f,  0.5f,  1.0f, 0.0f,
+  // Reuse linked programs from previous runs instead of recompiling every shader
+  ProgramCache::init("cache/shaders");
 
-                      0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 0.5f,  0.5f,  -0.5f, 1.0f, 1.0f,
-                      0.5f,  -0.5f, -0.5f, 0.0f, 1.0f, 0.5f,  -0.5f, -0.5f, 0.0f, 1.0f,
-                      0.5f,  -0.5f, 0.5f,  0.0f, 0.0f, 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+  JobSystem jobs;
+  ResourceManager resources(jobs);
 
-                      -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 0.5f,  -0.5f, -0.5f, 1.0f, 1.0f,
-                      0.5f,  -0.5f, 0.5f,  1.0f, 0.0f, 0.5f,  -0.5f, 0.5f,  1.0f, 0.0f,
-                      -0.5f, -0.5f, 0.5f,  0.0f, 0.0f, -0.5f, -0.5f, -0.5f, 0.0f, 1.0f,
+  // Kick off shader compilation first so the driver works on it while we build meshes and
+  // decode textures. Draws with a shader that isn't ready yet are skipped.
+  Shader& program = *resources.get(resources.loadShader("res/shaders/basic.glsl"));
+  Shader& light = *resources.get(resources.loadShader("res/shaders/lighting.glsl"));
 
-                      -0.5f, 0.5f,  -0.5f, 0.0f, 1.0f, 0.5f,  0.5f,  -0.5f, 1.0f, 1.0f,
-                      0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-                      -0.5f, 0.5f,  0.5f,  0.0f, 0.0f, -0.5f, 0.5f,  -0.5f, 0.0f, 1.0f};
+  // Edits to the shader sources are picked up while running
+  ShaderWatcher shaderWatcher;
+  shaderWatcher.watch(program);
+  shaderWatcher.watch(light);
 
   // world space positions of our cubes
   glm::vec3 cubePositions[] = {glm::vec3(0.0f, 0.0f, 0.0f),
@@ -72,11 +103,19 @@ int main()
                                glm::vec3(1.5f, 0.2f, -1.5f),
                                glm::vec3(-1.3f, 1.0f, -1.5f)};
 
-  VertexBuffer vb(vertices, sizeof(vertices));
+  // Cooked from res/models/cube.obj by mesh_cooker at build time, drawn once it's paged in
+  const Handle<Mesh> cubeMesh = resources.loadMesh("res/meshes/cube.mesh");
 
   // Register ECS components
   g_coordinator.RegisterComponent<Transform>();
   g_coordinator.RegisterComponent<Camera>();
+  g_coordinator.RegisterComponent<Bounds>();
+  g_coordinator.RegisterComponent<Material>();
+  g_coordinator.RegisterComponent<SDFShape>();
+  g_coordinator.RegisterComponent<WorldTransform>();
+  g_coordinator.RegisterComponent<Parent>();
+  g_coordinator.RegisterComponent<Children>();
+  g_coordinator.RegisterComponent<LodGroup>();
 
   // Register ECS systems
   auto camera_system = g_coordinator.registerSystem<CameraControlSystem>();
@@ -85,6 +124,32 @@ int main()
   cameraSig.set(g_coordinator.GetComponentType<Camera>());
   g_coordinator.SetSystemSignature<CameraControlSystem>(cameraSig);
 
+  auto transform_system = g_coordinator.registerSystem<TransformSystem>();
+  Signature transformSig;
+  transformSig.set(g_coordinator.GetComponentType<Transform>());
+  transformSig.set(g_coordinator.GetComponentType<WorldTransform>());
+  g_coordinator.SetSystemSignature<TransformSystem>(transformSig);
+
+  auto culling_system = g_coordinator.registerSystem<CullingSystem>();
+  Signature cullingSig;
+  cullingSig.set(g_coordinator.GetComponentType<WorldTransform>());
+  cullingSig.set(g_coordinator.GetComponentType<Bounds>());
+  g_coordinator.SetSystemSignature<CullingSystem>(cullingSig);
+
+  auto spatial_system = g_coordinator.registerSystem<SpatialIndexSystem>();
+  g_coordinator.SetSystemSignature<SpatialIndexSystem>(cullingSig);
+
+  auto lod_system = g_coordinator.registerSystem<LodSystem>();
+  Signature lodSig = cullingSig;
+  lodSig.set(g_coordinator.GetComponentType<LodGroup>());
+  g_coordinator.SetSystemSignature<LodSystem>(lodSig);
+
+  auto sdf_system = g_coordinator.registerSystem<SDFRenderSystem>();
+  Signature sdfSig;
+  sdfSig.set(g_coordinator.GetComponentType<WorldTransform>());
+  sdfSig.set(g_coordinator.GetComponentType<SDFShape>());
+  g_coordinator.SetSystemSignature<SDFRenderSystem>(sdfSig);
+
   // Create camera entity
   Entity cameraEntity = g_coordinator.createEntity();
   Transform cameraTransform{};
@@ -97,44 +162,181 @@ int main()
   cameraComponent.farPlane = 100.0f;
   g_coordinator.AddComponent(cameraEntity, cameraComponent);
 
-  // Initialize camera system
-  camera_system->Init();
-
-  VertexArray va;
-  VertexBufferLayout layout;
-  // Define position attribute (3 floats)
-  layout.push<float>(3);
-  // Define texture coordinate attribute (2 floats)
-  layout.push<float>(2);
-  va.addBuffer(vb, layout);
+  // Create the cube entities, bounded by the sphere around a unit cube
+  std::vector<Entity> cubes;
+  for (unsigned int i = 0; i < 10; i++)
+  {
+    Entity cube = cubes.emplace_back(g_coordinator.createEntity());
+    Transform cubeTransform{};
+    cubeTransform.position = cubePositions[i];
+    cubeTransform.rotation =
+        glm::angleAxis(glm::radians(20.0f * i), glm::normalize(glm::vec3(1.0f, 0.3f, 0.5f)));
+    g_coordinator.AddComponent(cube, cubeTransform);
+    g_coordinator.AddComponent(cube, WorldTransform{});
+
+    Bounds cubeBounds{};
+    cubeBounds.radius = glm::length(glm::vec3(0.5f));
+    g_coordinator.AddComponent(cube, cubeBounds);
+  }
 
-  VertexArray lightVAO;
-  lightVAO.addBuffer(vb, layout);
+  // Initialize systems
+  // The camera bumps into the SDF shapes instead of flying through them
+  SDFCollisionWorld collision;
+  camera_system->Init(&collision);
+  transform_system->Init(&jobs);
+  culling_system->Init(&jobs);
+  spatial_system->Init(&jobs);
+
+  // A small cube rides on the first one and turns with it
+  Entity moon = cubes.emplace_back(g_coordinator.createEntity());
+  Transform moonTransform{};
+  moonTransform.position = glm::vec3(0.0f, 0.0f, 1.2f);
+  moonTransform.scale = glm::vec3(0.3f);
+  g_coordinator.AddComponent(moon, moonTransform);
+  g_coordinator.AddComponent(moon, WorldTransform{});
+  Bounds moonBounds{};
+  moonBounds.radius = glm::length(glm::vec3(0.5f));
+  g_coordinator.AddComponent(moon, moonBounds);
+  transform_system->setParent(moon, cubes[0]);
+  sdf_system->Init(SCR_WIDTH, SCR_HEIGHT);
+
+  // A static blob gets a program with its sizes baked in
+  Entity blob = g_coordinator.createEntity();
+  Transform blobTransform{};
+  blobTransform.position = glm::vec3(-1.2f, 1.0f, 2.0f);
+  g_coordinator.AddComponent(blob, blobTransform);
+  g_coordinator.AddComponent(blob, WorldTransform{});
+  SDFShape blobShape{};
+  blobShape.isStatic = true;
+  blobShape.color = glm::vec3(0.0f, 0.0f, 1.0f);
+  {
+    SDFObject& sdf = blobShape.sdf;
+    Transform offset{};
+    offset.position = glm::vec3(0.0f, 0.5f, 0.0f);
+    sdf.unite(sdf.box(glm::vec3(0.4f)), sdf.sphere(0.4f, offset), 0.3f);
+  }
+  g_coordinator.AddComponent(blob, blobShape);
+
+  // The animated one is rebuilt every frame, only its parameters change so it keeps its program.
+  // Tab swaps the cutter for another primitive, which is a new structure and a new program.
+  Entity ring = g_coordinator.createEntity();
+  Transform ringTransform{};
+  ringTransform.position = glm::vec3(2.5f, 1.0f, 0.0f);
+  g_coordinator.AddComponent(ring, ringTransform);
+  g_coordinator.AddComponent(ring, WorldTransform{});
+  g_coordinator.AddComponent(ring, SDFShape{});
+  int ringCutter = 0;
+  auto buildRing = [&ringCutter](SDFObject& sdf, float time)
+  {
+    sdf.clear();
+    Transform cutterTransform{};
+    cutterTransform.position = glm::vec3(std::sin(time) * 0.8f, 0.0f, 0.0f);
+    const SDFNodeId cutter = ringCutter == 0
+                                 ? sdf.capsule(0.4f, 0.25f, cutterTransform)
+                                 : sdf.box(glm::vec3(0.3f), cutterTransform);
+    sdf.subtract(sdf.torus(0.7f, 0.2f + 0.05f * std::sin(time * 2.0f)), cutter, 0.05f);
+  };
+
+  // A crown of 25 primitives would be 25 evaluations per marching step, baked it's one lookup
+  Entity crown = g_coordinator.createEntity();
+  Transform crownTransform{};
+  crownTransform.position = glm::vec3(-3.0f, 1.0f, -3.0f);
+  g_coordinator.AddComponent(crown, crownTransform);
+  g_coordinator.AddComponent(crown, WorldTransform{});
+  SDFShape crownShape{};
+  crownShape.color = glm::vec3(0.9f, 0.7f, 0.2f);
+  {
+    SDFObject& sdf = crownShape.sdf;
+    SDFNodeId node = sdf.torus(0.8f, 0.15f);
+    for (int i = 0; i < 12; i++)
+    {
+      const float angle = glm::radians(30.0f * i);
+      Transform spike{};
+      spike.position = glm::vec3(std::cos(angle) * 0.8f, 0.3f, std::sin(angle) * 0.8f);
+      node = sdf.unite(node, sdf.capsule(0.25f, 0.08f, spike), 0.1f);
+      spike.position.y = 0.6f;
+      node = sdf.unite(node, sdf.sphere(0.12f, spike), 0.05f);
+    }
+    SDFBrickMap crownBake(0.02f);
+    crownBake.bake(sdf, jobs);
+    auto bricks = std::make_shared<SDFBrickTexture>();
+    bricks->upload(crownBake);
+    crownShape.bricks = std::move(bricks);
+    // From far enough away it's rasterised instead
+    crownShape.mesh = resources.addMesh(
+        "meshed/crown", std::make_shared<Mesh>("crown", SDFMesher::build(sdf, 0.02f, 3, jobs)));
+  }
+  g_coordinator.AddComponent(crown, crownShape);
 
-  // Shader
-  Shader program("res/shaders/basic.glsl");
-  Shader light("res/shaders/lighting.glsl");
-  Shader sdf("res/shaders/sdf.glsl");
-  program.bind();
+  // The camera collides with the shapes. They're added once and follow their world matrices,
+  // only the ring animates and gets replaced by its latest version every frame.
+  const Entity colliders[] = {blob, ring, crown};
+  for (Entity entity : colliders)
+  {
+    collision.add(g_coordinator.GetComponent<SDFShape>(entity).sdf,
+                  g_coordinator.GetComponent<WorldTransform>(entity).toMat4());
+  }
 
-  Texture texture1("res/textures/container.jpg", false);
-  texture1.bind(0);
-  program.setUniform("texture1", 0);
+  // Every texture shares one array, both of these are 512x512 and get a layer each. They're
+  // decoded and packed on the job system, the cubes show up once the array is built.
+  std::future<TextureAtlas> packing = jobs.submit(
+      []()
+      {
+        return TextureArray::packFiles(
+            {"res/textures/container.jpg", "res/textures/awesomeface.png"}, 512, 512);
+      });
+  std::unique_ptr<TextureArray> textures;
+  // Detail textures stream in at the resolution they're drawn at, within a fixed budget
+  TextureManager textureManager(jobs);
+  Material cubeMaterial{};
+  cubeMaterial.detail = resources.addTexture("streamed/res/textures/container.jpg",
+                                             textureManager.load("res/textures/container.jpg"));
+  // One level, the cube is too simple to coarsen, but they stop being drawn once they're specks
+  LodGroup cubeLods{};
+  cubeLods.levels.push_back({cubeMesh, 0, 1.0f});
+  cubeLods.cullScreenSize = 0.01f;
+  for (Entity cube : cubes)
+  {
+    g_coordinator.AddComponent(cube, cubeMaterial);
+    g_coordinator.AddComponent(cube, cubeLods);
+  }
 
-  Texture texture2("res/textures/awesomeface.png", true);
-  texture2.bind(1);
-  program.setUniform("texture2", 1);
+  auto setRegion = [](const Shader& shader, const std::string& name, const TextureRegion& region)
+  {
+    shader.setUniform(
+        name + ".rect", region.offset.x, region.offset.y, region.scale.x, region.scale.y);
+    shader.setUniform(name + ".layer", static_cast<float>(region.layer));
+  };
 
   Renderer renderer(0.1f, 0.1f, 0.1f);
   renderer.enableDepthTest();
 
+  // Everything is drawn offscreen, the raymarcher reads a copy of the depth the meshes left
+  Framebuffer scene(SCR_WIDTH, SCR_HEIGHT, GL_RGBA8, true);
+  Framebuffer sceneDepth(SCR_WIDTH, SCR_HEIGHT, GL_NONE, true);
+  GpuTimer meshTimer;
+  int frame = 0;
+  int measuredFrom = -1;
+
   float deltaTime = 0.0f;
   float lastFrame = 0.0f;
+  bool wasClicking = false;
 
   while (!window.shouldClose())
   {
     // TODO Abstract this into Time
-    float currentFrame = static_cast<float>(glfwGetTime());
+    float currentFrame = headless ? frame / 60.0f : static_cast<float>(glfwGetTime());
+    if (headless && measuredFrom < 0 && frame >= WARMUP_FRAMES &&
+        resources.getLoadingCount() == 0 && textures && !sdf_system->isCompiling())
+    {
+      measuredFrom = frame;
+      meshTimer.reset();
+      sdf_system->getPrepassTimer().reset();
+      sdf_system->getMarchTimer().reset();
+    }
+    if (headless && measuredFrom >= 0 && frame - measuredFrom == benchmarkFrames)
+      break;
+    frame++;
     deltaTime = currentFrame - lastFrame;
     lastFrame = currentFrame;
 
@@ -143,6 +345,8 @@ int main()
     {
       glfwSetWindowShouldClose(window.getWindow(), true);
     }
+    if (Input::isKeyDown(GLFW_KEY_TAB))
+      ringCutter = 1 - ringCutter;
 
     // Send input events to ECS
     std::bitset<8> inputButtons;
@@ -158,16 +362,63 @@ int main()
     g_coordinator.SendEvent(inputEvent);
 
     // Update ECS systems
+    g_coordinator.GetComponent<Transform>(cubes[0]).rotation =
+        glm::angleAxis(currentFrame, glm::vec3(0.0f, 1.0f, 0.0f));
+    transform_system->Update();
+    spatial_system->Update();
+
+    for (std::uint32_t i = 0; i < std::size(colliders); i++)
+    {
+      const glm::mat4 model = g_coordinator.GetComponent<WorldTransform>(colliders[i]).toMat4();
+      if (colliders[i] == ring)
+        collision.replace(i, g_coordinator.GetComponent<SDFShape>(ring).sdf, model);
+      else if (transform_system->wasUpdated(colliders[i]))
+        collision.update(i, model);
+    }
     camera_system->Update(deltaTime);
 
+    // Clicking toggles the overlay of whatever is under the crosshair
+    const bool clicking = Input::isMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT);
+    if (clicking && !wasClicking)
+    {
+      const auto& eye = g_coordinator.GetComponent<Transform>(cameraEntity);
+      const auto picked = spatial_system->pick(eye.position, eye.forward(), 100.0f);
+      if (picked && g_coordinator.HasComponent<Material>(*picked))
+      {
+        auto& material = g_coordinator.GetComponent<Material>(*picked);
+        material.overlayMix = material.overlayMix > 0.5f ? 0.2f : 1.0f;
+      }
+    }
+    wasClicking = clicking;
+
+    shaderWatcher.update();
+    resources.update();
+    textureManager.update();
+    if (!textures && packing.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+      // Region ids follow the file order
+      const TextureAtlas atlas = packing.get();
+      textures = std::make_unique<TextureArray>(atlas);
+      for (Entity cube : cubes)
+      {
+        auto& material = g_coordinator.GetComponent<Material>(cube);
+        material.albedo = atlas.getRegion(0);
+        material.overlay = atlas.getRegion(1);
+      }
+    }
+
     Input::update();
 
+    scene.bind();
     renderer.clear();
+    meshTimer.begin();
 
-    texture1.bind(0);
-    texture2.bind(1);
+    if (textures)
+      textures->bind(0);
 
     program.bind();
+    program.setUniform("textures", 0);
+    program.setUniform("detail", 1);
     light.setUniform("objectColor", 1.0f, 0.5f, 0.31f);
     light.setUniform("lightColor", 1.0f, 1.0f, 1.0f);
 
@@ -188,20 +439,37 @@ int main()
                                  cameraTransform.up());
     program.setUniform("view", view);
 
-    // render boxes
-    va.bind();
+    // Only draw what the camera can see, at the detail its size on screen calls for
+    culling_system->Update(Frustum::fromMatrix(projection * view));
+    lod_system->Update(*culling_system, cameraTransform.position, camera, deltaTime);
+
+    // Null until the file has been paged in and uploaded
+    const Mesh* cube = resources.get(cubeMesh);
 
-    glm::mat4 model = glm::mat4(1.0f);  // make sure to initialize matrix to identity matrix first
-    for (unsigned int i = 0; i < 10; i++)
+    // render boxes
+    const Texture* boundDetail = nullptr;
+    for (const LodSystem::Draw& draw : lod_system->getDraws())
     {
-      // calculate the model matrix for each object and pass it to shader before drawing
-      model = glm::mat4(1.0f);  // make sure to initialize matrix to identity matrix first
-      model = glm::translate(model, cubePositions[i]);
-      float angle = 20.0f * i;
-      model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-      program.setUniform("model", model);
-
-      renderer.draw(va, program, 36);
+      const auto& level = g_coordinator.GetComponent<LodGroup>(draw.entity).levels[draw.level];
+      const Mesh* mesh = resources.get(level.mesh);
+      if (!mesh || !textures)
+        continue;
+      program.setUniform("model", g_coordinator.GetComponent<WorldTransform>(draw.entity).toMat4());
+      const auto& material = g_coordinator.GetComponent<Material>(draw.entity);
+      setRegion(program, "albedo", material.albedo);
+      setRegion(program, "overlay", material.overlay);
+      program.setUniform("overlayMix", material.overlayMix);
+      program.setUniform("lodFade", draw.fade);
+      if (const Texture* detail = resources.get(material.detail))
+      {
+        // Tells the manager which levels of the detail texture are worth keeping
+        textureManager.requestSize(*detail, draw.screenSize * SCR_HEIGHT / material.detailTiling);
+        if (detail != boundDetail)
+          detail->bind(1);
+        boundDetail = detail;
+        program.setUniform("detailTiling", material.detailTiling);
+      }
+      mesh->draw(renderer, program, level.meshLod);
     }
 
     light.bind();
@@ -209,41 +477,57 @@ int main()
     light.setUniform("lightColor", 1.0f, 1.0f, 1.0f);
     light.setUniform("projection", projection);
     light.setUniform("view", view);
-    model = glm::mat4(1.0f);
+    glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, lightPos);
     model = glm::scale(model, glm::vec3(0.2f));
     light.setUniform("model", model);
-    lightVAO.bind();
-    renderer.draw(lightVAO, light, 36);
-
-    glm::vec3 sdfPos(-1.2f, 1.0f, 2.0f);
-    float sdfRadius = 1.0f;  // Sphere radius
-    sdf.bind();
-    sdf.setUniform("objectColor", 0.0f, 0.0f, 1.0);
-    sdf.setUniform("projection", projection);
-    sdf.setUniform("view", view);
-    // Create bounding box slightly larger than the sphere
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, sdfPos);
-    model = glm::scale(model, glm::vec3(sdfRadius * 2.0f));  // Bounding box size
-    sdf.setUniform("model", model);
-    // Pass SDF-specific uniforms
-    float time = glfwGetTime();
-    sdf.setUniform("time", time);
-    sdf.setUniform("cameraPos", cameraTransform.position);
-    sdf.setUniform("sphereCenter", sdfPos);
-    sdf.setUniform("sphereRadius", sdfRadius);
-
-    // Bind the cube VAO (this is the bounding box)
-    lightVAO.bind();  // Using cube geometry as bounding box
-
-    // Draw the bounding box (raymarching happens in fragment shader)
-    renderer.draw(lightVAO, sdf, 36);
+    if (cube)
+      cube->draw(renderer, light);
+    meshTimer.end();
+
+    // Raymarched inside the cube mesh stretched over their bounds
+    scene.blit(&sceneDepth, GL_DEPTH_BUFFER_BIT);
+    buildRing(g_coordinator.GetComponent<SDFShape>(ring).sdf, currentFrame);
+    if (cube)
+    {
+      sdf_system->Render(renderer,
+                         resources,
+                         *cube,
+                         view,
+                         projection,
+                         cameraTransform.position,
+                         camera.farPlane,
+                         sceneDepth,
+                         scene);
+    }
 
+    if (!headless)
+    {
+      int width, height;
+      glfwGetFramebufferSize(window.getWindow(), &width, &height);
+      scene.blit(nullptr, GL_COLOR_BUFFER_BIT, width, height);
+    }
     window.swapBuffers();
     window.pollEvents();
   }
   // TODO Error handling
 
+  if (headless)
+  {
+    meshTimer.finish();
+    sdf_system->getPrepassTimer().finish();
+    sdf_system->getMarchTimer().finish();
+    std::cout << benchmarkFrames << " frames at " << SCR_WIDTH << "x" << SCR_HEIGHT
+              << ", average GPU ms\n"
+              << "  meshes       " << meshTimer.getAverageMilliseconds() << "\n"
+              << "  sdf prepass  " << sdf_system->getPrepassTimer().getAverageMilliseconds()
+              << "\n"
+              << "  sdf march    " << sdf_system->getMarchTimer().getAverageMilliseconds()
+              << std::endl;
+  }
+
+  // g_coordinator outlives the window, baked SDF textures have to go while there's a context
+  for (Entity shape : {blob, ring, crown})
+    g_coordinator.GetComponent<SDFShape>(shape).bricks.reset();
   return 0;
 }
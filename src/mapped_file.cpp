@@ -0,0 +1,88 @@
+#include "mapped_file.h"
+
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP 1
+#endif
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+  *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  if (this != &other)
+  {
+    close();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+    m_mapped = std::exchange(other.m_mapped, false);
+    m_fallback = std::move(other.m_fallback);
+  }
+  return *this;
+}
+
+bool MappedFile::open(const std::string& filepath)
+{
+  close();
+
+#ifdef MAPPED_FILE_MMAP
+  int fd = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) == 0 && info.st_size > 0)
+  {
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED)
+    {
+      m_data = static_cast<const unsigned char*>(mapping);
+      m_size = static_cast<std::size_t>(info.st_size);
+      m_mapped = true;
+    }
+  }
+  ::close(fd);  // the mapping keeps its own reference
+  if (m_mapped)
+    return true;
+#endif
+
+  std::ifstream stream(filepath, std::ios::binary | std::ios::ate);
+  if (!stream)
+    return false;
+  m_fallback.resize(static_cast<std::size_t>(stream.tellg()));
+  stream.seekg(0);
+  auto* buffer = reinterpret_cast<char*>(m_fallback.data());
+  if (m_fallback.empty() || !stream.read(buffer, m_fallback.size()))
+  {
+    m_fallback.clear();
+    return false;
+  }
+  m_data = m_fallback.data();
+  m_size = m_fallback.size();
+  return true;
+}
+
+void MappedFile::close()
+{
+#ifdef MAPPED_FILE_MMAP
+  if (m_mapped)
+    munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+  m_data = nullptr;
+  m_size = 0;
+  m_mapped = false;
+  m_fallback.clear();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. Memory-mapped on POSIX so pages are only read in as they are
+// touched; elsewhere the file is read into memory up front.
+class MappedFile
+{
+  public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string& filepath) { open(filepath); }
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  bool open(const std::string& filepath);
+  void close();
+
+  inline bool isOpen() const { return m_data != nullptr; }
+  inline const unsigned char* data() const { return m_data; }
+  inline std::size_t size() const { return m_size; }
+
+  private:
+  const unsigned char* m_data = nullptr;
+  std::size_t m_size = 0;
+  bool m_mapped = false;
+  std::vector<unsigned char> m_fallback;
+};
@@ -0,0 +1,94 @@
+#include "mesh.h"
+
+#include "renderer.h"
+
+#include <iostream>
+
+Mesh::Mesh(const std::string& filepath) : m_filepath(filepath)
+{
+  MeshContainer::View container;
+  if (!container.open(filepath))
+  {
+    std::cerr << "ERROR::MESH::LOAD_FAILED " << filepath << std::endl;
+    return;
+  }
+
+  const auto& header = container.getHeader();
+  m_bounds = AABB(glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+                  glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]));
+  m_lodScreenSize.assign(header.lodScreenSize, header.lodScreenSize + header.lodCount);
+  const auto submeshes = container.getSubmeshes();
+  m_submeshes.assign(submeshes.begin(), submeshes.end());
+
+  // Straight from the mapping, the driver copies the pages as it reads them
+  const auto vertices = container.getVertexData();
+  const auto indices = container.getIndexData();
+  upload(vertices.data(), vertices.size(), indices.data(), header.indexCount, header.indexSize);
+}
+
+Mesh::Mesh(const std::string& name, const MeshContainer::MeshData& data) : m_filepath(name)
+{
+  if (data.vertices.empty() || data.indices.empty())
+  {
+    std::cerr << "ERROR::MESH::EMPTY " << name << std::endl;
+    return;
+  }
+
+  m_bounds = AABB(glm::vec3(data.boundsMin[0], data.boundsMin[1], data.boundsMin[2]),
+                  glm::vec3(data.boundsMax[0], data.boundsMax[1], data.boundsMax[2]));
+  m_lodScreenSize = data.lodScreenSize;
+  m_submeshes = data.submeshes;
+  upload(data.vertices.data(),
+         data.vertices.size() * sizeof(MeshContainer::Vertex),
+         data.indices.data(),
+         static_cast<unsigned int>(data.indices.size() / data.indexSize),
+         data.indexSize);
+}
+
+void Mesh::upload(const void* vertices,
+                  std::size_t vertexBytes,
+                  const void* indices,
+                  unsigned int indexCount,
+                  unsigned int indexSize)
+{
+  m_vertexBuffer = std::make_unique<VertexBuffer>(vertices, vertexBytes);
+  m_indexBuffer = std::make_unique<IndexBuffer>(
+      indices, indexCount, indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+  m_vertexArray = std::make_unique<VertexArray>();
+  m_vertexArray->addBuffer(*m_vertexBuffer, getLayout());
+}
+
+VertexBufferLayout Mesh::getLayout()
+{
+  VertexBufferLayout layout;
+  layout.push<float>(3);
+  layout.push<Half>(2);
+  layout.push<PackedNormal>(4);
+  return layout;
+}
+
+int Mesh::selectLod(float screenSize) const
+{
+  int lod = 0;
+  while (lod + 1 < getLodCount() && screenSize < m_lodScreenSize[lod + 1])
+    lod++;
+  return lod;
+}
+
+void Mesh::draw(const Renderer& renderer, const Shader& shader, int lod) const
+{
+  if (!isLoaded())
+    return;
+
+  for (const auto& submesh : m_submeshes)
+  {
+    if (submesh.lod != static_cast<std::uint32_t>(lod))
+      continue;
+    renderer.drawRange(*m_vertexArray,
+                       *m_indexBuffer,
+                       shader,
+                       submesh.firstIndex,
+                       submesh.indexCount,
+                       submesh.baseVertex);
+  }
+}
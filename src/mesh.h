@@ -0,0 +1,59 @@
+#pragma once
+
+#include "aabb.h"
+#include "index_buffer.h"
+#include "mesh_container.h"
+#include "vertex_array.h"
+#include "vertex_buffer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class Renderer;
+class Shader;
+
+// Cooked mesh (.mesh from tools/mesh_cooker) on the GPU.
+// The file is mapped and its vertex and index blobs handed to GL as they are, there is no
+// per-vertex work at load time.
+class Mesh
+{
+  public:
+  explicit Mesh(const std::string& filepath);
+  // Built at runtime instead of cooked, name is only for messages
+  Mesh(const std::string& name, const MeshContainer::MeshData& data);
+
+  Mesh(const Mesh&) = delete;
+  Mesh& operator=(const Mesh&) = delete;
+
+  inline bool isLoaded() const { return m_vertexArray != nullptr; }
+  inline const std::string& getFilepath() const { return m_filepath; }
+  inline const AABB& getBounds() const { return m_bounds; }
+  inline int getLodCount() const { return static_cast<int>(m_lodScreenSize.size()); }
+  inline const std::vector<MeshContainer::Submesh>& getSubmeshes() const { return m_submeshes; }
+
+  // Coarsest LOD still good enough for a mesh covering screenSize of the viewport height
+  int selectLod(float screenSize) const;
+
+  // Draws every submesh of the LOD, nothing if the file didn't load
+  void draw(const Renderer& renderer, const Shader& shader, int lod = 0) const;
+
+  // position, UV, normal: the layout every cooked mesh uses
+  static VertexBufferLayout getLayout();
+
+  private:
+  void upload(const void* vertices,
+              std::size_t vertexBytes,
+              const void* indices,
+              unsigned int indexCount,
+              unsigned int indexSize);
+
+  std::string m_filepath;
+  AABB m_bounds;
+  std::vector<float> m_lodScreenSize;
+  std::vector<MeshContainer::Submesh> m_submeshes;
+
+  std::unique_ptr<VertexBuffer> m_vertexBuffer;
+  std::unique_ptr<IndexBuffer> m_indexBuffer;
+  std::unique_ptr<VertexArray> m_vertexArray;
+};
@@ -0,0 +1,309 @@
+#include "mesh_builder.h"
+
+#include "hash.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <deque>
+
+namespace
+{
+constexpr std::uint32_t INVALID = ~0u;
+
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRI_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+float vertexScore(int cachePosition, unsigned int remainingTriangles, unsigned int cacheSize)
+{
+  if (remainingTriangles == 0)
+    return -1.0f;
+
+  float score = 0.0f;
+  if (cachePosition >= 0)
+  {
+    if (cachePosition < 3)
+    {
+      // The three vertices of the last triangle are deliberately not favoured over the rest
+      // of the cache, otherwise we get long thin strips
+      score = LAST_TRI_SCORE;
+    }
+    else
+    {
+      const float scaler = 1.0f / static_cast<float>(cacheSize - 3);
+      score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+    }
+  }
+
+  // Boost vertices with few triangles left so lone triangles don't get stranded
+  score += VALENCE_BOOST_SCALE *
+           std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+  return score;
+}
+}  // namespace
+
+MeshBuilder::MeshBuilder(unsigned int vertexSize) : m_vertexSize(vertexSize)
+{
+  assert(vertexSize > 0 && "Vertex size must be non-zero.");
+}
+
+unsigned int MeshBuilder::addVertex(const void* vertex)
+{
+  const std::uint64_t hash = fnv1a_64(vertex, m_vertexSize);
+
+  auto it = m_vertexLookup.find(hash);
+  std::uint32_t candidate = it != m_vertexLookup.end() ? it->second : INVALID;
+  while (candidate != INVALID)
+  {
+    if (std::memcmp(&m_vertexData[candidate * m_vertexSize], vertex, m_vertexSize) == 0)
+      return candidate;
+    candidate = m_nextWithHash[candidate];
+  }
+
+  const std::uint32_t index = getVertexCount();
+  const auto* bytes = static_cast<const unsigned char*>(vertex);
+  m_vertexData.insert(m_vertexData.end(), bytes, bytes + m_vertexSize);
+  m_nextWithHash.push_back(it != m_vertexLookup.end() ? it->second : INVALID);
+  m_vertexLookup[hash] = index;
+  return index;
+}
+
+void MeshBuilder::addTriangles(const void* vertices, unsigned int vertexCount)
+{
+  assert(vertexCount % 3 == 0 && "Triangle list vertex count must be a multiple of 3.");
+
+  const auto* bytes = static_cast<const unsigned char*>(vertices);
+  for (unsigned int i = 0; i < vertexCount; i++)
+  {
+    m_indices.push_back(addVertex(bytes + i * m_vertexSize));
+  }
+
+  m_stats.inputVertices += vertexCount;
+  m_stats.uniqueVertices = getVertexCount();
+  m_stats.triangles = getIndexCount() / 3;
+}
+
+void MeshBuilder::addTriangle(unsigned int a, unsigned int b, unsigned int c)
+{
+  assert(a < getVertexCount() && b < getVertexCount() && c < getVertexCount() &&
+         "Triangle references a vertex that wasn't added.");
+  m_indices.insert(m_indices.end(), {a, b, c});
+
+  m_stats.inputVertices += 3;
+  m_stats.uniqueVertices = getVertexCount();
+  m_stats.triangles = getIndexCount() / 3;
+}
+
+void MeshBuilder::optimize(unsigned int cacheSize)
+{
+  assert(cacheSize > 3 && "Cache must hold more than one triangle.");
+
+  m_stats.acmrBefore = computeACMR(m_indices);
+  optimizeVertexCache(cacheSize);
+  optimizeVertexFetch();
+  m_stats.acmrAfter = computeACMR(m_indices);
+}
+
+unsigned int MeshBuilder::getIndexType() const
+{
+  return uses16BitIndices() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+std::vector<unsigned char> MeshBuilder::getIndexData() const
+{
+  std::vector<unsigned char> data(m_indices.size() * getIndexSize());
+  if (uses16BitIndices())
+  {
+    auto* out = reinterpret_cast<std::uint16_t*>(data.data());
+    for (size_t i = 0; i < m_indices.size(); i++)
+      out[i] = static_cast<std::uint16_t>(m_indices[i]);
+  }
+  else
+  {
+    std::memcpy(data.data(), m_indices.data(), data.size());
+  }
+  return data;
+}
+
+float MeshBuilder::computeACMR(const std::vector<std::uint32_t>& indices, unsigned int cacheSize)
+{
+  if (indices.size() < 3)
+    return 0.0f;
+
+  std::deque<std::uint32_t> cache;
+  unsigned int misses = 0;
+  for (std::uint32_t index : indices)
+  {
+    if (std::find(cache.begin(), cache.end(), index) != cache.end())
+      continue;
+
+    ++misses;
+    cache.push_back(index);
+    if (cache.size() > cacheSize)
+      cache.pop_front();
+  }
+
+  return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+void MeshBuilder::optimizeVertexCache(unsigned int cacheSize)
+{
+  const unsigned int vertexCount = getVertexCount();
+  const unsigned int triangleCount = getIndexCount() / 3;
+  if (triangleCount == 0)
+    return;
+
+  // Vertex -> triangle adjacency, flattened
+  std::vector<std::uint32_t> adjacencyOffset(vertexCount + 1, 0);
+  for (std::uint32_t index : m_indices)
+    ++adjacencyOffset[index + 1];
+  for (unsigned int v = 0; v < vertexCount; v++)
+    adjacencyOffset[v + 1] += adjacencyOffset[v];
+
+  std::vector<std::uint32_t> adjacency(m_indices.size());
+  std::vector<std::uint32_t> remaining(vertexCount, 0);
+  for (unsigned int t = 0; t < triangleCount; t++)
+  {
+    for (int k = 0; k < 3; k++)
+    {
+      const std::uint32_t v = m_indices[t * 3 + k];
+      adjacency[adjacencyOffset[v] + remaining[v]++] = t;
+    }
+  }
+
+  std::vector<int> cachePosition(vertexCount, -1);
+  std::vector<float> score(vertexCount);
+  for (unsigned int v = 0; v < vertexCount; v++)
+    score[v] = vertexScore(-1, remaining[v], cacheSize);
+
+  std::vector<float> triangleScore(triangleCount);
+  for (unsigned int t = 0; t < triangleCount; t++)
+  {
+    triangleScore[t] = score[m_indices[t * 3]] + score[m_indices[t * 3 + 1]] +
+                       score[m_indices[t * 3 + 2]];
+  }
+
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<std::uint32_t> output;
+  output.reserve(m_indices.size());
+
+  // LRU cache with room for the triangle being added on top of cacheSize
+  std::vector<std::uint32_t> cache;
+  std::vector<std::uint32_t> newCache;
+  cache.reserve(cacheSize + 3);
+  newCache.reserve(cacheSize + 3);
+
+  unsigned int bestTriangle = 0;
+  unsigned int scanCursor = 0;
+
+  for (unsigned int emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+  {
+    if (bestTriangle == INVALID)
+    {
+      // Nothing in the cache has triangles left, fall back to the next unemitted one in order
+      while (emitted[scanCursor])
+        ++scanCursor;
+      bestTriangle = scanCursor;
+    }
+
+    emitted[bestTriangle] = true;
+    const std::uint32_t* tri = &m_indices[bestTriangle * 3];
+    output.insert(output.end(), tri, tri + 3);
+
+    // Remove the triangle from its vertices' remaining lists
+    for (int k = 0; k < 3; k++)
+    {
+      const std::uint32_t v = tri[k];
+      std::uint32_t* begin = &adjacency[adjacencyOffset[v]];
+      std::uint32_t* end = begin + remaining[v];
+      std::uint32_t* found = std::find(begin, end, bestTriangle);
+      assert(found != end);
+      std::swap(*found, *(end - 1));
+      --remaining[v];
+    }
+
+    // Move the triangle's vertices to the front of the cache
+    newCache.assign(tri, tri + 3);
+    for (std::uint32_t v : cache)
+    {
+      if (v != tri[0] && v != tri[1] && v != tri[2])
+        newCache.push_back(v);
+    }
+
+    for (std::uint32_t v : cache)
+      cachePosition[v] = -1;
+    for (unsigned int i = 0; i < newCache.size(); i++)
+      cachePosition[newCache[i]] = i < cacheSize ? static_cast<int>(i) : -1;
+
+    // Rescore everything that was or is in the cache and their triangles
+    for (std::uint32_t v : newCache)
+      score[v] = vertexScore(cachePosition[v], remaining[v], cacheSize);
+
+    bestTriangle = INVALID;
+    float bestScore = -1.0f;
+    for (std::uint32_t v : newCache)
+    {
+      for (unsigned int a = 0; a < remaining[v]; a++)
+      {
+        const std::uint32_t t = adjacency[adjacencyOffset[v] + a];
+        triangleScore[t] = score[m_indices[t * 3]] + score[m_indices[t * 3 + 1]] +
+                           score[m_indices[t * 3 + 2]];
+        if (triangleScore[t] > bestScore)
+        {
+          bestScore = triangleScore[t];
+          bestTriangle = t;
+        }
+      }
+    }
+
+    if (newCache.size() > cacheSize)
+      newCache.resize(cacheSize);
+    std::swap(cache, newCache);
+  }
+
+  m_indices = std::move(output);
+}
+
+void MeshBuilder::optimizeVertexFetch()
+{
+  const unsigned int vertexCount = getVertexCount();
+  std::vector<std::uint32_t> remap(vertexCount, INVALID);
+  std::vector<unsigned char> reordered;
+  reordered.reserve(m_vertexData.size());
+
+  std::uint32_t next = 0;
+  for (std::uint32_t& index : m_indices)
+  {
+    if (remap[index] == INVALID)
+    {
+      remap[index] = next++;
+      const unsigned char* src = &m_vertexData[index * m_vertexSize];
+      reordered.insert(reordered.end(), src, src + m_vertexSize);
+    }
+    index = remap[index];
+  }
+
+  // Unreferenced vertices are dropped
+  m_vertexData = std::move(reordered);
+  m_stats.uniqueVertices = getVertexCount();
+
+  // Rebuild the weld lookup for the new numbering so addVertex keeps working
+  m_vertexLookup.clear();
+  m_nextWithHash.assign(getVertexCount(), INVALID);
+  for (std::uint32_t v = 0; v < getVertexCount(); v++)
+  {
+    const std::uint64_t hash = fnv1a_64(&m_vertexData[v * m_vertexSize], m_vertexSize);
+    auto [it, inserted] = m_vertexLookup.try_emplace(hash, v);
+    if (!inserted)
+    {
+      m_nextWithHash[v] = it->second;
+      it->second = v;
+    }
+  }
+}
@@ -0,0 +1,131 @@
+#include "mesh_container.h"
+
+#include <fstream>
+#include <iostream>
+
+namespace MeshContainer
+{
+namespace
+{
+std::uint64_t align(std::uint64_t offset)
+{
+  return (offset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+}
+
+void writeAt(std::ofstream& file,
+             std::uint64_t& written,
+             std::uint64_t offset,
+             const void* data,
+             std::size_t size)
+{
+  const char padding[DATA_ALIGNMENT] = {};
+  file.write(padding, offset - written);
+  file.write(static_cast<const char*>(data), size);
+  written = offset + size;
+}
+}  // namespace
+
+bool write(const std::string& filepath, const MeshData& mesh)
+{
+  if (mesh.lodScreenSize.empty() || mesh.lodScreenSize.size() > MAX_LODS ||
+      (mesh.indexSize != 2 && mesh.indexSize != 4))
+    return false;
+
+  Header header{};
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.vertexSize = sizeof(Vertex);
+  header.indexSize = mesh.indexSize;
+  header.vertexCount = static_cast<std::uint32_t>(mesh.vertices.size());
+  header.indexCount = static_cast<std::uint32_t>(mesh.indices.size() / mesh.indexSize);
+  header.submeshCount = static_cast<std::uint32_t>(mesh.submeshes.size());
+  header.lodCount = static_cast<std::uint32_t>(mesh.lodScreenSize.size());
+  for (int k = 0; k < 3; k++)
+  {
+    header.boundsMin[k] = mesh.boundsMin[k];
+    header.boundsMax[k] = mesh.boundsMax[k];
+  }
+  for (std::uint32_t lod = 0; lod < header.lodCount; lod++)
+    header.lodScreenSize[lod] = mesh.lodScreenSize[lod];
+
+  const std::size_t submeshBytes = mesh.submeshes.size() * sizeof(Submesh);
+  const std::size_t vertexBytes = mesh.vertices.size() * sizeof(Vertex);
+  header.submeshOffset = align(sizeof(Header));
+  header.vertexOffset = align(header.submeshOffset + submeshBytes);
+  header.indexOffset = align(header.vertexOffset + vertexBytes);
+
+  std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+  std::uint64_t written = 0;
+  writeAt(file, written, 0, &header, sizeof(header));
+  writeAt(file, written, header.submeshOffset, mesh.submeshes.data(), submeshBytes);
+  writeAt(file, written, header.vertexOffset, mesh.vertices.data(), vertexBytes);
+  writeAt(file, written, header.indexOffset, mesh.indices.data(), mesh.indices.size());
+  return static_cast<bool>(file);
+}
+
+bool View::open(const std::string& filepath)
+{
+  m_header = nullptr;
+  if (!m_file.open(filepath) || m_file.size() < sizeof(Header))
+    return false;
+
+  // The mapping is page aligned, so the header can be used in place
+  const auto* header = reinterpret_cast<const Header*>(m_file.data());
+  if (header->magic != MAGIC || header->version != VERSION ||
+      header->vertexSize != sizeof(Vertex) || (header->indexSize != 2 && header->indexSize != 4) ||
+      header->lodCount == 0 || header->lodCount > MAX_LODS)
+  {
+    std::cerr << "ERROR::MESH::BAD_CONTAINER " << filepath << std::endl;
+    m_file.close();
+    return false;
+  }
+
+  auto fits = [&](std::uint64_t offset, std::uint64_t size)
+  { return offset <= m_file.size() && size <= m_file.size() - offset; };
+  if (!fits(header->submeshOffset, std::uint64_t(header->submeshCount) * sizeof(Submesh)) ||
+      !fits(header->vertexOffset, std::uint64_t(header->vertexCount) * header->vertexSize) ||
+      !fits(header->indexOffset, std::uint64_t(header->indexCount) * header->indexSize))
+  {
+    std::cerr << "ERROR::MESH::TRUNCATED_CONTAINER " << filepath << std::endl;
+    m_file.close();
+    return false;
+  }
+
+  // Submesh ranges are drawn straight from the blobs, so they have to stay inside them
+  const auto* submeshes = reinterpret_cast<const Submesh*>(m_file.data() + header->submeshOffset);
+  for (std::uint32_t i = 0; i < header->submeshCount; i++)
+  {
+    const Submesh& submesh = submeshes[i];
+    if (submesh.lod >= header->lodCount || submesh.baseVertex > header->vertexCount ||
+        submesh.vertexCount > header->vertexCount - submesh.baseVertex ||
+        submesh.firstIndex > header->indexCount ||
+        submesh.indexCount > header->indexCount - submesh.firstIndex)
+    {
+      std::cerr << "ERROR::MESH::BAD_CONTAINER " << filepath << std::endl;
+      m_file.close();
+      return false;
+    }
+  }
+
+  m_header = header;
+  return true;
+}
+
+std::span<const Submesh> View::getSubmeshes() const
+{
+  return {reinterpret_cast<const Submesh*>(m_file.data() + m_header->submeshOffset),
+          m_header->submeshCount};
+}
+
+std::span<const unsigned char> View::getVertexData() const
+{
+  return {m_file.data() + m_header->vertexOffset,
+          std::size_t(m_header->vertexCount) * m_header->vertexSize};
+}
+
+std::span<const unsigned char> View::getIndexData() const
+{
+  return {m_file.data() + m_header->indexOffset,
+          std::size_t(m_header->indexCount) * m_header->indexSize};
+}
+}  // namespace MeshContainer
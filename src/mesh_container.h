@@ -0,0 +1,93 @@
+#pragma once
+
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Cooked mesh file (.mesh) written by tools/mesh_cooker.
+// Header, submesh table, then one vertex blob and one index blob, each aligned to
+// DATA_ALIGNMENT. Every submesh and LOD owns a contiguous vertex range and index range, with
+// indices relative to the range start so 16-bit indices go a long way. Loading is a map plus
+// a header check, both blobs go to GL as they are.
+namespace MeshContainer
+{
+inline constexpr std::uint32_t MAGIC = 0x4853454d;  // "MESH"
+inline constexpr std::uint32_t VERSION = 1;
+inline constexpr std::uint32_t MAX_LODS = 4;
+inline constexpr std::uint32_t DATA_ALIGNMENT = 16;
+
+// The one vertex layout cooked meshes use: float position, half UV, packed normal.
+// Attribute order matches the shaders: position at 0, UV at 1, normal at 2.
+struct Vertex
+{
+  float position[3];
+  std::uint16_t uv[2];   // half floats, so tiling UVs outside [0, 1] survive
+  std::uint32_t normal;  // GL_INT_2_10_10_10_REV
+};
+static_assert(sizeof(Vertex) == 20, "Vertex layout is part of the file format");
+
+struct Submesh
+{
+  std::uint32_t lod;
+  std::uint32_t material;  // index into the material names of the source file
+  std::uint32_t baseVertex;
+  std::uint32_t vertexCount;
+  std::uint32_t firstIndex;
+  std::uint32_t indexCount;
+};
+
+struct Header
+{
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t vertexSize;
+  std::uint32_t indexSize;  // 2 or 4 bytes
+  std::uint32_t vertexCount;
+  std::uint32_t indexCount;
+  std::uint32_t submeshCount;
+  std::uint32_t lodCount;
+  float boundsMin[3];
+  float boundsMax[3];
+  // Screen-space fraction below which each LOD is good enough, LOD 0 first
+  float lodScreenSize[MAX_LODS];
+  std::uint64_t submeshOffset;
+  std::uint64_t vertexOffset;
+  std::uint64_t indexOffset;
+};
+static_assert(sizeof(Header) == 96, "Header layout is part of the file format");
+
+struct MeshData
+{
+  float boundsMin[3];
+  float boundsMax[3];
+  std::vector<float> lodScreenSize;
+  std::vector<Submesh> submeshes;
+  std::vector<Vertex> vertices;
+  // Packed to indexSize, relative to each submesh's baseVertex
+  std::vector<unsigned char> indices;
+  std::uint32_t indexSize = 2;
+};
+
+bool write(const std::string& filepath, const MeshData& mesh);
+
+// Mapped view of a container, all spans point straight into the file mapping
+class View
+{
+  public:
+  bool open(const std::string& filepath);
+
+  inline bool isOpen() const { return m_header != nullptr; }
+  inline const Header& getHeader() const { return *m_header; }
+
+  std::span<const Submesh> getSubmeshes() const;
+  std::span<const unsigned char> getVertexData() const;
+  std::span<const unsigned char> getIndexData() const;
+
+  private:
+  MappedFile m_file;
+  const Header* m_header = nullptr;
+};
+}  // namespace MeshContainer
@@ -0,0 +1,65 @@
+#include "mip_residency.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace MipResidency
+{
+float projectedSize(float worldSize, float distance, float fovY, float viewportHeight)
+{
+  const float visibleHeight = 2.0f * std::max(distance, 1e-4f) * std::tan(fovY * 0.5f);
+  return worldSize / visibleHeight * viewportHeight;
+}
+
+int selectMip(int width, int height, float screenSize)
+{
+  // One texel per pixel is enough, every level finer than that only costs memory
+  const float texels = static_cast<float>(std::max(width, height));
+  if (screenSize >= texels)
+    return 0;
+  return static_cast<int>(std::floor(std::log2(texels / std::max(screenSize, 1.0f))));
+}
+
+std::size_t bytesFrom(const Item& item, int mip)
+{
+  std::size_t bytes = 0;
+  for (std::size_t level = std::max(mip, 0); level < item.levelBytes.size(); level++)
+    bytes += item.levelBytes[level];
+  return bytes;
+}
+
+std::size_t plan(std::span<Item> items, std::size_t budget)
+{
+  std::size_t total = 0;
+  for (Item& item : items)
+  {
+    item.plannedMip = std::min(std::min(item.residentMip, item.tailMip), item.targetMip);
+    total += bytesFrom(item, item.plannedMip);
+  }
+
+  while (total > budget)
+  {
+    Item* victim = nullptr;
+    for (Item& item : items)
+    {
+      if (item.plannedMip >= item.tailMip)
+        continue;
+      if (!victim)
+      {
+        victim = &item;
+        continue;
+      }
+      const bool surplus = item.plannedMip < item.targetMip;
+      const bool victimSurplus = victim->plannedMip < victim->targetMip;
+      if (surplus != victimSurplus ? surplus : item.lastUsedFrame < victim->lastUsedFrame)
+        victim = &item;
+    }
+    if (!victim)
+      break;
+
+    total -= victim->levelBytes[victim->plannedMip];
+    victim->plannedMip++;
+  }
+  return total;
+}
+}  // namespace MipResidency
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Which mip levels of each texture to keep on the GPU, split out of TextureManager so it runs
+// without GL
+namespace MipResidency
+{
+struct Item
+{
+  std::span<const std::size_t> levelBytes;  // size of every level, finest first
+  int residentMip;                          // finest level on the GPU now
+  int targetMip;                            // finest level the size feedback asked for
+  int tailMip;                              // levels from here on are never dropped
+  std::uint64_t lastUsedFrame;
+  int plannedMip = 0;  // filled in by plan()
+};
+
+// Height in pixels of something worldSize across at the given distance
+float projectedSize(float worldSize, float distance, float fovY, float viewportHeight);
+// Finest level worth having for a texture of that size drawn screenSize pixels across
+int selectMip(int width, int height, float screenSize);
+
+// Bytes of levels [mip, levelBytes.size())
+std::size_t bytesFrom(const Item& item, int mip);
+
+// Sets plannedMip of every item so they fit in budget if they can, returns the planned total.
+// Resident levels are kept while there's room, they may be wanted again. Over budget it drops
+// one level at a time from whoever needs it least: levels finer than the target first, then
+// the least recently used texture. The tail stays even if the budget is blown.
+std::size_t plan(std::span<Item> items, std::size_t budget);
+}  // namespace MipResidency
@@ -0,0 +1,181 @@
+#include "program_cache.h"
+
+#include "gl_extensions.h"
+#include "hash.h"
+
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+constexpr std::uint32_t CACHE_MAGIC = 0x4e494250;  // "PBIN"
+constexpr std::uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader
+{
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint64_t key;
+  std::uint32_t format;
+  std::uint32_t length;
+};
+
+std::string_view glString(GLenum name)
+{
+  const auto* str = reinterpret_cast<const char*>(glGetString(name));
+  return str ? std::string_view(str) : std::string_view();
+}
+}  // namespace
+
+std::filesystem::path ProgramCache::s_directory;
+std::uint64_t ProgramCache::s_driverHash = FNV1A_64_OFFSET;
+
+void ProgramCache::init(const std::filesystem::path& directory)
+{
+  s_directory.clear();
+  if (directory.empty() || !GLExtensions::hasProgramBinary())
+    return;
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error)
+  {
+    std::cerr << "Warning: program cache disabled, can't create " << directory << ": "
+              << error.message() << std::endl;
+    return;
+  }
+  s_directory = directory;
+
+  s_driverHash = FNV1A_64_OFFSET;
+  for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+  {
+    s_driverHash = fnv1a_64(glString(name), s_driverHash);
+    s_driverHash = fnv1a_64("\n", s_driverHash);
+  }
+}
+
+bool ProgramCache::isEnabled()
+{
+  return !s_directory.empty();
+}
+
+std::uint64_t ProgramCache::computeKey(std::initializer_list<std::string_view> sources)
+{
+  std::uint64_t key = s_driverHash;
+  for (std::string_view source : sources)
+  {
+    // Hash the length too so moving text between stages changes the key
+    const std::uint64_t size = source.size();
+    key = fnv1a_64(&size, sizeof(size), key);
+    key = fnv1a_64(source, key);
+  }
+  return key;
+}
+
+std::filesystem::path ProgramCache::pathFor(std::uint64_t key)
+{
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+  return s_directory / name;
+}
+
+unsigned int ProgramCache::load(std::uint64_t key)
+{
+  if (!isEnabled())
+    return 0;
+
+  const auto path = pathFor(key);
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return 0;
+
+  // The length is checked against the file before anything is allocated for it
+  std::error_code error;
+  const std::uintmax_t fileSize = std::filesystem::file_size(path, error);
+  CacheHeader header{};
+  std::vector<char> binary;
+  if (!error && file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+      header.magic == CACHE_MAGIC && header.version == CACHE_VERSION && header.key == key &&
+      header.length <= fileSize - sizeof(header))
+  {
+    binary.resize(header.length);
+    if (!file.read(binary.data(), binary.size()))
+      binary.clear();
+  }
+  file.close();
+
+  if (binary.empty())
+  {
+    std::filesystem::remove(path, error);
+    return 0;
+  }
+
+  unsigned int program = glCreateProgram();
+  GLExtensions::programBinary()(program, header.format, binary.data(), header.length);
+
+  // The driver is free to reject binaries from older versions even when the strings match
+  GLint success = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success)
+  {
+    glDeleteProgram(program);
+    std::filesystem::remove(path, error);
+    return 0;
+  }
+
+  return program;
+}
+
+void ProgramCache::prepare(unsigned int program)
+{
+  if (isEnabled())
+    GLExtensions::programParameteri()(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramCache::store(std::uint64_t key, unsigned int program)
+{
+  if (!isEnabled())
+    return;
+
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+
+  CacheHeader header{CACHE_MAGIC, CACHE_VERSION, key, 0, 0};
+  std::vector<char> binary(length);
+  GLsizei written = 0;
+  GLenum format = 0;
+  GLExtensions::getProgramBinary()(program, length, &written, &format, binary.data());
+  if (written <= 0)
+    return;
+  header.format = format;
+  header.length = static_cast<std::uint32_t>(written);
+
+  std::error_code error;
+
+  // Write then rename so a crash or a second instance never sees a half-written entry
+  const auto path = pathFor(key);
+  auto temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), written);
+    if (!file)
+    {
+      file.close();
+      std::filesystem::remove(temporary, error);
+      return;
+    }
+  }
+
+  std::filesystem::rename(temporary, path, error);
+  if (error)
+    std::filesystem::remove(temporary, error);
+}
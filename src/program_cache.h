@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <string_view>
+
+// On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+// Entries are keyed by the program sources plus the GL vendor, renderer and version strings,
+// so a driver update or a different GPU simply misses and falls back to compiling from source.
+class ProgramCache
+{
+  public:
+  // Call once GLExtensions::init() has run. An empty directory disables the cache.
+  static void init(const std::filesystem::path& directory);
+  static bool isEnabled();
+
+  static std::uint64_t computeKey(std::initializer_list<std::string_view> sources);
+
+  // Returns a linked program, or 0 if there is no binary the driver will accept for this key
+  static unsigned int load(std::uint64_t key);
+
+  // Must be called before glLinkProgram for the binary to be retrievable afterwards
+  static void prepare(unsigned int program);
+  static void store(std::uint64_t key, unsigned int program);
+
+  private:
+  static std::filesystem::path pathFor(std::uint64_t key);
+
+  static std::filesystem::path s_directory;
+  static std::uint64_t s_driverHash;
+};
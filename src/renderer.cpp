@@ -9,15 +9,43 @@ void Renderer::clear() const
 
 void Renderer::draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
 {
+  // Still compiling (or broken), skip rather than stall the frame on the driver
+  if (!shader.isReady())
+    return;
+
   shader.bind();
   va.bind();
   ib.bind();
-  glDrawElements(GL_TRIANGLES, ib.getCount(), GL_UNSIGNED_INT, nullptr);
+  glDrawElements(GL_TRIANGLES, ib.getCount(), ib.getType(), nullptr);
 }
 
 void Renderer::draw(const VertexArray& va, const Shader& shader, int vertexCount) const
 {
+  if (!shader.isReady())
+    return;
+
   shader.bind();
   va.bind();
   glDrawArrays(GL_TRIANGLES, 0, vertexCount);
 }
+
+void Renderer::drawRange(const VertexArray& va,
+                         const IndexBuffer& ib,
+                         const Shader& shader,
+                         unsigned int firstIndex,
+                         unsigned int indexCount,
+                         int baseVertex) const
+{
+  if (!shader.isReady())
+    return;
+
+  shader.bind();
+  va.bind();
+  ib.bind();
+  const unsigned int indexSize = ib.getType() == GL_UNSIGNED_SHORT ? 2 : 4;
+  glDrawElementsBaseVertex(GL_TRIANGLES,
+                           indexCount,
+                           ib.getType(),
+                           reinterpret_cast<const void*>(uintptr_t(firstIndex) * indexSize),
+                           baseVertex);
+}
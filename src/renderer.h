@@ -13,6 +13,13 @@ class Renderer
   Renderer(float x, float y, float z) : m_clearColor(x, y, z, 1.0f) {}
   void draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
   void draw(const VertexArray& va, const Shader& shader, int vertexCount) const;
+  // Part of an index buffer, with indices relative to baseVertex
+  void drawRange(const VertexArray& va,
+                 const IndexBuffer& ib,
+                 const Shader& shader,
+                 unsigned int firstIndex,
+                 unsigned int indexCount,
+                 int baseVertex = 0) const;
   void clear() const;
 
   void setClearColor(float r, float g, float b, float a = 1.0f)
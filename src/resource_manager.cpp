@@ -0,0 +1,273 @@
+#include "resource_manager.h"
+
+#include "hash.h"
+#include "job_system.h"
+#include "mapped_file.h"
+#include "mesh.h"
+#include "shader.h"
+#include "texture.h"
+
+#include <chrono>
+#include <filesystem>
+
+namespace
+{
+constexpr std::size_t PAGE_SIZE = 4096;
+
+template <typename T>
+bool isReady(const std::shared_future<T>& future)
+{
+  return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// Paths are normalized so "res/a.png" and "res/./a.png" share an entry
+std::uint64_t pathKey(const std::string& filepath)
+{
+  return fnv1a_64(std::filesystem::path(filepath).lexically_normal().generic_string());
+}
+
+ResourceStatus pollTexture(std::shared_ptr<Texture>& texture)
+{
+  switch (texture->getStatus())
+  {
+    case TextureStatus::Loading:
+      return ResourceStatus::Loading;
+    case TextureStatus::Ready:
+      return ResourceStatus::Ready;
+    default:
+      return ResourceStatus::Failed;
+  }
+}
+}  // namespace
+
+ResourceManager::ResourceManager(JobSystem& jobs)
+    : m_jobs(jobs), m_textureLoader(jobs), m_frame(0), m_loadingCount(0)
+{
+}
+
+ResourceManager::~ResourceManager() = default;
+
+template <typename T>
+Handle<T> ResourceManager::acquireSlot(std::uint64_t key, bool& isNew)
+{
+  Pool<T>& resources = pool<T>();
+  if (auto it = resources.lookup.find(key); it != resources.lookup.end())
+  {
+    // Also revives a released resource that hasn't been freed yet
+    Slot<T>& slot = resources.slots[it->second];
+    slot.refCount++;
+    isNew = false;
+    return {it->second, slot.generation};
+  }
+
+  std::uint32_t index;
+  if (!resources.freeSlots.empty())
+  {
+    index = resources.freeSlots.back();
+    resources.freeSlots.pop_back();
+  }
+  else
+  {
+    index = static_cast<std::uint32_t>(resources.slots.size());
+    resources.slots.emplace_back();
+  }
+
+  Slot<T>& slot = resources.slots[index];
+  const std::uint32_t generation = slot.generation;
+  slot = Slot<T>{};
+  slot.generation = generation;
+  slot.key = key;
+  slot.refCount = 1;
+  slot.alive = true;
+  slot.future = slot.promise.get_future().share();
+  resources.lookup.emplace(key, index);
+  m_loadingCount++;
+  isNew = true;
+  return {index, generation};
+}
+
+Handle<Shader> ResourceManager::loadShader(const std::string& filepath,
+                                           std::vector<std::string> defines)
+{
+  std::uint64_t key = pathKey(filepath);
+  for (const auto& define : defines)
+    key = fnv1a_64(define, fnv1a_64("\n", key));
+
+  bool isNew;
+  const Handle<Shader> handle = acquireSlot<Shader>(key, isNew);
+  if (!isNew)
+    return handle;
+
+  // Compiling is already asynchronous in the driver, only the preprocessing happens here
+  Slot<Shader>& slot = *find(handle);
+  slot.resource = std::make_shared<Shader>(filepath, std::move(defines));
+  slot.poll = [](std::shared_ptr<Shader>& shader)
+  {
+    switch (shader->getStatus())
+    {
+      case ShaderStatus::Compiling:
+        return ResourceStatus::Loading;
+      case ShaderStatus::Ready:
+        return ResourceStatus::Ready;
+      default:
+        return ResourceStatus::Failed;
+    }
+  };
+  return handle;
+}
+
+Handle<Texture> ResourceManager::loadTexture(const std::string& filepath)
+{
+  bool isNew;
+  const Handle<Texture> handle = acquireSlot<Texture>(pathKey(filepath), isNew);
+  if (!isNew)
+    return handle;
+
+  Slot<Texture>& slot = *find(handle);
+  if (filepath.ends_with(".tex"))
+  {
+    // Cooked containers are uploaded in one go once their pages are in memory
+    slot.poll = [filepath, paged = prefetch(filepath).share()](std::shared_ptr<Texture>& texture)
+    {
+      if (!isReady(paged))
+        return ResourceStatus::Loading;
+      if (!paged.get())
+        return ResourceStatus::Failed;
+      texture = std::make_shared<Texture>(filepath);
+      return texture->isReady() ? ResourceStatus::Ready : ResourceStatus::Failed;
+    };
+  }
+  else
+  {
+    slot.resource = m_textureLoader.load(filepath);
+    slot.poll = pollTexture;
+  }
+  return handle;
+}
+
+Handle<Mesh> ResourceManager::loadMesh(const std::string& filepath)
+{
+  bool isNew;
+  const Handle<Mesh> handle = acquireSlot<Mesh>(pathKey(filepath), isNew);
+  if (!isNew)
+    return handle;
+
+  find(handle)->poll = [filepath, paged = prefetch(filepath).share()](std::shared_ptr<Mesh>& mesh)
+  {
+    if (!isReady(paged))
+      return ResourceStatus::Loading;
+    if (!paged.get())
+      return ResourceStatus::Failed;
+    mesh = std::make_shared<Mesh>(filepath);
+    return mesh->isLoaded() ? ResourceStatus::Ready : ResourceStatus::Failed;
+  };
+  return handle;
+}
+
+template <typename T>
+Handle<T> ResourceManager::adopt(const std::string& name,
+                                 std::shared_ptr<T> resource,
+                                 std::function<ResourceStatus(std::shared_ptr<T>&)> poll)
+{
+  bool isNew;
+  const Handle<T> handle = acquireSlot<T>(pathKey(name), isNew);
+  if (!isNew)
+    return handle;
+
+  // Still goes through update(), so callbacks and futures behave as for a load
+  Slot<T>& slot = *find(handle);
+  slot.resource = std::move(resource);
+  slot.poll = std::move(poll);
+  return handle;
+}
+
+Handle<Texture> ResourceManager::addTexture(const std::string& name,
+                                            std::shared_ptr<Texture> texture)
+{
+  return adopt<Texture>(name, std::move(texture), pollTexture);
+}
+
+Handle<Mesh> ResourceManager::addMesh(const std::string& name, std::shared_ptr<Mesh> mesh)
+{
+  return adopt<Mesh>(name,
+                     std::move(mesh),
+                     [](std::shared_ptr<Mesh>& mesh)
+                     { return mesh->isLoaded() ? ResourceStatus::Ready : ResourceStatus::Failed; });
+}
+
+std::future<bool> ResourceManager::prefetch(const std::string& filepath)
+{
+  return m_jobs.submit(
+      [filepath]()
+      {
+        MappedFile file;
+        if (!file.open(filepath))
+          return false;
+
+        // Touching one byte per page is enough to fault the whole file into the page cache
+        volatile unsigned char sink = 0;
+        for (std::size_t offset = 0; offset < file.size(); offset += PAGE_SIZE)
+          sink = sink + file.data()[offset];
+        return true;
+      });
+}
+
+template <typename T>
+void ResourceManager::updatePool(Pool<T>& resources)
+{
+  // Callbacks may load more resources and grow the pool, so they run after the walk
+  std::vector<std::pair<std::shared_ptr<T>, std::function<void(T&)>>> ready;
+
+  for (std::uint32_t index = 0; index < resources.slots.size(); index++)
+  {
+    Slot<T>& slot = resources.slots[index];
+    if (!slot.alive)
+      continue;
+
+    if (slot.status == ResourceStatus::Loading)
+    {
+      slot.status = slot.poll(slot.resource);
+      if (slot.status != ResourceStatus::Loading)
+      {
+        m_loadingCount--;
+        slot.poll = nullptr;
+        slot.promise.set_value(slot.status);
+        if (slot.status == ResourceStatus::Ready)
+        {
+          for (auto& callback : slot.callbacks)
+            ready.emplace_back(slot.resource, std::move(callback));
+        }
+        slot.callbacks.clear();
+      }
+    }
+
+    if (slot.refCount == 0 && m_frame - slot.releasedFrame >= RELEASE_DELAY)
+    {
+      if (slot.status == ResourceStatus::Loading)
+      {
+        m_loadingCount--;
+        slot.promise.set_value(ResourceStatus::Failed);
+      }
+      resources.lookup.erase(slot.key);
+      resources.freeSlots.push_back(index);
+      // Handles to the old resource stop resolving, 0 stays reserved for invalid handles
+      const std::uint32_t generation = slot.generation + 1 == 0 ? 1 : slot.generation + 1;
+      slot = Slot<T>{};
+      slot.generation = generation;
+    }
+  }
+
+  for (auto& [resource, callback] : ready)
+    callback(*resource);
+}
+
+void ResourceManager::update()
+{
+  m_textureLoader.update();
+
+  updatePool(m_shaders);
+  updatePool(m_textures);
+  updatePool(m_meshes);
+
+  m_frame++;
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "texture_loader.h"
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+class Mesh;
+class Shader;
+class Texture;
+
+// Typed reference to a resource owned by ResourceManager. The generation tells a live handle
+// apart from one whose slot has since been freed and reused.
+template <typename T>
+struct Handle
+{
+  std::uint32_t index = 0;
+  std::uint32_t generation = 0;  // never issued as 0, so a default handle is invalid
+
+  explicit operator bool() const { return generation != 0; }
+  bool operator==(const Handle&) const = default;
+};
+
+enum class ResourceStatus
+{
+  Loading,
+  Ready,
+  Failed
+};
+
+// Owns shaders, textures and meshes and hands out handles to them.
+// Loading the same file twice returns the same handle and bumps its reference count, so nothing
+// is read or uploaded twice. Loads return straight away: shaders compile in the driver, images
+// decode through TextureLoader and cooked files are paged in on the JobSystem before the GL
+// objects are created in update(). Once the last reference is released the resource lingers
+// for RELEASE_DELAY frames, so draws already recorded with it finish and a reload in the
+// meantime gets it back for free.
+//
+// Everything except waiting on a future must happen on the thread that owns the GL context.
+class ResourceManager
+{
+  public:
+  // Frames a released resource is kept before its GL objects are deleted
+  static constexpr std::uint64_t RELEASE_DELAY = 3;
+
+  explicit ResourceManager(JobSystem& jobs);
+  ~ResourceManager();
+
+  ResourceManager(const ResourceManager&) = delete;
+  ResourceManager& operator=(const ResourceManager&) = delete;
+
+  // Each load holds one reference, give it back with release()
+  Handle<Shader> loadShader(const std::string& filepath, std::vector<std::string> defines = {});
+  // Images stream in through TextureLoader, cooked .tex containers are mapped
+  Handle<Texture> loadTexture(const std::string& filepath);
+  Handle<Mesh> loadMesh(const std::string& filepath);
+
+  // Takes over a texture created elsewhere, e.g. by a TextureManager, so it's freed with the
+  // rest while there's still a GL context. The name shares its keys with file paths, if it's
+  // taken the existing texture is returned instead.
+  Handle<Texture> addTexture(const std::string& name, std::shared_ptr<Texture> texture);
+  // Same for meshes built at runtime
+  Handle<Mesh> addMesh(const std::string& name, std::shared_ptr<Mesh> mesh);
+
+  // Call once per frame: finishes loads, runs ready callbacks and frees released resources
+  void update();
+
+  template <typename T>
+  void acquire(Handle<T> handle)
+  {
+    if (Slot<T>* slot = find(handle))
+      slot->refCount++;
+  }
+
+  template <typename T>
+  void release(Handle<T> handle)
+  {
+    Slot<T>* slot = find(handle);
+    if (!slot || slot->refCount == 0)
+      return;
+    if (--slot->refCount == 0)
+      slot->releasedFrame = m_frame;
+  }
+
+  // Null for stale handles and for meshes that haven't loaded yet. Shaders and textures exist
+  // from the start: textures bind their placeholder and Renderer skips shaders still compiling.
+  template <typename T>
+  T* get(Handle<T> handle) const
+  {
+    const Slot<T>* slot = find(handle);
+    return slot ? slot->resource.get() : nullptr;
+  }
+
+  template <typename T>
+  ResourceStatus getStatus(Handle<T> handle) const
+  {
+    const Slot<T>* slot = find(handle);
+    return slot ? slot->status : ResourceStatus::Failed;
+  }
+
+  // Resolved by update(), so only wait on it from another thread
+  template <typename T>
+  std::shared_future<ResourceStatus> getFuture(Handle<T> handle) const
+  {
+    if (const Slot<T>* slot = find(handle))
+      return slot->future;
+
+    std::promise<ResourceStatus> stale;
+    stale.set_value(ResourceStatus::Failed);
+    return stale.get_future().share();
+  }
+
+  // Runs from update() once the resource is ready, or right away if it already is. Dropped if
+  // the load fails.
+  template <typename T>
+  void whenReady(Handle<T> handle, std::function<void(T&)> callback)
+  {
+    Slot<T>* slot = find(handle);
+    if (!slot || slot->status == ResourceStatus::Failed)
+      return;
+    if (slot->status == ResourceStatus::Ready)
+      callback(*slot->resource);
+    else
+      slot->callbacks.push_back(std::move(callback));
+  }
+
+  inline std::size_t getLoadingCount() const { return m_loadingCount; }
+
+  private:
+  template <typename T>
+  struct Slot
+  {
+    std::shared_ptr<T> resource;
+    std::uint64_t key = 0;
+    std::uint32_t generation = 1;
+    std::uint32_t refCount = 0;
+    std::uint64_t releasedFrame = 0;
+    bool alive = false;
+
+    ResourceStatus status = ResourceStatus::Loading;
+    // Called by update() while loading, may fill in resource
+    std::function<ResourceStatus(std::shared_ptr<T>&)> poll;
+    std::promise<ResourceStatus> promise;
+    std::shared_future<ResourceStatus> future;
+    std::vector<std::function<void(T&)>> callbacks;
+  };
+
+  template <typename T>
+  struct Pool
+  {
+    std::vector<Slot<T>> slots;
+    std::vector<std::uint32_t> freeSlots;
+    std::unordered_map<std::uint64_t, std::uint32_t> lookup;  // key -> slot
+  };
+
+  template <typename T>
+  Pool<T>& pool() const
+  {
+    if constexpr (std::is_same_v<T, Shader>)
+      return m_shaders;
+    else if constexpr (std::is_same_v<T, Texture>)
+      return m_textures;
+    else
+      return m_meshes;
+  }
+
+  template <typename T>
+  Slot<T>* find(Handle<T> handle) const
+  {
+    Pool<T>& resources = pool<T>();
+    if (handle.index >= resources.slots.size())
+      return nullptr;
+    Slot<T>& slot = resources.slots[handle.index];
+    return slot.alive && slot.generation == handle.generation ? &slot : nullptr;
+  }
+
+  // Returns the existing handle for key with one more reference, or a fresh slot for the
+  // caller to fill in with isNew set
+  template <typename T>
+  Handle<T> acquireSlot(std::uint64_t key, bool& isNew);
+
+  template <typename T>
+  Handle<T> adopt(const std::string& name,
+                  std::shared_ptr<T> resource,
+                  std::function<ResourceStatus(std::shared_ptr<T>&)> poll);
+
+  template <typename T>
+  void updatePool(Pool<T>& resources);
+
+  // Reads every page of a file on a worker, so creating the GL objects from it doesn't stall
+  std::future<bool> prefetch(const std::string& filepath);
+
+  JobSystem& m_jobs;
+  TextureLoader m_textureLoader;
+  std::uint64_t m_frame;
+  std::size_t m_loadingCount;
+
+  // find() is const but hands out mutable slots, like get() hands out mutable resources
+  mutable Pool<Shader> m_shaders;
+  mutable Pool<Texture> m_textures;
+  mutable Pool<Mesh> m_meshes;
+};
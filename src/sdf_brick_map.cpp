@@ -0,0 +1,315 @@
+#include "sdf_brick_map.h"
+
+#include "job_system.h"
+#include "sdf_object.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+constexpr int SAMPLES_PER_BRICK =
+    SDFBrickMap::BRICK_SAMPLES * SDFBrickMap::BRICK_SAMPLES * SDFBrickMap::BRICK_SAMPLES;
+
+inline float maxQuantised(SDFBrickFormat format)
+{
+  return format == SDFBrickFormat::R8 ? 255.0f : 65535.0f;
+}
+}  // namespace
+
+SDFBrickMap::SDFBrickMap(float voxelSize, float band, SDFBrickFormat format)
+    // Less than a voxel of band would let the surface slip between the samples of empty bricks
+    : m_voxelSize(voxelSize), m_band(std::max(band, 1.0f) * voxelSize), m_format(format)
+{
+}
+
+void SDFBrickMap::bake(const SDFObject& sdf, JobSystem& jobs)
+{
+  m_atlas.clear();
+  m_atlasLayers = 0;
+  m_slotCount = 0;
+  m_freeSlots.clear();
+  m_dirtyBricks.clear();
+  m_changedSlots.clear();
+  m_fullyChanged = true;
+  m_indirectionChanged = true;
+
+  const AABB bounds = sdf.getBounds();
+  if (sdf.isEmpty() || bounds.isEmpty())
+  {
+    m_gridSize = glm::ivec3(0);
+    m_indirection.clear();
+    m_dirty.clear();
+    return;
+  }
+
+  // A band of margin keeps everything outside the grid at least a band from the surface
+  const float brickSize = BRICK_CELLS * m_voxelSize;
+  const glm::vec3 padding(m_band + m_voxelSize);
+  m_origin = bounds.min - padding;
+  const glm::vec3 extent = bounds.size() + 2.0f * padding;
+  m_gridSize = glm::max(glm::ivec3(glm::ceil(extent / brickSize)), glm::ivec3(1));
+
+  const std::size_t brickCount =
+      static_cast<std::size_t>(m_gridSize.x) * m_gridSize.y * m_gridSize.z;
+  m_indirection.assign(brickCount, EMPTY_OUTSIDE);
+  m_dirty.assign(brickCount, false);
+
+  std::vector<std::uint32_t> bricks(brickCount);
+  for (std::uint32_t i = 0; i < brickCount; i++)
+    bricks[i] = i;
+  bakeBricks(sdf, jobs, bricks);
+}
+
+void SDFBrickMap::markDirty(const AABB& region)
+{
+  if (m_indirection.empty() || region.isEmpty())
+    return;
+
+  // Clamped distances only change within a band of the edit, the extra voxel catches bricks
+  // sharing a face with it
+  const float brickSize = BRICK_CELLS * m_voxelSize;
+  const glm::vec3 margin(m_band + m_voxelSize);
+  auto brickOf = [&](const glm::vec3& point)
+  {
+    const glm::ivec3 brick(glm::floor((point - m_origin) / brickSize));
+    return glm::clamp(brick, glm::ivec3(0), m_gridSize - 1);
+  };
+  const glm::ivec3 lo = brickOf(region.min - margin);
+  const glm::ivec3 hi = brickOf(region.max + margin);
+
+  for (int z = lo.z; z <= hi.z; z++)
+    for (int y = lo.y; y <= hi.y; y++)
+      for (int x = lo.x; x <= hi.x; x++)
+      {
+        const std::uint32_t brick = (z * m_gridSize.y + y) * m_gridSize.x + x;
+        if (!m_dirty[brick])
+        {
+          m_dirty[brick] = true;
+          m_dirtyBricks.push_back(brick);
+        }
+      }
+}
+
+std::size_t SDFBrickMap::update(const SDFObject& sdf, JobSystem& jobs)
+{
+  AABB needed = sdf.getBounds();
+  needed.min -= glm::vec3(m_band);
+  needed.max += glm::vec3(m_band);
+  if (m_indirection.empty() || !getBounds().contains(needed))
+  {
+    bake(sdf, jobs);
+    return m_indirection.size();
+  }
+
+  const std::vector<std::uint32_t> bricks = std::move(m_dirtyBricks);
+  m_dirtyBricks.clear();
+  for (std::uint32_t brick : bricks)
+    m_dirty[brick] = false;
+  bakeBricks(sdf, jobs, bricks);
+  return bricks.size();
+}
+
+void SDFBrickMap::bakeBricks(const SDFObject& sdf,
+                             JobSystem& jobs,
+                             const std::vector<std::uint32_t>& bricks)
+{
+  // Evaluating is the slow part and goes wide, slots are handed out afterwards in brick order
+  // so the atlas layout doesn't depend on scheduling
+  std::vector<BakedBrick> baked(bricks.size());
+  jobs.parallelFor(bricks.size(),
+                   4,
+                   [&](std::size_t begin, std::size_t end)
+                   {
+                     for (std::size_t i = begin; i < end; i++)
+                     {
+                       baked[i].brick = bricks[i];
+                       bakeBrick(sdf, baked[i]);
+                     }
+                   });
+
+  for (std::uint32_t brick : bricks)
+  {
+    if (m_indirection[brick] < EMPTY_INSIDE)
+      m_freeSlots.push_back(m_indirection[brick]);
+  }
+  for (const BakedBrick& brick : baked)
+    store(brick);
+}
+
+void SDFBrickMap::bakeBrick(const SDFObject& sdf, BakedBrick& baked) const
+{
+  const glm::vec3 corner = brickCorner(baked.brick);
+  const float brickSize = BRICK_CELLS * m_voxelSize;
+
+  // Far enough from the surface that every sample would be clamped anyway
+  const float centerDistance = sdf.evaluate(corner + glm::vec3(brickSize * 0.5f));
+  const float halfDiagonal = brickSize * 0.5f * std::sqrt(3.0f);
+  baked.state = centerDistance < 0.0f ? EMPTY_INSIDE : EMPTY_OUTSIDE;
+  if (std::abs(centerDistance) - halfDiagonal >= m_band)
+    return;
+
+  float x[SAMPLES_PER_BRICK], y[SAMPLES_PER_BRICK], z[SAMPLES_PER_BRICK];
+  float distances[SAMPLES_PER_BRICK];
+  int i = 0;
+  for (int k = 0; k < BRICK_SAMPLES; k++)
+    for (int j = 0; j < BRICK_SAMPLES; j++)
+      for (int l = 0; l < BRICK_SAMPLES; l++, i++)
+      {
+        x[i] = corner.x + l * m_voxelSize;
+        y[i] = corner.y + j * m_voxelSize;
+        z[i] = corner.z + k * m_voxelSize;
+      }
+  sdf.evaluate(x, y, z, SAMPLES_PER_BRICK, distances);
+
+  const bool nearSurface = std::any_of(
+      distances, distances + SAMPLES_PER_BRICK, [&](float d) { return std::abs(d) < m_band; });
+  if (!nearSurface)
+  {
+    baked.state = distances[0] < 0.0f ? EMPTY_INSIDE : EMPTY_OUTSIDE;
+    return;
+  }
+
+  const float scale = maxQuantised(m_format);
+  baked.state = 0;
+  baked.samples.resize(SAMPLES_PER_BRICK);
+  for (i = 0; i < SAMPLES_PER_BRICK; i++)
+  {
+    const float normalized = std::clamp(distances[i] / m_band, -1.0f, 1.0f);
+    baked.samples[i] = static_cast<std::uint16_t>(std::lround((normalized * 0.5f + 0.5f) * scale));
+  }
+}
+
+void SDFBrickMap::store(const BakedBrick& baked)
+{
+  std::uint32_t state = baked.state;
+  if (baked.samples.empty())
+  {
+    m_indirectionChanged |= m_indirection[baked.brick] != state;
+    m_indirection[baked.brick] = state;
+    return;
+  }
+
+  state = allocateSlot();
+  const glm::ivec3 origin = slotOrigin(state);
+  const int bytes = getBytesPerSample();
+  int i = 0;
+  for (int k = 0; k < BRICK_SAMPLES; k++)
+    for (int j = 0; j < BRICK_SAMPLES; j++)
+    {
+      const std::size_t texel =
+          (static_cast<std::size_t>(origin.z + k) * ATLAS_WIDTH + origin.y + j) * ATLAS_WIDTH +
+          origin.x;
+      std::uint8_t* row = &m_atlas[texel * bytes];
+      for (int l = 0; l < BRICK_SAMPLES; l++, i++)
+      {
+        if (bytes == 1)
+          row[l] = static_cast<std::uint8_t>(baked.samples[i]);
+        else
+          std::memcpy(row + l * 2, &baked.samples[i], 2);
+      }
+    }
+
+  if (!m_fullyChanged)
+    m_changedSlots.push_back(state);
+  m_indirectionChanged |= m_indirection[baked.brick] != state;
+  m_indirection[baked.brick] = state;
+}
+
+std::uint32_t SDFBrickMap::allocateSlot()
+{
+  if (!m_freeSlots.empty())
+  {
+    const std::uint32_t slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    return slot;
+  }
+
+  if (m_slotCount == m_atlasLayers * BRICKS_PER_LAYER)
+  {
+    // The texture has to be reallocated for a new layer, so it gets everything again
+    m_atlasLayers++;
+    m_atlas.resize(static_cast<std::size_t>(ATLAS_WIDTH) * ATLAS_WIDTH * getAtlasDepth() *
+                   getBytesPerSample());
+    m_fullyChanged = true;
+    m_changedSlots.clear();
+  }
+  return m_slotCount++;
+}
+
+float SDFBrickMap::sample(const glm::vec3& point) const
+{
+  if (m_indirection.empty())
+    return m_band;
+
+  const glm::vec3 grid = (point - m_origin) / m_voxelSize;
+  const glm::vec3 extent = glm::vec3(m_gridSize * BRICK_CELLS);
+  const glm::vec3 outside = glm::max(glm::max(-grid, grid - extent), glm::vec3(0.0f));
+  if (outside != glm::vec3(0.0f))
+    return glm::length(outside) * m_voxelSize + m_band;
+
+  const glm::ivec3 brick = glm::min(glm::ivec3(grid) / BRICK_CELLS, m_gridSize - 1);
+  const std::uint32_t state =
+      m_indirection[(brick.z * m_gridSize.y + brick.y) * m_gridSize.x + brick.x];
+  if (state >= EMPTY_INSIDE)
+    return state == EMPTY_INSIDE ? -m_band : m_band;
+
+  const glm::vec3 local = grid - glm::vec3(brick * BRICK_CELLS);
+  const glm::ivec3 cell = glm::min(glm::ivec3(local), glm::ivec3(BRICK_CELLS - 1));
+  const glm::vec3 f = local - glm::vec3(cell);
+  const glm::ivec3 origin = slotOrigin(state) + cell;
+  const int bytes = getBytesPerSample();
+
+  auto fetch = [&](int dx, int dy, int dz)
+  {
+    const std::size_t index =
+        ((static_cast<std::size_t>(origin.z + dz) * ATLAS_WIDTH + origin.y + dy) * ATLAS_WIDTH +
+         origin.x + dx) *
+        bytes;
+    if (bytes == 1)
+      return static_cast<float>(m_atlas[index]);
+    std::uint16_t value;
+    std::memcpy(&value, &m_atlas[index], 2);
+    return static_cast<float>(value);
+  };
+
+  const float x00 = fetch(0, 0, 0) + (fetch(1, 0, 0) - fetch(0, 0, 0)) * f.x;
+  const float x10 = fetch(0, 1, 0) + (fetch(1, 1, 0) - fetch(0, 1, 0)) * f.x;
+  const float x01 = fetch(0, 0, 1) + (fetch(1, 0, 1) - fetch(0, 0, 1)) * f.x;
+  const float x11 = fetch(0, 1, 1) + (fetch(1, 1, 1) - fetch(0, 1, 1)) * f.x;
+  const float y0 = x00 + (x10 - x00) * f.y;
+  const float y1 = x01 + (x11 - x01) * f.y;
+  const float value = (y0 + (y1 - y0) * f.z) / maxQuantised(m_format);
+  return (value * 2.0f - 1.0f) * m_band;
+}
+
+AABB SDFBrickMap::getBounds() const
+{
+  if (m_indirection.empty())
+    return {};
+  return {m_origin, m_origin + glm::vec3(m_gridSize * BRICK_CELLS) * m_voxelSize};
+}
+
+glm::ivec3 SDFBrickMap::slotOrigin(std::uint32_t slot)
+{
+  return glm::ivec3(slot % ATLAS_BRICKS,
+                    (slot / ATLAS_BRICKS) % ATLAS_BRICKS,
+                    slot / BRICKS_PER_LAYER) *
+         BRICK_SAMPLES;
+}
+
+void SDFBrickMap::clearChanges()
+{
+  m_fullyChanged = false;
+  m_indirectionChanged = false;
+  m_changedSlots.clear();
+}
+
+glm::vec3 SDFBrickMap::brickCorner(std::uint32_t brick) const
+{
+  const glm::ivec3 coord(brick % m_gridSize.x,
+                         (brick / m_gridSize.x) % m_gridSize.y,
+                         brick / (m_gridSize.x * m_gridSize.y));
+  return m_origin + glm::vec3(coord * BRICK_CELLS) * m_voxelSize;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "aabb.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+class SDFObject;
+
+enum class SDFBrickFormat : std::uint8_t
+{
+  R8,
+  R16
+};
+
+// Sparse bake of an SDFObject for constant cost sampling, however big the tree is.
+// The bounds are split into a grid of bricks of BRICK_CELLS^3 voxels. Only bricks the surface
+// passes near are stored, as BRICK_SAMPLES^3 distances clamped to [-band, band] and quantised.
+// Neighbouring bricks repeat their shared face, so trilinear filtering never reads across
+// bricks. Every other brick is just marked as inside or outside.
+//
+// The stored bricks live in a 3D atlas laid out like the GPU texture (see SDFBrickTexture):
+// ATLAS_BRICKS x ATLAS_BRICKS bricks per layer, layers added as needed. An indirection grid
+// maps each brick of the bounds to its atlas slot.
+//
+// After an edit, markDirty() the region it touched and update() re-bakes just those bricks.
+class SDFBrickMap
+{
+  public:
+  static constexpr int BRICK_CELLS = 7;
+  static constexpr int BRICK_SAMPLES = BRICK_CELLS + 1;
+  static constexpr int ATLAS_BRICKS = 32;
+  static constexpr int ATLAS_WIDTH = ATLAS_BRICKS * BRICK_SAMPLES;
+  static constexpr std::uint32_t BRICKS_PER_LAYER = ATLAS_BRICKS * ATLAS_BRICKS;
+  // Indirection values of bricks that aren't stored
+  static constexpr std::uint32_t EMPTY_INSIDE = 0xFFFFFFFE;
+  static constexpr std::uint32_t EMPTY_OUTSIDE = 0xFFFFFFFF;
+
+  // band is how far from the surface distances are kept, in voxels
+  explicit SDFBrickMap(float voxelSize,
+                       float band = 3.0f,
+                       SDFBrickFormat format = SDFBrickFormat::R8);
+
+  // Throws away everything and bakes the whole object, bounds included
+  void bake(const SDFObject& sdf, JobSystem& jobs);
+
+  // Region in the object's space whose distances may have changed
+  void markDirty(const AABB& region);
+  // Re-bakes the dirty bricks and returns how many there were. Falls back to a full bake when
+  // the object has grown out of the baked bounds.
+  std::size_t update(const SDFObject& sdf, JobSystem& jobs);
+
+  // Trilinear like the shader, band clamped. Outside the bounds it's a lower bound.
+  float sample(const glm::vec3& point) const;
+
+  inline float getVoxelSize() const { return m_voxelSize; }
+  // In object units
+  inline float getBand() const { return m_band; }
+  inline SDFBrickFormat getFormat() const { return m_format; }
+  inline int getBytesPerSample() const { return m_format == SDFBrickFormat::R8 ? 1 : 2; }
+
+  inline const glm::vec3& getOrigin() const { return m_origin; }
+  inline const glm::ivec3& getGridSize() const { return m_gridSize; }
+  AABB getBounds() const;
+  inline const std::vector<std::uint32_t>& getIndirection() const { return m_indirection; }
+
+  // Stored bricks, the atlas may have free slots on top of these
+  inline std::size_t getBrickCount() const { return m_slotCount - m_freeSlots.size(); }
+  inline int getAtlasDepth() const { return m_atlasLayers * BRICK_SAMPLES; }
+  inline const std::vector<std::uint8_t>& getAtlas() const { return m_atlas; }
+  // Texel of the first sample of a slot
+  static glm::ivec3 slotOrigin(std::uint32_t slot);
+
+  // What changed since clearChanges(), so uploads can be partial. A full bake or a grown atlas
+  // sets isFullyChanged instead of listing every slot.
+  inline bool isFullyChanged() const { return m_fullyChanged; }
+  inline bool isIndirectionChanged() const { return m_indirectionChanged; }
+  inline const std::vector<std::uint32_t>& getChangedSlots() const { return m_changedSlots; }
+  void clearChanges();
+
+  private:
+  struct BakedBrick
+  {
+    std::uint32_t brick;
+    // EMPTY_* or a stored brick, whose quantised samples are in samples
+    std::uint32_t state;
+    std::vector<std::uint16_t> samples;
+  };
+
+  void bakeBricks(const SDFObject& sdf, JobSystem& jobs, const std::vector<std::uint32_t>& bricks);
+  void bakeBrick(const SDFObject& sdf, BakedBrick& baked) const;
+  void store(const BakedBrick& baked);
+  std::uint32_t allocateSlot();
+  glm::vec3 brickCorner(std::uint32_t brick) const;
+
+  float m_voxelSize;
+  float m_band;
+  SDFBrickFormat m_format;
+
+  glm::vec3 m_origin{0.0f};
+  glm::ivec3 m_gridSize{0};
+  std::vector<std::uint32_t> m_indirection;
+  std::vector<bool> m_dirty;
+  std::vector<std::uint32_t> m_dirtyBricks;
+
+  std::vector<std::uint8_t> m_atlas;
+  int m_atlasLayers = 0;
+  std::uint32_t m_slotCount = 0;
+  std::vector<std::uint32_t> m_freeSlots;
+
+  bool m_fullyChanged = false;
+  bool m_indirectionChanged = false;
+  std::vector<std::uint32_t> m_changedSlots;
+};
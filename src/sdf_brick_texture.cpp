@@ -0,0 +1,137 @@
+#include "sdf_brick_texture.h"
+
+#include "sdf_brick_map.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+
+SDFBrickTexture::SDFBrickTexture()
+    : m_atlasID(0),
+      m_indirectionID(0),
+      m_atlasDepth(0),
+      m_bytesPerSample(0),
+      m_gridSize(0),
+      m_voxelSize(0.0f),
+      m_band(0.0f)
+{
+  glGenTextures(1, &m_atlasID);
+  glGenTextures(1, &m_indirectionID);
+
+  // Bricks repeat their borders, so plain trilinear filtering is seamless
+  glBindTexture(GL_TEXTURE_3D, m_atlasID);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+  // Integer textures can't be filtered
+  glBindTexture(GL_TEXTURE_3D, m_indirectionID);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+SDFBrickTexture::~SDFBrickTexture()
+{
+  glDeleteTextures(1, &m_atlasID);
+  glDeleteTextures(1, &m_indirectionID);
+}
+
+void SDFBrickTexture::upload(SDFBrickMap& map)
+{
+  const bool r8 = map.getFormat() == SDFBrickFormat::R8;
+  const GLenum internalFormat = r8 ? GL_R8 : GL_R16;
+  const GLenum type = r8 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+  constexpr int WIDTH = SDFBrickMap::ATLAS_WIDTH;
+  constexpr int SAMPLES = SDFBrickMap::BRICK_SAMPLES;
+
+  glBindTexture(GL_TEXTURE_3D, m_atlasID);
+  const bool reallocate =
+      map.getAtlasDepth() != m_atlasDepth || map.getBytesPerSample() != m_bytesPerSample;
+  if ((reallocate || map.isFullyChanged()) && map.getAtlasDepth() > 0)
+  {
+    glTexImage3D(GL_TEXTURE_3D,
+                 0,
+                 internalFormat,
+                 WIDTH,
+                 WIDTH,
+                 map.getAtlasDepth(),
+                 0,
+                 GL_RED,
+                 type,
+                 map.getAtlas().data());
+  }
+  else if (map.getAtlasDepth() > 0)
+  {
+    // Each brick is a box inside the atlas, the unpack state picks it out of the CPU copy
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, WIDTH);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, WIDTH);
+    for (std::uint32_t slot : map.getChangedSlots())
+    {
+      const glm::ivec3 origin = SDFBrickMap::slotOrigin(slot);
+      glPixelStorei(GL_UNPACK_SKIP_PIXELS, origin.x);
+      glPixelStorei(GL_UNPACK_SKIP_ROWS, origin.y);
+      glPixelStorei(GL_UNPACK_SKIP_IMAGES, origin.z);
+      glTexSubImage3D(GL_TEXTURE_3D,
+                      0,
+                      origin.x,
+                      origin.y,
+                      origin.z,
+                      SAMPLES,
+                      SAMPLES,
+                      SAMPLES,
+                      GL_RED,
+                      type,
+                      map.getAtlas().data());
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_IMAGES, 0);
+  }
+  m_atlasDepth = map.getAtlasDepth();
+  m_bytesPerSample = map.getBytesPerSample();
+
+  // A few bytes per brick of the bounds, cheaper to resend whole than to track
+  const glm::ivec3& grid = map.getGridSize();
+  if (map.isIndirectionChanged() && !map.getIndirection().empty())
+  {
+    glBindTexture(GL_TEXTURE_3D, m_indirectionID);
+    glTexImage3D(GL_TEXTURE_3D,
+                 0,
+                 GL_R32UI,
+                 grid.x,
+                 grid.y,
+                 grid.z,
+                 0,
+                 GL_RED_INTEGER,
+                 GL_UNSIGNED_INT,
+                 map.getIndirection().data());
+  }
+  glBindTexture(GL_TEXTURE_3D, 0);
+
+  m_bounds = map.getBounds();
+  m_gridSize = grid;
+  m_voxelSize = map.getVoxelSize();
+  m_band = map.getBand();
+  map.clearChanges();
+}
+
+void SDFBrickTexture::bind(const Shader& shader,
+                           unsigned int atlasSlot,
+                           unsigned int indirectionSlot) const
+{
+  glActiveTexture(GL_TEXTURE0 + atlasSlot);
+  glBindTexture(GL_TEXTURE_3D, m_atlasID);
+  glActiveTexture(GL_TEXTURE0 + indirectionSlot);
+  glBindTexture(GL_TEXTURE_3D, m_indirectionID);
+
+  shader.setUniform("brickAtlas", static_cast<int>(atlasSlot));
+  shader.setUniform("brickIndirection", static_cast<int>(indirectionSlot));
+  shader.setUniform("brickOrigin", m_bounds.min);
+  shader.setUniform("brickGridSize", glm::vec3(m_gridSize));
+  shader.setUniform("brickVoxelSize", m_voxelSize);
+  shader.setUniform("brickBand", m_band);
+}
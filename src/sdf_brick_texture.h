@@ -0,0 +1,41 @@
+#pragma once
+
+#include "aabb.h"
+
+#include <glm/glm.hpp>
+
+class SDFBrickMap;
+class Shader;
+
+// GPU copy of an SDFBrickMap: the brick atlas as a filtered GL_TEXTURE_3D and the indirection
+// grid as an unsigned integer one. res/shaders/include/sdf_bricks.glsl samples them.
+class SDFBrickTexture
+{
+  public:
+  SDFBrickTexture();
+  ~SDFBrickTexture();
+
+  SDFBrickTexture(const SDFBrickTexture&) = delete;
+  SDFBrickTexture& operator=(const SDFBrickTexture&) = delete;
+
+  // Sends what changed since the last upload and clears the map's change tracking.
+  // After an incremental update that's only the re-baked bricks.
+  void upload(SDFBrickMap& map);
+
+  // Binds both textures and sets the uniforms the sampling code reads
+  void bind(const Shader& shader, unsigned int atlasSlot, unsigned int indirectionSlot) const;
+
+  inline const AABB& getBounds() const { return m_bounds; }
+  inline bool isEmpty() const { return m_bounds.isEmpty(); }
+
+  private:
+  unsigned int m_atlasID;
+  unsigned int m_indirectionID;
+  int m_atlasDepth;
+  int m_bytesPerSample;
+
+  AABB m_bounds;
+  glm::ivec3 m_gridSize;
+  float m_voxelSize;
+  float m_band;
+};
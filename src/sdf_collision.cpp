@@ -0,0 +1,375 @@
+#include "sdf_collision.h"
+
+#include "job_system.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+constexpr int PACKET = static_cast<int>(SDFObject::BATCH_WIDTH);
+// Points per batched evaluation, every probe of a full packet
+constexpr int MAX_POINTS = PACKET * SDFCollisionWorld::MAX_PROBES;
+constexpr float FAR = std::numeric_limits<float>::max();
+constexpr float NORMAL_EPSILON = 1e-3f;
+
+using Mover = SDFCollisionWorld::Mover;
+
+// Spheres half a radius apart along the capsule, the surface sinks in at most 3% of a radius
+// between two of them
+int probeCount(const Mover& mover)
+{
+  if (mover.halfHeight <= 0.0f)
+    return 1;
+  const int count = 1 + static_cast<int>(std::ceil(4.0f * mover.halfHeight / mover.radius));
+  return std::min(count, SDFCollisionWorld::MAX_PROBES);
+}
+
+glm::vec3 probe(const Mover& mover, int index, int count)
+{
+  if (count == 1)
+    return mover.position;
+  const float y = mover.halfHeight * (2.0f * index / (count - 1) - 1.0f);
+  return mover.position + glm::vec3(0.0f, y, 0.0f);
+}
+
+inline float boxDistance(const AABB& box, const glm::vec3& point)
+{
+  return glm::length(glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.0f)));
+}
+
+// Spreads the low 10 bits two apart, for interleaving into a Morton code
+inline std::uint32_t spreadBits(std::uint32_t v)
+{
+  v &= 0x3FF;
+  v = (v | (v << 16)) & 0x030000FF;
+  v = (v | (v << 8)) & 0x0300F00F;
+  v = (v | (v << 4)) & 0x030C30C3;
+  v = (v | (v << 2)) & 0x09249249;
+  return v;
+}
+}  // namespace
+
+std::uint32_t SDFCollisionWorld::add(const SDFObject& sdf, const Transform& transform)
+{
+  return add(sdf, transform.matrix());
+}
+
+std::uint32_t SDFCollisionWorld::add(const SDFObject& sdf, const glm::mat4& model)
+{
+  const auto index = static_cast<std::uint32_t>(m_instances.size());
+  m_instances.emplace_back().sdf = sdf;
+  m_proxies.push_back(DynamicBvh::NULL_NODE);
+  place(index, model);
+  return index;
+}
+
+void SDFCollisionWorld::update(std::uint32_t index, const glm::mat4& model)
+{
+  place(index, model);
+}
+
+void SDFCollisionWorld::replace(std::uint32_t index, const SDFObject& sdf, const glm::mat4& model)
+{
+  m_instances[index].sdf = sdf;
+  place(index, model);
+}
+
+void SDFCollisionWorld::place(std::uint32_t index, const glm::mat4& model)
+{
+  Instance& instance = m_instances[index];
+  std::int32_t& proxy = m_proxies[index];
+  const AABB bounds = instance.sdf.getBounds();
+  if (instance.sdf.isEmpty() || bounds.isEmpty())
+  {
+    if (proxy != DynamicBvh::NULL_NODE)
+      m_bvh.destroyProxy(proxy);
+    proxy = DynamicBvh::NULL_NODE;
+    return;
+  }
+
+  instance.inverseModel = glm::inverse(model);
+  // Rotations leave the axis lengths alone, these are the scale
+  instance.distanceScale = std::min(glm::length(glm::vec3(model[0])),
+                                    std::min(glm::length(glm::vec3(model[1])),
+                                             glm::length(glm::vec3(model[2]))));
+  instance.bounds = AABB();
+  for (int corner = 0; corner < 8; corner++)
+  {
+    const glm::vec3 point((corner & 1) ? bounds.max.x : bounds.min.x,
+                          (corner & 2) ? bounds.max.y : bounds.min.y,
+                          (corner & 4) ? bounds.max.z : bounds.min.z);
+    instance.bounds.expand(glm::vec3(model * glm::vec4(point, 1.0f)));
+  }
+
+  // Small moves stay inside the fat bounds and leave the tree alone
+  if (proxy == DynamicBvh::NULL_NODE)
+    proxy = m_bvh.createProxy(instance.bounds, index);
+  else
+    m_bvh.updateProxy(proxy, instance.bounds);
+}
+
+void SDFCollisionWorld::clear()
+{
+  for (std::int32_t proxy : m_proxies)
+  {
+    if (proxy != DynamicBvh::NULL_NODE)
+      m_bvh.destroyProxy(proxy);
+  }
+  m_proxies.clear();
+  m_instances.clear();
+}
+
+float SDFCollisionWorld::distance(const glm::vec3& point) const
+{
+  float result;
+  distances(&point.x, &point.y, &point.z, 1, &result);
+  return result;
+}
+
+void SDFCollisionWorld::distances(const float* x,
+                                  const float* y,
+                                  const float* z,
+                                  std::size_t count,
+                                  float* distances,
+                                  float maxDistance) const
+{
+  std::fill(distances, distances + count, maxDistance);
+  float lx[MAX_POINTS], ly[MAX_POINTS], lz[MAX_POINTS], local[MAX_POINTS];
+  std::uint32_t needed[MAX_POINTS];
+  for (std::size_t first = 0; first < count; first += MAX_POINTS)
+  {
+    const std::size_t end = std::min<std::size_t>(first + MAX_POINTS, count);
+    AABB region;
+    for (std::size_t i = first; i < end; i++)
+      region.expand(glm::vec3(x[i], y[i], z[i]));
+    region.min -= glm::vec3(maxDistance);
+    region.max += glm::vec3(maxDistance);
+
+    m_bvh.queryOverlap(
+        region,
+        [&](std::int32_t proxy)
+        {
+          const Instance& instance = m_instances[m_bvh.getUserData(proxy)];
+          // The surface is inside the bounds, points already nearer to something than to the
+          // box are left out of the batch
+          std::size_t n = 0;
+          for (std::size_t i = first; i < end; i++)
+          {
+            const glm::vec3 p(x[i], y[i], z[i]);
+            if (boxDistance(instance.bounds, p) >= distances[i])
+              continue;
+            const glm::vec3 objectPoint = glm::vec3(instance.inverseModel * glm::vec4(p, 1.0f));
+            needed[n] = static_cast<std::uint32_t>(i);
+            lx[n] = objectPoint.x;
+            ly[n] = objectPoint.y;
+            lz[n] = objectPoint.z;
+            n++;
+          }
+          if (n == 0)
+            return true;
+
+          instance.sdf.evaluate(lx, ly, lz, n, local);
+          for (std::size_t k = 0; k < n; k++)
+          {
+            float& distance = distances[needed[k]];
+            distance = std::min(distance, local[k] * instance.distanceScale);
+          }
+          return true;
+        });
+  }
+}
+
+glm::vec3 SDFCollisionWorld::normal(const glm::vec3& point, float maxDistance) const
+{
+  // Same tetrahedron as SDFObject::normal, all four in one batch
+  static const glm::vec3 OFFSETS[4] = {
+      {1.0f, -1.0f, -1.0f}, {-1.0f, -1.0f, 1.0f}, {-1.0f, 1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}};
+  float x[4], y[4], z[4], d[4];
+  for (int i = 0; i < 4; i++)
+  {
+    const glm::vec3 p = point + OFFSETS[i] * NORMAL_EPSILON;
+    x[i] = p.x;
+    y[i] = p.y;
+    z[i] = p.z;
+  }
+  distances(x, y, z, 4, d, maxDistance);
+
+  glm::vec3 gradient(0.0f);
+  for (int i = 0; i < 4; i++)
+    gradient += OFFSETS[i] * d[i];
+  const float length = glm::length(gradient);
+  // Flat spots (or nothing at all around) push up
+  return length > 0.0f ? gradient / length : glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+bool SDFCollisionWorld::sweepSphere(const glm::vec3& from,
+                                    const glm::vec3& to,
+                                    float radius,
+                                    Hit& hit) const
+{
+  const float length = glm::length(to - from);
+  const glm::vec3 direction = length > 0.0f ? (to - from) / length : glm::vec3(0.0f);
+  float t = 0.0f;
+  for (int step = 0; step < MAX_SWEEP_STEPS; step++)
+  {
+    const glm::vec3 point = from + direction * t;
+    const float gap = distance(point) - radius;
+    if (gap < SKIN)
+    {
+      hit.fraction = length > 0.0f ? t / length : 0.0f;
+      hit.normal = normal(point);
+      return true;
+    }
+    t += gap;
+    if (t >= length)
+      break;
+  }
+  hit.fraction = length > 0.0f ? std::min(t / length, 1.0f) : 1.0f;
+  hit.normal = glm::vec3(0.0f);
+  return false;
+}
+
+float SDFCollisionWorld::penetration(const Mover& mover, glm::vec3* contactNormal) const
+{
+  const int count = probeCount(mover);
+  float x[MAX_PROBES], y[MAX_PROBES], z[MAX_PROBES], d[MAX_PROBES];
+  for (int i = 0; i < count; i++)
+  {
+    const glm::vec3 p = probe(mover, i, count);
+    x[i] = p.x;
+    y[i] = p.y;
+    z[i] = p.z;
+  }
+  distances(x, y, z, count, d);
+
+  const int nearest = static_cast<int>(std::min_element(d, d + count) - d);
+  if (contactNormal)
+    *contactNormal = normal(probe(mover, nearest, count));
+  return mover.radius - d[nearest];
+}
+
+void SDFCollisionWorld::move(Mover& mover) const
+{
+  movePacket(&mover, 1);
+}
+
+void SDFCollisionWorld::move(std::span<Mover> movers, JobSystem& jobs) const
+{
+  // Packets go in Morton order of the positions, so their movers are close together and query
+  // the same few shapes
+  AABB area;
+  for (const Mover& mover : movers)
+    area.expand(mover.position);
+  const glm::vec3 scale = 1023.0f / glm::max(area.size(), glm::vec3(1e-6f));
+  std::vector<std::uint64_t> order(movers.size());
+  for (std::size_t i = 0; i < movers.size(); i++)
+  {
+    const glm::uvec3 cell((movers[i].position - area.min) * scale);
+    const std::uint32_t code =
+        spreadBits(cell.x) | (spreadBits(cell.y) << 1) | (spreadBits(cell.z) << 2);
+    order[i] = (static_cast<std::uint64_t>(code) << 32) | i;
+  }
+  std::sort(order.begin(), order.end());
+
+  const std::size_t packets = (movers.size() + PACKET - 1) / PACKET;
+  jobs.parallelFor(packets,
+                   16,
+                   [&](std::size_t begin, std::size_t end)
+                   {
+                     Mover packet[PACKET];
+                     for (std::size_t p = begin; p < end; p++)
+                     {
+                       const std::size_t first = p * PACKET;
+                       const int count = static_cast<int>(
+                           std::min<std::size_t>(PACKET, movers.size() - first));
+                       for (int m = 0; m < count; m++)
+                         packet[m] = movers[static_cast<std::uint32_t>(order[first + m])];
+                       movePacket(packet, count);
+                       for (int m = 0; m < count; m++)
+                         movers[static_cast<std::uint32_t>(order[first + m])] = packet[m];
+                     }
+                   });
+}
+
+void SDFCollisionWorld::movePacket(Mover* movers, int count) const
+{
+  glm::vec3 remaining[PACKET];
+  int probes[PACKET];
+  bool active[PACKET];
+  for (int m = 0; m < count; m++)
+  {
+    remaining[m] = movers[m].motion;
+    probes[m] = probeCount(movers[m]);
+    active[m] = true;
+    movers[m].collided = false;
+    movers[m].normal = glm::vec3(0.0f);
+  }
+
+  float x[MAX_POINTS], y[MAX_POINTS], z[MAX_POINTS], d[MAX_POINTS];
+  for (int iteration = 0; iteration < MAX_ITERATIONS; iteration++)
+  {
+    int firstProbe[PACKET];
+    int points = 0;
+    float reach = 0.0f;
+    for (int m = 0; m < count; m++)
+    {
+      if (!active[m])
+        continue;
+      firstProbe[m] = points;
+      reach = std::max(reach, glm::length(remaining[m]) + movers[m].radius + SKIN);
+      for (int i = 0; i < probes[m]; i++, points++)
+      {
+        const glm::vec3 p = probe(movers[m], i, probes[m]);
+        x[points] = p.x;
+        y[points] = p.y;
+        z[points] = p.z;
+      }
+    }
+    if (points == 0)
+      break;
+    // Anything further than a mover can get this step doesn't matter
+    distances(x, y, z, points, d, reach);
+
+    for (int m = 0; m < count; m++)
+    {
+      if (!active[m])
+        continue;
+      Mover& mover = movers[m];
+      const float* own = d + firstProbe[m];
+      const int nearest = static_cast<int>(std::min_element(own, own + probes[m]) - own);
+      const float gap = own[nearest] - mover.radius;
+
+      // Penetrating: out along the gradient, and no more moving into the surface
+      if (gap < 0.0f)
+      {
+        // The surface is within a radius, nothing further can change the gradient
+        const glm::vec3 n = normal(probe(mover, nearest, probes[m]), 2.0f * mover.radius);
+        mover.position += n * (SKIN - gap);
+        remaining[m] -= n * std::min(glm::dot(remaining[m], n), 0.0f);
+        mover.collided = true;
+        mover.normal = n;
+        continue;
+      }
+
+      const float length = glm::length(remaining[m]);
+      if (length <= 0.0f)
+      {
+        active[m] = false;
+        continue;
+      }
+      // Nothing is nearer than the gap, the whole rest of the motion is free
+      if (gap >= length)
+      {
+        mover.position += remaining[m];
+        active[m] = false;
+        continue;
+      }
+      const float step = std::min(std::max(gap, MIN_STEP * mover.radius), length);
+      mover.position += remaining[m] * (step / length);
+      remaining[m] *= 1.0f - step / length;
+    }
+  }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "aabb.h"
+#include "bvh.h"
+#include "component/transform.h"
+#include "sdf_object.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+// Sphere and capsule movers against SDF shapes, on the CPU evaluator. The distance to the
+// scene is all a query needs, so a shape of a hundred primitives costs a hundred primitive
+// evaluations and nothing like a triangle soup would.
+//
+// move() walks a mover along its motion in steps as long as the free distance around it. In
+// contact it steps at least MIN_STEP radii, then pushes out along the gradient by the depth it
+// ended up at and drops the part of the motion going into the surface, so it slides.
+// Movers are processed in packets of SDFObject::BATCH_WIDTH. A DynamicBvh over the shapes finds
+// the ones within reach of a packet, and each goes through one batched evaluation of the probes
+// that can't be nearer to something else already.
+class SDFCollisionWorld
+{
+  public:
+  static constexpr int MAX_ITERATIONS = 16;
+  static constexpr int MAX_SWEEP_STEPS = 64;
+  // Capsules are probed with at most this many spheres
+  static constexpr int MAX_PROBES = 8;
+  // Movers are pushed out to this far from surfaces
+  static constexpr float SKIN = 1e-3f;
+  static constexpr float MIN_STEP = 0.25f;
+
+  struct Mover
+  {
+    glm::vec3 position{0.0f};
+    // Wanted displacement
+    glm::vec3 motion{0.0f};
+    float radius{0.25f};
+    // A capsule along world Y when above 0, half the length of its straight part
+    float halfHeight{0.0f};
+    // Set by move(), normal of the last contact
+    bool collided{false};
+    glm::vec3 normal{0.0f};
+  };
+
+  struct Hit
+  {
+    // Of the motion, travelled before touching
+    float fraction;
+    glm::vec3 normal;
+  };
+
+  // Copied, later edits to sdf don't show up until replace(). Returns the index of the shape,
+  // shapes are numbered in the order they're added.
+  std::uint32_t add(const SDFObject& sdf, const Transform& transform);
+  std::uint32_t add(const SDFObject& sdf, const glm::mat4& model);
+  // Moves a shape, its node list stays as it is
+  void update(std::uint32_t index, const glm::mat4& model);
+  // Swaps in another copy of sdf, for shapes whose parameters or structure changed
+  void replace(std::uint32_t index, const SDFObject& sdf, const glm::mat4& model);
+  void clear();
+  inline std::size_t getShapeCount() const { return m_instances.size(); }
+
+  // Nearest surface, a lower bound under non-uniform scale. Huge when there are no shapes.
+  float distance(const glm::vec3& point) const;
+  // Shapes further than maxDistance from every point are skipped, results are capped to it
+  void distances(const float* x,
+                 const float* y,
+                 const float* z,
+                 std::size_t count,
+                 float* distances,
+                 float maxDistance = std::numeric_limits<float>::max()) const;
+  // Gradient of distance(), pointing out of the nearest surface
+  glm::vec3 normal(const glm::vec3& point,
+                   float maxDistance = std::numeric_limits<float>::max()) const;
+
+  // Sphere traces a sphere from from to to, false when it gets there without touching
+  bool sweepSphere(const glm::vec3& from, const glm::vec3& to, float radius, Hit& hit) const;
+  // How deep the mover is in the scene at its position, 0 or less when it's free
+  float penetration(const Mover& mover, glm::vec3* contactNormal = nullptr) const;
+
+  void move(Mover& mover) const;
+  void move(std::span<Mover> movers, JobSystem& jobs) const;
+
+  private:
+  struct Instance
+  {
+    SDFObject sdf;
+    glm::mat4 inverseModel;
+    // Smallest axis of the scale, object distances times this are still a lower bound
+    float distanceScale;
+    AABB bounds;
+  };
+
+  // Refits the shape to model, empty shapes stay out of the BVH
+  void place(std::uint32_t index, const glm::mat4& model);
+  void movePacket(Mover* movers, int count) const;
+
+  std::vector<Instance> m_instances;
+  DynamicBvh m_bvh;
+  // Per instance, NULL_NODE while it's empty
+  std::vector<std::int32_t> m_proxies;
+};
@@ -0,0 +1,266 @@
+#include "sdf_compiler.h"
+
+#include "hash.h"
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+const glm::mat3 IDENTITY(1.0f);
+
+std::string glslFloat(float value)
+{
+  char buffer[32];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  std::string literal(buffer, result.ptr);
+  // "1" is an int in GLSL
+  if (literal.find_first_of(".e") == std::string::npos)
+    literal += ".0";
+  return literal;
+}
+
+// One walk over the node program serves all three outputs, so the code and the parameter
+// layout can't drift apart. Null outputs are skipped.
+class Emitter
+{
+  public:
+  Emitter(bool bake, std::string* code, std::vector<glm::vec4>* parameters)
+      : m_bake(bake), m_code(code), m_parameters(parameters)
+  {
+    hash(bake);
+  }
+
+  // Handle to a vec4 of parameters, either a slot in the uniform block or a baked constant
+  struct Param
+  {
+    glm::vec4 value;
+    int slot;
+  };
+
+  Param add(const glm::vec4& value)
+  {
+    if (m_bake)
+    {
+      hash(value);
+      return {value, -1};
+    }
+    if (m_parameters)
+      m_parameters->push_back(value);
+    return {value, m_slotCount++};
+  }
+
+  std::string ref(const Param& param, const char* swizzle) const
+  {
+    if (!m_code)
+      return {};
+    if (param.slot >= 0)
+      return "sdfParameters[" + std::to_string(param.slot) + "]." + swizzle;
+
+    const std::size_t count = std::strlen(swizzle);
+    std::string literal = count == 1 ? "" : "vec" + std::to_string(count) + "(";
+    for (std::size_t i = 0; i < count; i++)
+    {
+      const int component = swizzle[i] == 'w' ? 3 : swizzle[i] - 'x';
+      literal += (i ? ", " : "") + glslFloat(param.value[component]);
+    }
+    return count == 1 ? literal : literal + ")";
+  }
+
+  void line(const std::string& text)
+  {
+    if (m_code)
+      *m_code += "  " + text + "\n";
+  }
+
+  template <typename T>
+  void hash(const T& value)
+  {
+    m_key = fnv1a_64(&value, sizeof(value), m_key);
+  }
+
+  inline bool isEmitting() const { return m_code != nullptr; }
+  inline int getSlotCount() const { return m_slotCount; }
+  inline std::uint64_t getKey() const { return m_key; }
+
+  private:
+  bool m_bake;
+  std::string* m_code;
+  std::vector<glm::vec4>* m_parameters;
+  int m_slotCount = 0;
+  std::uint64_t m_key = FNV1A_64_OFFSET;
+};
+
+void emitPrimitive(Emitter& out, const SDFObject::Node& node, const std::string& name)
+{
+  const bool rotates = node.toLocal != IDENTITY;
+  const bool translates = node.position != glm::vec3(0.0f);
+  const bool scales = node.distanceScale != 1.0f;
+  out.hash(node.op);
+  out.hash(rotates);
+  out.hash(translates);
+  out.hash(scales);
+
+  std::string point = "p";
+  if (rotates || translates)
+  {
+    std::string local = "p";
+    if (translates)
+      local = "(p - " + out.ref(out.add(glm::vec4(node.position, 0.0f)), "xyz") + ")";
+    if (rotates)
+    {
+      const auto c0 = out.add(glm::vec4(node.toLocal[0], 0.0f));
+      const auto c1 = out.add(glm::vec4(node.toLocal[1], 0.0f));
+      const auto c2 = out.add(glm::vec4(node.toLocal[2], 0.0f));
+      local = "mat3(" + out.ref(c0, "xyz") + ", " + out.ref(c1, "xyz") + ", " +
+              out.ref(c2, "xyz") + ") * " + local;
+    }
+    point = "p" + name;
+    out.line("vec3 " + point + " = " + local + ";");
+  }
+
+  // Sizes in xyz, distance scale in w
+  const auto size = out.add(glm::vec4(glm::vec3(node.params), node.distanceScale));
+  if (!out.isEmitting())
+    return;
+
+  std::string distance;
+  switch (node.op)
+  {
+    case SDFOp::Sphere:
+      distance = "sdSphere(" + point + ", " + out.ref(size, "x") + ")";
+      break;
+    case SDFOp::Box:
+      distance = "sdBox(" + point + ", " + out.ref(size, "xyz") + ")";
+      break;
+    case SDFOp::Capsule:
+      distance = "sdCapsule(" + point + ", " + out.ref(size, "x") + ", " + out.ref(size, "y") + ")";
+      break;
+    default:
+      distance = "sdTorus(" + point + ", " + out.ref(size, "xy") + ")";
+      break;
+  }
+  if (scales)
+    distance += " * " + out.ref(size, "w");
+  out.line("float d" + name + " = " + distance + ";");
+}
+
+void emitOperator(Emitter& out,
+                  const SDFObject::Node& node,
+                  const std::string& name,
+                  const std::string& a,
+                  const std::string& b)
+{
+  const bool smooth = node.params.x > 0.0f;
+  out.hash(node.op);
+  out.hash(smooth);
+
+  if (!smooth)
+  {
+    switch (node.op)
+    {
+      case SDFOp::Union:
+        out.line("float d" + name + " = min(" + a + ", " + b + ");");
+        break;
+      case SDFOp::Subtract:
+        out.line("float d" + name + " = max(" + a + ", -" + b + ");");
+        break;
+      default:
+        out.line("float d" + name + " = max(" + a + ", " + b + ");");
+        break;
+    }
+    return;
+  }
+
+  const std::string k = out.ref(out.add(glm::vec4(node.params.x, 0.0f, 0.0f, 0.0f)), "x");
+  const char* function = node.op == SDFOp::Union      ? "opSmoothUnion"
+                         : node.op == SDFOp::Subtract ? "opSmoothSubtract"
+                                                      : "opSmoothIntersect";
+  out.line("float d" + name + " = " + function + "(" + a + ", " + b + ", " + k + ");");
+}
+
+// Returns the name of the root's distance variable, empty for an empty object
+std::string emit(Emitter& out, const SDFObject& sdf)
+{
+  const auto& nodes = sdf.getNodes();
+  const auto& program = sdf.getProgram();
+
+  // Variables are numbered by position in the program, so unused nodes don't change the key
+  std::vector<std::uint32_t> position(nodes.size(), 0);
+  for (std::uint32_t i = 0; i < program.size(); i++)
+    position[program[i]] = i;
+
+  for (std::uint32_t i = 0; i < program.size(); i++)
+  {
+    const SDFObject::Node& node = nodes[program[i]];
+    const std::string name = out.isEmitting() ? std::to_string(i) : std::string();
+    if (node.op <= SDFOp::Torus)
+    {
+      emitPrimitive(out, node, name);
+      continue;
+    }
+
+    out.hash(position[node.a]);
+    out.hash(position[node.b]);
+    const std::string a = out.isEmitting() ? "d" + std::to_string(position[node.a]) : "";
+    const std::string b = out.isEmitting() ? "d" + std::to_string(position[node.b]) : "";
+    emitOperator(out, node, name, a, b);
+  }
+  return program.empty() ? std::string() : "d" + std::to_string(position[sdf.getRoot()]);
+}
+}  // namespace
+
+namespace SDFCompiler
+{
+std::uint64_t structureKey(const SDFObject& sdf, bool bakeParameters)
+{
+  Emitter out(bakeParameters, nullptr, nullptr);
+  emit(out, sdf);
+  return out.getKey();
+}
+
+std::string generate(const SDFObject& sdf, bool bakeParameters)
+{
+  std::string body;
+  Emitter out(bakeParameters, &body, nullptr);
+  const std::string root = emit(out, sdf);
+
+  std::string code;
+  if (out.getSlotCount() > 0)
+  {
+    code += "layout(std140) uniform " + std::string(PARAMETER_BLOCK) + "\n{\n";
+    code += "  vec4 sdfParameters[" + std::to_string(out.getSlotCount()) + "];\n};\n\n";
+  }
+  code += "float sceneSDF(vec3 p)\n{\n" + body;
+  // Nothing to hit, but far enough that marching gives up quickly
+  code += "  return " + (root.empty() ? std::string("1e10") : root) + ";\n}\n";
+  return code;
+}
+
+void gatherParameters(const SDFObject& sdf, std::vector<glm::vec4>& parameters)
+{
+  parameters.clear();
+  Emitter out(false, nullptr, &parameters);
+  emit(out, sdf);
+}
+
+PreprocessedShader buildShader(const std::string& templatePath,
+                               const SDFObject& sdf,
+                               bool bakeParameters,
+                               const std::vector<std::string>& defines)
+{
+  PreprocessedShader shader = ShaderPreprocessor::process(templatePath, defines);
+  std::string& fragment = shader.source.FragmentSource;
+  const std::size_t marker = fragment.find(SCENE_PRAGMA);
+  if (marker == std::string::npos)
+  {
+    std::cerr << "ERROR::SDF::MISSING_SCENE_PRAGMA " << templatePath << std::endl;
+    shader.ok = false;
+    return shader;
+  }
+
+  fragment.replace(marker, std::strlen(SCENE_PRAGMA), generate(sdf, bakeParameters));
+  return shader;
+}
+}  // namespace SDFCompiler
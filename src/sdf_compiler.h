@@ -0,0 +1,40 @@
+#pragma once
+
+#include "sdf_object.h"
+#include "shader_preprocessor.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Turns an SDFObject into a specialised GLSL `float sceneSDF(vec3 p)`.
+// Every node becomes a line of straight code: identity rotations, zero offsets, unit scales and
+// sharp operators are folded away at generation time instead of being evaluated per step.
+//
+// With bakeParameters the sizes and transforms are written into the source as constants, which
+// suits objects that never change. Otherwise they are read from the SDFParameters uniform
+// block, so the source and its key only depend on the structure of the tree: moving or
+// resizing a primitive is a buffer update, adding one is a new program.
+namespace SDFCompiler
+{
+inline constexpr const char* PARAMETER_BLOCK = "SDFParameters";
+// Where the generated code goes in the fragment stage of the template shader
+inline constexpr const char* SCENE_PRAGMA = "#pragma sdf_scene";
+
+// Equal keys generate identical source
+std::uint64_t structureKey(const SDFObject& sdf, bool bakeParameters);
+
+// The function, preceded by the uniform block it reads from when parameters aren't baked
+std::string generate(const SDFObject& sdf, bool bakeParameters);
+
+// Contents of the uniform block, in the order the generated code expects them
+void gatherParameters(const SDFObject& sdf, std::vector<glm::vec4>& parameters);
+
+// Preprocesses the template and replaces its SCENE_PRAGMA line with the generated code
+PreprocessedShader buildShader(const std::string& templatePath,
+                               const SDFObject& sdf,
+                               bool bakeParameters,
+                               const std::vector<std::string>& defines = {});
+}  // namespace SDFCompiler
@@ -0,0 +1,284 @@
+#include "sdf_mesher.h"
+
+#include "aabb.h"
+#include "job_system.h"
+#include "mesh_builder.h"
+#include "sdf_object.h"
+#include "vertex_format.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+using MeshContainer::Vertex;
+
+constexpr int N = SDFMesher::CHUNK_CELLS;
+constexpr float REFERENCE_HEIGHT = 1080.0f;
+constexpr std::uint32_t NO_VERTEX = 0xFFFFFFFF;
+
+struct Grid
+{
+  glm::vec3 origin;
+  float voxelSize;
+  glm::ivec3 cells;
+};
+
+inline int cornerIndex(const glm::ivec3& corner, const glm::ivec3& size)
+{
+  return (corner.z * size.y + corner.y) * size.x + corner.x;
+}
+
+void meshChunk(const SDFObject& sdf,
+               const Grid& grid,
+               const glm::ivec3& chunk,
+               SDFMesher::Level& out)
+{
+  // Cells from one before the chunk up to its end, and the corners around them
+  const glm::ivec3 first = glm::max(chunk * N - 1, glm::ivec3(0));
+  const glm::ivec3 end = glm::min(chunk * N + N, grid.cells);
+  const glm::ivec3 cellCount = end - first;
+  const glm::ivec3 cornerCount = cellCount + 1;
+
+  // Nothing to do when the surface is further away than any corner
+  const glm::vec3 lo = grid.origin + glm::vec3(first) * grid.voxelSize;
+  const glm::vec3 hi = grid.origin + glm::vec3(end) * grid.voxelSize;
+  if (std::abs(sdf.evaluate((lo + hi) * 0.5f)) > glm::length(hi - lo) * 0.5f + grid.voxelSize)
+    return;
+
+  const std::size_t samples = static_cast<std::size_t>(cornerCount.x) * cornerCount.y *
+                              cornerCount.z;
+  std::vector<float> x(samples), y(samples), z(samples), d(samples);
+  for (int k = 0; k < cornerCount.z; k++)
+    for (int j = 0; j < cornerCount.y; j++)
+      for (int i = 0; i < cornerCount.x; i++)
+      {
+        const int index = cornerIndex({i, j, k}, cornerCount);
+        const glm::ivec3 corner = first + glm::ivec3(i, j, k);
+        const glm::vec3 p = grid.origin + glm::vec3(corner) * grid.voxelSize;
+        x[index] = p.x;
+        y[index] = p.y;
+        z[index] = p.z;
+      }
+  sdf.evaluate(x.data(), y.data(), z.data(), samples, d.data());
+
+  // One vertex per crossed cell, at the average of the crossings on its twelve edges
+  std::vector<std::uint32_t> cellVertex(static_cast<std::size_t>(cellCount.x) * cellCount.y *
+                                            cellCount.z,
+                                        NO_VERTEX);
+  for (int k = 0; k < cellCount.z; k++)
+    for (int j = 0; j < cellCount.y; j++)
+      for (int i = 0; i < cellCount.x; i++)
+      {
+        float corners[8];
+        int inside = 0;
+        for (int c = 0; c < 8; c++)
+        {
+          const glm::ivec3 offset(c & 1, (c >> 1) & 1, (c >> 2) & 1);
+          corners[c] = d[cornerIndex(glm::ivec3(i, j, k) + offset, cornerCount)];
+          inside += corners[c] < 0.0f;
+        }
+        if (inside == 0 || inside == 8)
+          continue;
+
+        glm::vec3 sum(0.0f);
+        int crossings = 0;
+        for (int c = 0; c < 8; c++)
+          for (int bit = 1; bit < 8; bit <<= 1)
+          {
+            const float d0 = corners[c];
+            const float d1 = corners[c | bit];
+            if ((c & bit) || (d0 < 0.0f) == (d1 < 0.0f))
+              continue;
+            glm::vec3 crossing(c & 1, (c >> 1) & 1, (c >> 2) & 1);
+            crossing[bit >> 1] += d0 / (d0 - d1);
+            sum += crossing;
+            crossings++;
+          }
+
+        const glm::vec3 position =
+            grid.origin +
+            (glm::vec3(first + glm::ivec3(i, j, k)) + sum / static_cast<float>(crossings)) *
+                grid.voxelSize;
+        Vertex vertex{};
+        for (int c = 0; c < 3; c++)
+          vertex.position[c] = position[c];
+        vertex.normal =
+            VertexFormat::packNormal(sdf.normal(position, grid.voxelSize * 0.5f)).bits;
+        cellVertex[cornerIndex({i, j, k}, cellCount)] =
+            static_cast<std::uint32_t>(out.vertices.size());
+        out.vertices.push_back(vertex);
+      }
+
+  // A quad for every crossed edge starting at one of the chunk's own corners, between the four
+  // cells around it. Edges on the border of the grid have no cells on one side, but the
+  // padding keeps the surface off them.
+  const glm::ivec3 ownFirst = chunk * N;
+  for (int k = ownFirst.z; k < end.z; k++)
+    for (int j = ownFirst.y; j < end.y; j++)
+      for (int i = ownFirst.x; i < end.x; i++)
+      {
+        const glm::ivec3 p(i, j, k);
+        const float d0 = d[cornerIndex(p - first, cornerCount)];
+        for (int a = 0; a < 3; a++)
+        {
+          const int b = (a + 1) % 3;
+          const int c = (a + 2) % 3;
+          if (p[b] == 0 || p[c] == 0)
+            continue;
+          glm::ivec3 next = p;
+          next[a]++;
+          const float d1 = d[cornerIndex(next - first, cornerCount)];
+          if ((d0 < 0.0f) == (d1 < 0.0f))
+            continue;
+
+          glm::ivec3 eb(0), ec(0);
+          eb[b] = 1;
+          ec[c] = 1;
+          const glm::ivec3 cells[4] = {p - eb - ec, p - ec, p, p - eb};
+          std::uint32_t quad[4];
+          for (int q = 0; q < 4; q++)
+          {
+            quad[q] = cellVertex[cornerIndex(cells[q] - first, cellCount)];
+            assert(quad[q] != NO_VERTEX);
+          }
+          // Counter-clockwise seen from outside: towards +a when p is the inside corner
+          if (d0 >= 0.0f)
+            std::swap(quad[1], quad[3]);
+          out.indices.insert(out.indices.end(), {quad[0], quad[1], quad[2]});
+          out.indices.insert(out.indices.end(), {quad[0], quad[2], quad[3]});
+        }
+      }
+}
+}  // namespace
+
+namespace SDFMesher
+{
+Level extract(const SDFObject& sdf, float voxelSize, JobSystem& jobs)
+{
+  const AABB bounds = sdf.getBounds();
+  if (sdf.isEmpty() || bounds.isEmpty())
+    return {};
+
+  // A voxel of margin on each side keeps every crossing away from the border of the grid
+  Grid grid;
+  grid.voxelSize = voxelSize;
+  grid.origin = bounds.min - glm::vec3(voxelSize);
+  grid.cells = glm::max(glm::ivec3(glm::ceil(bounds.size() / voxelSize)) + 2, glm::ivec3(1));
+  const glm::ivec3 chunks = (grid.cells + N - 1) / N;
+
+  std::vector<Level> results(static_cast<std::size_t>(chunks.x) * chunks.y * chunks.z);
+  jobs.parallelFor(results.size(),
+                   1,
+                   [&](std::size_t begin, std::size_t end)
+                   {
+                     for (std::size_t i = begin; i < end; i++)
+                     {
+                       const int index = static_cast<int>(i);
+                       const glm::ivec3 chunk(index % chunks.x,
+                                              index / chunks.x % chunks.y,
+                                              index / (chunks.x * chunks.y));
+                       meshChunk(sdf, grid, chunk, results[i]);
+                     }
+                   });
+
+  MeshBuilder builder(sizeof(Vertex));
+  std::vector<unsigned int> remap;
+  for (const Level& chunk : results)
+  {
+    remap.resize(chunk.vertices.size());
+    for (std::size_t i = 0; i < chunk.vertices.size(); i++)
+      remap[i] = builder.addVertex(&chunk.vertices[i]);
+    for (std::size_t i = 0; i < chunk.indices.size(); i += 3)
+    {
+      builder.addTriangle(
+          remap[chunk.indices[i]], remap[chunk.indices[i + 1]], remap[chunk.indices[i + 2]]);
+    }
+  }
+  builder.optimize();
+
+  Level level;
+  level.vertices.resize(builder.getVertexCount());
+  std::memcpy(level.vertices.data(),
+              builder.getVertexData().data(),
+              builder.getVertexData().size());
+  level.indices = builder.getIndices();
+  return level;
+}
+
+MeshContainer::MeshData build(const SDFObject& sdf,
+                              float voxelSize,
+                              int lodCount,
+                              JobSystem& jobs)
+{
+  std::vector<Level> levels;
+  lodCount = std::clamp(lodCount, 1, static_cast<int>(MeshContainer::MAX_LODS));
+  for (int lod = 0; lod < lodCount; lod++)
+  {
+    Level level = extract(sdf, voxelSize * static_cast<float>(1 << lod), jobs);
+    if (level.indices.empty())
+      break;
+    levels.push_back(std::move(level));
+  }
+
+  AABB bounds;
+  if (!levels.empty())
+  {
+    for (const Vertex& vertex : levels[0].vertices)
+      bounds.expand(glm::vec3(vertex.position[0], vertex.position[1], vertex.position[2]));
+  }
+  else
+  {
+    bounds = AABB(glm::vec3(0.0f), glm::vec3(0.0f));
+  }
+
+  MeshContainer::MeshData data;
+  for (int k = 0; k < 3; k++)
+  {
+    data.boundsMin[k] = bounds.min[k];
+    data.boundsMax[k] = bounds.max[k];
+  }
+
+  const float extent = std::max(glm::max(bounds.size().x, bounds.size().y), bounds.size().z);
+  std::vector<std::uint32_t> indices;
+  std::size_t largestRange = 0;
+  for (std::uint32_t lod = 0; lod < levels.size(); lod++)
+  {
+    const float levelVoxel = voxelSize * static_cast<float>(1 << lod);
+    data.lodScreenSize.push_back(
+        lod == 0 ? 1.0f : PIXELS_PER_VOXEL * extent / (levelVoxel * REFERENCE_HEIGHT));
+
+    const Level& level = levels[lod];
+    data.submeshes.push_back({lod,
+                              0,
+                              static_cast<std::uint32_t>(data.vertices.size()),
+                              static_cast<std::uint32_t>(level.vertices.size()),
+                              static_cast<std::uint32_t>(indices.size()),
+                              static_cast<std::uint32_t>(level.indices.size())});
+    data.vertices.insert(data.vertices.end(), level.vertices.begin(), level.vertices.end());
+    indices.insert(indices.end(), level.indices.begin(), level.indices.end());
+    largestRange = std::max(largestRange, level.vertices.size());
+  }
+
+  // Relative to each level's vertices, like the cooker writes them
+  data.indexSize = largestRange <= 0x10000 ? 2 : 4;
+  data.indices.resize(indices.size() * data.indexSize);
+  for (std::size_t i = 0; i < indices.size(); i++)
+  {
+    if (data.indexSize == 2)
+    {
+      const auto index = static_cast<std::uint16_t>(indices[i]);
+      std::memcpy(&data.indices[i * 2], &index, 2);
+    }
+    else
+    {
+      std::memcpy(&data.indices[i * 4], &indices[i], 4);
+    }
+  }
+  return data;
+}
+}  // namespace SDFMesher
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "mesh_container.h"
+
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+class SDFObject;
+
+// Surface nets over an SDFObject, so shapes far enough away can be rasterised as a plain Mesh
+// instead of raymarched. Every grid cell the surface crosses gets one vertex, at the average of
+// the crossings on its edges, and every crossed edge a quad between the four cells around it.
+//
+// The grid is cut into CHUNK_CELLS^3 chunks meshed in parallel. A chunk places the vertices of
+// a ring of cells around its own as well, so it can close the quads on its border by itself.
+// Both chunks compute a shared vertex from the same samples, so the copies are welded bytewise
+// when the chunks are merged.
+namespace SDFMesher
+{
+inline constexpr int CHUNK_CELLS = 32;
+// A LOD is used until one of its voxels covers this many pixels of a 1080p view
+inline constexpr float PIXELS_PER_VOXEL = 2.0f;
+
+// Indexed triangles in the cooked mesh vertex format, UVs are zero
+struct Level
+{
+  std::vector<MeshContainer::Vertex> vertices;
+  std::vector<std::uint32_t> indices;
+};
+
+Level extract(const SDFObject& sdf, float voxelSize, JobSystem& jobs);
+
+// Up to lodCount levels, the voxel size doubling with each, packed like a cooked mesh so it
+// goes straight to Mesh. Stops early once a level has no triangles left.
+MeshContainer::MeshData build(const SDFObject& sdf,
+                              float voxelSize,
+                              int lodCount,
+                              JobSystem& jobs);
+}  // namespace SDFMesher
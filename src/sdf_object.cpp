@@ -1 +1,650 @@
 #include "sdf_object.h"
+
+#include "cpu_features.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#ifdef CPU_X86_64
+#include <immintrin.h>
+#endif
+
+namespace
+{
+// Points per pass over the node program, each node's results for a block stay in L1
+constexpr std::size_t BLOCK_SIZE = 64;
+constexpr float NO_SURFACE = std::numeric_limits<float>::max();
+
+bool isPrimitive(SDFOp op)
+{
+  return op <= SDFOp::Torus;
+}
+
+// Straight ports of sdf_primitives.glsl, keep the two in sync
+float sdSphere(const glm::vec3& p, float radius)
+{
+  return glm::length(p) - radius;
+}
+
+float sdBox(const glm::vec3& p, const glm::vec3& halfSize)
+{
+  const glm::vec3 q = glm::abs(p) - halfSize;
+  return glm::length(glm::max(q, 0.0f)) + std::min(std::max(q.x, std::max(q.y, q.z)), 0.0f);
+}
+
+float sdCapsule(glm::vec3 p, float halfHeight, float radius)
+{
+  p.y -= glm::clamp(p.y, -halfHeight, halfHeight);
+  return glm::length(p) - radius;
+}
+
+float sdTorus(const glm::vec3& p, const glm::vec2& radii)
+{
+  const glm::vec2 q(glm::length(glm::vec2(p.x, p.z)) - radii.x, p.y);
+  return glm::length(q) - radii.y;
+}
+
+float opSmoothUnion(float a, float b, float k)
+{
+  const float h = glm::clamp(0.5f + 0.5f * (b - a) / k, 0.0f, 1.0f);
+  return glm::mix(b, a, h) - k * h * (1.0f - h);
+}
+
+float opSmoothSubtract(float a, float b, float k)
+{
+  const float h = glm::clamp(0.5f - 0.5f * (a + b) / k, 0.0f, 1.0f);
+  return glm::mix(a, -b, h) + k * h * (1.0f - h);
+}
+
+float opSmoothIntersect(float a, float b, float k)
+{
+  const float h = glm::clamp(0.5f - 0.5f * (b - a) / k, 0.0f, 1.0f);
+  return glm::mix(b, a, h) + k * h * (1.0f - h);
+}
+
+float evaluatePrimitive(const SDFObject::Node& node, const glm::vec3& point)
+{
+  const glm::vec3 p = node.toLocal * (point - node.position);
+  float d = 0.0f;
+  switch (node.op)
+  {
+    case SDFOp::Sphere:
+      d = sdSphere(p, node.params.x);
+      break;
+    case SDFOp::Box:
+      d = sdBox(p, glm::vec3(node.params));
+      break;
+    case SDFOp::Capsule:
+      d = sdCapsule(p, node.params.x, node.params.y);
+      break;
+    case SDFOp::Torus:
+      d = sdTorus(p, glm::vec2(node.params.x, node.params.y));
+      break;
+    default:
+      break;
+  }
+  return d * node.distanceScale;
+}
+
+float combine(SDFOp op, float k, float a, float b)
+{
+  if (k <= 0.0f)
+  {
+    switch (op)
+    {
+      case SDFOp::Union:
+        return std::min(a, b);
+      case SDFOp::Subtract:
+        return std::max(a, -b);
+      default:
+        return std::max(a, b);
+    }
+  }
+
+  switch (op)
+  {
+    case SDFOp::Union:
+      return opSmoothUnion(a, b, k);
+    case SDFOp::Subtract:
+      return opSmoothSubtract(a, b, k);
+    default:
+      return opSmoothIntersect(a, b, k);
+  }
+}
+
+#ifdef CPU_X86_64
+CPU_TARGET_AVX2 inline __m256 lengthAVX2(__m256 x, __m256 y, __m256 z)
+{
+  return _mm256_sqrt_ps(_mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_mul_ps(z, z))));
+}
+
+CPU_TARGET_AVX2 inline __m256 absAVX2(__m256 v)
+{
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+CPU_TARGET_AVX2 inline __m256 clampAVX2(__m256 v, __m256 lo, __m256 hi)
+{
+  return _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+}
+
+CPU_TARGET_AVX2 __m256 primitiveAVX2(const SDFObject::Node& node, __m256 px, __m256 py, __m256 pz)
+{
+  px = _mm256_sub_ps(px, _mm256_set1_ps(node.position.x));
+  py = _mm256_sub_ps(py, _mm256_set1_ps(node.position.y));
+  pz = _mm256_sub_ps(pz, _mm256_set1_ps(node.position.z));
+
+  // glm is column-major, row r of the matrix is m[0][r], m[1][r], m[2][r]
+  const glm::mat3& m = node.toLocal;
+  __m256 local[3];
+  for (int r = 0; r < 3; r++)
+  {
+    local[r] = _mm256_fmadd_ps(
+        _mm256_set1_ps(m[0][r]),
+        px,
+        _mm256_fmadd_ps(
+            _mm256_set1_ps(m[1][r]), py, _mm256_mul_ps(_mm256_set1_ps(m[2][r]), pz)));
+  }
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 x = local[0], y = local[1], z = local[2];
+
+  __m256 d;
+  switch (node.op)
+  {
+    case SDFOp::Sphere:
+      d = _mm256_sub_ps(lengthAVX2(x, y, z), _mm256_set1_ps(node.params.x));
+      break;
+    case SDFOp::Box:
+    {
+      const __m256 qx = _mm256_sub_ps(absAVX2(x), _mm256_set1_ps(node.params.x));
+      const __m256 qy = _mm256_sub_ps(absAVX2(y), _mm256_set1_ps(node.params.y));
+      const __m256 qz = _mm256_sub_ps(absAVX2(z), _mm256_set1_ps(node.params.z));
+      const __m256 outside =
+          lengthAVX2(_mm256_max_ps(qx, zero), _mm256_max_ps(qy, zero), _mm256_max_ps(qz, zero));
+      const __m256 inside = _mm256_min_ps(_mm256_max_ps(qx, _mm256_max_ps(qy, qz)), zero);
+      d = _mm256_add_ps(outside, inside);
+      break;
+    }
+    case SDFOp::Capsule:
+    {
+      const __m256 h = _mm256_set1_ps(node.params.x);
+      const __m256 cy = _mm256_sub_ps(y, clampAVX2(y, _mm256_sub_ps(zero, h), h));
+      d = _mm256_sub_ps(lengthAVX2(x, cy, z), _mm256_set1_ps(node.params.y));
+      break;
+    }
+    default:
+    {
+      const __m256 ring = _mm256_sub_ps(lengthAVX2(x, zero, z), _mm256_set1_ps(node.params.x));
+      d = _mm256_sub_ps(lengthAVX2(ring, y, zero), _mm256_set1_ps(node.params.y));
+      break;
+    }
+  }
+  return _mm256_mul_ps(d, _mm256_set1_ps(node.distanceScale));
+}
+
+CPU_TARGET_AVX2 __m256 combineAVX2(SDFOp op, float smoothness, __m256 a, __m256 b)
+{
+  if (smoothness <= 0.0f)
+  {
+    switch (op)
+    {
+      case SDFOp::Union:
+        return _mm256_min_ps(a, b);
+      case SDFOp::Subtract:
+        return _mm256_max_ps(a, _mm256_sub_ps(_mm256_setzero_ps(), b));
+      default:
+        return _mm256_max_ps(a, b);
+    }
+  }
+
+  const __m256 k = _mm256_set1_ps(smoothness);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  if (op == SDFOp::Subtract)
+  {
+    const __m256 negB = _mm256_sub_ps(zero, b);
+    const __m256 h = clampAVX2(
+        _mm256_fnmadd_ps(half, _mm256_div_ps(_mm256_add_ps(a, b), k), half), zero, one);
+    const __m256 mixed = _mm256_fmadd_ps(_mm256_sub_ps(negB, a), h, a);
+    return _mm256_fmadd_ps(_mm256_mul_ps(k, h), _mm256_sub_ps(one, h), mixed);
+  }
+
+  // Union and intersection only differ in the sign of the blend
+  const __m256 t = _mm256_mul_ps(half, _mm256_div_ps(_mm256_sub_ps(b, a), k));
+  const bool isUnion = op == SDFOp::Union;
+  const __m256 h =
+      clampAVX2(isUnion ? _mm256_add_ps(half, t) : _mm256_sub_ps(half, t), zero, one);
+  const __m256 mixed = _mm256_fmadd_ps(_mm256_sub_ps(a, b), h, b);
+  const __m256 blend = _mm256_mul_ps(_mm256_mul_ps(k, h), _mm256_sub_ps(one, h));
+  return isUnion ? _mm256_sub_ps(mixed, blend) : _mm256_add_ps(mixed, blend);
+}
+
+// count is a multiple of 8 and at most BLOCK_SIZE
+CPU_TARGET_AVX2 void evaluateBlockAVX2(const std::vector<SDFObject::Node>& nodes,
+                                       const std::vector<SDFNodeId>& program,
+                                       const float* x,
+                                       const float* y,
+                                       const float* z,
+                                       std::size_t count,
+                                       float* scratch)
+{
+  for (SDFNodeId id : program)
+  {
+    const SDFObject::Node& node = nodes[id];
+    float* out = scratch + id * BLOCK_SIZE;
+    if (isPrimitive(node.op))
+    {
+      for (std::size_t i = 0; i < count; i += 8)
+      {
+        const __m256 d = primitiveAVX2(
+            node, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), _mm256_loadu_ps(z + i));
+        _mm256_storeu_ps(out + i, d);
+      }
+    }
+    else
+    {
+      const float* a = scratch + node.a * BLOCK_SIZE;
+      const float* b = scratch + node.b * BLOCK_SIZE;
+      for (std::size_t i = 0; i < count; i += 8)
+      {
+        const __m256 d = combineAVX2(
+            node.op, node.params.x, _mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        _mm256_storeu_ps(out + i, d);
+      }
+    }
+  }
+}
+
+CPU_TARGET_SSE41 inline __m128 lengthSSE41(__m128 x, __m128 y, __m128 z)
+{
+  return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_add_ps(_mm_mul_ps(y, y), _mm_mul_ps(z, z))));
+}
+
+CPU_TARGET_SSE41 inline __m128 absSSE41(__m128 v)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+CPU_TARGET_SSE41 inline __m128 clampSSE41(__m128 v, __m128 lo, __m128 hi)
+{
+  return _mm_min_ps(_mm_max_ps(v, lo), hi);
+}
+
+CPU_TARGET_SSE41 __m128 primitiveSSE41(const SDFObject::Node& node, __m128 px, __m128 py, __m128 pz)
+{
+  px = _mm_sub_ps(px, _mm_set1_ps(node.position.x));
+  py = _mm_sub_ps(py, _mm_set1_ps(node.position.y));
+  pz = _mm_sub_ps(pz, _mm_set1_ps(node.position.z));
+
+  const glm::mat3& m = node.toLocal;
+  __m128 local[3];
+  for (int r = 0; r < 3; r++)
+  {
+    local[r] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0][r]), px),
+                          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[1][r]), py),
+                                     _mm_mul_ps(_mm_set1_ps(m[2][r]), pz)));
+  }
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 x = local[0], y = local[1], z = local[2];
+
+  __m128 d;
+  switch (node.op)
+  {
+    case SDFOp::Sphere:
+      d = _mm_sub_ps(lengthSSE41(x, y, z), _mm_set1_ps(node.params.x));
+      break;
+    case SDFOp::Box:
+    {
+      const __m128 qx = _mm_sub_ps(absSSE41(x), _mm_set1_ps(node.params.x));
+      const __m128 qy = _mm_sub_ps(absSSE41(y), _mm_set1_ps(node.params.y));
+      const __m128 qz = _mm_sub_ps(absSSE41(z), _mm_set1_ps(node.params.z));
+      const __m128 outside =
+          lengthSSE41(_mm_max_ps(qx, zero), _mm_max_ps(qy, zero), _mm_max_ps(qz, zero));
+      const __m128 inside = _mm_min_ps(_mm_max_ps(qx, _mm_max_ps(qy, qz)), zero);
+      d = _mm_add_ps(outside, inside);
+      break;
+    }
+    case SDFOp::Capsule:
+    {
+      const __m128 h = _mm_set1_ps(node.params.x);
+      const __m128 cy = _mm_sub_ps(y, clampSSE41(y, _mm_sub_ps(zero, h), h));
+      d = _mm_sub_ps(lengthSSE41(x, cy, z), _mm_set1_ps(node.params.y));
+      break;
+    }
+    default:
+    {
+      const __m128 ring = _mm_sub_ps(lengthSSE41(x, zero, z), _mm_set1_ps(node.params.x));
+      d = _mm_sub_ps(lengthSSE41(ring, y, zero), _mm_set1_ps(node.params.y));
+      break;
+    }
+  }
+  return _mm_mul_ps(d, _mm_set1_ps(node.distanceScale));
+}
+
+CPU_TARGET_SSE41 __m128 combineSSE41(SDFOp op, float smoothness, __m128 a, __m128 b)
+{
+  if (smoothness <= 0.0f)
+  {
+    switch (op)
+    {
+      case SDFOp::Union:
+        return _mm_min_ps(a, b);
+      case SDFOp::Subtract:
+        return _mm_max_ps(a, _mm_sub_ps(_mm_setzero_ps(), b));
+      default:
+        return _mm_max_ps(a, b);
+    }
+  }
+
+  const __m128 k = _mm_set1_ps(smoothness);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  if (op == SDFOp::Subtract)
+  {
+    const __m128 negB = _mm_sub_ps(zero, b);
+    const __m128 h = clampSSE41(
+        _mm_sub_ps(half, _mm_mul_ps(half, _mm_div_ps(_mm_add_ps(a, b), k))), zero, one);
+    const __m128 mixed = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(negB, a), h), a);
+    return _mm_add_ps(_mm_mul_ps(_mm_mul_ps(k, h), _mm_sub_ps(one, h)), mixed);
+  }
+
+  const __m128 t = _mm_mul_ps(half, _mm_div_ps(_mm_sub_ps(b, a), k));
+  const bool isUnion = op == SDFOp::Union;
+  const __m128 h = clampSSE41(isUnion ? _mm_add_ps(half, t) : _mm_sub_ps(half, t), zero, one);
+  const __m128 mixed = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(a, b), h), b);
+  const __m128 blend = _mm_mul_ps(_mm_mul_ps(k, h), _mm_sub_ps(one, h));
+  return isUnion ? _mm_sub_ps(mixed, blend) : _mm_add_ps(mixed, blend);
+}
+
+// count is a multiple of 4 and at most BLOCK_SIZE
+CPU_TARGET_SSE41 void evaluateBlockSSE41(const std::vector<SDFObject::Node>& nodes,
+                                         const std::vector<SDFNodeId>& program,
+                                         const float* x,
+                                         const float* y,
+                                         const float* z,
+                                         std::size_t count,
+                                         float* scratch)
+{
+  for (SDFNodeId id : program)
+  {
+    const SDFObject::Node& node = nodes[id];
+    float* out = scratch + id * BLOCK_SIZE;
+    if (isPrimitive(node.op))
+    {
+      for (std::size_t i = 0; i < count; i += 4)
+      {
+        const __m128 d =
+            primitiveSSE41(node, _mm_loadu_ps(x + i), _mm_loadu_ps(y + i), _mm_loadu_ps(z + i));
+        _mm_storeu_ps(out + i, d);
+      }
+    }
+    else
+    {
+      const float* a = scratch + node.a * BLOCK_SIZE;
+      const float* b = scratch + node.b * BLOCK_SIZE;
+      for (std::size_t i = 0; i < count; i += 4)
+      {
+        const __m128 d =
+            combineSSE41(node.op, node.params.x, _mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        _mm_storeu_ps(out + i, d);
+      }
+    }
+  }
+}
+#endif
+}  // namespace
+
+SDFNodeId SDFObject::addPrimitive(SDFOp op, const glm::vec4& params, const Transform& transform)
+{
+  Node node{};
+  node.op = op;
+  node.params = params;
+  node.position = transform.position;
+  const glm::mat3 inverseRotation = glm::mat3_cast(glm::conjugate(transform.rotation));
+  for (int r = 0; r < 3; r++)
+  {
+    for (int c = 0; c < 3; c++)
+      node.toLocal[c][r] = inverseRotation[c][r] / transform.scale[r];
+  }
+  node.distanceScale = std::min(transform.scale.x, std::min(transform.scale.y, transform.scale.z));
+
+  m_nodes.push_back(node);
+  setRoot(static_cast<SDFNodeId>(m_nodes.size() - 1));
+  return m_root;
+}
+
+SDFNodeId SDFObject::addOperator(SDFOp op, SDFNodeId a, SDFNodeId b, float smoothness)
+{
+  assert(a < m_nodes.size() && b < m_nodes.size() && "SDF operand does not exist.");
+
+  Node node{};
+  node.op = op;
+  node.a = a;
+  node.b = b;
+  node.params.x = smoothness;
+
+  m_nodes.push_back(node);
+  setRoot(static_cast<SDFNodeId>(m_nodes.size() - 1));
+  return m_root;
+}
+
+SDFNodeId SDFObject::sphere(float radius, const Transform& transform)
+{
+  return addPrimitive(SDFOp::Sphere, glm::vec4(radius, 0.0f, 0.0f, 0.0f), transform);
+}
+
+SDFNodeId SDFObject::box(const glm::vec3& halfSize, const Transform& transform)
+{
+  return addPrimitive(SDFOp::Box, glm::vec4(halfSize, 0.0f), transform);
+}
+
+SDFNodeId SDFObject::capsule(float halfHeight, float radius, const Transform& transform)
+{
+  return addPrimitive(SDFOp::Capsule, glm::vec4(halfHeight, radius, 0.0f, 0.0f), transform);
+}
+
+SDFNodeId SDFObject::torus(float majorRadius, float minorRadius, const Transform& transform)
+{
+  return addPrimitive(SDFOp::Torus, glm::vec4(majorRadius, minorRadius, 0.0f, 0.0f), transform);
+}
+
+SDFNodeId SDFObject::unite(SDFNodeId a, SDFNodeId b, float smoothness)
+{
+  return addOperator(SDFOp::Union, a, b, smoothness);
+}
+
+SDFNodeId SDFObject::subtract(SDFNodeId a, SDFNodeId b, float smoothness)
+{
+  return addOperator(SDFOp::Subtract, a, b, smoothness);
+}
+
+SDFNodeId SDFObject::intersect(SDFNodeId a, SDFNodeId b, float smoothness)
+{
+  return addOperator(SDFOp::Intersect, a, b, smoothness);
+}
+
+void SDFObject::setRoot(SDFNodeId node)
+{
+  assert(node < m_nodes.size() && "SDF root does not exist.");
+  m_root = node;
+
+  // Operands always come before the node using them, so a reverse sweep finds everything the
+  // root depends on and the sorted result is a valid evaluation order
+  std::vector<bool> used(m_nodes.size(), false);
+  used[node] = true;
+  for (SDFNodeId id = node + 1; id-- > 0;)
+  {
+    if (!used[id] || isPrimitive(m_nodes[id].op))
+      continue;
+    used[m_nodes[id].a] = true;
+    used[m_nodes[id].b] = true;
+  }
+
+  m_program.clear();
+  for (SDFNodeId id = 0; id <= node; id++)
+  {
+    if (used[id])
+      m_program.push_back(id);
+  }
+}
+
+void SDFObject::clear()
+{
+  m_nodes.clear();
+  m_program.clear();
+  m_root = 0;
+}
+
+float SDFObject::evaluate(const glm::vec3& point) const
+{
+  float distance;
+  evaluateScalar(&point.x, &point.y, &point.z, 1, &distance);
+  return distance;
+}
+
+void SDFObject::evaluateScalar(const float* x,
+                               const float* y,
+                               const float* z,
+                               std::size_t count,
+                               float* distances) const
+{
+  if (m_nodes.empty())
+  {
+    std::fill(distances, distances + count, NO_SURFACE);
+    return;
+  }
+
+  thread_local std::vector<float> values;
+  values.resize(m_nodes.size());
+  for (std::size_t i = 0; i < count; i++)
+  {
+    const glm::vec3 point(x[i], y[i], z[i]);
+    for (SDFNodeId id : m_program)
+    {
+      const Node& node = m_nodes[id];
+      values[id] = isPrimitive(node.op)
+                       ? evaluatePrimitive(node, point)
+                       : combine(node.op, node.params.x, values[node.a], values[node.b]);
+    }
+    distances[i] = values[m_root];
+  }
+}
+
+void SDFObject::evaluate(const float* x,
+                         const float* y,
+                         const float* z,
+                         std::size_t count,
+                         float* distances) const
+{
+#ifdef CPU_X86_64
+  const bool avx2 = CpuFeatures::hasAVX2();
+  if (!m_nodes.empty() && (avx2 || CpuFeatures::hasSSE41()))
+  {
+    thread_local std::vector<float> scratch;
+    scratch.resize(m_nodes.size() * BLOCK_SIZE);
+
+    const std::size_t width = avx2 ? BATCH_WIDTH : 4;
+    const std::size_t simdEnd = count / width * width;
+    const auto evaluateBlock = avx2 ? evaluateBlockAVX2 : evaluateBlockSSE41;
+    for (std::size_t first = 0; first < simdEnd; first += BLOCK_SIZE)
+    {
+      const std::size_t block = std::min(BLOCK_SIZE, simdEnd - first);
+      evaluateBlock(m_nodes, m_program, x + first, y + first, z + first, block, scratch.data());
+      std::memcpy(distances + first, scratch.data() + m_root * BLOCK_SIZE, block * sizeof(float));
+    }
+
+    // A partial step padded with copies of its last point still beats going point by point,
+    // and small batches (collision probes, normals) are mostly tail
+    const std::size_t tail = count - simdEnd;
+    if (tail > 0)
+    {
+      float px[BATCH_WIDTH], py[BATCH_WIDTH], pz[BATCH_WIDTH];
+      for (std::size_t i = 0; i < width; i++)
+      {
+        const std::size_t source = simdEnd + std::min(i, tail - 1);
+        px[i] = x[source];
+        py[i] = y[source];
+        pz[i] = z[source];
+      }
+      evaluateBlock(m_nodes, m_program, px, py, pz, width, scratch.data());
+      std::memcpy(distances + simdEnd, scratch.data() + m_root * BLOCK_SIZE, tail * sizeof(float));
+    }
+    return;
+  }
+#endif
+  evaluateScalar(x, y, z, count, distances);
+}
+
+glm::vec3 SDFObject::normal(const glm::vec3& point, float eps) const
+{
+  // Four samples instead of six for central differences
+  const glm::vec3 k0(1.0f, -1.0f, -1.0f), k1(-1.0f, -1.0f, 1.0f), k2(-1.0f, 1.0f, -1.0f),
+      k3(1.0f, 1.0f, 1.0f);
+  const glm::vec3 gradient =
+      k0 * evaluate(point + k0 * eps) + k1 * evaluate(point + k1 * eps) +
+      k2 * evaluate(point + k2 * eps) + k3 * evaluate(point + k3 * eps);
+  const float length = glm::length(gradient);
+  return length > 0.0f ? gradient / length : glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+AABB SDFObject::nodeBounds(SDFNodeId id) const
+{
+  const Node& node = m_nodes[id];
+  const glm::vec4& p = node.params;
+  switch (node.op)
+  {
+    case SDFOp::Union:
+    {
+      // A smooth union bulges out by at most a quarter of its radius
+      AABB bounds = AABB::merge(nodeBounds(node.a), nodeBounds(node.b));
+      bounds.min -= glm::vec3(p.x * 0.25f);
+      bounds.max += glm::vec3(p.x * 0.25f);
+      return bounds;
+    }
+    case SDFOp::Subtract:
+      return nodeBounds(node.a);
+    case SDFOp::Intersect:
+    {
+      const AABB a = nodeBounds(node.a);
+      const AABB b = nodeBounds(node.b);
+      return AABB(glm::max(a.min, b.min), glm::min(a.max, b.max));
+    }
+    default:
+      break;
+  }
+
+  glm::vec3 extents;
+  switch (node.op)
+  {
+    case SDFOp::Sphere:
+      extents = glm::vec3(p.x);
+      break;
+    case SDFOp::Box:
+      extents = glm::vec3(p);
+      break;
+    case SDFOp::Capsule:
+      extents = glm::vec3(p.y, p.x + p.y, p.y);
+      break;
+    default:
+      extents = glm::vec3(p.x + p.y, p.y, p.x + p.y);
+      break;
+  }
+
+  // Local box through the inverse of toLocal, same trick as for transformed AABBs
+  const glm::mat3 toWorld = glm::inverse(node.toLocal);
+  glm::vec3 worldExtents(0.0f);
+  for (int c = 0; c < 3; c++)
+    worldExtents += glm::abs(toWorld[c]) * extents[c];
+  return AABB(node.position - worldExtents, node.position + worldExtents);
+}
+
+AABB SDFObject::getBounds() const
+{
+  return m_nodes.empty() ? AABB() : nodeBounds(m_root);
+}
@@ -1,5 +1,106 @@
 #pragma once
 
+#include "aabb.h"
+#include "component/transform.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class SDFOp : std::uint8_t
+{
+  Sphere,
+  Box,
+  Capsule,
+  Torus,
+  Union,
+  Subtract,
+  Intersect
+};
+
+using SDFNodeId = std::uint32_t;
+
+// Signed distance field built from primitives and CSG operators, evaluated on the CPU for
+// collision, picking and baking. The formulas are the ones in res/shaders/include/
+// sdf_primitives.glsl, so CPU and GPU agree to within SHADER_TOLERANCE.
+//
+// Nodes are added children first and the last one added is the root, e.g.
+//   SDFObject sdf;
+//   sdf.unite(sdf.box({1, 1, 1}), sdf.sphere(1.2f, transform), 0.1f);
+//
+// Primitives take a Transform. Non-uniform scale squashes the field, so distances are scaled by
+// the smallest axis: still a safe lower bound for marching, just no longer exact.
 class SDFObject
 {
+  public:
+  // Points per SIMD step of the batched evaluator (AVX2), SSE4.1 does two steps of 4
+  static constexpr std::size_t BATCH_WIDTH = 8;
+  // Largest difference to the shader for points within a few units of the surface
+  static constexpr float SHADER_TOLERANCE = 1e-4f;
+
+  SDFNodeId sphere(float radius, const Transform& transform = {});
+  SDFNodeId box(const glm::vec3& halfSize, const Transform& transform = {});
+  // Along local Y, the straight part runs from -halfHeight to halfHeight
+  SDFNodeId capsule(float halfHeight, float radius, const Transform& transform = {});
+  // In the local XZ plane
+  SDFNodeId torus(float majorRadius, float minorRadius, const Transform& transform = {});
+
+  // smoothness is the blend radius, 0 gives the sharp operator
+  SDFNodeId unite(SDFNodeId a, SDFNodeId b, float smoothness = 0.0f);
+  // a with b carved out of it
+  SDFNodeId subtract(SDFNodeId a, SDFNodeId b, float smoothness = 0.0f);
+  SDFNodeId intersect(SDFNodeId a, SDFNodeId b, float smoothness = 0.0f);
+
+  void setRoot(SDFNodeId node);
+  inline SDFNodeId getRoot() const { return m_root; }
+  inline bool isEmpty() const { return m_nodes.empty(); }
+  inline std::size_t getNodeCount() const { return m_nodes.size(); }
+  void clear();
+
+  float evaluate(const glm::vec3& point) const;
+  // Structure-of-arrays batch, any count. Uses AVX2 or SSE4.1 when the CPU has them.
+  void evaluate(const float* x,
+                const float* y,
+                const float* z,
+                std::size_t count,
+                float* distances) const;
+  void evaluateScalar(const float* x,
+                      const float* y,
+                      const float* z,
+                      std::size_t count,
+                      float* distances) const;
+
+  // Gradient from four samples on a tetrahedron, eps is the sample offset
+  glm::vec3 normal(const glm::vec3& point, float eps = 1e-3f) const;
+
+  // Conservative world-space bounds of the surface
+  AABB getBounds() const;
+
+  struct Node
+  {
+    SDFOp op;
+    SDFNodeId a = 0;
+    SDFNodeId b = 0;
+    // Primitive sizes, or the smoothness of a combining op in params.x
+    glm::vec4 params{0.0f};
+    // World to local: local = toLocal * (p - position), distance scaled back by distanceScale
+    glm::mat3 toLocal{1.0f};
+    glm::vec3 position{0.0f};
+    float distanceScale = 1.0f;
+  };
+
+  inline const std::vector<Node>& getNodes() const { return m_nodes; }
+  // Nodes the root depends on, every node after its operands
+  inline const std::vector<SDFNodeId>& getProgram() const { return m_program; }
+
+  private:
+  SDFNodeId addPrimitive(SDFOp op, const glm::vec4& params, const Transform& transform);
+  SDFNodeId addOperator(SDFOp op, SDFNodeId a, SDFNodeId b, float smoothness);
+  AABB nodeBounds(SDFNodeId node) const;
+
+  std::vector<Node> m_nodes;
+  std::vector<SDFNodeId> m_program;
+  SDFNodeId m_root = 0;
 };
@@ -0,0 +1,294 @@
+#include "sdf_reference_renderer.h"
+
+#include "job_system.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace
+{
+// Matches the box the shader marches in
+constexpr float BOUNDS_PADDING = 0.01f;
+constexpr int PACKET = static_cast<int>(SDFObject::BATCH_WIDTH);
+
+// Tiles a thread still has to do, begin in the high half. The owner takes from the front and
+// thieves take the back half, both with a CAS so a tile is never handed out twice.
+struct TileRange
+{
+  std::atomic<std::uint64_t> packed{0};
+};
+
+inline std::uint64_t pack(std::uint32_t begin, std::uint32_t end)
+{
+  return (static_cast<std::uint64_t>(begin) << 32) | end;
+}
+
+inline std::uint32_t rangeBegin(std::uint64_t packed)
+{
+  return static_cast<std::uint32_t>(packed >> 32);
+}
+
+inline std::uint32_t rangeEnd(std::uint64_t packed)
+{
+  return static_cast<std::uint32_t>(packed);
+}
+
+bool popFront(TileRange& range, std::uint32_t& tile)
+{
+  std::uint64_t packed = range.packed.load();
+  while (rangeBegin(packed) < rangeEnd(packed))
+  {
+    if (range.packed.compare_exchange_weak(
+            packed, pack(rangeBegin(packed) + 1, rangeEnd(packed))))
+    {
+      tile = rangeBegin(packed);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Moves the back half of the fullest range into the thief's (empty) one
+bool stealHalf(TileRange* ranges, std::size_t count, std::size_t thief)
+{
+  for (;;)
+  {
+    std::size_t victim = count;
+    std::uint32_t most = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+      const std::uint64_t packed = ranges[i].packed.load();
+      const std::uint32_t remaining = rangeEnd(packed) - rangeBegin(packed);
+      if (i != thief && remaining > most)
+      {
+        most = remaining;
+        victim = i;
+      }
+    }
+    if (victim == count)
+      return false;
+
+    std::uint64_t packed = ranges[victim].packed.load();
+    const std::uint32_t begin = rangeBegin(packed);
+    const std::uint32_t end = rangeEnd(packed);
+    if (begin >= end)
+      continue;
+    const std::uint32_t middle = begin + (end - begin) / 2;
+    if (ranges[victim].packed.compare_exchange_strong(packed, pack(begin, middle)))
+    {
+      ranges[thief].packed.store(pack(middle, end));
+      return true;
+    }
+  }
+}
+
+bool intersectBox(const glm::vec3& origin,
+                  const glm::vec3& direction,
+                  const AABB& box,
+                  float& tEnter,
+                  float& tExit)
+{
+  const glm::vec3 inverse = 1.0f / direction;
+  const glm::vec3 t0 = (box.min - origin) * inverse;
+  const glm::vec3 t1 = (box.max - origin) * inverse;
+  const glm::vec3 tNear = glm::min(t0, t1);
+  const glm::vec3 tFar = glm::max(t0, t1);
+  tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+  tExit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+  return tEnter <= tExit;
+}
+}  // namespace
+
+SDFReferenceRenderer::SDFReferenceRenderer(JobSystem& jobs) : m_jobs(jobs) {}
+
+void SDFReferenceRenderer::add(const SDFObject& sdf,
+                               const Transform& transform,
+                               const glm::vec3& color)
+{
+  const AABB bounds = sdf.getBounds();
+  if (sdf.isEmpty() || bounds.isEmpty())
+    return;
+
+  Instance& instance = m_instances.emplace_back();
+  instance.sdf = sdf;
+  instance.model = transform.matrix();
+  instance.inverseModel = glm::inverse(instance.model);
+  instance.normalMatrix = glm::transpose(glm::mat3(instance.inverseModel));
+  instance.color = color;
+  const glm::vec3 extents = (bounds.size() * (1.0f + BOUNDS_PADDING) + BOUNDS_PADDING) * 0.5f;
+  instance.bounds = AABB(bounds.center() - extents, bounds.center() + extents);
+}
+
+void SDFReferenceRenderer::clear()
+{
+  m_instances.clear();
+}
+
+std::vector<float> SDFReferenceRenderer::render(const Camera& camera,
+                                                const Transform& cameraTransform,
+                                                int width,
+                                                int height)
+{
+  const glm::mat4 projection = glm::perspective(glm::radians(camera.fov),
+                                                static_cast<float>(width) / height,
+                                                camera.nearPlane,
+                                                camera.farPlane);
+  const glm::mat4 viewMatrix = glm::lookAt(cameraTransform.position,
+                                           cameraTransform.position + cameraTransform.forward(),
+                                           cameraTransform.up());
+  const View view{glm::inverse(projection * viewMatrix),
+                  cameraTransform.position,
+                  camera.farPlane,
+                  width,
+                  height};
+
+  std::vector<float> pixels(static_cast<std::size_t>(width) * height * 3);
+  const std::size_t tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+  const std::size_t tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+  m_tileCount = tilesX * tilesY;
+
+  // Everyone starts on a contiguous run, neighbouring tiles cost about the same
+  std::size_t threads = m_jobs.getConcurrency();
+  if (m_maxThreads > 0)
+    threads = std::min<std::size_t>(threads, m_maxThreads);
+  std::unique_ptr<TileRange[]> ranges(new TileRange[threads]);
+  for (std::size_t i = 0; i < threads; i++)
+  {
+    ranges[i].packed = pack(static_cast<std::uint32_t>(m_tileCount * i / threads),
+                            static_cast<std::uint32_t>(m_tileCount * (i + 1) / threads));
+  }
+
+  std::atomic<std::size_t> steals{0};
+  m_jobs.parallelFor(threads,
+                     1,
+                     [&](std::size_t begin, std::size_t end)
+                     {
+                       for (std::size_t thread = begin; thread < end; thread++)
+                       {
+                         std::uint32_t tile;
+                         for (;;)
+                         {
+                           if (popFront(ranges[thread], tile))
+                             renderTile(view, tile, pixels.data());
+                           else if (stealHalf(ranges.get(), threads, thread))
+                             steals++;
+                           else
+                             break;
+                         }
+                       }
+                     });
+  m_stealCount = steals;
+  return pixels;
+}
+
+void SDFReferenceRenderer::renderTile(const View& view, std::size_t tile, float* pixels) const
+{
+  const int tilesX = (view.width + TILE_SIZE - 1) / TILE_SIZE;
+  const int x0 = static_cast<int>(tile % tilesX) * TILE_SIZE;
+  const int y0 = static_cast<int>(tile / tilesX) * TILE_SIZE;
+  const int x1 = std::min(x0 + TILE_SIZE, view.width);
+  const int y1 = std::min(y0 + TILE_SIZE, view.height);
+
+  for (int y = y0; y < y1; y++)
+  {
+    for (int x = x0; x < x1; x += PACKET)
+      renderPacket(view, x, y, std::min(PACKET, x1 - x), pixels);
+  }
+}
+
+void SDFReferenceRenderer::renderPacket(const View& view,
+                                        int x,
+                                        int y,
+                                        int count,
+                                        float* pixels) const
+{
+  // Through the pixel centers, like the rasterised box
+  glm::vec3 directions[PACKET];
+  const float ndcY = 1.0f - (y + 0.5f) / view.height * 2.0f;
+  for (int i = 0; i < count; i++)
+  {
+    const float ndcX = (x + i + 0.5f) / view.width * 2.0f - 1.0f;
+    const glm::vec4 farPoint = view.inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    directions[i] = glm::normalize(glm::vec3(farPoint) / farPoint.w - view.origin);
+  }
+
+  // World distance of the nearest hit so far, later instances stop marching there
+  float nearest[PACKET];
+  const Instance* hitInstance[PACKET] = {};
+  glm::vec3 hitPoint[PACKET];
+  std::fill(nearest, nearest + PACKET, view.farPlane);
+
+  for (const Instance& instance : m_instances)
+  {
+    const glm::vec3 origin = glm::vec3(instance.inverseModel * glm::vec4(view.origin, 1.0f));
+    const glm::mat3 toObject(instance.inverseModel);
+    const glm::mat3 toWorld(instance.model);
+
+    glm::vec3 rays[PACKET];
+    float t[PACKET], tMax[PACKET], worldScale[PACKET];
+    int active[PACKET];
+    int activeCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+      rays[i] = glm::normalize(toObject * directions[i]);
+      worldScale[i] = glm::length(toWorld * rays[i]);
+      float tExit;
+      if (!intersectBox(origin, rays[i], instance.bounds, t[i], tExit))
+        continue;
+      tMax[i] = std::min(tExit, nearest[i] / worldScale[i]);
+      if (t[i] < tMax[i])
+        active[activeCount++] = i;
+    }
+
+    float px[PACKET], py[PACKET], pz[PACKET], distances[PACKET];
+    for (int step = 0; step < MAX_STEPS && activeCount > 0; step++)
+    {
+      for (int k = 0; k < activeCount; k++)
+      {
+        const glm::vec3 p = origin + rays[active[k]] * t[active[k]];
+        px[k] = p.x;
+        py[k] = p.y;
+        pz[k] = p.z;
+      }
+      instance.sdf.evaluate(px, py, pz, activeCount, distances);
+
+      // Finished rays drop out so the next batch only holds live ones
+      int stillActive = 0;
+      for (int k = 0; k < activeCount; k++)
+      {
+        const int i = active[k];
+        if (distances[k] < HIT_DISTANCE)
+        {
+          nearest[i] = t[i] * worldScale[i];
+          hitInstance[i] = &instance;
+          hitPoint[i] = glm::vec3(px[k], py[k], pz[k]);
+          continue;
+        }
+        t[i] += distances[k];
+        if (t[i] < tMax[i])
+          active[stillActive++] = i;
+      }
+      activeCount = stillActive;
+    }
+  }
+
+  const glm::vec3 lightDir = glm::normalize(glm::vec3(1.0f));
+  for (int i = 0; i < count; i++)
+  {
+    glm::vec3 color = m_background;
+    if (const Instance* instance = hitInstance[i])
+    {
+      const glm::vec3 normal =
+          glm::normalize(instance->normalMatrix * instance->sdf.normal(hitPoint[i]));
+      const float diffuse = std::max(glm::dot(normal, lightDir), 0.0f);
+      color = instance->color * (0.3f + 0.7f * diffuse);
+    }
+    float* pixel = pixels + (static_cast<std::size_t>(y) * view.width + x + i) * 3;
+    pixel[0] = color.r;
+    pixel[1] = color.g;
+    pixel[2] = color.b;
+  }
+}
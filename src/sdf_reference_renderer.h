@@ -0,0 +1,79 @@
+#pragma once
+
+#include "component/camera.h"
+#include "component/transform.h"
+#include "sdf_object.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+class JobSystem;
+
+// Software raymarcher for SDF scenes, for machines without a GPU and as a golden image for
+// res/shaders/sdf.glsl. It uses the same camera model as main, the same bounds, step count and
+// hit distance as the shader and the same shading, so the two should agree to a pixel or two
+// along silhouettes.
+//
+// The image is split into TILE_SIZE tiles. Every thread starts on its own contiguous run of
+// tiles and steals half of the largest remaining run once it's done. Rays are marched in
+// packets of SDFObject::BATCH_WIDTH along a row, evaluated together with the batched
+// evaluator.
+class SDFReferenceRenderer
+{
+  public:
+  static constexpr int TILE_SIZE = 16;
+  static constexpr int MAX_STEPS = 128;
+  static constexpr float HIT_DISTANCE = 0.001f;
+
+  explicit SDFReferenceRenderer(JobSystem& jobs);
+
+  // Copied, later edits to sdf don't show up
+  void add(const SDFObject& sdf, const Transform& transform, const glm::vec3& color);
+  void clear();
+
+  inline void setBackground(const glm::vec3& color) { m_background = color; }
+  // Caps how many threads of the job system work on a frame, 0 uses all of them
+  inline void setMaxThreads(unsigned int count) { m_maxThreads = count; }
+
+  // RGB floats, rows top to bottom
+  std::vector<float> render(const Camera& camera,
+                            const Transform& cameraTransform,
+                            int width,
+                            int height);
+
+  // Of the last render
+  inline std::size_t getTileCount() const { return m_tileCount; }
+  inline std::size_t getStealCount() const { return m_stealCount; }
+
+  private:
+  struct Instance
+  {
+    SDFObject sdf;
+    glm::mat4 model;
+    glm::mat4 inverseModel;
+    glm::mat3 normalMatrix;
+    glm::vec3 color;
+    AABB bounds;
+  };
+
+  struct View
+  {
+    glm::mat4 inverseViewProjection;
+    glm::vec3 origin;
+    float farPlane;
+    int width, height;
+  };
+
+  void renderTile(const View& view, std::size_t tile, float* pixels) const;
+  void renderPacket(const View& view, int x, int y, int count, float* pixels) const;
+
+  JobSystem& m_jobs;
+  std::vector<Instance> m_instances;
+  glm::vec3 m_background{0.1f};
+  unsigned int m_maxThreads = 0;
+
+  std::size_t m_tileCount = 0;
+  std::size_t m_stealCount = 0;
+};
@@ -1,124 +1,246 @@
 #include "shader.h"
 
-#include <fstream>
+#include "gl_extensions.h"
+#include "program_cache.h"
+
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
-#include <sstream>
+#include <utility>
 #include <vector>
 
 #include <glad/glad.h>
 
-Shader::Shader(const std::string& filepath) : m_filepath(filepath), m_rendererID(0)
+Shader::Shader(const std::string& filepath, std::vector<std::string> defines)
+    : m_filepath(filepath), m_defines(std::move(defines)), m_status(ShaderStatus::Compiling)
+{
+  submitInitial(preprocess());
+}
+
+Shader::Shader(const std::string& filepath, PreprocessedShader shader)
+    : m_filepath(filepath), m_status(ShaderStatus::Compiling)
 {
-  ShaderProgramSource source = parseShader(filepath);
-  m_rendererID = createShader(source.VertexSource, source.FragmentSource);
+  submitInitial(std::move(shader));
+}
+
+void Shader::submitInitial(PreprocessedShader shader)
+{
+  m_dependencies = std::move(shader.dependencies);
+  m_build = submit(shader.source);
+  m_rendererID = m_build.program;
+  if (!m_build.vertex)
+  {
+    m_status = ShaderStatus::Ready;  // came straight out of the program cache
+    m_build = {};
+  }
 }
 
 Shader::~Shader()
 {
+  for (Build* build : {&m_build, &m_reload})
+  {
+    glDeleteShader(build->vertex);
+    glDeleteShader(build->fragment);
+  }
+  glDeleteProgram(m_reload.program);
   glDeleteProgram(m_rendererID);
 }
 
-unsigned int Shader::compileShader(unsigned int type, const std::string& source)
+unsigned int Shader::compileShader(unsigned int type, const std::string& source) const
 {
+  // Status is checked in finish(), querying it here would stall until the driver is done
   unsigned int id = glCreateShader(type);
   const char* src = source.c_str();
   glShaderSource(id, 1, &src, nullptr);
   glCompileShader(id);
+  return id;
+}
 
+bool Shader::logCompileErrors(unsigned int shader, const char* shaderType) const
+{
   GLint success;
-  glGetShaderiv(id, GL_COMPILE_STATUS, &success);
-  if (!success)
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  if (success)
+    return false;
+
+  GLint logLength;
+  glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+  std::vector<char> infoLog(std::max(logLength, 1), '\0');
+  glGetShaderInfoLog(shader, logLength, nullptr, infoLog.data());
+
+  std::cerr << "ERROR::SHADER::" << shaderType << "::COMPILATION_FAILED " << m_filepath << '\n'
+            << infoLog.data();
+  // Error locations are "source(line)", sources are numbered by #line in the preprocessor
+  if (m_dependencies.size() > 1)
   {
-    GLint logLength;
-    glGetShaderiv(id, GL_INFO_LOG_LENGTH, &logLength);
-    std::vector<char> infoLog(logLength);
-    glGetShaderInfoLog(id, logLength, nullptr, infoLog.data());
-
-    const char* shaderType = (type == GL_VERTEX_SHADER) ? "VERTEX" : "FRAGMENT";
-    std::cerr << "ERROR::SHADER::" << shaderType << "::COMPILATION_FAILED\n"
-              << infoLog.data() << std::endl;
-    glDeleteShader(id);
-    return 0;
+    for (size_t i = 0; i < m_dependencies.size(); i++)
+      std::cerr << "  source " << i << ": " << m_dependencies[i] << '\n';
   }
+  std::cerr << std::endl;
+  return true;
+}
 
-  return id;
+PreprocessedShader Shader::preprocess() const
+{
+  return ShaderPreprocessor::process(m_filepath, m_defines);
 }
 
-ShaderProgramSource Shader::parseShader(const std::string& filepath)
+Shader::Build Shader::submit(const ShaderProgramSource& source) const
 {
-  std::ifstream stream(filepath);
+  Build build;
+  build.cacheKey = ProgramCache::computeKey({source.VertexSource, source.FragmentSource});
+  build.program = ProgramCache::load(build.cacheKey);
+  if (build.program)
+    return build;
+
+  // Submit everything and return, the driver compiles and links while we do other work
+  build.program = glCreateProgram();
+  build.vertex = compileShader(GL_VERTEX_SHADER, source.VertexSource);
+  build.fragment = compileShader(GL_FRAGMENT_SHADER, source.FragmentSource);
+
+  glAttachShader(build.program, build.vertex);
+  glAttachShader(build.program, build.fragment);
+  ProgramCache::prepare(build.program);
+  glLinkProgram(build.program);
+  return build;
+}
 
-  enum class ShaderType
-  {
-    NONE = -1,
-    VERTEX = 0,
-    FRAGMENT = 1
-  };
+bool Shader::isComplete(const Build& build)
+{
+  if (!build.vertex || !GLExtensions::hasParallelShaderCompile())
+    return true;
 
-  std::string line;
-  std::stringstream ss[2];
-  ShaderType type = ShaderType::NONE;
+  GLint done = GL_FALSE;
+  glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &done);
+  return done;
+}
 
-  while (getline(stream, line))
+bool Shader::finish(Build& build) const
+{
+  if (!build.vertex)
+    return build.program != 0;
+
+  int success;
+  glGetProgramiv(build.program, GL_LINK_STATUS, &success);
+  if (!success)
   {
-    if (line.find("#shader") != std::string::npos)
+    // A failed compile also fails the link, report the stage that actually broke
+    const bool compileFailed = logCompileErrors(build.vertex, "VERTEX") |
+                               logCompileErrors(build.fragment, "FRAGMENT");
+    if (!compileFailed)
     {
-      if (line.find("vertex") != std::string::npos)
-        type = ShaderType::VERTEX;
-      else if (line.find("fragment") != std::string::npos)
-        type = ShaderType::FRAGMENT;
-    }
-    else
-    {
-      ss[(int)type] << line << '\n';
+      GLchar infoLog[1024];
+      glGetProgramInfoLog(build.program, 1024, NULL, infoLog);
+      std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: PROGRAM " << m_filepath << '\n'
+                << infoLog << '\n'
+                << std::endl;
     }
+    glDeleteProgram(build.program);
+    build.program = 0;
+  }
+  else
+  {
+    glDetachShader(build.program, build.vertex);
+    glDetachShader(build.program, build.fragment);
+    ProgramCache::store(build.cacheKey, build.program);
   }
 
-  return {ss[0].str(), ss[1].str()};
+  glDeleteShader(build.vertex);
+  glDeleteShader(build.fragment);
+  build.vertex = 0;
+  build.fragment = 0;
+  return success;
 }
 
-unsigned int Shader::createShader(const std::string& vertexShaderSource,
-                                  const std::string& fragmentShaderSource)
+bool Shader::isReady() const
 {
-  unsigned int program = glCreateProgram();
-  unsigned int vs = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-  unsigned int fs = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+  if (m_status == ShaderStatus::Compiling && isComplete(m_build))
+    wait();
+  return m_status == ShaderStatus::Ready;
+}
 
-  glAttachShader(program, vs);
-  glAttachShader(program, fs);
-  glLinkProgram(program);
-  glValidateProgram(program);
+ShaderStatus Shader::getStatus() const
+{
+  isReady();
+  return m_status;
+}
 
-  GLchar infoLog[1024];
-  int success;
+void Shader::wait() const
+{
+  if (m_status != ShaderStatus::Compiling)
+    return;
+
+  m_status = finish(m_build) ? ShaderStatus::Ready : ShaderStatus::Failed;
+  m_rendererID = m_build.program;
+  m_build = {};
+  if (m_status == ShaderStatus::Ready)
+    applyBlockBindings();
+}
 
-  glGetProgramiv(program, GL_LINK_STATUS, &success);
-  if (!success)
+void Shader::reload()
+{
+  reload(preprocess());
+}
+
+void Shader::reload(PreprocessedShader shader)
+{
+  if (!shader.ok)
+    return;
+
+  // A newer edit supersedes whatever is still compiling, deleting in-flight objects is fine
+  glDeleteShader(m_reload.vertex);
+  glDeleteShader(m_reload.fragment);
+  glDeleteProgram(m_reload.program);
+  m_reload = submit(shader.source);
+  m_reloadDependencies = std::move(shader.dependencies);
+}
+
+bool Shader::pollReload()
+{
+  if (!m_reload.program || !isComplete(m_reload))
+    return false;
+
+  if (!finish(m_reload))
   {
-    glGetProgramInfoLog(program, 1024, NULL, infoLog);
-    std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: PROGRAM\n" << infoLog << '\n' << std::endl;
+    std::cerr << "Keeping previous version of " << m_filepath << std::endl;
+    return false;
   }
 
-  glDeleteShader(vs);
-  glDeleteShader(fs);
-
-  return program;
+  // Settle the initial build first so its program isn't leaked
+  wait();
+  glDeleteProgram(m_rendererID);
+  m_rendererID = m_reload.program;
+  m_status = ShaderStatus::Ready;
+  m_reload = {};
+  m_dependencies = std::move(m_reloadDependencies);
+
+  // Names stay the same but the new program can lay its uniforms out differently, and it
+  // starts with every block on binding 0
+  m_uniformLocationCache.clear();
+  applyBlockBindings();
+  return true;
 }
 
 void Shader::bind() const
 {
-  glUseProgram(m_rendererID);
+  // Using a program that hasn't finished linking is an error, bind nothing until then
+  glUseProgram(isReady() ? m_rendererID : 0);
 }
 void Shader::unbind() const
 {
   glUseProgram(0);
 }
 
-unsigned int Shader::getUniformLocation(const std::string& name)
+int Shader::getUniformLocation(const std::string& name) const
 {
+  // Locations only exist once the program has linked
+  if (!isReady())
+    return -1;
+
   // Check cache first
-  if (m_uniformLocationCache.find(name) != m_uniformLocationCache.end())
-    return m_uniformLocationCache[name];
+  auto it = m_uniformLocationCache.find(name);
+  if (it != m_uniformLocationCache.end())
+    return it->second;
 
   // Get location from OpenGL
   int location = glGetUniformLocation(m_rendererID, name.c_str());
@@ -133,60 +255,87 @@ unsigned int Shader::getUniformLocation(const std::string& name)
 
 void Shader::setUniform(const std::string& name, bool value) const
 {
-  glUniform1i(glGetUniformLocation(m_rendererID, name.c_str()), (int)value);
+  glUniform1i(getUniformLocation(name), (int)value);
 }
 
 void Shader::setUniform(const std::string& name, int value) const
 {
-  glUniform1i(glGetUniformLocation(m_rendererID, name.c_str()), value);
+  glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setUniform(const std::string& name, float value) const
 {
-  glUniform1f(glGetUniformLocation(m_rendererID, name.c_str()), value);
+  glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setUniform(const std::string& name, const glm::vec2& value) const
 {
-  glUniform2fv(glGetUniformLocation(m_rendererID, name.c_str()), 1, &value[0]);
+  glUniform2fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setUniform(const std::string& name, float x, float y) const
 {
-  glUniform2f(glGetUniformLocation(m_rendererID, name.c_str()), x, y);
+  glUniform2f(getUniformLocation(name), x, y);
 }
 
 void Shader::setUniform(const std::string& name, const glm::vec3& value) const
 {
-  glUniform3fv(glGetUniformLocation(m_rendererID, name.c_str()), 1, &value[0]);
+  glUniform3fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setUniform(const std::string& name, float x, float y, float z) const
 {
-  glUniform3f(glGetUniformLocation(m_rendererID, name.c_str()), x, y, z);
+  glUniform3f(getUniformLocation(name), x, y, z);
 }
 
 void Shader::setUniform(const std::string& name, const glm::vec4& value) const
 {
-  glUniform4fv(glGetUniformLocation(m_rendererID, name.c_str()), 1, &value[0]);
+  glUniform4fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setUniform(const std::string& name, float x, float y, float z, float w) const
 {
-  glUniform4f(glGetUniformLocation(m_rendererID, name.c_str()), x, y, z, w);
+  glUniform4f(getUniformLocation(name), x, y, z, w);
 }
 
 void Shader::setUniform(const std::string& name, const glm::mat2& mat) const
 {
-  glUniformMatrix2fv(glGetUniformLocation(m_rendererID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+  glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setUniform(const std::string& name, const glm::mat3& mat) const
 {
-  glUniformMatrix3fv(glGetUniformLocation(m_rendererID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+  glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setUniform(const std::string& name, const glm::mat4& mat) const
 {
-  glUniformMatrix4fv(glGetUniformLocation(m_rendererID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+  glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setUniformBlockBinding(const std::string& name, unsigned int binding) const
+{
+  m_blockBindings[name] = binding;
+  // Otherwise it's applied once the program has linked
+  if (isReady())
+  {
+    const unsigned int index = glGetUniformBlockIndex(m_rendererID, name.c_str());
+    if (index == GL_INVALID_INDEX)
+    {
+      std::cerr << "Warning: uniform block '" << name << "' doesn't exist!" << std::endl;
+      return;
+    }
+    glUniformBlockBinding(m_rendererID, index, binding);
+  }
+}
+
+void Shader::applyBlockBindings() const
+{
+  // A reload may have dropped a block, that's not worth a warning every time
+  for (const auto& [name, binding] : m_blockBindings)
+  {
+    const unsigned int index = glGetUniformBlockIndex(m_rendererID, name.c_str());
+    if (index != GL_INVALID_INDEX)
+      glUniformBlockBinding(m_rendererID, index, binding);
+  }
 }
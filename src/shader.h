@@ -1,25 +1,60 @@
 #pragma once
 
+#include "shader_preprocessor.h"
+
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
-struct ShaderProgramSource
+enum class ShaderStatus
 {
-  std::string VertexSource;
-  std::string FragmentSource;
+  Compiling,
+  Ready,
+  Failed
 };
 
+// Compilation is submitted in the constructor and never waited on there. Create every shader up
+// front, do other loading, then poll isReady() (or wait()) - the driver compiles in the meantime.
 class Shader
 {
   public:
-  Shader(const std::string& filepath);
+  // Defines are injected after #version, either "NAME" or "NAME VALUE"
+  Shader(const std::string& filepath, std::vector<std::string> defines = {});
+  // Source that has already been preprocessed or generated. filepath is only used for error
+  // messages and reload(), which goes back to the file.
+  Shader(const std::string& filepath, PreprocessedShader shader);
   ~Shader();
 
+  Shader(const Shader&) = delete;
+  Shader& operator=(const Shader&) = delete;
+
   void bind() const;
   void unbind() const;
 
+  // Non-blocking when KHR_parallel_shader_compile is available, otherwise the first
+  // call waits for the driver to finish
+  bool isReady() const;
+  ShaderStatus getStatus() const;
+  void wait() const;
+
+  // Rebuild from new source. The current program stays in use until the new one has linked,
+  // and a rebuild that fails to compile is logged and dropped.
+  void reload();
+  void reload(PreprocessedShader shader);
+  // Call at a frame boundary, returns true when a reloaded program was swapped in
+  bool pollReload();
+  bool isReloading() const { return m_reload.program != 0; }
+
+  const std::string& getFilepath() const { return m_filepath; }
+  const std::vector<std::string>& getDefines() const { return m_defines; }
+  // Every file the source was assembled from
+  const std::vector<std::string>& getDependencies() const { return m_dependencies; }
+
+  PreprocessedShader preprocess() const;
+
   // Instead of having all of these function, we could just have a template?
   void setUniform(const std::string& name, bool value) const;
   void setUniform(const std::string& name, int value) const;
@@ -33,15 +68,39 @@ class Shader
   void setUniform(const std::string& name, const glm::mat2& mat) const;
   void setUniform(const std::string& name, const glm::mat3& mat) const;
   void setUniform(const std::string& name, const glm::mat4& mat) const;
+  // GL 3.3 has no layout(binding) for uniform blocks, so the binding point is set from here.
+  // It's remembered, a program that is still linking or swapped in by a reload gets it too.
+  void setUniformBlockBinding(const std::string& name, unsigned int binding) const;
 
   private:
+  // One in-flight compile and link, either the initial build or a reload
+  struct Build
+  {
+    unsigned int program = 0;
+    unsigned int vertex = 0;
+    unsigned int fragment = 0;
+    std::uint64_t cacheKey = 0;
+  };
+
   mutable std::unordered_map<std::string, int> m_uniformLocationCache;
-  unsigned int compileShader(unsigned int type, const std::string& source);
-  ShaderProgramSource parseShader(const std::string& filepath);
-  unsigned int createShader(const std::string& vertexShaderSource,
-                            const std::string& fragmentShaderSource);
-  unsigned int getUniformLocation(const std::string& name);
-
-  std::string m_filepath;
-  unsigned int m_rendererID;
+  mutable std::unordered_map<std::string, unsigned int> m_blockBindings;
+  unsigned int compileShader(unsigned int type, const std::string& source) const;
+  Build submit(const ShaderProgramSource& source) const;
+  static bool isComplete(const Build& build);
+  bool finish(Build& build) const;
+  bool logCompileErrors(unsigned int shader, const char* shaderType) const;
+  int getUniformLocation(const std::string& name) const;
+  void applyBlockBindings() const;
+  void submitInitial(PreprocessedShader shader);
+
+  const std::string m_filepath;
+  const std::vector<std::string> m_defines;
+  std::vector<std::string> m_dependencies;
+  std::vector<std::string> m_reloadDependencies;
+
+  // Pending compile state, resolved lazily by isReady()
+  mutable unsigned int m_rendererID = 0;
+  mutable ShaderStatus m_status;
+  mutable Build m_build;
+  Build m_reload;
 };
@@ -0,0 +1,264 @@
+#include "shader_preprocessor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+
+namespace
+{
+constexpr int MAX_INCLUDE_DEPTH = 32;
+
+bool readFile(const std::string& filepath, std::string& contents)
+{
+  std::ifstream stream(filepath, std::ios::binary | std::ios::ate);
+  if (!stream)
+    return false;
+  contents.assign(static_cast<size_t>(stream.tellg()), '\0');
+  stream.seekg(0);
+  stream.read(contents.data(), contents.size());
+  return true;
+}
+
+std::string_view trimLeft(std::string_view line)
+{
+  const size_t start = line.find_first_not_of(" \t");
+  return start == std::string_view::npos ? std::string_view() : line.substr(start);
+}
+
+bool startsWithDirective(std::string_view line, std::string_view directive)
+{
+  line = trimLeft(line);
+  if (!line.starts_with('#'))
+    return false;
+  return trimLeft(line.substr(1)).starts_with(directive);
+}
+
+// Iterates lines without copying, the last line may lack a trailing newline
+class LineReader
+{
+  public:
+  explicit LineReader(std::string_view text) : m_remaining(text) {}
+
+  bool next(std::string_view& line)
+  {
+    if (m_remaining.empty())
+      return false;
+    const size_t end = m_remaining.find('\n');
+    line = m_remaining.substr(0, end);
+    if (line.ends_with('\r'))
+      line.remove_suffix(1);
+    m_remaining.remove_prefix(end == std::string_view::npos ? m_remaining.size() : end + 1);
+    m_lineNumber++;
+    return true;
+  }
+
+  int lineNumber() const { return m_lineNumber; }
+  std::string_view remaining() const { return m_remaining; }
+
+  private:
+  std::string_view m_remaining;
+  int m_lineNumber = 0;
+};
+
+class Expander
+{
+  public:
+  explicit Expander(PreprocessedShader& result) : m_result(result) {}
+
+  void beginStage() { m_included.clear(); }
+
+  // Appends text (already read from file number fileIndex) to out, expanding includes
+  void expand(std::string_view text, int fileIndex, int firstLine, int depth, std::string& out)
+  {
+    const std::filesystem::path directory =
+        std::filesystem::path(m_result.dependencies[fileIndex]).parent_path();
+
+    LineReader reader(text);
+    std::string_view line;
+    while (reader.next(line))
+    {
+      const int lineNumber = firstLine + reader.lineNumber() - 1;
+      if (startsWithDirective(line, "pragma") && line.find("keywords") != std::string_view::npos)
+      {
+        addKeywords(line.substr(line.find("keywords") + 8));
+        out += '\n';
+      }
+      else if (startsWithDirective(line, "include"))
+      {
+        include(line, directory, fileIndex, lineNumber, depth, out);
+      }
+      else
+      {
+        out.append(line);
+        out += '\n';
+      }
+    }
+  }
+
+  private:
+  void addKeywords(std::string_view names)
+  {
+    size_t start = 0;
+    while ((start = names.find_first_not_of(" \t", start)) != std::string_view::npos)
+    {
+      const size_t end = std::min(names.find_first_of(" \t", start), names.size());
+      std::string keyword(names.substr(start, end - start));
+      if (std::find(m_result.keywords.begin(), m_result.keywords.end(), keyword) ==
+          m_result.keywords.end())
+        m_result.keywords.push_back(std::move(keyword));
+      start = end;
+    }
+  }
+
+  void include(std::string_view line,
+               const std::filesystem::path& directory,
+               int fileIndex,
+               int lineNumber,
+               int depth,
+               std::string& out)
+  {
+    const size_t open = line.find('"');
+    const size_t close = open == std::string_view::npos ? open : line.find('"', open + 1);
+    if (close == std::string_view::npos)
+    {
+      error(fileIndex, lineNumber, "malformed #include");
+      out += '\n';
+      return;
+    }
+
+    const std::string path =
+        (directory / line.substr(open + 1, close - open - 1)).lexically_normal().string();
+    if (m_included.contains(path))
+    {
+      out += '\n';
+      return;
+    }
+
+    std::string contents;
+    if (depth >= MAX_INCLUDE_DEPTH || !readFile(path, contents))
+    {
+      error(fileIndex, lineNumber, "can't include " + path);
+      out += '\n';
+      return;
+    }
+    m_included.insert(path);
+
+    const int includeIndex = dependencyIndex(path);
+    out += "#line 1 " + std::to_string(includeIndex) + '\n';
+    expand(contents, includeIndex, 1, depth + 1, out);
+    out += "#line " + std::to_string(lineNumber + 1) + ' ' + std::to_string(fileIndex) + '\n';
+  }
+
+  int dependencyIndex(const std::string& path)
+  {
+    auto& dependencies = m_result.dependencies;
+    auto it = std::find(dependencies.begin(), dependencies.end(), path);
+    if (it != dependencies.end())
+      return static_cast<int>(it - dependencies.begin());
+    dependencies.push_back(path);
+    return static_cast<int>(dependencies.size() - 1);
+  }
+
+  void error(int fileIndex, int lineNumber, const std::string& message)
+  {
+    std::cerr << "ERROR::SHADER::PREPROCESSOR " << m_result.dependencies[fileIndex] << ':'
+              << lineNumber << ": " << message << std::endl;
+    m_result.ok = false;
+  }
+
+  PreprocessedShader& m_result;
+  std::unordered_set<std::string> m_included;
+};
+}  // namespace
+
+namespace ShaderPreprocessor
+{
+PreprocessedShader process(const std::string& filepath, const std::vector<std::string>& defines)
+{
+  PreprocessedShader result;
+  result.dependencies.push_back(std::filesystem::path(filepath).lexically_normal().string());
+
+  std::string file;
+  if (!readFile(filepath, file))
+  {
+    std::cerr << "ERROR::SHADER::FILE_NOT_FOUND " << filepath << std::endl;
+    result.ok = false;
+    return result;
+  }
+
+  std::string injected;
+  for (const auto& define : defines)
+    injected += "#define " + define + '\n';
+
+  Expander expander(result);
+  auto emitStage = [&](std::string* stage, std::string_view text, int firstLine)
+  {
+    if (!stage)
+      return;
+    expander.beginStage();
+
+    // #version has to come first, so the defines and #line go straight after it
+    LineReader reader(text);
+    std::string_view line;
+    bool hasVersion = false;
+    while (!hasVersion && reader.next(line))
+      hasVersion = startsWithDirective(line, "version");
+    if (hasVersion)
+    {
+      stage->append(text.substr(0, text.size() - reader.remaining().size()));
+      if (!stage->ends_with('\n'))
+        *stage += '\n';
+    }
+    else
+    {
+      reader = LineReader(text);
+    }
+
+    *stage += injected;
+    *stage += "#line " + std::to_string(firstLine + reader.lineNumber()) + " 0\n";
+    expander.expand(reader.remaining(), 0, firstLine + reader.lineNumber(), 0, *stage);
+  };
+
+  // Split on the #shader markers, each stage remembers where it started for #line
+  std::string* stage = nullptr;
+  std::string_view stageText;
+  int stageFirstLine = 1;
+  LineReader reader(file);
+  std::string_view line;
+  size_t lineStart = 0;
+  while (reader.next(line))
+  {
+    if (line.find("#shader") != std::string_view::npos)
+    {
+      emitStage(stage, stageText.substr(0, lineStart - (file.size() - stageText.size())),
+                stageFirstLine);
+      stage = nullptr;
+      if (line.find("vertex") != std::string_view::npos)
+        stage = &result.source.VertexSource;
+      else if (line.find("fragment") != std::string_view::npos)
+        stage = &result.source.FragmentSource;
+      stageText = reader.remaining();
+      stageFirstLine = reader.lineNumber() + 1;
+    }
+    lineStart = file.size() - reader.remaining().size();
+  }
+  emitStage(stage, stageText, stageFirstLine);
+
+  return result;
+}
+
+std::vector<std::string> keywordDefines(const std::vector<std::string>& keywords,
+                                        std::uint32_t mask)
+{
+  std::vector<std::string> defines;
+  for (size_t i = 0; i < keywords.size() && i < 32; i++)
+  {
+    if (mask & (1u << i))
+      defines.push_back(keywords[i]);
+  }
+  return defines;
+}
+}  // namespace ShaderPreprocessor
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct ShaderProgramSource
+{
+  std::string VertexSource;
+  std::string FragmentSource;
+};
+
+struct PreprocessedShader
+{
+  ShaderProgramSource source;
+
+  // Every file read, the shader itself first. Indices match the source string numbers in the
+  // emitted #line directives, so compiler errors can be mapped back to the right file.
+  std::vector<std::string> dependencies;
+
+  // Names declared with `#pragma keywords A B ...`, bit i of a variant mask enables keywords[i]
+  std::vector<std::string> keywords;
+
+  bool ok = true;
+};
+
+// Turns a .glsl file into per-stage sources:
+//  - splits on `#shader vertex` / `#shader fragment`
+//  - expands `#include "file"` relative to the including file, each file at most once per stage
+//  - injects the given defines ("NAME" or "NAME VALUE") right after each stage's #version line
+//  - collects `#pragma keywords` for permutation variants
+// Only reads files, so it is safe to call off the main thread.
+namespace ShaderPreprocessor
+{
+PreprocessedShader process(const std::string& filepath,
+                           const std::vector<std::string>& defines = {});
+
+// Defines enabling the keywords set in mask
+std::vector<std::string> keywordDefines(const std::vector<std::string>& keywords,
+                                        std::uint32_t mask);
+}  // namespace ShaderPreprocessor
@@ -0,0 +1,58 @@
+#include "shader_variants.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+// 2^n variants add up quickly, precompileAll() is meant for a handful of keywords
+constexpr size_t MAX_PRECOMPILE_KEYWORDS = 6;
+}  // namespace
+
+ShaderVariants::ShaderVariants(const std::string& filepath, std::vector<std::string> defines)
+    : m_filepath(filepath), m_defines(std::move(defines))
+{
+  m_keywords = ShaderPreprocessor::process(m_filepath, m_defines).keywords;
+  assert(m_keywords.size() <= 32 && "Too many shader keywords for a 32-bit variant mask.");
+}
+
+std::uint32_t ShaderVariants::keywordMask(std::initializer_list<std::string_view> names) const
+{
+  std::uint32_t mask = 0;
+  for (std::string_view name : names)
+  {
+    auto it = std::find(m_keywords.begin(), m_keywords.end(), name);
+    assert(it != m_keywords.end() && "Unknown shader keyword.");
+    if (it != m_keywords.end())
+      mask |= 1u << (it - m_keywords.begin());
+  }
+  return mask;
+}
+
+Shader& ShaderVariants::get(std::uint32_t mask)
+{
+  auto& variant = m_variants[mask];
+  if (!variant)
+  {
+    auto defines = m_defines;
+    for (auto& keyword : ShaderPreprocessor::keywordDefines(m_keywords, mask))
+      defines.push_back(std::move(keyword));
+    variant = std::make_unique<Shader>(m_filepath, std::move(defines));
+  }
+  return *variant;
+}
+
+void ShaderVariants::precompile(std::span<const std::uint32_t> masks)
+{
+  // Shader construction only submits the compile, nothing here waits on the driver
+  for (std::uint32_t mask : masks)
+    get(mask);
+}
+
+void ShaderVariants::precompileAll()
+{
+  assert(m_keywords.size() <= MAX_PRECOMPILE_KEYWORDS && "Too many keywords to precompile all.");
+  const std::uint32_t count = 1u << std::min(m_keywords.size(), MAX_PRECOMPILE_KEYWORDS);
+  for (std::uint32_t mask = 0; mask < count; mask++)
+    get(mask);
+}
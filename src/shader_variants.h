@@ -0,0 +1,47 @@
+#pragma once
+
+#include "shader.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Compile-time permutations of one shader file. The file declares its switches with
+// `#pragma keywords A B C` and each variant is keyed by a bitmask over that list, so the
+// fragment shader gets `#define B` instead of branching on a uniform at runtime.
+class ShaderVariants
+{
+  public:
+  explicit ShaderVariants(const std::string& filepath, std::vector<std::string> defines = {});
+
+  const std::vector<std::string>& getKeywords() const { return m_keywords; }
+  std::uint32_t keywordMask(std::initializer_list<std::string_view> names) const;
+
+  // Compiled lazily on first use, so it may not be ready yet
+  Shader& get(std::uint32_t mask);
+  Shader& get(std::initializer_list<std::string_view> names) { return get(keywordMask(names)); }
+
+  // Submit a batch up front so the driver can compile them in parallel
+  void precompile(std::span<const std::uint32_t> masks);
+  void precompileAll();
+
+  template<typename F>
+  void forEach(F&& fn)
+  {
+    for (auto& [mask, shader] : m_variants)
+      fn(mask, *shader);
+  }
+
+  size_t getVariantCount() const { return m_variants.size(); }
+
+  private:
+  std::string m_filepath;
+  std::vector<std::string> m_defines;
+  std::vector<std::string> m_keywords;
+  std::unordered_map<std::uint32_t, std::unique_ptr<Shader>> m_variants;
+};
@@ -0,0 +1,204 @@
+#include "shader_watcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(100);
+
+// Editors tend to save in several steps (truncate, write, rename), let them settle
+constexpr auto SETTLE_DELAY = std::chrono::milliseconds(50);
+}  // namespace
+
+ShaderWatcher::ShaderWatcher() : m_running(true), m_inotify(-1)
+{
+#ifdef __linux__
+  m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_inotify < 0)
+    std::cerr << "Warning: inotify unavailable, polling shader files instead" << std::endl;
+#endif
+  m_thread = std::thread(&ShaderWatcher::watchLoop, this);
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+  m_running = false;
+  m_thread.join();
+#ifdef __linux__
+  if (m_inotify >= 0)
+    close(m_inotify);
+#endif
+}
+
+std::string ShaderWatcher::normalize(const std::filesystem::path& path)
+{
+  return std::filesystem::absolute(path).lexically_normal().string();
+}
+
+void ShaderWatcher::watch(Shader& shader)
+{
+  std::vector<std::string> files;
+  for (const auto& file : shader.getDependencies())
+    files.push_back(normalize(file));
+
+  std::lock_guard lock(m_mutex);
+  addWatches(files);
+  m_dependencies[&shader] = std::move(files);
+}
+
+void ShaderWatcher::unwatch(Shader& shader)
+{
+  std::lock_guard lock(m_mutex);
+  m_dependencies.erase(&shader);
+  std::erase_if(m_parsed, [&](const auto& parsed) { return parsed.first == &shader; });
+  std::erase(m_reloading, &shader);
+}
+
+void ShaderWatcher::addWatches(const std::vector<std::string>& files)
+{
+  for (const auto& file : files)
+  {
+#ifdef __linux__
+    if (m_inotify >= 0)
+    {
+      // Watch the directory rather than the file, editors often replace files by renaming
+      const std::string directory = std::filesystem::path(file).parent_path().string();
+      int wd = inotify_add_watch(
+          m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+      if (wd >= 0)
+        m_directories[wd] = directory;
+      continue;
+    }
+#endif
+    std::error_code error;
+    m_writeTimes.try_emplace(file, std::filesystem::last_write_time(file, error));
+  }
+}
+
+bool ShaderWatcher::waitForChanges(std::vector<std::string>& changed)
+{
+#ifdef __linux__
+  if (m_inotify >= 0)
+  {
+    pollfd fd{m_inotify, POLLIN, 0};
+    if (poll(&fd, 1, static_cast<int>(POLL_INTERVAL.count())) <= 0)
+      return false;
+
+    std::this_thread::sleep_for(SETTLE_DELAY);
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+    {
+      std::lock_guard lock(m_mutex);
+      for (char* ptr = buffer; ptr < buffer + length;)
+      {
+        const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+        auto it = m_directories.find(event->wd);
+        if (event->len > 0 && it != m_directories.end())
+          changed.push_back(normalize(std::filesystem::path(it->second) / event->name));
+        ptr += sizeof(inotify_event) + event->len;
+      }
+    }
+    return !changed.empty();
+  }
+#endif
+
+  std::this_thread::sleep_for(POLL_INTERVAL);
+
+  std::lock_guard lock(m_mutex);
+  for (auto& [file, writeTime] : m_writeTimes)
+  {
+    std::error_code error;
+    const auto current = std::filesystem::last_write_time(file, error);
+    if (!error && current != writeTime)
+    {
+      writeTime = current;
+      changed.push_back(file);
+    }
+  }
+  return !changed.empty();
+}
+
+void ShaderWatcher::watchLoop()
+{
+  std::vector<std::string> changed;
+  struct Dirty
+  {
+    Shader* shader;
+    std::string filepath;
+    std::vector<std::string> defines;
+  };
+  std::vector<Dirty> dirty;
+
+  while (m_running)
+  {
+    changed.clear();
+    if (!waitForChanges(changed))
+      continue;
+
+    const std::unordered_set<std::string> changedFiles(changed.begin(), changed.end());
+    dirty.clear();
+    {
+      std::lock_guard lock(m_mutex);
+      for (const auto& [shader, files] : m_dependencies)
+      {
+        if (std::ranges::any_of(files, [&](const auto& f) { return changedFiles.contains(f); }))
+          dirty.push_back({shader, shader->getFilepath(), shader->getDefines()});
+      }
+    }
+
+    // File IO and preprocessing happen here, only the GL calls are left for the main thread.
+    // Works from copies so the shader may be unwatched meanwhile.
+    for (auto& [shader, filepath, defines] : dirty)
+    {
+      PreprocessedShader source = ShaderPreprocessor::process(filepath, defines);
+      const auto& stages = source.source;
+      if (!source.ok || stages.VertexSource.empty() || stages.FragmentSource.empty())
+        continue;  // caught mid-save, the next write event will pick it up
+
+      std::lock_guard lock(m_mutex);
+      if (!m_dependencies.contains(shader))
+        continue;
+      std::erase_if(m_parsed, [&](const auto& parsed) { return parsed.first == shader; });
+      m_parsed.emplace_back(shader, std::move(source));
+    }
+  }
+}
+
+void ShaderWatcher::update()
+{
+  std::vector<std::pair<Shader*, PreprocessedShader>> parsed;
+  {
+    std::lock_guard lock(m_mutex);
+    parsed.swap(m_parsed);
+  }
+
+  for (auto& [shader, source] : parsed)
+  {
+    shader->reload(std::move(source));
+    if (std::ranges::find(m_reloading, shader) == m_reloading.end())
+      m_reloading.push_back(shader);
+  }
+
+  std::erase_if(m_reloading,
+                [&](Shader* shader)
+                {
+                  if (shader->pollReload())
+                  {
+                    std::cout << "Reloaded " << shader->getFilepath() << std::endl;
+                    watch(*shader);  // the set of included files may have changed
+                    return true;
+                  }
+                  return !shader->isReloading();
+                });
+}
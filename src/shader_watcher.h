@@ -0,0 +1,55 @@
+#pragma once
+
+#include "shader.h"
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Hot-reloads shaders when their source files change on disk.
+// A background thread watches the files (inotify on Linux, modification times elsewhere) and
+// re-reads changed shaders off the main thread. update() hands the new source to the Shader at
+// a frame boundary and swaps it in once it links; broken edits leave the old program running.
+// Watched shaders must outlive the watcher or be unwatched first.
+class ShaderWatcher
+{
+  public:
+  ShaderWatcher();
+  ~ShaderWatcher();
+
+  ShaderWatcher(const ShaderWatcher&) = delete;
+  ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+  void watch(Shader& shader);
+  void unwatch(Shader& shader);
+
+  // Call once per frame on the thread that owns the GL context
+  void update();
+
+  private:
+  void watchLoop();
+  bool waitForChanges(std::vector<std::string>& changed);
+  void addWatches(const std::vector<std::string>& files);
+  static std::string normalize(const std::filesystem::path& path);
+
+  std::atomic<bool> m_running;
+  std::thread m_thread;
+
+  // Shared with the watch thread
+  std::mutex m_mutex;
+  std::unordered_map<Shader*, std::vector<std::string>> m_dependencies;
+  std::vector<std::pair<Shader*, PreprocessedShader>> m_parsed;
+
+  // Platform watch state, only touched under m_mutex or from the watch thread
+  int m_inotify;
+  std::unordered_map<int, std::string> m_directories;
+  std::unordered_map<std::string, std::filesystem::file_time_type> m_writeTimes;
+
+  // Main thread only
+  std::vector<Shader*> m_reloading;
+};
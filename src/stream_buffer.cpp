@@ -0,0 +1,166 @@
+#include "stream_buffer.h"
+
+#include "gl_extensions.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+// How long a single glClientWaitSync blocks before we re-check, in nanoseconds
+constexpr GLuint64 FENCE_TIMEOUT = 1'000'000;
+
+unsigned int alignUp(unsigned int value, unsigned int alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+StreamBuffer::StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount)
+    : m_rendererID(0),
+      m_target(target),
+      m_regionSize(regionSize),
+      m_regionCount(regionCount),
+      m_minAlignment(1),
+      m_persistent(GLExtensions::hasBufferStorage()),
+      m_region(0),
+      m_cursor(0),
+      m_mapped(nullptr),
+      m_mapBegin(0)
+{
+  assert(regionCount > 0 && regionCount <= MAX_REGIONS && "Invalid stream buffer region count.");
+
+  if (m_target == GL_UNIFORM_BUFFER)
+  {
+    GLint alignment = 1;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_minAlignment = static_cast<unsigned int>(alignment);
+    m_regionSize = alignUp(m_regionSize, m_minAlignment);
+  }
+
+  const GLsizeiptr totalSize = static_cast<GLsizeiptr>(m_regionSize) * m_regionCount;
+
+  glGenBuffers(1, &m_rendererID);
+  glBindBuffer(m_target, m_rendererID);
+
+  if (m_persistent)
+  {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLExtensions::bufferStorage()(m_target, totalSize, nullptr, flags);
+    m_mapped = static_cast<unsigned char*>(glMapBufferRange(m_target, 0, totalSize, flags));
+  }
+  else
+  {
+    glBufferData(m_target, totalSize, nullptr, GL_STREAM_DRAW);
+  }
+
+  glBindBuffer(m_target, 0);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+  for (void* fence : m_fences)
+  {
+    if (fence)
+      glDeleteSync(static_cast<GLsync>(fence));
+  }
+
+  if (m_mapped)
+  {
+    glBindBuffer(m_target, m_rendererID);
+    glUnmapBuffer(m_target);
+  }
+
+  glDeleteBuffers(1, &m_rendererID);
+}
+
+void StreamBuffer::beginFrame()
+{
+  flush();
+  m_region = (m_region + 1) % m_regionCount;
+  waitForRegion(m_region);
+  m_cursor = regionBegin();
+}
+
+void StreamBuffer::endFrame()
+{
+  flush();
+  if (m_fences[m_region])
+    glDeleteSync(static_cast<GLsync>(m_fences[m_region]));
+  m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate(unsigned int size, unsigned int alignment)
+{
+  const unsigned int offset = alignUp(m_cursor, std::max(alignment, m_minAlignment));
+  const unsigned int regionEnd = regionBegin() + m_regionSize;
+
+  if (offset + size > regionEnd)
+  {
+    assert(false && "Stream buffer region exhausted.");
+    return {};
+  }
+
+  if (!m_persistent && !m_mapped)
+  {
+    // Map everything left in the region at once so earlier allocations stay valid until flush().
+    // The fence in beginFrame() already guarantees the GPU is done with this range.
+    m_mapBegin = offset;
+    glBindBuffer(m_target, m_rendererID);
+    m_mapped = static_cast<unsigned char*>(glMapBufferRange(m_target,
+                                                            m_mapBegin,
+                                                            regionEnd - m_mapBegin,
+                                                            GL_MAP_WRITE_BIT |
+                                                                GL_MAP_UNSYNCHRONIZED_BIT |
+                                                                GL_MAP_INVALIDATE_RANGE_BIT |
+                                                                GL_MAP_FLUSH_EXPLICIT_BIT));
+  }
+
+  if (!m_mapped)
+    return {};
+
+  m_cursor = offset + size;
+  return {m_mapped + (offset - m_mapBegin), offset, size};
+}
+
+void StreamBuffer::flush()
+{
+  if (m_persistent || !m_mapped)
+    return;
+
+  glBindBuffer(m_target, m_rendererID);
+  glFlushMappedBufferRange(m_target, 0, m_cursor - m_mapBegin);
+  glUnmapBuffer(m_target);
+  m_mapped = nullptr;
+}
+
+void StreamBuffer::bind() const
+{
+  glBindBuffer(m_target, m_rendererID);
+}
+
+void StreamBuffer::unbind() const
+{
+  glBindBuffer(m_target, 0);
+}
+
+void StreamBuffer::bindRange(unsigned int index, const Allocation& allocation) const
+{
+  glBindBufferRange(m_target, index, m_rendererID, allocation.offset, allocation.size);
+}
+
+void StreamBuffer::waitForRegion(unsigned int region)
+{
+  GLsync fence = static_cast<GLsync>(m_fences[region]);
+  if (!fence)
+    return;
+
+  GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+  while (result == GL_TIMEOUT_EXPIRED)
+  {
+    result = glClientWaitSync(fence, 0, FENCE_TIMEOUT);
+  }
+
+  glDeleteSync(fence);
+  m_fences[region] = nullptr;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+
+// Ring buffer for data that is rewritten every frame (instance data, particles, debug lines).
+// The buffer is split into regionCount regions of regionSize bytes. Each frame writes into one
+// region, which is fenced at endFrame() and only reused once the GPU has signalled the fence, so
+// writes never make the driver wait on in-flight draws.
+//
+// With ARB_buffer_storage the whole buffer is persistently and coherently mapped once. Otherwise
+// the free part of the region is mapped unsynchronized on the first allocation after a flush.
+class StreamBuffer
+{
+  public:
+  static constexpr unsigned int MAX_REGIONS = 4;
+
+  struct Allocation
+  {
+    void* data{nullptr};     // CPU write pointer, valid until the next flush()
+    unsigned int offset{0};  // byte offset into the GL buffer
+    unsigned int size{0};
+
+    explicit operator bool() const { return data != nullptr; }
+  };
+
+  StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount = 3);
+  ~StreamBuffer();
+
+  StreamBuffer(const StreamBuffer&) = delete;
+  StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+  // Moves to the next region, blocking only if the GPU is still reading it
+  void beginFrame();
+  // Fences the current region so it isn't handed out again until the GPU is done with it
+  void endFrame();
+
+  // Sub-allocates from the current region. Returns an empty allocation if the region is full.
+  Allocation allocate(unsigned int size, unsigned int alignment = 16);
+
+  // Makes allocations written since the last flush visible to GL. Call before drawing with them.
+  // Does nothing when persistently mapped.
+  void flush();
+
+  void bind() const;
+  void unbind() const;
+  // Binds an allocation to an indexed target (uniform buffer blocks)
+  void bindRange(unsigned int index, const Allocation& allocation) const;
+
+  inline bool isPersistent() const { return m_persistent; }
+  inline unsigned int getRendererID() const { return m_rendererID; }
+  inline unsigned int getRegionSize() const { return m_regionSize; }
+  inline unsigned int getUsed() const { return m_cursor - regionBegin(); }
+
+  private:
+  unsigned int regionBegin() const { return m_region * m_regionSize; }
+  void waitForRegion(unsigned int region);
+
+  unsigned int m_rendererID;
+  unsigned int m_target;
+  unsigned int m_regionSize;
+  unsigned int m_regionCount;
+  unsigned int m_minAlignment;
+  bool m_persistent;
+
+  unsigned int m_region;
+  unsigned int m_cursor;
+  std::array<void*, MAX_REGIONS> m_fences{};
+
+  // Persistent mapping of the whole buffer, or the transient mapping of [m_mapBegin, region end)
+  unsigned char* m_mapped;
+  unsigned int m_mapBegin;
+};
@@ -4,13 +4,15 @@
 #include "../coordinator.h"
 #include "../ecs_constants.h"
 #include "../input.h"
+#include "../sdf_collision.h"
 
 #include <glm/gtc/quaternion.hpp>
 
 extern Coordinator g_coordinator;
 
-void CameraControlSystem::Init()
+void CameraControlSystem::Init(const SDFCollisionWorld* collision)
 {
+  m_collision = collision;
   g_coordinator.AddEventListener(
       METHOD_LISTENER(Events::Window::INPUT, CameraControlSystem::InputListener));
 }
@@ -24,34 +26,49 @@ void CameraControlSystem::Update(float dt)
     float speed = 5.0f;
 
     // Movement relative to camera orientation
+    glm::vec3 motion(0.0f);
     if (mButtons.test(static_cast<std::size_t>(InputButtons::W)))
     {
-      transform.position += transform.forward() * speed * dt;
+      motion += transform.forward() * speed * dt;
     }
 
     if (mButtons.test(static_cast<std::size_t>(InputButtons::S)))
     {
-      transform.position -= transform.forward() * speed * dt;
+      motion -= transform.forward() * speed * dt;
     }
 
     if (mButtons.test(static_cast<std::size_t>(InputButtons::A)))
     {
-      transform.position -= transform.right() * speed * dt;
+      motion -= transform.right() * speed * dt;
     }
 
     if (mButtons.test(static_cast<std::size_t>(InputButtons::D)))
     {
-      transform.position += transform.right() * speed * dt;
+      motion += transform.right() * speed * dt;
     }
 
     if (mButtons.test(static_cast<std::size_t>(InputButtons::Q)))
     {
-      transform.position += glm::vec3(0, 1, 0) * speed * dt;  // World up
+      motion += glm::vec3(0, 1, 0) * speed * dt;  // World up
     }
 
     if (mButtons.test(static_cast<std::size_t>(InputButtons::E)))
     {
-      transform.position -= glm::vec3(0, 1, 0) * speed * dt;  // World down
+      motion -= glm::vec3(0, 1, 0) * speed * dt;  // World down
+    }
+
+    if (m_collision)
+    {
+      SDFCollisionWorld::Mover mover;
+      mover.position = transform.position;
+      mover.motion = motion;
+      mover.radius = COLLISION_RADIUS;
+      m_collision->move(mover);
+      transform.position = mover.position;
+    }
+    else
+    {
+      transform.position += motion;
     }
 
     // Mouse look
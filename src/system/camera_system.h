@@ -3,16 +3,22 @@
 #include "../system_manager.h"
 
 class Event;
+class SDFCollisionWorld;
 
 class CameraControlSystem : public System
 {
   public:
-  void Init();
+  // Size of the sphere the camera collides as
+  static constexpr float COLLISION_RADIUS = 0.2f;
+
+  // Without a collision world the camera flies through everything
+  void Init(const SDFCollisionWorld* collision = nullptr);
 
   void Update(float dt);
 
   private:
   std::bitset<8> mButtons;
+  const SDFCollisionWorld* m_collision = nullptr;
 
   void InputListener(Event& event);
 };
@@ -0,0 +1,41 @@
+#include "culling_system.h"
+
+#include "../component/bounds.h"
+#include "../component/world_transform.h"
+#include "../coordinator.h"
+
+#include <algorithm>
+
+extern Coordinator g_coordinator;
+
+void CullingSystem::Init(JobSystem* jobs)
+{
+  m_jobs = jobs;
+}
+
+void CullingSystem::Update(const Frustum& frustum)
+{
+  // Gather world-space spheres into SoA so the test runs several spheres per instruction
+  m_spheres.clear();
+  m_sphereEntities.clear();
+  m_spheres.reserve(m_entities.size());
+  m_sphereEntities.reserve(m_entities.size());
+
+  for (auto& entity : m_entities)
+  {
+    const auto& world = g_coordinator.GetComponent<WorldTransform>(entity);
+    const Bounds::Sphere sphere =
+        g_coordinator.GetComponent<Bounds>(entity).worldSphere(world.matrix);
+
+    m_spheres.push(sphere.center, sphere.radius);
+    m_sphereEntities.push_back(entity);
+  }
+
+  Culling::cullSpheres(frustum, m_spheres, m_visibleIndices, m_jobs);
+
+  m_visible.clear();
+  for (std::uint32_t index : m_visibleIndices)
+  {
+    m_visible.push_back(m_sphereEntities[index]);
+  }
+}
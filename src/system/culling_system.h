@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../frustum.h"
+#include "../system_manager.h"
+
+#include <vector>
+
+class JobSystem;
+
+// Tests the world-space bounding spheres of every entity with WorldTransform + Bounds against
+// the camera frustum and keeps the visible ones for the render loop
+class CullingSystem : public System
+{
+  public:
+  void Init(JobSystem* jobs);
+
+  void Update(const Frustum& frustum);
+
+  inline const std::vector<Entity>& getVisibleEntities() const { return m_visible; }
+  // The world spheres tested this frame and which of them passed, for passes that run on the
+  // visible set (LodSystem)
+  inline const SphereBatch& getSpheres() const { return m_spheres; }
+  inline const std::vector<Entity>& getSphereEntities() const { return m_sphereEntities; }
+  inline const std::vector<std::uint32_t>& getVisibleIndices() const { return m_visibleIndices; }
+
+  private:
+  JobSystem* m_jobs{nullptr};
+  SphereBatch m_spheres;
+  std::vector<Entity> m_sphereEntities;
+  std::vector<std::uint32_t> m_visibleIndices;
+  std::vector<Entity> m_visible;
+};
@@ -0,0 +1,73 @@
+#include "lod_system.h"
+
+#include "../component/camera.h"
+#include "../component/lod_group.h"
+#include "../coordinator.h"
+#include "../lod_selection.h"
+#include "culling_system.h"
+
+#include <algorithm>
+
+extern Coordinator g_coordinator;
+
+void LodSystem::Update(const CullingSystem& culling,
+                       const glm::vec3& cameraPosition,
+                       const Camera& camera,
+                       float dt)
+{
+  m_frame++;
+  m_draws.clear();
+
+  // Screen sizes of everything visible in one pass over the culling spheres
+  const std::vector<std::uint32_t>& visible = culling.getVisibleIndices();
+  m_sizes.resize(visible.size());
+  LodSelection::screenSizes(culling.getSpheres(),
+                            visible.data(),
+                            visible.size(),
+                            cameraPosition,
+                            LodSelection::projectionScale(camera.fov),
+                            m_sizes.data());
+
+  for (std::size_t i = 0; i < visible.size(); i++)
+  {
+    const Entity entity = culling.getSphereEntities()[visible[i]];
+    if (!m_entities.contains(entity))
+      continue;
+
+    auto& group = g_coordinator.GetComponent<LodGroup>(entity);
+    const auto count = static_cast<std::uint32_t>(group.levels.size());
+    m_thresholds.clear();
+    for (const LodGroup::Level& level : group.levels)
+      m_thresholds.push_back(level.screenSize);
+
+    // Out of view last frame, there's nothing on screen to fade from
+    const bool continuing = group.selectedFrame + 1 == m_frame;
+    group.selectedFrame = m_frame;
+    const std::uint32_t level = LodSelection::select(
+        m_thresholds,
+        group.cullScreenSize,
+        m_sizes[i],
+        continuing ? static_cast<std::int64_t>(group.current) : -1);
+
+    if (!continuing || group.fadeTime <= 0.0f)
+    {
+      group.current = level;
+      group.fade = 1.0f;
+    }
+    else if (level != group.current)
+    {
+      group.previous = group.current;
+      group.current = level;
+      group.fade = 0.0f;
+    }
+    else if (group.fade < 1.0f)
+      group.fade = std::min(group.fade + dt / group.fadeTime, 1.0f);
+
+    // The two levels dither with complementary patterns, together they cover every pixel once
+    const bool fading = group.fade < 1.0f;
+    if (fading && group.previous < count)
+      m_draws.push_back({entity, group.previous, group.fade, m_sizes[i]});
+    if (group.current < count)
+      m_draws.push_back({entity, group.current, fading ? group.fade - 1.0f : 0.0f, m_sizes[i]});
+  }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../system_manager.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+class CullingSystem;
+struct Camera;
+
+// Picks the LodGroup level of every visible entity with WorldTransform + Bounds + LodGroup. It
+// works off the culling pass, reusing its world spheres and only looking at what survived it.
+class LodSystem : public System
+{
+  public:
+  struct Draw
+  {
+    Entity entity;
+    std::uint32_t level;
+    // For the lodFade uniform (res/shaders/include/lod_fade.glsl): 0 draws every pixel, in
+    // (0, 1) the level is dithering out, in [-1, 0) in
+    float fade;
+    // Fraction of the view height the entity covers, for texture streaming feedback
+    float screenSize;
+  };
+
+  // Run after culling_system->Update() for the same frame
+  void Update(const CullingSystem& culling,
+              const glm::vec3& cameraPosition,
+              const Camera& camera,
+              float dt);
+
+  // Levels to draw this frame, an entity in the middle of a cross-fade has two
+  inline const std::vector<Draw>& getDraws() const { return m_draws; }
+
+  private:
+  std::uint64_t m_frame{0};
+  std::vector<float> m_sizes;
+  std::vector<float> m_thresholds;
+  std::vector<Draw> m_draws;
+};
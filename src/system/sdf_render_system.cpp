@@ -0,0 +1,272 @@
+#include "sdf_render_system.h"
+
+#include "../component/sdf_shape.h"
+#include "../component/world_transform.h"
+#include "../coordinator.h"
+#include "../mesh.h"
+#include "../renderer.h"
+#include "../sdf_brick_texture.h"
+#include "../sdf_compiler.h"
+#include "../shader.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+
+extern Coordinator g_coordinator;
+
+namespace
+{
+// Keeps surfaces that touch their bounds from being cut off by the box faces
+constexpr float BOUNDS_PADDING = 0.01f;
+// Prepass texels no shape covers are never read, anything works as long as GL_MIN passes it
+constexpr float PREPASS_CLEAR = 1e30f;
+
+// Fraction of the view height covered by the sphere around bounds
+float screenSize(const AABB& bounds,
+                 const glm::mat4& model,
+                 const glm::vec3& cameraPosition,
+                 const glm::mat4& projection)
+{
+  const float maxScale = std::max(glm::length(glm::vec3(model[0])),
+                                  std::max(glm::length(glm::vec3(model[1])),
+                                           glm::length(glm::vec3(model[2]))));
+  const float radius = glm::length(bounds.extents()) * maxScale;
+  const glm::vec3 center = glm::vec3(model * glm::vec4(bounds.center(), 1.0f));
+  const float distance = glm::length(center - cameraPosition);
+  // Inside the sphere it covers the whole view
+  if (distance <= radius)
+    return 1.0f;
+  return radius * projection[1][1] / distance;
+}
+}  // namespace
+
+void SDFRenderSystem::Init(int width,
+                           int height,
+                           const std::string& templatePath,
+                           const std::string& meshShaderPath)
+{
+  m_templatePath = templatePath;
+  m_meshShader = std::make_unique<Shader>(meshShaderPath);
+  m_parameters = std::make_unique<StreamBuffer>(GL_UNIFORM_BUFFER, PARAMETER_BYTES_PER_FRAME);
+  m_brickProgram.shader =
+      std::make_unique<Shader>(templatePath, std::vector<std::string>{"SDF_BRICKS"});
+  m_brickProgram.prepass = std::make_unique<Shader>(
+      templatePath, std::vector<std::string>{"SDF_BRICKS", "SDF_PREPASS"});
+
+  // Rounded up so every pixel has a texel at half its coordinates
+  m_prepass = std::make_unique<Framebuffer>((width + 1) / 2, (height + 1) / 2, GL_R32F, false);
+  m_prepassTimer = std::make_unique<GpuTimer>();
+  m_marchTimer = std::make_unique<GpuTimer>();
+}
+
+const SDFRenderSystem::Program* SDFRenderSystem::programFor(const SDFObject& sdf,
+                                                             bool bakeParameters)
+{
+  const std::uint64_t key = SDFCompiler::structureKey(sdf, bakeParameters);
+  Program& program = m_programs[key];
+  if (!program.shader)
+  {
+    program.shader = std::make_unique<Shader>(
+        m_templatePath, SDFCompiler::buildShader(m_templatePath, sdf, bakeParameters));
+    program.prepass = std::make_unique<Shader>(
+        m_templatePath,
+        SDFCompiler::buildShader(m_templatePath, sdf, bakeParameters, {"SDF_PREPASS"}));
+  }
+
+  // A shape has to be in the prepass to be drawn, so both wait for each other
+  if (!program.shader->isReady() || !program.prepass->isReady())
+    return nullptr;
+  if (!program.blockBound && !bakeParameters)
+  {
+    program.shader->setUniformBlockBinding(SDFCompiler::PARAMETER_BLOCK, PARAMETER_BINDING);
+    program.prepass->setUniformBlockBinding(SDFCompiler::PARAMETER_BLOCK, PARAMETER_BINDING);
+    program.blockBound = true;
+  }
+  return &program;
+}
+
+bool SDFRenderSystem::isCompiling() const
+{
+  auto compiling = [](const Program& program)
+  {
+    return program.shader->getStatus() == ShaderStatus::Compiling ||
+           program.prepass->getStatus() == ShaderStatus::Compiling;
+  };
+  if (compiling(m_brickProgram) || m_meshShader->getStatus() == ShaderStatus::Compiling)
+    return true;
+  for (const auto& [key, program] : m_programs)
+  {
+    if (compiling(program))
+      return true;
+  }
+  return false;
+}
+
+void SDFRenderSystem::Render(const Renderer& renderer,
+                             const ResourceManager& resources,
+                             const Mesh& cube,
+                             const glm::mat4& view,
+                             const glm::mat4& projection,
+                             const glm::vec3& cameraPosition,
+                             float farPlane,
+                             const Framebuffer& sceneDepth,
+                             const Framebuffer& target)
+{
+  struct Draw
+  {
+    Entity entity;
+    const Program* program;
+    AABB bounds;
+    StreamBuffer::Allocation parameters;
+  };
+  std::vector<Draw> draws;
+  struct MeshDraw
+  {
+    Entity entity;
+    const Mesh* mesh;
+    int lod;
+  };
+  std::vector<MeshDraw> meshDraws;
+
+  // Write every shape's parameters first, so there's a single flush before drawing
+  m_parameters->beginFrame();
+  for (Entity entity : m_entities)
+  {
+    const auto& shape = g_coordinator.GetComponent<SDFShape>(entity);
+    const Mesh* mesh = resources.get(shape.mesh);
+    if (mesh && mesh->isLoaded() && m_meshShader->isReady())
+    {
+      const glm::mat4 model = g_coordinator.GetComponent<WorldTransform>(entity).toMat4();
+      const float size = screenSize(mesh->getBounds(), model, cameraPosition, projection);
+      if (size < shape.meshScreenSize)
+      {
+        meshDraws.push_back({entity, mesh, mesh->selectLod(size)});
+        continue;
+      }
+    }
+
+    if (shape.bricks)
+    {
+      const bool ready = m_brickProgram.shader->isReady() && m_brickProgram.prepass->isReady();
+      if (!shape.bricks->isEmpty() && ready)
+        draws.push_back({entity, &m_brickProgram, shape.bricks->getBounds(), {}});
+      continue;
+    }
+
+    const AABB bounds = shape.sdf.getBounds();
+    if (shape.sdf.isEmpty() || bounds.isEmpty())
+      continue;
+
+    const Program* program = programFor(shape.sdf, shape.isStatic);
+    if (!program)
+      continue;
+
+    Draw draw{entity, program, bounds, {}};
+    if (!shape.isStatic)
+    {
+      SDFCompiler::gatherParameters(shape.sdf, m_scratch);
+      const auto bytes = static_cast<unsigned int>(m_scratch.size() * sizeof(glm::vec4));
+      draw.parameters = m_parameters->allocate(bytes);
+      if (!draw.parameters)
+        continue;  // out of room this frame
+      std::memcpy(draw.parameters.data, m_scratch.data(), bytes);
+    }
+    draws.push_back(draw);
+  }
+  m_parameters->flush();
+
+  // Angle a prepass texel covers, the cone around it has half its diagonal as radius
+  const float texelAngle = 2.0f / (projection[1][1] * m_prepass->getHeight());
+
+  auto bindShape = [&](const Shader& shader, const Draw& draw, const glm::mat4& model)
+  {
+    const auto& shape = g_coordinator.GetComponent<SDFShape>(draw.entity);
+    shader.bind();
+    shader.setUniform("model", model);
+    shader.setUniform("inverseModel", glm::inverse(model));
+    shader.setUniform("view", view);
+    shader.setUniform("projection", projection);
+    shader.setUniform("cameraPos", cameraPosition);
+    shader.setUniform("farPlane", farPlane);
+    shader.setUniform("boundsCenter", draw.bounds.center());
+    shader.setUniform("objectColor", shape.color);
+    if (draw.parameters)
+      m_parameters->bindRange(PARAMETER_BINDING, draw.parameters);
+    if (shape.bricks)
+      shape.bricks->bind(shader, BRICK_ATLAS_SLOT, BRICK_INDIRECTION_SLOT);
+  };
+  const glm::vec3 padding = glm::vec3(BOUNDS_PADDING);
+
+  // Prepass, blending keeps the nearest distance of the shapes covering each texel
+  m_prepassTimer->begin();
+  m_prepass->bind();
+  glClearColor(PREPASS_CLEAR, PREPASS_CLEAR, PREPASS_CLEAR, PREPASS_CLEAR);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glDisable(GL_DEPTH_TEST);
+  glEnable(GL_BLEND);
+  glBlendEquation(GL_MIN);
+  for (const Draw& draw : draws)
+  {
+    const glm::mat4 model = g_coordinator.GetComponent<WorldTransform>(draw.entity).toMat4();
+    const glm::vec3 scale(glm::length(glm::vec3(model[0])),
+                          glm::length(glm::vec3(model[1])),
+                          glm::length(glm::vec3(model[2])));
+    const float minScale = std::min(scale.x, std::min(scale.y, scale.z));
+    const float maxScale = std::max(scale.x, std::max(scale.y, scale.z));
+
+    // The box grows by a texel and a half at its far side, so it covers the center of every
+    // texel any of its pixels are in
+    const float farthest = glm::length(glm::vec3(model * glm::vec4(draw.bounds.center(), 1.0f)) -
+                                       cameraPosition) +
+                           glm::length(draw.bounds.extents()) * maxScale;
+    const float margin = 1.5f * texelAngle * farthest / minScale;
+
+    const Shader& shader = *draw.program->prepass;
+    bindShape(shader, draw, model);
+    shader.setUniform("boundsSize", draw.bounds.size() * (1.0f + BOUNDS_PADDING) + padding +
+                                        glm::vec3(2.0f * margin));
+    shader.setUniform("coneRadius", 0.75f * texelAngle * maxScale / minScale);
+    cube.draw(renderer, shader);
+  }
+  glBlendEquation(GL_FUNC_ADD);
+  glDisable(GL_BLEND);
+  glEnable(GL_DEPTH_TEST);
+  m_prepassTimer->end();
+
+  m_marchTimer->begin();
+  target.bind();
+  m_meshedCount = meshDraws.size();
+  if (!meshDraws.empty())
+  {
+    m_meshShader->bind();
+    m_meshShader->setUniform("view", view);
+    m_meshShader->setUniform("projection", projection);
+    for (const MeshDraw& draw : meshDraws)
+    {
+      const auto& shape = g_coordinator.GetComponent<SDFShape>(draw.entity);
+      const glm::mat4 model = g_coordinator.GetComponent<WorldTransform>(draw.entity).toMat4();
+      m_meshShader->setUniform("model", model);
+      m_meshShader->setUniform("inverseModel", glm::inverse(model));
+      m_meshShader->setUniform("objectColor", shape.color);
+      draw.mesh->draw(renderer, *m_meshShader, draw.lod);
+    }
+  }
+  m_prepass->bindColorTexture(PREPASS_SLOT);
+  sceneDepth.bindDepthTexture(SCENE_DEPTH_SLOT);
+  const glm::mat4 inverseProjection = glm::inverse(projection);
+  for (const Draw& draw : draws)
+  {
+    const glm::mat4 model = g_coordinator.GetComponent<WorldTransform>(draw.entity).toMat4();
+    const Shader& shader = *draw.program->shader;
+    bindShape(shader, draw, model);
+    shader.setUniform("boundsSize", draw.bounds.size() * (1.0f + BOUNDS_PADDING) + padding);
+    shader.setUniform("prepassDistance", static_cast<int>(PREPASS_SLOT));
+    shader.setUniform("sceneDepth", static_cast<int>(SCENE_DEPTH_SLOT));
+    shader.setUniform("inverseProjection", inverseProjection);
+    cube.draw(renderer, shader);
+  }
+  m_marchTimer->end();
+  m_parameters->endFrame();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "../framebuffer.h"
+#include "../gpu_timer.h"
+#include "../stream_buffer.h"
+#include "../system_manager.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+class Renderer;
+class ResourceManager;
+class SDFObject;
+class Shader;
+
+// Raymarches every entity with WorldTransform + SDFShape inside a box around its bounds.
+// Each shape is drawn with a program generated by SDFCompiler, cached by structure key: shapes
+// that only differ in their parameters share one program and stream those through a uniform
+// buffer, a new structure compiles in the background and shows up once it has linked.
+// Shapes with a brick map bake are drawn with one shared program that samples it.
+//
+// A half resolution prepass cone marches every shape first and keeps, per texel, how far the
+// rays through it are empty. The full resolution pass starts marching there, and stops at the
+// depth of the meshes already drawn or at the far plane.
+//
+// Shapes with a mesh that are small enough on screen skip both passes and are rasterised at
+// the LOD their size calls for.
+class SDFRenderSystem : public System
+{
+  public:
+  static constexpr unsigned int PARAMETER_BINDING = 0;
+  static constexpr unsigned int PARAMETER_BYTES_PER_FRAME = 64 * 1024;
+  // Texture units, baked shapes use the first two
+  static constexpr unsigned int BRICK_ATLAS_SLOT = 1;
+  static constexpr unsigned int BRICK_INDIRECTION_SLOT = 2;
+  static constexpr unsigned int SCENE_DEPTH_SLOT = 3;
+  static constexpr unsigned int PREPASS_SLOT = 4;
+
+  // Size of the target Render() draws into
+  void Init(int width,
+            int height,
+            const std::string& templatePath = "res/shaders/sdf.glsl",
+            const std::string& meshShaderPath = "res/shaders/sdf_mesh.glsl");
+
+  // The unit cube mesh is stretched over each shape's bounds. sceneDepth holds a copy of the
+  // depth in target, which can't be sampled while it's being drawn into.
+  void Render(const Renderer& renderer,
+              const ResourceManager& resources,
+              const Mesh& cube,
+              const glm::mat4& view,
+              const glm::mat4& projection,
+              const glm::vec3& cameraPosition,
+              float farPlane,
+              const Framebuffer& sceneDepth,
+              const Framebuffer& target);
+
+  inline std::size_t getProgramCount() const { return m_programs.size(); }
+  // Of the last Render()
+  inline std::size_t getMeshedCount() const { return m_meshedCount; }
+  // Some program is still compiling, shapes using it aren't drawn yet
+  bool isCompiling() const;
+  inline GpuTimer& getPrepassTimer() { return *m_prepassTimer; }
+  inline GpuTimer& getMarchTimer() { return *m_marchTimer; }
+
+  private:
+  struct Program
+  {
+    std::unique_ptr<Shader> shader;
+    std::unique_ptr<Shader> prepass;
+    bool blockBound{false};
+  };
+
+  const Program* programFor(const SDFObject& sdf, bool bakeParameters);
+
+  std::string m_templatePath;
+  std::unique_ptr<StreamBuffer> m_parameters;
+  std::vector<glm::vec4> m_scratch;
+  std::unordered_map<std::uint64_t, Program> m_programs;
+  // Every baked shape samples its textures with the same code
+  Program m_brickProgram;
+  std::unique_ptr<Shader> m_meshShader;
+  std::size_t m_meshedCount = 0;
+
+  std::unique_ptr<Framebuffer> m_prepass;
+  std::unique_ptr<GpuTimer> m_prepassTimer;
+  std::unique_ptr<GpuTimer> m_marchTimer;
+};
@@ -0,0 +1,119 @@
+#include "spatial_index_system.h"
+
+#include "../component/bounds.h"
+#include "../component/world_transform.h"
+#include "../coordinator.h"
+
+#include <cmath>
+
+extern Coordinator g_coordinator;
+
+namespace
+{
+Bounds::Sphere worldSphere(Entity entity)
+{
+  return g_coordinator.GetComponent<Bounds>(entity).worldSphere(
+      g_coordinator.GetComponent<WorldTransform>(entity).matrix);
+}
+
+// Distance along a normalized ray to the sphere, negative on a miss
+float raySphere(const glm::vec3& origin, const glm::vec3& direction, const Bounds::Sphere& sphere)
+{
+  const glm::vec3 toOrigin = origin - sphere.center;
+  const float b = glm::dot(toOrigin, direction);
+  const float c = glm::dot(toOrigin, toOrigin) - sphere.radius * sphere.radius;
+  const float discriminant = b * b - c;
+  if (discriminant < 0.0f)
+    return -1.0f;
+
+  const float t = -b - std::sqrt(discriminant);
+  if (t + 2.0f * std::sqrt(discriminant) < 0.0f)
+    return -1.0f;  // sphere entirely behind the origin
+
+  // Starting inside the sphere counts as a hit at the origin
+  return std::max(t, 0.0f);
+}
+}  // namespace
+
+void SpatialIndexSystem::Init(JobSystem* jobs)
+{
+  m_jobs = jobs;
+}
+
+void SpatialIndexSystem::Update()
+{
+  // Entities that lost WorldTransform or Bounds, or were destroyed
+  m_removed.clear();
+  for (const auto& [entity, proxy] : m_proxies)
+  {
+    if (!m_entities.contains(entity))
+      m_removed.push_back(entity);
+  }
+  for (Entity entity : m_removed)
+  {
+    m_bvh.destroyProxy(m_proxies[entity]);
+    m_proxies.erase(entity);
+  }
+
+  for (auto& entity : m_entities)
+  {
+    // pick() and nearest() test the sphere, queryOverlap() the box, the leaf holds both
+    const AABB bounds = g_coordinator.GetComponent<Bounds>(entity).worldEnclosing(
+        g_coordinator.GetComponent<WorldTransform>(entity).matrix);
+
+    auto it = m_proxies.find(entity);
+    if (it == m_proxies.end())
+      m_proxies.emplace(entity, m_bvh.createProxy(bounds, entity));
+    else
+      m_bvh.updateProxy(it->second, bounds);
+  }
+
+  m_bvh.update(m_jobs);
+}
+
+std::optional<Entity> SpatialIndexSystem::pick(const glm::vec3& origin,
+                                               const glm::vec3& direction,
+                                               float maxDistance) const
+{
+  const glm::vec3 dir = glm::normalize(direction);
+  auto intersect = [&](std::int32_t proxy, float)
+  { return raySphere(origin, dir, worldSphere(m_bvh.getUserData(proxy))); };
+
+  auto hit = m_bvh.raycast(origin, dir, maxDistance, intersect);
+
+  if (!hit)
+    return std::nullopt;
+  return static_cast<Entity>(m_bvh.getUserData(hit.proxy));
+}
+
+void SpatialIndexSystem::queryOverlap(const AABB& bounds, std::vector<Entity>& entities) const
+{
+  m_bvh.queryOverlap(bounds,
+                     [&](std::int32_t proxy)
+                     {
+                       const auto entity = static_cast<Entity>(m_bvh.getUserData(proxy));
+                       const auto& world = g_coordinator.GetComponent<WorldTransform>(entity);
+                       const auto& entityBounds = g_coordinator.GetComponent<Bounds>(entity);
+
+                       // The tree stores fattened bounds, check the real ones
+                       if (entityBounds.worldBox(world.matrix).intersects(bounds))
+                         entities.push_back(entity);
+                       return true;
+                     });
+}
+
+std::optional<Entity> SpatialIndexSystem::nearest(const glm::vec3& point, float maxDistance) const
+{
+  auto hit = m_bvh.nearest(point,
+                           maxDistance,
+                           [&](std::int32_t proxy)
+                           {
+                             const Bounds::Sphere sphere = worldSphere(m_bvh.getUserData(proxy));
+                             return std::max(glm::distance(point, sphere.center) - sphere.radius,
+                                             0.0f);
+                           });
+
+  if (!hit)
+    return std::nullopt;
+  return static_cast<Entity>(m_bvh.getUserData(hit.proxy));
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../bvh.h"
+#include "../system_manager.h"
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+// Keeps a DynamicBvh in sync with the world bounds of every entity with WorldTransform + Bounds
+// and answers spatial queries (picking, overlap, nearest) against it. Run after TransformSystem.
+class SpatialIndexSystem : public System
+{
+  public:
+  void Init(JobSystem* jobs);
+
+  // Adds/removes proxies for entities that came or went, refits the ones that moved
+  void Update();
+
+  // Closest entity whose world bounding sphere the ray hits
+  std::optional<Entity> pick(const glm::vec3& origin,
+                             const glm::vec3& direction,
+                             float maxDistance) const;
+  // Entities whose world bounds overlap the box
+  void queryOverlap(const AABB& bounds, std::vector<Entity>& entities) const;
+  // Entity whose world bounding sphere surface is closest to the point
+  std::optional<Entity> nearest(const glm::vec3& point, float maxDistance) const;
+
+  inline const DynamicBvh& getBvh() const { return m_bvh; }
+
+  private:
+  JobSystem* m_jobs{nullptr};
+  DynamicBvh m_bvh;
+  std::unordered_map<Entity, std::int32_t> m_proxies;
+  std::vector<Entity> m_removed;
+};
@@ -0,0 +1,97 @@
+#include "transform_system.h"
+
+#include "../component/hierarchy.h"
+#include "../component/transform.h"
+#include "../component/world_transform.h"
+#include "../coordinator.h"
+
+#include <algorithm>
+#include <cassert>
+
+extern Coordinator g_coordinator;
+
+void TransformSystem::Init(JobSystem* jobs)
+{
+  m_jobs = jobs;
+}
+
+void TransformSystem::setParent(Entity child, Entity parent)
+{
+  assert(child != parent && "Entity parented to itself.");
+  for (Entity ancestor = parent; g_coordinator.HasComponent<Parent>(ancestor);)
+  {
+    ancestor = g_coordinator.GetComponent<Parent>(ancestor).entity;
+    assert(ancestor != child && "Parenting would make a cycle.");
+  }
+
+  detach(child);
+  g_coordinator.AddComponent(child, Parent{parent});
+  if (!g_coordinator.HasComponent<Children>(parent))
+    g_coordinator.AddComponent(parent, Children{});
+  g_coordinator.GetComponent<Children>(parent).entities.push_back(child);
+  m_structureChanged = true;
+}
+
+void TransformSystem::detach(Entity child)
+{
+  if (!g_coordinator.HasComponent<Parent>(child))
+    return;
+
+  const Entity parent = g_coordinator.GetComponent<Parent>(child).entity;
+  g_coordinator.RemoveComponent<Parent>(child);
+  if (g_coordinator.HasComponent<Children>(parent))
+  {
+    auto& siblings = g_coordinator.GetComponent<Children>(parent).entities;
+    std::erase(siblings, child);
+    if (siblings.empty())
+      g_coordinator.RemoveComponent<Children>(parent);
+  }
+  m_structureChanged = true;
+}
+
+void TransformSystem::rebuild()
+{
+  m_nodes.assign(m_entities.begin(), m_entities.end());
+  m_nodeIndices.clear();
+  for (std::uint32_t node = 0; node < m_nodes.size(); node++)
+    m_nodeIndices.emplace(m_nodes[node], node);
+
+  // Parents without a transform of their own (or gone) leave their children at the root
+  m_parents.assign(m_nodes.size(), TransformHierarchy::NO_PARENT);
+  for (std::uint32_t node = 0; node < m_nodes.size(); node++)
+  {
+    if (!g_coordinator.HasComponent<Parent>(m_nodes[node]))
+      continue;
+    auto it = m_nodeIndices.find(g_coordinator.GetComponent<Parent>(m_nodes[node]).entity);
+    if (it != m_nodeIndices.end())
+      m_parents[node] = it->second;
+  }
+  m_hierarchy.build(m_parents);
+  m_structureChanged = false;
+}
+
+void TransformSystem::Update()
+{
+  // Entities coming and going change the structure as much as reparenting does
+  if (m_structureChanged ||
+      !std::equal(m_entities.begin(), m_entities.end(), m_nodes.begin(), m_nodes.end()))
+    rebuild();
+
+  for (std::uint32_t node = 0; node < m_nodes.size(); node++)
+    m_hierarchy.setLocal(node, g_coordinator.GetComponent<Transform>(m_nodes[node]));
+  m_updatedCount = m_hierarchy.update(m_jobs);
+
+  if (m_updatedCount == 0)
+    return;
+  for (std::uint32_t node = 0; node < m_nodes.size(); node++)
+  {
+    if (m_hierarchy.wasUpdated(node))
+      g_coordinator.GetComponent<WorldTransform>(m_nodes[node]).matrix = m_hierarchy.getWorld(node);
+  }
+}
+
+bool TransformSystem::wasUpdated(Entity entity) const
+{
+  auto it = m_nodeIndices.find(entity);
+  return it != m_nodeIndices.end() && m_hierarchy.wasUpdated(it->second);
+}
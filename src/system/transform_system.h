@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../system_manager.h"
+#include "../transform_hierarchy.h"
+
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+
+// Keeps the WorldTransform of every entity with Transform + WorldTransform up to date, following
+// Parent links. Only entities whose Transform changed since the last Update, and everything
+// attached under them, get their world matrix recomputed and written back.
+class TransformSystem : public System
+{
+  public:
+  void Init(JobSystem* jobs);
+
+  void Update();
+
+  // Moves child under parent, or to the root with detach(). The child's Transform becomes
+  // relative to the new parent as it is, it isn't adjusted to keep the world position.
+  void setParent(Entity child, Entity parent);
+  void detach(Entity child);
+
+  // World matrices recomputed by the last Update
+  inline std::size_t getUpdatedCount() const { return m_updatedCount; }
+  // Whether the last Update recomputed the entity's world matrix
+  bool wasUpdated(Entity entity) const;
+
+  private:
+  void rebuild();
+
+  JobSystem* m_jobs{nullptr};
+  TransformHierarchy m_hierarchy;
+  // Entities in node order, and the other way round
+  std::vector<Entity> m_nodes;
+  std::unordered_map<Entity, std::uint32_t> m_nodeIndices;
+  std::vector<std::uint32_t> m_parents;
+  bool m_structureChanged{true};
+  std::size_t m_updatedCount{0};
+};
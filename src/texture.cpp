@@ -1,7 +1,14 @@
 #include "texture.h"
 
+#include "block_compression.h"
+#include "gl_extensions.h"
+#include "texture_container.h"
+
 #include <glad/glad.h>
 
+#include <iostream>
+#include <utility>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
@@ -11,7 +18,10 @@ Texture::Texture(const std::string& filepath, bool has_alpha)
       m_localBuffer(nullptr),
       m_width(0),
       m_height(0),
-      m_BPP(0)
+      m_BPP(0),
+      m_status(TextureStatus::Ready),
+      m_mipCount(1),
+      m_residentMip(0)
 {
   stbi_set_flip_vertically_on_load(true);
   m_localBuffer = stbi_load(m_filepath.c_str(), &m_width, &m_height, &m_BPP, 0);
@@ -32,21 +42,144 @@ Texture::Texture(const std::string& filepath, bool has_alpha)
   glGenerateMipmap(GL_TEXTURE_2D);
   glBindTexture(GL_TEXTURE_2D, 0);
 
+  if (!m_localBuffer)
+    m_status = TextureStatus::Failed;
+
   if (m_localBuffer)
   {
     stbi_image_free(m_localBuffer);
   }
 }
 
+Texture::Texture(const std::string& cookedFilepath)
+    : m_rendererID(0),
+      m_filepath(cookedFilepath),
+      m_localBuffer(nullptr),
+      m_width(0),
+      m_height(0),
+      m_BPP(0),
+      m_status(TextureStatus::Failed),
+      m_mipCount(0),
+      m_residentMip(0)
+{
+  TextureContainer::View container;
+  if (!container.open(cookedFilepath))
+  {
+    std::cerr << "ERROR::TEXTURE::LOAD_FAILED " << cookedFilepath << std::endl;
+    return;
+  }
+
+  using TextureContainer::Format;
+  const auto& header = container.getHeader();
+  m_width = header.width;
+  m_height = header.height;
+  m_BPP = header.format == Format::RGB8 ? 3 : 4;
+  m_mipCount = header.mipCount;
+
+  glGenTextures(1, &m_rendererID);
+  glBindTexture(GL_TEXTURE_2D, m_rendererID);
+  for (std::uint32_t level = 0; level < header.mipCount; level++)
+    uploadCookedLevel(container, level, level);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_mipCount - 1);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  m_status = TextureStatus::Ready;
+}
+
+void Texture::uploadCookedLevel(const TextureContainer::View& container,
+                                std::uint32_t level,
+                                int glLevel)
+{
+  using TextureContainer::Format;
+  const auto& header = container.getHeader();
+  const auto& mip = header.mips[level];
+  const unsigned char* data = container.getMipData(level);
+
+  // Without S3TC in the driver, compressed levels are expanded on the CPU instead
+  const bool compressed = TextureContainer::isCompressed(header.format);
+  const bool native = compressed && GLExtensions::isSupported("GL_EXT_texture_compression_s3tc");
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  if (native)
+  {
+    const GLenum internalFormat = header.format == Format::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+                                                               : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    glCompressedTexImage2D(
+        GL_TEXTURE_2D, glLevel, internalFormat, mip.width, mip.height, 0, mip.size, data);
+  }
+  else if (compressed)
+  {
+    const auto blockFormat = header.format == Format::BC1 ? BlockCompression::Format::BC1
+                                                          : BlockCompression::Format::BC3;
+    const auto rgba = BlockCompression::decompress(blockFormat, data, mip.width, mip.height);
+    glTexImage2D(GL_TEXTURE_2D,
+                 glLevel,
+                 GL_RGBA,
+                 mip.width,
+                 mip.height,
+                 0,
+                 GL_RGBA,
+                 GL_UNSIGNED_BYTE,
+                 rgba.data());
+  }
+  else
+  {
+    const GLenum format = header.format == Format::RGB8 ? GL_RGB : GL_RGBA;
+    glTexImage2D(
+        GL_TEXTURE_2D, glLevel, format, mip.width, mip.height, 0, format, GL_UNSIGNED_BYTE, data);
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+Texture::Texture(std::string filepath, Pending)
+    : m_rendererID(0),
+      m_filepath(std::move(filepath)),
+      m_localBuffer(nullptr),
+      m_width(0),
+      m_height(0),
+      m_BPP(0),
+      m_status(TextureStatus::Loading),
+      m_mipCount(0),
+      m_residentMip(0)
+{
+}
+
 Texture::~Texture()
 {
   glDeleteTextures(1, &m_rendererID);
 }
 
+unsigned int Texture::getPlaceholder()
+{
+  static unsigned int placeholder = 0;
+  if (!placeholder)
+  {
+    const unsigned char pixels[] = {128, 128, 128, 200, 200, 200, 200, 200, 200, 128, 128, 128};
+    glGenTextures(1, &placeholder);
+    glBindTexture(GL_TEXTURE_2D, placeholder);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 2, 2, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+  return placeholder;
+}
+
 void Texture::bind(unsigned int slot) const
 {
+  // Loading textures have storage but nothing to sample until the first mip lands
+  const bool resident =
+      m_rendererID && m_status != TextureStatus::Failed && m_residentMip < m_mipCount;
   glActiveTexture(GL_TEXTURE0 + slot);
-  glBindTexture(GL_TEXTURE_2D, m_rendererID);
+  glBindTexture(GL_TEXTURE_2D, resident ? m_rendererID : getPlaceholder());
 }
 
 void Texture::unbind() const
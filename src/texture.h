@@ -1,22 +1,70 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
+namespace TextureContainer
+{
+class View;
+}
+
+enum class TextureStatus
+{
+  Loading,
+  Ready,
+  Failed
+};
+
 class Texture
 {
   public:
+  // Decodes and uploads synchronously. Use TextureLoader to keep this off the main thread.
   Texture(const std::string& filepath, bool has_alpha);
+  // Cooked container from tools/texture_cooker: mapped and uploaded as is, mips included
+  explicit Texture(const std::string& cookedFilepath);
   ~Texture();
 
+  Texture(const Texture&) = delete;
+  Texture& operator=(const Texture&) = delete;
+
+  // Binds the placeholder until at least one mip level has been uploaded
   void bind(unsigned int slot = 0) const;
   void unbind() const;
 
   inline int getWidth() const { return m_width; }
   inline int getHeight() const { return m_height; }
+  inline const std::string& getFilepath() const { return m_filepath; }
+
+  inline TextureStatus getStatus() const { return m_status; }
+  inline bool isReady() const { return m_status == TextureStatus::Ready; }
+  // Finest mip level uploaded so far, equal to getMipCount() while nothing is resident
+  inline int getResidentMip() const { return m_residentMip; }
+  inline int getMipCount() const { return m_mipCount; }
+
+  // 2x2 grey checker shown while textures stream in
+  static unsigned int getPlaceholder();
 
   private:
+  friend class TextureLoader;
+  friend class TextureManager;
+
+  // Empty texture filled in over several frames by TextureLoader
+  struct Pending
+  {
+  };
+  Texture(std::string filepath, Pending);
+
+  // Defines `glLevel` of the bound texture from a level of a cooked container
+  static void uploadCookedLevel(const TextureContainer::View& container,
+                                std::uint32_t level,
+                                int glLevel);
+
   unsigned int m_rendererID;
   std::string m_filepath;
   unsigned char* m_localBuffer;
   int m_width, m_height, m_BPP;
+
+  TextureStatus m_status;
+  int m_mipCount;
+  int m_residentMip;
 };
@@ -0,0 +1,96 @@
+#include "texture_array.h"
+
+#include "image_util.h"
+#include "texture_loader.h"
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+TextureArray::TextureArray(const TextureAtlas& atlas)
+    : m_rendererID(0),
+      m_width(atlas.getLayerWidth()),
+      m_height(atlas.getLayerHeight()),
+      m_layerCount(atlas.getLayerCount())
+{
+  glGenTextures(1, &m_rendererID);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, m_rendererID);
+
+  // Level 0 for every layer at once, then fill the layers in one by one
+  glTexImage3D(GL_TEXTURE_2D_ARRAY,
+               0,
+               GL_RGBA8,
+               m_width,
+               m_height,
+               m_layerCount,
+               0,
+               GL_RGBA,
+               GL_UNSIGNED_BYTE,
+               nullptr);
+  for (int layer = 0; layer < m_layerCount; layer++)
+  {
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+                    0,
+                    0,
+                    0,
+                    layer,
+                    m_width,
+                    m_height,
+                    1,
+                    GL_RGBA,
+                    GL_UNSIGNED_BYTE,
+                    atlas.getLayer(layer).data());
+  }
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+  // Regions never wrap, sampling stays inside their rect and gutter
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, atlas.getMipCount() - 1);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+TextureArray::~TextureArray()
+{
+  glDeleteTextures(1, &m_rendererID);
+}
+
+TextureAtlas TextureArray::packFiles(const std::vector<std::string>& filepaths,
+                                     int layerWidth,
+                                     int layerHeight,
+                                     int padding)
+{
+  TextureAtlas atlas(layerWidth, layerHeight, padding);
+  for (const std::string& filepath : filepaths)
+  {
+    // The loader builds a mip chain as well, only the base level is packed
+    TextureLoader::DecodedImage image = TextureLoader::decode(filepath);
+    if (image.mips.empty())
+    {
+      std::cerr << "ERROR::TEXTURE::LOAD_FAILED " << filepath << std::endl;
+      std::vector<unsigned char> magenta;
+      for (int p = 0; p < 16; p++)
+        magenta.insert(magenta.end(), {255, 0, 255, 255});
+      atlas.add(std::move(magenta), 4, 4);
+      continue;
+    }
+    atlas.add(ImageUtil::toRGBA(image.mips[0].data(), image.width, image.height, image.channels),
+              image.width,
+              image.height);
+  }
+  atlas.build();
+  return atlas;
+}
+
+void TextureArray::bind(unsigned int slot) const
+{
+  glActiveTexture(GL_TEXTURE0 + slot);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, m_rendererID);
+}
+
+void TextureArray::unbind() const
+{
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
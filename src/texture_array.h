@@ -0,0 +1,38 @@
+#pragma once
+
+#include "texture_atlas.h"
+
+#include <string>
+#include <vector>
+
+// GL_TEXTURE_2D_ARRAY holding the layers of a TextureAtlas.
+// Everything drawn with it shares one bind, materials pick their texture with a TextureRegion.
+class TextureArray
+{
+  public:
+  explicit TextureArray(const TextureAtlas& atlas);
+  ~TextureArray();
+
+  TextureArray(const TextureArray&) = delete;
+  TextureArray& operator=(const TextureArray&) = delete;
+
+  // Decodes the images with TextureLoader::decode() and packs them, region ids follow the file
+  // order. Files that fail to decode get a small magenta region so they stand out. Doesn't
+  // touch GL, submit it to the job system and build the array from the result once it's ready.
+  static TextureAtlas packFiles(const std::vector<std::string>& filepaths,
+                                int layerWidth,
+                                int layerHeight,
+                                int padding = TextureAtlas::DEFAULT_PADDING);
+
+  void bind(unsigned int slot = 0) const;
+  void unbind() const;
+
+  inline int getWidth() const { return m_width; }
+  inline int getHeight() const { return m_height; }
+  inline int getLayerCount() const { return m_layerCount; }
+
+  private:
+  unsigned int m_rendererID;
+  int m_width, m_height;
+  int m_layerCount;
+};
@@ -0,0 +1,171 @@
+#include "texture_atlas.h"
+
+#include "image_util.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <utility>
+
+namespace
+{
+int alignUp(int value, int alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+AtlasPacker::AtlasPacker(int width, int height, int padding, int alignment)
+    : m_width(width), m_height(height), m_padding(padding), m_alignment(alignment)
+{
+  assert(padding % alignment == 0 && "Padding has to keep rects on the alignment grid.");
+}
+
+std::optional<glm::ivec2> AtlasPacker::pack(int width, int height)
+{
+  const int footprintWidth = alignUp(width + 2 * m_padding, m_alignment);
+  const int footprintHeight = alignUp(height + 2 * m_padding, m_alignment);
+
+  // Lowest shelf that still has room, so tall shelves aren't filled with short rects
+  Shelf* best = nullptr;
+  for (Shelf& shelf : m_shelves)
+  {
+    if (shelf.height >= footprintHeight && shelf.x + footprintWidth <= m_width &&
+        (!best || shelf.height < best->height))
+      best = &shelf;
+  }
+
+  if (!best)
+  {
+    const int y = m_shelves.empty() ? 0 : m_shelves.back().y + m_shelves.back().height;
+    if (y + footprintHeight > m_height || footprintWidth > m_width)
+      return std::nullopt;
+    best = &m_shelves.emplace_back(Shelf{y, footprintHeight, 0});
+  }
+
+  const glm::ivec2 corner(best->x + m_padding, best->y + m_padding);
+  best->x += footprintWidth;
+  return corner;
+}
+
+void AtlasPacker::reset()
+{
+  m_shelves.clear();
+}
+
+TextureAtlas::TextureAtlas(int layerWidth, int layerHeight, int padding)
+    : m_layerWidth(layerWidth), m_layerHeight(layerHeight), m_padding(padding), m_mipCount(0)
+{
+  assert(std::has_single_bit(static_cast<unsigned int>(padding)) &&
+         "Atlas padding has to be a power of two.");
+}
+
+std::size_t TextureAtlas::add(std::vector<unsigned char> rgba, int width, int height)
+{
+  m_images.push_back({std::move(rgba), width, height});
+  return m_images.size() - 1;
+}
+
+void TextureAtlas::blit(std::vector<unsigned char>& layer,
+                        const Image& image,
+                        glm::ivec2 corner) const
+{
+  // The gutter repeats the edge texels so filtering and the first few mips stay clean. It fills
+  // the whole footprint the packer rounded up to the grid, the coarsest texels average all of it.
+  const int right = alignUp(image.width + 2 * m_padding, m_padding) - m_padding;
+  const int bottom = alignUp(image.height + 2 * m_padding, m_padding) - m_padding;
+  for (int y = -m_padding; y < bottom; y++)
+  {
+    const int srcY = std::clamp(y, 0, image.height - 1);
+    const int dstY = corner.y + y;
+    for (int x = -m_padding; x < right; x++)
+    {
+      const int srcX = std::clamp(x, 0, image.width - 1);
+      const int dstX = corner.x + x;
+      const unsigned char* src = &image.rgba[(srcY * image.width + srcX) * 4];
+      std::copy(src, src + 4, &layer[(dstY * m_layerWidth + dstX) * 4]);
+    }
+  }
+}
+
+void TextureAtlas::build()
+{
+  const size_t layerSize = static_cast<size_t>(m_layerWidth) * m_layerHeight * 4;
+  m_regions.assign(m_images.size(), {});
+  m_layers.clear();
+
+  auto shrink = [](Image& image)
+  {
+    image.rgba = ImageUtil::halve(image.rgba.data(), image.width, image.height, 4);
+    image.width = std::max(image.width / 2, 1);
+    image.height = std::max(image.height / 2, 1);
+  };
+
+  std::vector<size_t> packed;
+  for (size_t i = 0; i < m_images.size(); i++)
+  {
+    Image& image = m_images[i];
+    while (image.width > m_layerWidth || image.height > m_layerHeight)
+      shrink(image);
+
+    if (image.width == m_layerWidth && image.height == m_layerHeight)
+    {
+      m_regions[i].layer = static_cast<std::uint32_t>(m_layers.size());
+      m_layers.push_back(std::move(image.rgba));
+    }
+    else
+    {
+      packed.push_back(i);
+    }
+  }
+
+  // Tallest first keeps the shelves tight
+  std::stable_sort(packed.begin(),
+                   packed.end(),
+                   [&](size_t a, size_t b) { return m_images[a].height > m_images[b].height; });
+
+  std::vector<std::pair<AtlasPacker, std::uint32_t>> pages;
+  for (size_t i : packed)
+  {
+    Image& image = m_images[i];
+    std::optional<glm::ivec2> corner;
+    std::uint32_t layer = 0;
+    while (!corner)
+    {
+      for (auto& [packer, pageLayer] : pages)
+      {
+        if ((corner = packer.pack(image.width, image.height)))
+        {
+          layer = pageLayer;
+          break;
+        }
+      }
+      if (corner)
+        break;
+
+      AtlasPacker fresh(m_layerWidth, m_layerHeight, m_padding, m_padding);
+      if (fresh.pack(image.width, image.height))
+      {
+        fresh.reset();
+        pages.emplace_back(fresh, static_cast<std::uint32_t>(m_layers.size()));
+        m_layers.emplace_back(layerSize, 0);
+        continue;
+      }
+      // Almost layer sized, the gutter doesn't fit around it
+      shrink(image);
+    }
+
+    blit(m_layers[layer], image, *corner);
+    TextureRegion& region = m_regions[i];
+    region.layer = layer;
+    region.offset = glm::vec2(*corner) / glm::vec2(m_layerWidth, m_layerHeight);
+    region.scale = glm::vec2(image.width, image.height) / glm::vec2(m_layerWidth, m_layerHeight);
+  }
+
+  // At level n every texel covers 2^n texels of level 0, past the gutter it mixes neighbours
+  m_mipCount = ImageUtil::mipCount(m_layerWidth, m_layerHeight);
+  if (!pages.empty())
+    m_mipCount = std::min(m_mipCount, std::countr_zero(static_cast<unsigned int>(m_padding)) + 1);
+
+  m_images.clear();
+}
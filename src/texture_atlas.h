@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Where a texture ended up inside a TextureArray: layer plus the UV rect covering it.
+// Shaders sample at vec3(offset + uv * scale, layer).
+struct TextureRegion
+{
+  std::uint32_t layer{0};
+  glm::vec2 offset{0.0f};
+  glm::vec2 scale{1.0f};
+};
+
+// Shelf packer for a single fixed-size page. Rects are placed on a grid of `alignment` pixels
+// and keep `padding` pixels free on every side.
+class AtlasPacker
+{
+  public:
+  AtlasPacker(int width, int height, int padding, int alignment = 1);
+
+  // Top-left corner of the rect, nothing when the page is full
+  std::optional<glm::ivec2> pack(int width, int height);
+  void reset();
+
+  inline int getWidth() const { return m_width; }
+  inline int getHeight() const { return m_height; }
+
+  private:
+  struct Shelf
+  {
+    int y;
+    int height;
+    int x;
+  };
+
+  int m_width, m_height;
+  int m_padding;
+  int m_alignment;
+  std::vector<Shelf> m_shelves;
+};
+
+// Groups RGBA images into the layers of one texture array.
+// Images exactly the layer size get a layer of their own, smaller ones are packed together
+// into atlas pages and bigger ones are box filtered down until they fit. Atlas entries get
+// an edge-extended gutter, and the mip chain is cut short where it would start mixing
+// neighbouring entries.
+class TextureAtlas
+{
+  public:
+  static constexpr int DEFAULT_PADDING = 8;
+
+  // padding must be a power of two, it also sets the placement grid
+  TextureAtlas(int layerWidth, int layerHeight, int padding = DEFAULT_PADDING);
+
+  // Returns the id to look the region up with after build()
+  std::size_t add(std::vector<unsigned char> rgba, int width, int height);
+  void build();
+
+  inline const TextureRegion& getRegion(std::size_t id) const { return m_regions[id]; }
+  inline std::size_t getRegionCount() const { return m_regions.size(); }
+
+  inline int getLayerWidth() const { return m_layerWidth; }
+  inline int getLayerHeight() const { return m_layerHeight; }
+  inline int getLayerCount() const { return static_cast<int>(m_layers.size()); }
+  inline const std::vector<unsigned char>& getLayer(int layer) const { return m_layers[layer]; }
+  // Levels that are safe to sample, including level 0
+  inline int getMipCount() const { return m_mipCount; }
+
+  private:
+  struct Image
+  {
+    std::vector<unsigned char> rgba;
+    int width, height;
+  };
+
+  void blit(std::vector<unsigned char>& layer, const Image& image, glm::ivec2 corner) const;
+
+  int m_layerWidth, m_layerHeight;
+  int m_padding;
+  int m_mipCount;
+  std::vector<Image> m_images;
+  std::vector<TextureRegion> m_regions;
+  std::vector<std::vector<unsigned char>> m_layers;
+};
@@ -0,0 +1,108 @@
+#include "texture_container.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace TextureContainer
+{
+std::uint64_t levelSize(Format format, std::uint32_t width, std::uint32_t height)
+{
+  const std::uint64_t blocks = static_cast<std::uint64_t>((width + 3) / 4) * ((height + 3) / 4);
+  const std::uint64_t pixels = static_cast<std::uint64_t>(width) * height;
+  switch (format)
+  {
+    case Format::RGBA8:
+      return pixels * 4;
+    case Format::RGB8:
+      return pixels * 3;
+    case Format::BC1:
+      return blocks * 8;
+    case Format::BC3:
+      return blocks * 16;
+  }
+  return 0;
+}
+
+bool write(const std::string& filepath,
+           Format format,
+           int width,
+           int height,
+           const std::vector<std::vector<unsigned char>>& mips)
+{
+  if (mips.empty() || mips.size() > MAX_MIPS)
+    return false;
+
+  Header header{};
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.format = format;
+  header.width = width;
+  header.height = height;
+  header.mipCount = static_cast<std::uint32_t>(mips.size());
+
+  std::uint64_t offset = sizeof(Header);
+  for (std::uint32_t level = 0; level < header.mipCount; level++)
+  {
+    offset = (offset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+    header.mips[level] = {offset,
+                          mips[level].size(),
+                          static_cast<std::uint32_t>(std::max(1, width >> level)),
+                          static_cast<std::uint32_t>(std::max(1, height >> level))};
+    offset += mips[level].size();
+  }
+
+  std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  const char padding[DATA_ALIGNMENT] = {};
+  std::uint64_t written = sizeof(Header);
+  for (std::uint32_t level = 0; level < header.mipCount; level++)
+  {
+    file.write(padding, header.mips[level].offset - written);
+    file.write(reinterpret_cast<const char*>(mips[level].data()), mips[level].size());
+    written = header.mips[level].offset + mips[level].size();
+  }
+  return static_cast<bool>(file);
+}
+
+bool View::open(const std::string& filepath)
+{
+  m_header = nullptr;
+  if (!m_file.open(filepath) || m_file.size() < sizeof(Header))
+    return false;
+
+  // The mapping is page aligned, so the header can be used in place
+  const auto* header = reinterpret_cast<const Header*>(m_file.data());
+  if (header->magic != MAGIC || header->version != VERSION || header->mipCount == 0 ||
+      header->mipCount > MAX_MIPS || header->width == 0 || header->width > MAX_SIZE ||
+      header->height == 0 || header->height > MAX_SIZE || levelSize(header->format, 1, 1) == 0)
+  {
+    std::cerr << "ERROR::TEXTURE::BAD_CONTAINER " << filepath << std::endl;
+    m_file.close();
+    return false;
+  }
+  for (std::uint32_t level = 0; level < header->mipCount; level++)
+  {
+    const MipEntry& mip = header->mips[level];
+    // Each level is half the one before, and holds at least what its size calls for
+    const std::uint32_t width = std::max(1u, header->width >> level);
+    const std::uint32_t height = std::max(1u, header->height >> level);
+    if (mip.width != width || mip.height != height ||
+        mip.size < levelSize(header->format, width, height))
+    {
+      std::cerr << "ERROR::TEXTURE::BAD_CONTAINER " << filepath << std::endl;
+      m_file.close();
+      return false;
+    }
+    if (mip.offset > m_file.size() || mip.size > m_file.size() - mip.offset)
+    {
+      std::cerr << "ERROR::TEXTURE::TRUNCATED_CONTAINER " << filepath << std::endl;
+      m_file.close();
+      return false;
+    }
+  }
+
+  m_header = header;
+  return true;
+}
+}  // namespace TextureContainer
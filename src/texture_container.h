@@ -0,0 +1,85 @@
+#pragma once
+
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Cooked texture file (.tex) written by tools/texture_cooker.
+// A fixed-size header with a mip table is followed by the mip levels, finest first, each
+// aligned to DATA_ALIGNMENT. Loading is a map plus a header check; every level is already in
+// the layout glTexImage2D / glCompressedTexImage2D expects.
+namespace TextureContainer
+{
+inline constexpr std::uint32_t MAGIC = 0x43584554;  // "TEXC"
+inline constexpr std::uint32_t VERSION = 1;
+inline constexpr std::uint32_t MAX_MIPS = 16;
+inline constexpr std::uint32_t DATA_ALIGNMENT = 16;
+// Largest width or height, a full chain of it fits in MAX_MIPS
+inline constexpr std::uint32_t MAX_SIZE = 1u << (MAX_MIPS - 1);
+
+enum class Format : std::uint32_t
+{
+  RGBA8 = 0,
+  RGB8 = 1,
+  BC1 = 2,
+  BC3 = 3
+};
+
+struct MipEntry
+{
+  std::uint64_t offset;  // from the start of the file
+  std::uint64_t size;
+  std::uint32_t width;
+  std::uint32_t height;
+};
+
+struct Header
+{
+  std::uint32_t magic;
+  std::uint32_t version;
+  Format format;
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint32_t mipCount;
+  std::uint32_t reserved[2];
+  MipEntry mips[MAX_MIPS];
+};
+static_assert(sizeof(Header) == 32 + 24 * MAX_MIPS, "Header layout is part of the file format");
+
+inline bool isCompressed(Format format)
+{
+  return format == Format::BC1 || format == Format::BC3;
+}
+
+// Bytes a level of that size takes at least, 0 for a format this version doesn't know
+std::uint64_t levelSize(Format format, std::uint32_t width, std::uint32_t height);
+
+// Writes a container from pre-built levels, finest first
+bool write(const std::string& filepath,
+           Format format,
+           int width,
+           int height,
+           const std::vector<std::vector<unsigned char>>& mips);
+
+// Mapped view of a container, mip data points straight into the file mapping.
+// open() rejects unknown formats and levels whose size or dimensions don't add up, so every
+// level can be handed to GL or the BC decoder as it is.
+class View
+{
+  public:
+  bool open(const std::string& filepath);
+
+  inline bool isOpen() const { return m_header != nullptr; }
+  inline const Header& getHeader() const { return *m_header; }
+  inline const unsigned char* getMipData(std::uint32_t level) const
+  {
+    return m_file.data() + m_header->mips[level].offset;
+  }
+
+  private:
+  MappedFile m_file;
+  const Header* m_header = nullptr;
+};
+}  // namespace TextureContainer
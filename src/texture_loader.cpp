@@ -0,0 +1,224 @@
+#include "texture_loader.h"
+
+#include "image_util.h"
+#include "job_system.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "stb_image.h"
+
+namespace
+{
+GLenum formatFor(int channels)
+{
+  return channels == 4 ? GL_RGBA : GL_RGB;
+}
+}  // namespace
+
+TextureLoader::TextureLoader(JobSystem& jobs, unsigned int bytesPerFrame)
+    : m_jobs(jobs),
+      m_frameBudget(bytesPerFrame),
+      m_staging(GL_PIXEL_UNPACK_BUFFER, stagingBytes(bytesPerFrame)),
+      m_uploadedLastFrame(0)
+{
+}
+
+std::shared_ptr<Texture> TextureLoader::load(const std::string& filepath)
+{
+  // Texture's constructor is private to us, so no make_shared
+  std::shared_ptr<Texture> texture(new Texture(filepath, Texture::Pending{}));
+  m_decoding.push_back({texture, m_jobs.submit([filepath]() { return decode(filepath); })});
+  return texture;
+}
+
+TextureLoader::DecodedImage TextureLoader::decode(const std::string& filepath)
+{
+  DecodedImage image;
+
+  // The plain setter is global state shared with every other decoding thread
+  stbi_set_flip_vertically_on_load_thread(true);
+  unsigned char* pixels =
+      stbi_load(filepath.c_str(), &image.width, &image.height, &image.channels, 0);
+  if (!pixels)
+    return {};
+
+  // Grey and grey+alpha are widened so everything uploads as RGB or RGBA
+  const int channels = (image.channels == 2 || image.channels == 4) ? 4 : 3;
+  const size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+  std::vector<unsigned char> base(pixelCount * channels);
+  if (channels == image.channels)
+  {
+    std::memcpy(base.data(), pixels, base.size());
+  }
+  else
+  {
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+      const unsigned char* src = pixels + i * image.channels;
+      unsigned char* dst = base.data() + i * channels;
+      dst[0] = dst[1] = dst[2] = src[0];
+      if (channels == 4)
+        dst[3] = src[1];
+    }
+  }
+  stbi_image_free(pixels);
+
+  image.channels = channels;
+  image.mips = ImageUtil::buildMipChain(std::move(base), image.width, image.height, channels);
+  return image;
+}
+
+void TextureLoader::allocateStorage(Texture& texture, const DecodedImage& image)
+{
+  texture.m_width = image.width;
+  texture.m_height = image.height;
+  texture.m_BPP = image.channels;
+  texture.m_mipCount = static_cast<int>(image.mips.size());
+  texture.m_residentMip = texture.m_mipCount;
+
+  const GLenum format = formatFor(image.channels);
+  glGenTextures(1, &texture.m_rendererID);
+  glBindTexture(GL_TEXTURE_2D, texture.m_rendererID);
+  for (int level = 0; level < texture.m_mipCount; level++)
+  {
+    glTexImage2D(GL_TEXTURE_2D,
+                 level,
+                 format,
+                 std::max(1, image.width >> level),
+                 std::max(1, image.height >> level),
+                 0,
+                 format,
+                 GL_UNSIGNED_BYTE,
+                 nullptr);
+  }
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  // Sampling is clamped to the levels that have actually arrived
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture.m_mipCount - 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.m_mipCount - 1);
+}
+
+bool TextureLoader::uploadRows(Texture& texture, Upload& upload, unsigned int& budget)
+{
+  const auto& image = upload.image;
+  while (upload.level >= 0)
+  {
+    const int width = std::max(1, image.width >> upload.level);
+    const int height = std::max(1, image.height >> upload.level);
+    const unsigned int rowBytes = width * image.channels;
+
+    // Large levels are split into row bands so no single frame goes over budget
+    const int rows = bandRows(height - upload.row, rowBytes, budget);
+    if (rows <= 0)
+      return false;
+
+    const unsigned int bytes = rows * rowBytes;
+    StreamBuffer::Allocation staging = m_staging.allocate(bytes, STAGING_ALIGNMENT);
+    if (!staging)
+      return false;
+    std::memcpy(staging.data, &image.mips[upload.level][upload.row * rowBytes], bytes);
+    m_staging.flush();
+
+    const GLenum format = formatFor(image.channels);
+    glTexSubImage2D(GL_TEXTURE_2D,
+                    upload.level,
+                    0,
+                    upload.row,
+                    width,
+                    rows,
+                    format,
+                    GL_UNSIGNED_BYTE,
+                    reinterpret_cast<const void*>(static_cast<uintptr_t>(staging.offset)));
+    budget -= stagingBytes(bytes);
+    upload.row += rows;
+
+    if (upload.row == height)
+    {
+      texture.m_residentMip = upload.level;
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, upload.level);
+      upload.level--;
+      upload.row = 0;
+    }
+  }
+  return true;
+}
+
+void TextureLoader::update()
+{
+  // Pick up finished decodes without waiting on the ones still running
+  for (auto it = m_decoding.begin(); it != m_decoding.end();)
+  {
+    if (it->image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+      ++it;
+      continue;
+    }
+
+    DecodedImage image = it->image.get();
+    if (auto texture = it->texture.lock())
+    {
+      if (image.mips.empty())
+      {
+        std::cerr << "ERROR::TEXTURE::LOAD_FAILED " << texture->getFilepath() << std::endl;
+        texture->m_status = TextureStatus::Failed;
+      }
+      else if (bandRows(1, image.width * image.channels, m_frameBudget) == 0)
+      {
+        std::cerr << "ERROR::TEXTURE::ROW_EXCEEDS_UPLOAD_BUDGET " << texture->getFilepath()
+                  << std::endl;
+        texture->m_status = TextureStatus::Failed;
+      }
+      else
+      {
+        // Storage goes in now, while no unpack buffer is bound to source the null data from
+        allocateStorage(*texture, image);
+        const int level = static_cast<int>(image.mips.size()) - 1;
+        m_uploads.push_back({it->texture, std::move(image), level, 0});
+      }
+    }
+    it = m_decoding.erase(it);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  m_uploadedLastFrame = 0;
+  if (m_uploads.empty())
+    return;
+
+  m_staging.beginFrame();
+  m_staging.bind();
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  unsigned int budget = m_frameBudget;
+  while (!m_uploads.empty())
+  {
+    Upload& upload = m_uploads.front();
+    auto texture = upload.texture.lock();
+    if (!texture)
+    {
+      m_uploads.pop_front();
+      continue;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture->m_rendererID);
+    if (!uploadRows(*texture, upload, budget))
+      break;
+
+    texture->m_status = TextureStatus::Ready;
+    m_uploads.pop_front();
+  }
+
+  m_uploadedLastFrame = m_frameBudget - budget;
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  m_staging.unbind();
+  m_staging.endFrame();
+}
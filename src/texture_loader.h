@@ -0,0 +1,94 @@
+#pragma once
+
+#include "stream_buffer.h"
+#include "texture.h"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+// Streams textures in without stalling the main thread.
+// Images are decoded and their mip chains built on the JobSystem. update() then copies the
+// levels through a ring of pixel unpack buffers, coarsest first, and stops each frame once the
+// byte budget is spent. Textures bind a placeholder until their first level is resident and
+// report Ready once the full chain is up.
+class TextureLoader
+{
+  public:
+  static constexpr unsigned int DEFAULT_FRAME_BUDGET = 4 * 1024 * 1024;
+  // Every band of rows starts this aligned in the staging buffer
+  static constexpr unsigned int STAGING_ALIGNMENT = 4;
+
+  explicit TextureLoader(JobSystem& jobs, unsigned int bytesPerFrame = DEFAULT_FRAME_BUDGET);
+
+  TextureLoader(const TextureLoader&) = delete;
+  TextureLoader& operator=(const TextureLoader&) = delete;
+
+  // Returns straight away, the texture fills in over the following frames
+  std::shared_ptr<Texture> load(const std::string& filepath);
+
+  // Call once per frame on the thread that owns the GL context
+  void update();
+
+  inline bool isIdle() const { return m_decoding.empty() && m_uploads.empty(); }
+  inline size_t getPendingCount() const { return m_decoding.size() + m_uploads.size(); }
+  inline unsigned int getUploadedLastFrame() const { return m_uploadedLastFrame; }
+
+  // RGB or RGBA with the full mip chain, finest first. No mips when the file couldn't be read.
+  struct DecodedImage
+  {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<std::vector<unsigned char>> mips;
+  };
+
+  // Safe to call from any thread
+  static DecodedImage decode(const std::string& filepath);
+
+  // Staging bytes a band takes, padded so the next one starts aligned. RGB rows often aren't a
+  // multiple of 4, charging the unpadded size would run the buffer region out before the budget.
+  static inline unsigned int stagingBytes(unsigned int bytes)
+  {
+    return (bytes + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+  }
+  // Rows of the next band, at most rowsLeft and no more than budget holds once padded
+  static inline int bandRows(int rowsLeft, unsigned int rowBytes, unsigned int budget)
+  {
+    int rows = std::min<int>(rowsLeft, budget / rowBytes);
+    while (rows > 0 && stagingBytes(rows * rowBytes) > budget)
+      rows--;
+    return rows;
+  }
+
+  private:
+  struct Decode
+  {
+    std::weak_ptr<Texture> texture;
+    std::future<DecodedImage> image;
+  };
+
+  struct Upload
+  {
+    std::weak_ptr<Texture> texture;
+    DecodedImage image;
+    int level;
+    int row;
+  };
+
+  void allocateStorage(Texture& texture, const DecodedImage& image);
+  bool uploadRows(Texture& texture, Upload& upload, unsigned int& budget);
+
+  JobSystem& m_jobs;
+  unsigned int m_frameBudget;
+  StreamBuffer m_staging;
+
+  std::vector<Decode> m_decoding;
+  std::deque<Upload> m_uploads;
+  unsigned int m_uploadedLastFrame;
+};
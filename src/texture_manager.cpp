@@ -0,0 +1,373 @@
+#include "texture_manager.h"
+
+#include "gl_extensions.h"
+#include "job_system.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+bool isReady(const std::future<void>& future)
+{
+  return !future.valid() ||
+         future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+}  // namespace
+
+std::size_t TextureManager::Source::measureLevel(int level) const
+{
+  const int width = std::max(1, this->width >> level);
+  const int height = std::max(1, this->height >> level);
+
+  // Compressed levels stay compressed in VRAM, everything else ends up as RGBA8
+  if (nativeCompressed)
+    return container.getHeader().mips[level].size;
+  return static_cast<std::size_t>(width) * height * 4;
+}
+
+void TextureManager::Source::uploadLevel(int level, int glLevel) const
+{
+  if (isCooked())
+  {
+    Texture::uploadCookedLevel(container, level, glLevel);
+    return;
+  }
+
+  const GLenum format = image.channels == 4 ? GL_RGBA : GL_RGB;
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D,
+               glLevel,
+               format,
+               std::max(1, width >> level),
+               std::max(1, height >> level),
+               0,
+               format,
+               GL_UNSIGNED_BYTE,
+               image.mips[level].data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+TextureManager::TextureManager(JobSystem& jobs,
+                               std::size_t budgetBytes,
+                               unsigned int uploadBytesPerFrame)
+    : m_jobs(jobs),
+      m_budget(budgetBytes),
+      m_uploadBudget(uploadBytesPerFrame),
+      m_frame(1),
+      m_residentBytes(0),
+      m_uploadedLastFrame(0)
+{
+}
+
+TextureManager::~TextureManager()
+{
+  for (auto& entry : m_entries)
+  {
+    cancelRebuild(*entry);
+    if (entry->decoding.valid())
+      entry->decoding.wait();
+  }
+}
+
+std::shared_ptr<Texture> TextureManager::load(const std::string& filepath)
+{
+  std::shared_ptr<Texture> texture(new Texture(filepath, Texture::Pending{}));
+
+  auto entry = std::make_unique<Entry>();
+  entry->texture = texture;
+
+  // Cooked files only need their header checked, everything else is decoded on a worker
+  if (filepath.ends_with(".tex"))
+  {
+    entry->source = std::make_unique<Source>();
+    if (!entry->source->container.open(filepath))
+    {
+      std::cerr << "ERROR::TEXTURE::LOAD_FAILED " << filepath << std::endl;
+      texture->m_status = TextureStatus::Failed;
+      return texture;
+    }
+    const auto& header = entry->source->container.getHeader();
+    entry->source->width = header.width;
+    entry->source->height = header.height;
+    entry->source->mipCount = header.mipCount;
+    entry->source->nativeCompressed =
+        TextureContainer::isCompressed(header.format) &&
+        GLExtensions::isSupported("GL_EXT_texture_compression_s3tc");
+    finishDecode(*entry, *texture);
+  }
+  else
+  {
+    entry->decoding = m_jobs.submit([filepath]() { return TextureLoader::decode(filepath); });
+  }
+
+  m_lookup[texture.get()] = entry.get();
+  m_entries.push_back(std::move(entry));
+  return texture;
+}
+
+bool TextureManager::finishDecode(Entry& entry, Texture& texture)
+{
+  if (!entry.source)
+  {
+    if (entry.decoding.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      return false;
+
+    TextureLoader::DecodedImage image = entry.decoding.get();
+    if (image.mips.empty())
+    {
+      std::cerr << "ERROR::TEXTURE::LOAD_FAILED " << texture.getFilepath() << std::endl;
+      texture.m_status = TextureStatus::Failed;
+      return false;
+    }
+
+    entry.source = std::make_unique<Source>();
+    entry.source->width = image.width;
+    entry.source->height = image.height;
+    entry.source->mipCount = static_cast<int>(image.mips.size());
+    entry.source->image = std::move(image);
+  }
+
+  const Source& source = *entry.source;
+  texture.m_width = source.width;
+  texture.m_height = source.height;
+  texture.m_BPP = source.isCooked() ? 4 : source.image.channels;
+  texture.m_mipCount = source.mipCount;
+  texture.m_residentMip = source.mipCount;
+
+  for (int level = 0; level < source.mipCount; level++)
+    entry.source->levelSizes.push_back(source.measureLevel(level));
+
+  entry.tailMip = source.mipCount - 1;
+  while (entry.tailMip > 0 &&
+         std::max(source.width >> (entry.tailMip - 1), source.height >> (entry.tailMip - 1)) <=
+             MIN_RESIDENT_SIZE)
+    entry.tailMip--;
+  entry.targetMip = entry.tailMip;
+  entry.plannedMip = entry.tailMip;
+  return true;
+}
+
+void TextureManager::requestSize(const Texture& texture, float screenSize)
+{
+  auto it = m_lookup.find(&texture);
+  if (it == m_lookup.end())
+    return;
+
+  // Several draws of the same texture in a frame, the largest one decides
+  Entry& entry = *it->second;
+  if (entry.lastUsedFrame != m_frame || !entry.source)
+    entry.targetMip = entry.tailMip;
+  entry.lastUsedFrame = m_frame;
+  if (entry.source)
+  {
+    const int mip =
+        MipResidency::selectMip(entry.source->width, entry.source->height, screenSize);
+    entry.targetMip = std::min(entry.targetMip, std::min(mip, entry.tailMip));
+  }
+}
+
+std::size_t TextureManager::bytesFrom(const Entry& entry, int mip) const
+{
+  std::size_t bytes = 0;
+  for (int level = mip; level < entry.source->mipCount; level++)
+    bytes += entry.source->levelBytes(level);
+  return bytes;
+}
+
+void TextureManager::planResidency()
+{
+  m_plan.clear();
+  m_planned.clear();
+  for (auto& entry : m_entries)
+  {
+    auto texture = entry->texture.lock();
+    if (!entry->source || !texture)
+      continue;
+    m_plan.push_back({entry->source->levelSizes,
+                      texture->m_residentMip,
+                      entry->targetMip,
+                      entry->tailMip,
+                      entry->lastUsedFrame});
+    m_planned.push_back(entry.get());
+  }
+
+  MipResidency::plan(m_plan, m_budget);
+
+  for (std::size_t i = 0; i < m_planned.size(); i++)
+  {
+    Entry& entry = *m_planned[i];
+    entry.plannedMip = m_plan[i].plannedMip;
+    const int resident = entry.texture.lock()->m_residentMip;
+    if (entry.plannedMip == resident)
+      cancelRebuild(entry);
+    else if (!entry.rebuild.rendererID || entry.rebuild.baseMip != entry.plannedMip)
+      startRebuild(entry);
+  }
+}
+
+void TextureManager::startRebuild(Entry& entry)
+{
+  cancelRebuild(entry);
+
+  const Source& source = *entry.source;
+  Rebuild& rebuild = entry.rebuild;
+  rebuild.baseMip = entry.plannedMip;
+  rebuild.nextLevel = source.mipCount - 1;
+
+  glGenTextures(1, &rebuild.rendererID);
+  glBindTexture(GL_TEXTURE_2D, rebuild.rendererID);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, source.mipCount - 1 - rebuild.baseMip);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  // Fault the mapped levels in on a worker so the upload doesn't wait on the disk
+  if (source.isCooked())
+  {
+    const auto& header = source.container.getHeader();
+    const unsigned char* begin = source.container.getMipData(rebuild.baseMip);
+    const unsigned char* end = source.container.getMipData(source.mipCount - 1) +
+                               header.mips[source.mipCount - 1].size;
+    rebuild.prefetch = m_jobs.submit(
+        [begin, end]()
+        {
+          unsigned char sum = 0;
+          for (const unsigned char* page = begin; page < end; page += 4096)
+            sum += *reinterpret_cast<const volatile unsigned char*>(page);
+          (void)sum;
+        });
+  }
+}
+
+void TextureManager::cancelRebuild(Entry& entry)
+{
+  // The prefetch reads from the mapping, it has to be done before the source can go away
+  Rebuild& rebuild = entry.rebuild;
+  if (rebuild.prefetch.valid())
+    rebuild.prefetch.wait();
+  glDeleteTextures(1, &rebuild.rendererID);
+  rebuild = {};
+}
+
+bool TextureManager::uploadRebuild(Entry& entry, Texture& texture, unsigned int& budget)
+{
+  Rebuild& rebuild = entry.rebuild;
+  if (!isReady(rebuild.prefetch))
+    return false;
+
+  glBindTexture(GL_TEXTURE_2D, rebuild.rendererID);
+  while (rebuild.nextLevel >= rebuild.baseMip)
+  {
+    // A level bigger than the whole budget still goes through, on a frame of its own
+    const std::size_t bytes = entry.source->levelBytes(rebuild.nextLevel);
+    if (bytes > budget && budget < m_uploadBudget)
+      return false;
+
+    entry.source->uploadLevel(rebuild.nextLevel, rebuild.nextLevel - rebuild.baseMip);
+    budget -= static_cast<unsigned int>(std::min<std::size_t>(bytes, budget));
+    rebuild.nextLevel--;
+  }
+
+  // Complete, the old texture can go
+  glDeleteTextures(1, &texture.m_rendererID);
+  texture.m_rendererID = rebuild.rendererID;
+  texture.m_residentMip = rebuild.baseMip;
+  texture.m_status = TextureStatus::Ready;
+  entry.residentBytes = bytesFrom(entry, rebuild.baseMip);
+  if (rebuild.prefetch.valid())
+    rebuild.prefetch.get();
+  rebuild = {};
+  return true;
+}
+
+void TextureManager::update()
+{
+  // Forget textures nobody holds anymore, their GL objects went with them
+  std::erase_if(m_entries,
+                [&](std::unique_ptr<Entry>& entry)
+                {
+                  if (!entry->texture.expired())
+                    return false;
+                  cancelRebuild(*entry);
+                  if (entry->decoding.valid())
+                    entry->decoding.wait();
+                  std::erase_if(m_lookup,
+                                [&](const auto& item) { return item.second == entry.get(); });
+                  return true;
+                });
+
+  for (auto& entry : m_entries)
+  {
+    if (!entry->source && entry->decoding.valid())
+      finishDecode(*entry, *entry->texture.lock());
+  }
+
+  planResidency();
+
+  // Evictions go first since they free memory, then whatever was on screen most recently
+  std::vector<Entry*> rebuilds;
+  for (auto& entry : m_entries)
+  {
+    if (entry->rebuild.rendererID)
+      rebuilds.push_back(entry.get());
+  }
+  std::sort(rebuilds.begin(),
+            rebuilds.end(),
+            [](const Entry* a, const Entry* b)
+            {
+              const bool aEvicts = a->rebuild.baseMip > a->texture.lock()->m_residentMip;
+              const bool bEvicts = b->rebuild.baseMip > b->texture.lock()->m_residentMip;
+              if (aEvicts != bEvicts)
+                return aEvicts;
+              return a->lastUsedFrame > b->lastUsedFrame;
+            });
+
+  unsigned int budget = m_uploadBudget;
+  for (Entry* entry : rebuilds)
+  {
+    if (budget == 0)
+      break;
+    uploadRebuild(*entry, *entry->texture.lock(), budget);
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+  m_uploadedLastFrame = m_uploadBudget - budget;
+
+  m_residentBytes = 0;
+  for (const auto& entry : m_entries)
+    m_residentBytes += entry->residentBytes;
+  m_frame++;
+}
+
+bool TextureManager::getResidency(const Texture& texture, TextureResidency& residency) const
+{
+  auto it = m_lookup.find(&texture);
+  if (it == m_lookup.end())
+    return false;
+
+  const Entry& entry = *it->second;
+  residency.residentMip = texture.m_residentMip;
+  residency.targetMip = entry.targetMip;
+  residency.mipCount = texture.m_mipCount;
+  residency.residentBytes = entry.residentBytes;
+  residency.lastUsedFrame = entry.lastUsedFrame;
+  residency.streaming = entry.rebuild.rendererID != 0;
+  return true;
+}
+
+void TextureManager::forEachResidency(
+    const std::function<void(const Texture&, const TextureResidency&)>& fn) const
+{
+  for (const auto& entry : m_entries)
+  {
+    auto texture = entry->texture.lock();
+    TextureResidency residency;
+    if (texture && getResidency(*texture, residency))
+      fn(*texture, residency);
+  }
+}
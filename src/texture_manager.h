@@ -0,0 +1,134 @@
+#pragma once
+
+#include "mip_residency.h"
+#include "texture.h"
+#include "texture_container.h"
+#include "texture_loader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+
+// What a managed texture currently holds on the GPU
+struct TextureResidency
+{
+  int residentMip;  // finest level on the GPU
+  int targetMip;    // finest level the latest size feedback asked for
+  int mipCount;
+  std::size_t residentBytes;
+  std::uint64_t lastUsedFrame;
+  bool streaming;  // a different set of levels is being uploaded
+};
+
+// Keeps textures within a fixed GPU memory budget.
+// Only the levels an object needs at its current screen size are kept resident. The renderer
+// reports how large each texture is drawn with requestSize(), and update() streams finer
+// levels in when they become visible. When the budget runs out it drops levels from the least
+// recently used textures, starting with levels nobody is asking for anymore.
+//
+// GL 3.3 can't shrink a texture in place, so a change of levels builds a new texture in the
+// background and swaps it in once it's complete. Every level can be uploaded again at any
+// time: cooked containers (.tex) stay mapped, other images keep their decoded mips in memory.
+class TextureManager
+{
+  public:
+  static constexpr std::size_t DEFAULT_BUDGET = 256 * 1024 * 1024;
+  // Levels this size and smaller are always resident, so there's something to sample
+  static constexpr int MIN_RESIDENT_SIZE = 64;
+
+  explicit TextureManager(JobSystem& jobs,
+                          std::size_t budgetBytes = DEFAULT_BUDGET,
+                          unsigned int uploadBytesPerFrame = TextureLoader::DEFAULT_FRAME_BUDGET);
+  ~TextureManager();
+
+  TextureManager(const TextureManager&) = delete;
+  TextureManager& operator=(const TextureManager&) = delete;
+
+  // Returns straight away, the placeholder is bound until the coarse levels are in
+  std::shared_ptr<Texture> load(const std::string& filepath);
+
+  // Renderer feedback: the texture was drawn this frame covering about screenSize pixels, see
+  // MipResidency::projectedSize() for sizes from a distance
+  void requestSize(const Texture& texture, float screenSize);
+
+  // Call once per frame on the thread that owns the GL context
+  void update();
+
+  inline void setBudget(std::size_t bytes) { m_budget = bytes; }
+  inline std::size_t getBudget() const { return m_budget; }
+  inline std::size_t getResidentBytes() const { return m_residentBytes; }
+  inline unsigned int getUploadedLastFrame() const { return m_uploadedLastFrame; }
+
+  // False for textures this manager doesn't own
+  bool getResidency(const Texture& texture, TextureResidency& residency) const;
+  void forEachResidency(
+      const std::function<void(const Texture&, const TextureResidency&)>& fn) const;
+
+  private:
+  // Where levels come from when they have to be uploaded (again)
+  struct Source
+  {
+    TextureContainer::View container;
+    TextureLoader::DecodedImage image;
+
+    int width = 0;
+    int height = 0;
+    int mipCount = 0;
+    bool nativeCompressed = false;  // stays block compressed in VRAM
+    std::vector<std::size_t> levelSizes;  // VRAM taken by each level
+
+    bool isCooked() const { return container.isOpen(); }
+    std::size_t levelBytes(int level) const { return levelSizes[level]; }
+    std::size_t measureLevel(int level) const;
+    void uploadLevel(int level, int glLevel) const;
+  };
+
+  // Replacement texture holding levels [baseMip, mipCount), filled coarsest first
+  struct Rebuild
+  {
+    unsigned int rendererID = 0;
+    int baseMip = 0;
+    int nextLevel = -1;
+    std::future<void> prefetch;
+  };
+
+  struct Entry
+  {
+    std::weak_ptr<Texture> texture;
+    std::future<TextureLoader::DecodedImage> decoding;
+    std::unique_ptr<Source> source;
+    int tailMip = 0;
+    int targetMip = 0;
+    int plannedMip = 0;
+    std::size_t residentBytes = 0;
+    std::uint64_t lastUsedFrame = 0;
+    Rebuild rebuild;
+  };
+
+  bool finishDecode(Entry& entry, Texture& texture);
+  void planResidency();
+  void startRebuild(Entry& entry);
+  void cancelRebuild(Entry& entry);
+  bool uploadRebuild(Entry& entry, Texture& texture, unsigned int& budget);
+  std::size_t bytesFrom(const Entry& entry, int mip) const;
+
+  JobSystem& m_jobs;
+  std::size_t m_budget;
+  unsigned int m_uploadBudget;
+  std::uint64_t m_frame;
+  std::size_t m_residentBytes;
+  unsigned int m_uploadedLastFrame;
+
+  std::vector<std::unique_ptr<Entry>> m_entries;
+  std::unordered_map<const Texture*, Entry*> m_lookup;
+  // Scratch for planResidency(), m_planned[i] is the entry of m_plan[i]
+  std::vector<MipResidency::Item> m_plan;
+  std::vector<Entry*> m_planned;
+};
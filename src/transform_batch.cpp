@@ -0,0 +1,293 @@
+#include "transform_batch.h"
+
+#include "cpu_features.h"
+#include "job_system.h"
+
+#ifdef CPU_X86_64
+#include <immintrin.h>
+#endif
+
+namespace
+{
+using TransformMatrices::Layout;
+
+// Below this many transforms the job system costs more than it saves
+constexpr std::size_t PARALLEL_THRESHOLD = 32 * 1024;
+constexpr std::size_t PARALLEL_GRAIN = 16 * 1024;
+
+#ifdef CPU_X86_64
+// r[k] holds element k of 8 matrices, afterwards r[i] holds elements 0-7 of matrix i
+CPU_TARGET_AVX2 inline void transpose8(__m256 r[8])
+{
+  const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+  const __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+  const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+  const __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+  const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+  const __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+  const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+  const __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+  const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+  r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+  r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+  r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+  r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+  r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+  r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+  r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+  r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+CPU_TARGET_AVX2 void writeAVX2(const TransformBatch& batch,
+                               std::size_t first,
+                               std::size_t count,
+                               Layout layout,
+                               float* out)
+{
+  const std::size_t stride = TransformMatrices::floatsPerMatrix(layout);
+  const std::size_t end = first + count;
+  const std::size_t simdEnd = first + count / 8 * 8;
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+
+  for (std::size_t i = first; i < simdEnd; i += 8)
+  {
+    const __m256 x = _mm256_loadu_ps(&batch.qx[i]);
+    const __m256 y = _mm256_loadu_ps(&batch.qy[i]);
+    const __m256 z = _mm256_loadu_ps(&batch.qz[i]);
+    const __m256 w = _mm256_loadu_ps(&batch.qw[i]);
+    const __m256 x2 = _mm256_add_ps(x, x);
+    const __m256 y2 = _mm256_add_ps(y, y);
+    const __m256 z2 = _mm256_add_ps(z, z);
+    const __m256 xx = _mm256_mul_ps(x, x2);
+    const __m256 yy = _mm256_mul_ps(y, y2);
+    const __m256 zz = _mm256_mul_ps(z, z2);
+    const __m256 xy = _mm256_mul_ps(x, y2);
+    const __m256 xz = _mm256_mul_ps(x, z2);
+    const __m256 yz = _mm256_mul_ps(y, z2);
+    const __m256 wx = _mm256_mul_ps(w, x2);
+    const __m256 wy = _mm256_mul_ps(w, y2);
+    const __m256 wz = _mm256_mul_ps(w, z2);
+
+    // Same terms as glm::mat3_cast, each column times its scale
+    const __m256 sx = _mm256_loadu_ps(&batch.sx[i]);
+    const __m256 sy = _mm256_loadu_ps(&batch.sy[i]);
+    const __m256 sz = _mm256_loadu_ps(&batch.sz[i]);
+    const __m256 c0x = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx);
+    const __m256 c0y = _mm256_mul_ps(_mm256_add_ps(xy, wz), sx);
+    const __m256 c0z = _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx);
+    const __m256 c1x = _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy);
+    const __m256 c1y = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy);
+    const __m256 c1z = _mm256_mul_ps(_mm256_add_ps(yz, wx), sy);
+    const __m256 c2x = _mm256_mul_ps(_mm256_add_ps(xz, wy), sz);
+    const __m256 c2y = _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz);
+    const __m256 c2z = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz);
+    const __m256 px = _mm256_loadu_ps(&batch.px[i]);
+    const __m256 py = _mm256_loadu_ps(&batch.py[i]);
+    const __m256 pz = _mm256_loadu_ps(&batch.pz[i]);
+
+    float* dst = out + (i - first) * stride;
+    if (layout == Layout::MAT4)
+    {
+      __m256 low[8] = {c0x, c0y, c0z, zero, c1x, c1y, c1z, zero};
+      __m256 high[8] = {c2x, c2y, c2z, zero, px, py, pz, one};
+      transpose8(low);
+      transpose8(high);
+      for (int lane = 0; lane < 8; lane++)
+      {
+        _mm256_storeu_ps(dst + lane * 16, low[lane]);
+        _mm256_storeu_ps(dst + lane * 16 + 8, high[lane]);
+      }
+    }
+    else
+    {
+      // The first two rows go through the 8x8 transpose, the third through two 4x4 ones
+      __m256 rows[8] = {c0x, c1x, c2x, px, c0y, c1y, c2y, py};
+      transpose8(rows);
+      __m128 lowZ[4] = {_mm256_castps256_ps128(c0z),
+                        _mm256_castps256_ps128(c1z),
+                        _mm256_castps256_ps128(c2z),
+                        _mm256_castps256_ps128(pz)};
+      __m128 highZ[4] = {_mm256_extractf128_ps(c0z, 1),
+                         _mm256_extractf128_ps(c1z, 1),
+                         _mm256_extractf128_ps(c2z, 1),
+                         _mm256_extractf128_ps(pz, 1)};
+      _MM_TRANSPOSE4_PS(lowZ[0], lowZ[1], lowZ[2], lowZ[3]);
+      _MM_TRANSPOSE4_PS(highZ[0], highZ[1], highZ[2], highZ[3]);
+      for (int lane = 0; lane < 8; lane++)
+      {
+        _mm256_storeu_ps(dst + lane * 12, rows[lane]);
+        _mm_storeu_ps(dst + lane * 12 + 8, lane < 4 ? lowZ[lane] : highZ[lane - 4]);
+      }
+    }
+  }
+
+  TransformMatrices::writeScalar(
+      batch, simdEnd, end - simdEnd, layout, out + (simdEnd - first) * stride);
+}
+
+CPU_TARGET_SSE41 void writeSSE41(const TransformBatch& batch,
+                                 std::size_t first,
+                                 std::size_t count,
+                                 Layout layout,
+                                 float* out)
+{
+  const std::size_t stride = TransformMatrices::floatsPerMatrix(layout);
+  const std::size_t end = first + count;
+  const std::size_t simdEnd = first + count / 4 * 4;
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  for (std::size_t i = first; i < simdEnd; i += 4)
+  {
+    const __m128 x = _mm_loadu_ps(&batch.qx[i]);
+    const __m128 y = _mm_loadu_ps(&batch.qy[i]);
+    const __m128 z = _mm_loadu_ps(&batch.qz[i]);
+    const __m128 w = _mm_loadu_ps(&batch.qw[i]);
+    const __m128 x2 = _mm_add_ps(x, x);
+    const __m128 y2 = _mm_add_ps(y, y);
+    const __m128 z2 = _mm_add_ps(z, z);
+    const __m128 xx = _mm_mul_ps(x, x2);
+    const __m128 yy = _mm_mul_ps(y, y2);
+    const __m128 zz = _mm_mul_ps(z, z2);
+    const __m128 xy = _mm_mul_ps(x, y2);
+    const __m128 xz = _mm_mul_ps(x, z2);
+    const __m128 yz = _mm_mul_ps(y, z2);
+    const __m128 wx = _mm_mul_ps(w, x2);
+    const __m128 wy = _mm_mul_ps(w, y2);
+    const __m128 wz = _mm_mul_ps(w, z2);
+
+    const __m128 sx = _mm_loadu_ps(&batch.sx[i]);
+    const __m128 sy = _mm_loadu_ps(&batch.sy[i]);
+    const __m128 sz = _mm_loadu_ps(&batch.sz[i]);
+    __m128 c0x = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+    __m128 c0y = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+    __m128 c0z = _mm_mul_ps(_mm_sub_ps(xz, wy), sx);
+    __m128 c1x = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+    __m128 c1y = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+    __m128 c1z = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+    __m128 c2x = _mm_mul_ps(_mm_add_ps(xz, wy), sz);
+    __m128 c2y = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+    __m128 c2z = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+    __m128 px = _mm_loadu_ps(&batch.px[i]);
+    __m128 py = _mm_loadu_ps(&batch.py[i]);
+    __m128 pz = _mm_loadu_ps(&batch.pz[i]);
+
+    // Each 4x4 transpose turns four elements of four matrices into one vec4 per matrix
+    float* dst = out + (i - first) * stride;
+    if (layout == Layout::MAT4)
+    {
+      __m128 w0 = zero, w1 = zero, w2 = zero, w3 = one;
+      _MM_TRANSPOSE4_PS(c0x, c0y, c0z, w0);
+      _MM_TRANSPOSE4_PS(c1x, c1y, c1z, w1);
+      _MM_TRANSPOSE4_PS(c2x, c2y, c2z, w2);
+      _MM_TRANSPOSE4_PS(px, py, pz, w3);
+      const __m128 columns[4][4] = {
+          {c0x, c0y, c0z, w0}, {c1x, c1y, c1z, w1}, {c2x, c2y, c2z, w2}, {px, py, pz, w3}};
+      for (int lane = 0; lane < 4; lane++)
+      {
+        for (int column = 0; column < 4; column++)
+          _mm_storeu_ps(dst + lane * 16 + column * 4, columns[column][lane]);
+      }
+    }
+    else
+    {
+      _MM_TRANSPOSE4_PS(c0x, c1x, c2x, px);
+      _MM_TRANSPOSE4_PS(c0y, c1y, c2y, py);
+      _MM_TRANSPOSE4_PS(c0z, c1z, c2z, pz);
+      const __m128 rows[3][4] = {{c0x, c1x, c2x, px}, {c0y, c1y, c2y, py}, {c0z, c1z, c2z, pz}};
+      for (int lane = 0; lane < 4; lane++)
+      {
+        for (int row = 0; row < 3; row++)
+          _mm_storeu_ps(dst + lane * 12 + row * 4, rows[row][lane]);
+      }
+    }
+  }
+
+  TransformMatrices::writeScalar(
+      batch, simdEnd, end - simdEnd, layout, out + (simdEnd - first) * stride);
+}
+#endif
+}  // namespace
+
+namespace TransformMatrices
+{
+void writeScalar(const TransformBatch& batch,
+                 std::size_t first,
+                 std::size_t count,
+                 Layout layout,
+                 float* out)
+{
+  const std::size_t stride = floatsPerMatrix(layout);
+  for (std::size_t i = first; i < first + count; i++, out += stride)
+  {
+    const float x = batch.qx[i], y = batch.qy[i], z = batch.qz[i], w = batch.qw[i];
+    const float xx = 2.0f * x * x, yy = 2.0f * y * y, zz = 2.0f * z * z;
+    const float xy = 2.0f * x * y, xz = 2.0f * x * z, yz = 2.0f * y * z;
+    const float wx = 2.0f * w * x, wy = 2.0f * w * y, wz = 2.0f * w * z;
+    const float sx = batch.sx[i], sy = batch.sy[i], sz = batch.sz[i];
+
+    // m[column][row] of the affine matrix
+    const float m[4][3] = {{(1.0f - yy - zz) * sx, (xy + wz) * sx, (xz - wy) * sx},
+                           {(xy - wz) * sy, (1.0f - xx - zz) * sy, (yz + wx) * sy},
+                           {(xz + wy) * sz, (yz - wx) * sz, (1.0f - xx - yy) * sz},
+                           {batch.px[i], batch.py[i], batch.pz[i]}};
+    if (layout == Layout::MAT4)
+    {
+      for (int column = 0; column < 4; column++)
+      {
+        out[column * 4 + 0] = m[column][0];
+        out[column * 4 + 1] = m[column][1];
+        out[column * 4 + 2] = m[column][2];
+        out[column * 4 + 3] = column == 3 ? 1.0f : 0.0f;
+      }
+    }
+    else
+    {
+      for (int row = 0; row < 3; row++)
+      {
+        for (int column = 0; column < 4; column++)
+          out[row * 4 + column] = m[column][row];
+      }
+    }
+  }
+}
+
+void write(const TransformBatch& batch,
+           std::size_t first,
+           std::size_t count,
+           Layout layout,
+           float* out)
+{
+#ifdef CPU_X86_64
+  if (CpuFeatures::hasAVX2())
+    return writeAVX2(batch, first, count, layout, out);
+  if (CpuFeatures::hasSSE41())
+    return writeSSE41(batch, first, count, layout, out);
+#endif
+  writeScalar(batch, first, count, layout, out);
+}
+
+void write(const TransformBatch& batch, Layout layout, float* out, JobSystem* jobs)
+{
+  const std::size_t count = batch.size();
+  if (!jobs || count < PARALLEL_THRESHOLD)
+  {
+    write(batch, 0, count, layout, out);
+    return;
+  }
+
+  const std::size_t stride = floatsPerMatrix(layout);
+  jobs->parallelFor(count,
+                    PARALLEL_GRAIN,
+                    [&](std::size_t begin, std::size_t end)
+                    { write(batch, begin, end - begin, layout, out + begin * stride); });
+}
+}  // namespace TransformMatrices
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "component/transform.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+class JobSystem;
+
+// Local transforms in structure-of-arrays form for the batched matrix kernels
+struct TransformBatch
+{
+  std::vector<float> px, py, pz;
+  std::vector<float> qx, qy, qz, qw;
+  std::vector<float> sx, sy, sz;
+
+  std::size_t size() const { return px.size(); }
+
+  void clear()
+  {
+    for (std::vector<float>* lane : lanes())
+      lane->clear();
+  }
+
+  void reserve(std::size_t count)
+  {
+    for (std::vector<float>* lane : lanes())
+      lane->reserve(count);
+  }
+
+  void push(const Transform& transform)
+  {
+    px.push_back(transform.position.x);
+    py.push_back(transform.position.y);
+    pz.push_back(transform.position.z);
+    qx.push_back(transform.rotation.x);
+    qy.push_back(transform.rotation.y);
+    qz.push_back(transform.rotation.z);
+    qw.push_back(transform.rotation.w);
+    sx.push_back(transform.scale.x);
+    sy.push_back(transform.scale.y);
+    sz.push_back(transform.scale.z);
+  }
+
+  private:
+  std::array<std::vector<float>*, 10> lanes()
+  {
+    return {&px, &py, &pz, &qx, &qy, &qz, &qw, &sx, &sy, &sz};
+  }
+};
+
+// Transform::matrix() for whole batches, writing straight to where the matrices are consumed:
+// typically the data of a StreamBuffer allocation holding per-instance attributes. The output is
+// written front to back and never read, which is what write-combined mapped memory wants.
+namespace TransformMatrices
+{
+enum class Layout
+{
+  // Column-major mat4, 16 floats
+  MAT4,
+  // The top three rows of the matrix, 12 floats. Column-major that is a GLSL mat3x4 m, with
+  // world = vec4(position, 1.0) * m.
+  AFFINE
+};
+
+constexpr std::size_t floatsPerMatrix(Layout layout)
+{
+  return layout == Layout::MAT4 ? 16 : 12;
+}
+
+// Writes the matrices of transforms [first, first + count) to out, the one of first at out[0].
+// Uses AVX2 (8 transforms per step) or SSE4.1 (4 per step) when the CPU has them.
+void write(const TransformBatch& batch,
+           std::size_t first,
+           std::size_t count,
+           Layout layout,
+           float* out);
+
+// Same as above for the whole batch, split over the job system for large counts
+void write(const TransformBatch& batch, Layout layout, float* out, JobSystem* jobs = nullptr);
+
+// Reference implementation, also used for the tails the SIMD paths can't fill
+void writeScalar(const TransformBatch& batch,
+                 std::size_t first,
+                 std::size_t count,
+                 Layout layout,
+                 float* out);
+}  // namespace TransformMatrices
@@ -0,0 +1,136 @@
+#include "transform_hierarchy.h"
+
+#include "job_system.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace
+{
+// Levels smaller than this are done on the calling thread
+constexpr std::size_t PARALLEL_THRESHOLD = 4 * 1024;
+constexpr std::size_t PARALLEL_GRAIN = 1024;
+}  // namespace
+
+glm::mat4x3 TransformHierarchy::compose(const glm::mat4x3& parent, const glm::mat4x3& child)
+{
+  glm::mat4x3 result;
+  for (int i = 0; i < 3; i++)
+    result[i] = parent[0] * child[i].x + parent[1] * child[i].y + parent[2] * child[i].z;
+  result[3] = parent[0] * child[3].x + parent[1] * child[3].y + parent[2] * child[3].z + parent[3];
+  return result;
+}
+
+void TransformHierarchy::build(std::span<const std::uint32_t> parents)
+{
+  const std::size_t count = parents.size();
+  auto parentOf = [&](std::size_t node)
+  { return parents[node] < count ? parents[node] : NO_PARENT; };
+
+  // Depth of every node, walking up until a node whose depth is known
+  constexpr std::uint32_t UNKNOWN = NO_PARENT;
+  std::vector<std::uint32_t> depths(count, UNKNOWN);
+  std::vector<std::uint32_t> chain;
+  std::uint32_t maxDepth = 0;
+  for (std::size_t node = 0; node < count; node++)
+  {
+    chain.clear();
+    std::uint32_t current = static_cast<std::uint32_t>(node);
+    while (current != NO_PARENT && depths[current] == UNKNOWN)
+    {
+      assert(chain.size() < count && "Cycle in transform hierarchy.");
+      chain.push_back(current);
+      current = parentOf(current);
+    }
+    std::uint32_t depth = current == NO_PARENT ? 0 : depths[current] + 1;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+      depths[*it] = depth++;
+    if (!chain.empty())
+      maxDepth = std::max(maxDepth, depth - 1);
+  }
+
+  // Counting sort by depth, nodes keep their relative order inside a level
+  m_levels.assign(count ? maxDepth + 2 : 1, 0);
+  for (std::uint32_t depth : depths)
+    m_levels[depth + 1]++;
+  for (std::size_t level = 1; level < m_levels.size(); level++)
+    m_levels[level] += m_levels[level - 1];
+
+  m_slots.resize(count);
+  std::vector<std::uint32_t> next(m_levels.begin(), m_levels.end() - 1);
+  for (std::size_t node = 0; node < count; node++)
+    m_slots[node] = next[depths[node]]++;
+
+  m_parentSlots.resize(count);
+  for (std::size_t node = 0; node < count; node++)
+  {
+    const std::uint32_t parent = parentOf(node);
+    m_parentSlots[m_slots[node]] = parent == NO_PARENT ? NO_PARENT : m_slots[parent];
+  }
+
+  m_positions.assign(count, glm::vec3(0.0f));
+  m_rotations.assign(count, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+  m_scales.assign(count, glm::vec3(1.0f));
+  m_world.assign(count, glm::mat4x3(1.0f));
+  m_dirty.assign(count, 1);
+  m_updated.assign(count, 0);
+}
+
+void TransformHierarchy::setLocal(std::uint32_t node, const Transform& local)
+{
+  const std::uint32_t slot = m_slots[node];
+  if (m_positions[slot] == local.position && m_rotations[slot] == local.rotation &&
+      m_scales[slot] == local.scale)
+    return;
+  m_positions[slot] = local.position;
+  m_rotations[slot] = local.rotation;
+  m_scales[slot] = local.scale;
+  m_dirty[slot] = 1;
+}
+
+std::size_t TransformHierarchy::update(JobSystem* jobs)
+{
+  std::atomic<std::size_t> updated{0};
+  for (std::size_t level = 0; level + 1 < m_levels.size(); level++)
+  {
+    const std::size_t begin = m_levels[level];
+    const std::size_t end = m_levels[level + 1];
+    auto run = [&](std::size_t first, std::size_t last)
+    {
+      updateRange(first, last);
+      std::size_t count = 0;
+      for (std::size_t slot = first; slot < last; slot++)
+        count += m_updated[slot];
+      updated += count;
+    };
+
+    if (jobs && end - begin >= PARALLEL_THRESHOLD)
+    {
+      jobs->parallelFor(end - begin,
+                        PARALLEL_GRAIN,
+                        [&](std::size_t first, std::size_t last)
+                        { run(begin + first, begin + last); });
+    }
+    else
+      run(begin, end);
+  }
+  return updated;
+}
+
+void TransformHierarchy::updateRange(std::size_t begin, std::size_t end)
+{
+  for (std::size_t slot = begin; slot < end; slot++)
+  {
+    // The parent's level is done, its flag already says whether it moved this update
+    const std::uint32_t parent = m_parentSlots[slot];
+    const bool changed = m_dirty[slot] || (parent != NO_PARENT && m_updated[parent]);
+    m_dirty[slot] = 0;
+    m_updated[slot] = changed;
+    if (!changed)
+      continue;
+
+    const Transform local{m_positions[slot], m_rotations[slot], m_scales[slot]};
+    m_world[slot] = parent == NO_PARENT ? local.affine() : compose(m_world[parent], local.affine());
+  }
+}
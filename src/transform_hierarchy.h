@@ -0,0 +1,60 @@
+#pragma once
+
+#include "component/transform.h"
+
+#include <glm/glm.hpp>
+#include "glm/mat4x3.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+// World matrices of a forest of local transforms. Nodes are stored breadth first, sorted by
+// depth, in structure-of-arrays form: every parent comes before its children, so a level only
+// reads the one above it and its nodes can be split over the job system.
+//
+// setLocal() marks a node dirty when its transform actually changed. update() recomputes the
+// dirty nodes and everything under them and leaves the rest alone, so a frame where one arm
+// moves costs that arm and not the whole scene.
+class TransformHierarchy
+{
+  public:
+  static constexpr std::uint32_t NO_PARENT = std::numeric_limits<std::uint32_t>::max();
+
+  // parents[node] is the index of its parent or NO_PARENT for roots. Out of range parents count
+  // as NO_PARENT. Every node starts out dirty with an identity local transform.
+  void build(std::span<const std::uint32_t> parents);
+
+  void setLocal(std::uint32_t node, const Transform& local);
+  // Returns how many world matrices were recomputed
+  std::size_t update(JobSystem* jobs = nullptr);
+
+  inline std::size_t getNodeCount() const { return m_slots.size(); }
+  inline std::size_t getLevelCount() const { return m_levels.empty() ? 0 : m_levels.size() - 1; }
+  inline const glm::mat4x3& getWorld(std::uint32_t node) const { return m_world[m_slots[node]]; }
+  // Whether the last update() recomputed the node
+  inline bool wasUpdated(std::uint32_t node) const { return m_updated[m_slots[node]] != 0; }
+
+  // Parent * child for affine matrices, the implied bottom rows are 0 0 0 1
+  static glm::mat4x3 compose(const glm::mat4x3& parent, const glm::mat4x3& child);
+
+  private:
+  void updateRange(std::size_t begin, std::size_t end);
+
+  // Node index to its position in the sorted arrays below
+  std::vector<std::uint32_t> m_slots;
+  // Everything below is in breadth-first order, level l is [m_levels[l], m_levels[l + 1])
+  std::vector<std::uint32_t> m_levels;
+  std::vector<std::uint32_t> m_parentSlots;
+  std::vector<glm::vec3> m_positions;
+  std::vector<glm::quat> m_rotations;
+  std::vector<glm::vec3> m_scales;
+  std::vector<glm::mat4x3> m_world;
+  // Bytes rather than vector<bool> so neighbouring nodes can be written from different threads
+  std::vector<std::uint8_t> m_dirty;
+  std::vector<std::uint8_t> m_updated;
+};
@@ -26,7 +26,6 @@ void VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
   bind();
   vb.bind();
   const auto& elements = layout.getElements();
-  unsigned int offset = 0;
   for (int i = 0; i < elements.size(); i++)
   {
     const auto& element = elements[i];
@@ -39,7 +38,6 @@ void VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
                           element.type,
                           element.normalized,
                           layout.getStride(),
-                          (const void*)offset);
-    offset += element.count * VertexBufferElement::getSizeOfType(element.type);
+                          (const void*)(uintptr_t)element.offset);
   }
 }
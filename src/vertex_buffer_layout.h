@@ -1,7 +1,10 @@
 #pragma once
 
+#include "vertex_format.h"
+
 #include <glad/glad.h>
 #include <cassert>
+#include <cstdint>
 #include <vector>
 
 struct VertexBufferElement
@@ -9,6 +12,7 @@ struct VertexBufferElement
   unsigned int type;
   unsigned int count;
   unsigned char normalized;
+  unsigned int offset;
 
   static unsigned int getSizeOfType(unsigned int type)
   {
@@ -17,11 +21,27 @@ struct VertexBufferElement
       case GL_FLOAT:
         return 4;
       case GL_UNSIGNED_INT:
+      case GL_INT:
+        return 4;
+      case GL_HALF_FLOAT:
+      case GL_UNSIGNED_SHORT:
+      case GL_SHORT:
+        return 2;
+      case GL_UNSIGNED_BYTE:
+      case GL_BYTE:
+        return 1;
+      case GL_INT_2_10_10_10_REV:
+        // All four components share one 32-bit word
         return 4;
     }
     assert(false);
     return 0;
   }
+
+  unsigned int getSize() const
+  {
+    return type == GL_INT_2_10_10_10_REV ? 4 : count * getSizeOfType(type);
+  }
 };
 
 class VertexBufferLayout
@@ -29,35 +49,87 @@ class VertexBufferLayout
   public:
   VertexBufferLayout() : m_stride(0) {}
 
+  // normalized maps integer attributes to [0, 1] (unsigned) or [-1, 1] (signed) in the shader,
+  // otherwise they are converted to float as is
   template <typename T>
-  void push(unsigned int count);
+  void push(unsigned int count, bool normalized = false);
 
   inline const std::vector<VertexBufferElement> getElements() const { return m_elements; }
   inline unsigned int getStride() const { return m_stride; }
 
   private:
+  void pushElement(unsigned int type, unsigned int count, bool normalized)
+  {
+    // Attributes start on 4 byte boundaries, so 3 x half or 3 x byte get padded
+    const unsigned int offset = (m_stride + 3) & ~3u;
+    m_elements.push_back({type, count, static_cast<unsigned char>(normalized), offset});
+    m_stride = offset + m_elements.back().getSize();
+  }
+
   std::vector<VertexBufferElement> m_elements;
   unsigned int m_stride;
 };
 
 // Primary template definition (for unsupported types)
 template <typename T>
-void VertexBufferLayout::push(unsigned int)
+void VertexBufferLayout::push(unsigned int, bool)
 {
   static_assert(sizeof(T) == 0, "Unsupported vertex buffer type");
 }
 
 // Specializations must be at namespace scope
 template <>
-inline void VertexBufferLayout::push<float>(unsigned int count)
+inline void VertexBufferLayout::push<float>(unsigned int count, bool)
+{
+  pushElement(GL_FLOAT, count, false);
+}
+
+template <>
+inline void VertexBufferLayout::push<unsigned int>(unsigned int count, bool normalized)
+{
+  pushElement(GL_UNSIGNED_INT, count, normalized);
+}
+
+template <>
+inline void VertexBufferLayout::push<int>(unsigned int count, bool normalized)
+{
+  pushElement(GL_INT, count, normalized);
+}
+
+template <>
+inline void VertexBufferLayout::push<Half>(unsigned int count, bool)
+{
+  pushElement(GL_HALF_FLOAT, count, false);
+}
+
+template <>
+inline void VertexBufferLayout::push<std::uint16_t>(unsigned int count, bool normalized)
+{
+  pushElement(GL_UNSIGNED_SHORT, count, normalized);
+}
+
+template <>
+inline void VertexBufferLayout::push<std::int16_t>(unsigned int count, bool normalized)
+{
+  pushElement(GL_SHORT, count, normalized);
+}
+
+template <>
+inline void VertexBufferLayout::push<std::uint8_t>(unsigned int count, bool normalized)
+{
+  pushElement(GL_UNSIGNED_BYTE, count, normalized);
+}
+
+template <>
+inline void VertexBufferLayout::push<std::int8_t>(unsigned int count, bool normalized)
 {
-  m_elements.push_back({GL_FLOAT, count, GL_FALSE});
-  m_stride += VertexBufferElement::getSizeOfType(GL_FLOAT) * count;
+  pushElement(GL_BYTE, count, normalized);
 }
 
+// Always four components, always normalized
 template <>
-inline void VertexBufferLayout::push<unsigned int>(unsigned int count)
+inline void VertexBufferLayout::push<PackedNormal>(unsigned int count, bool)
 {
-  m_elements.push_back({GL_UNSIGNED_INT, count, GL_FALSE});
-  m_stride += VertexBufferElement::getSizeOfType(GL_UNSIGNED_INT) * count;
+  assert(count == 4 && "GL_INT_2_10_10_10_REV attributes have exactly four components.");
+  pushElement(GL_INT_2_10_10_10_REV, 4, true);
 }
@@ -0,0 +1,142 @@
+#include "vertex_format.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace VertexFormat
+{
+std::uint16_t floatToHalf(float value)
+{
+  const std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+  const std::uint32_t sign = (bits >> 16) & 0x8000u;
+  const std::uint32_t exponent = (bits >> 23) & 0xFFu;
+  std::uint32_t mantissa = bits & 0x7FFFFFu;
+
+  // NaN and infinity
+  if (exponent == 0xFF)
+    return static_cast<std::uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+
+  const int halfExponent = static_cast<int>(exponent) - 127 + 15;
+
+  // Overflow rounds to infinity
+  if (halfExponent >= 0x1F)
+    return static_cast<std::uint16_t>(sign | 0x7C00u);
+
+  // Subnormal half, or flush to signed zero
+  if (halfExponent <= 0)
+  {
+    if (halfExponent < -10)
+      return static_cast<std::uint16_t>(sign);
+
+    mantissa |= 0x800000u;
+    const int shift = 14 - halfExponent;
+    std::uint32_t half = mantissa >> shift;
+    const std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const std::uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1u)))
+      ++half;
+    return static_cast<std::uint16_t>(sign | half);
+  }
+
+  // Round to nearest even, a carry out of the mantissa correctly bumps the exponent
+  std::uint32_t half = sign | (static_cast<std::uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+  const std::uint32_t remainder = mantissa & 0x1FFFu;
+  if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+    ++half;
+  return static_cast<std::uint16_t>(half);
+}
+
+float halfToFloat(std::uint16_t half)
+{
+  const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+  const std::uint32_t exponent = (half >> 10) & 0x1Fu;
+  const std::uint32_t mantissa = half & 0x3FFu;
+
+  if (exponent == 0)
+  {
+    // Zero or subnormal
+    const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+    return sign ? -magnitude : magnitude;
+  }
+
+  if (exponent == 0x1F)
+    return std::bit_cast<float>(sign | 0x7F800000u | (mantissa << 13));
+
+  return std::bit_cast<float>(sign | ((exponent + 127 - 15) << 23) | (mantissa << 13));
+}
+
+std::uint8_t toUnorm8(float value)
+{
+  return static_cast<std::uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+std::uint16_t toUnorm16(float value)
+{
+  return static_cast<std::uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+std::int8_t toSnorm8(float value)
+{
+  return static_cast<std::int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+}
+
+std::int16_t toSnorm16(float value)
+{
+  return static_cast<std::int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+PackedNormal packNormal(const glm::vec4& value)
+{
+  auto field = [](float v, float scale, std::uint32_t mask)
+  { return static_cast<std::uint32_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * scale)) & mask; };
+
+  return {field(value.x, 511.0f, 0x3FFu) | (field(value.y, 511.0f, 0x3FFu) << 10) |
+          (field(value.z, 511.0f, 0x3FFu) << 20) | (field(value.w, 1.0f, 0x3u) << 30)};
+}
+
+glm::vec4 unpackNormal(PackedNormal packed)
+{
+  // Sign extend each field, GL clamps -512 to -1 the same way
+  auto field = [&](int shift, int bits, float scale)
+  {
+    const int raw = static_cast<int>(packed.bits << (32 - shift - bits)) >> (32 - bits);
+    return std::max(static_cast<float>(raw) / scale, -1.0f);
+  };
+
+  return {field(0, 10, 511.0f), field(10, 10, 511.0f), field(20, 10, 511.0f), field(30, 2, 1.0f)};
+}
+
+std::array<std::uint16_t, 2> packUV(const glm::vec2& uv)
+{
+  return {floatToHalf(uv.x), floatToHalf(uv.y)};
+}
+
+glm::vec2 unpackUV(const std::array<std::uint16_t, 2>& packed)
+{
+  return {halfToFloat(packed[0]), halfToFloat(packed[1])};
+}
+
+PositionQuantizer::PositionQuantizer(const AABB& bounds)
+    : m_min(bounds.min), m_size(glm::max(bounds.size(), glm::vec3(1e-6f)))
+{
+}
+
+std::array<std::uint16_t, 3> PositionQuantizer::encode(const glm::vec3& position) const
+{
+  const glm::vec3 normalized = (position - m_min) / m_size;
+  return {toUnorm16(normalized.x), toUnorm16(normalized.y), toUnorm16(normalized.z)};
+}
+
+glm::vec3 PositionQuantizer::decode(const std::array<std::uint16_t, 3>& encoded) const
+{
+  return m_min + glm::vec3(encoded[0], encoded[1], encoded[2]) / 65535.0f * m_size;
+}
+
+glm::mat4 PositionQuantizer::getDequantizeMatrix() const
+{
+  return glm::scale(glm::translate(glm::mat4(1.0f), m_min), m_size);
+}
+}  // namespace VertexFormat
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "aabb.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+
+// Tag types for compact attributes, used with VertexBufferLayout::push
+struct Half
+{
+  std::uint16_t bits;
+};
+
+// Four signed normalized components in GL_INT_2_10_10_10_REV: 10 bits each for xyz, 2 for w
+struct PackedNormal
+{
+  std::uint32_t bits;
+};
+
+// CPU-side encoders for compact vertex data
+namespace VertexFormat
+{
+std::uint16_t floatToHalf(float value);
+float halfToFloat(std::uint16_t half);
+
+// Clamped, rounded normalized integers
+std::uint8_t toUnorm8(float value);
+std::uint16_t toUnorm16(float value);
+std::int8_t toSnorm8(float value);
+std::int16_t toSnorm16(float value);
+
+// Packs a unit vector (normal, or tangent with handedness in w) into GL_INT_2_10_10_10_REV
+PackedNormal packNormal(const glm::vec4& value);
+inline PackedNormal packNormal(const glm::vec3& value)
+{
+  return packNormal(glm::vec4(value, 0.0f));
+}
+glm::vec4 unpackNormal(PackedNormal packed);
+
+// UVs as half floats (push<Half>(2)). Not clamped, tiled UVs outside [0, 1] keep working,
+// with 11 bits of precision relative to their magnitude.
+std::array<std::uint16_t, 2> packUV(const glm::vec2& uv);
+glm::vec2 unpackUV(const std::array<std::uint16_t, 2>& packed);
+
+// Quantizes positions to normalized 16-bit against the mesh bounds. Upload with
+// push<unsigned short>(3, true) and fold getDequantizeMatrix() into the model matrix.
+class PositionQuantizer
+{
+  public:
+  explicit PositionQuantizer(const AABB& bounds);
+
+  std::array<std::uint16_t, 3> encode(const glm::vec3& position) const;
+  glm::vec3 decode(const std::array<std::uint16_t, 3>& encoded) const;
+
+  // Maps the [0, 1] attribute range back onto the original bounds
+  glm::mat4 getDequantizeMatrix() const;
+  // Worst case reconstruction error per axis
+  glm::vec3 getPrecision() const { return m_size / 65535.0f * 0.5f; }
+
+  private:
+  glm::vec3 m_min;
+  glm::vec3 m_size;
+};
+}  // namespace VertexFormat
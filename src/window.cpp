@@ -1,11 +1,13 @@
 #include "window.h"
 
+#include "gl_extensions.h"
+
 #include <glad/glad.h>
 #include "GLFW/glfw3.h"
 
 #include <stdexcept>
 
-Window::Window(int width, int height, const std::string& title)
+Window::Window(int width, int height, const std::string& title, bool visible)
     : m_window(nullptr), m_width(width), m_height(height)
 {
   // Initialize GLFW
@@ -17,6 +19,7 @@ Window::Window(int width, int height, const std::string& title)
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
 
 #ifdef __APPLE__
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
@@ -37,6 +40,8 @@ Window::Window(int width, int height, const std::string& title)
     throw std::runtime_error("Failed to initialize GLAD");
   }
 
+  GLExtensions::init();
+
   glfwSetWindowUserPointer(m_window, this);
   glfwSetFramebufferSizeCallback(m_window, framebuffer_size_callback);
 }
@@ -7,7 +7,8 @@
 class Window
 {
   public:
-  Window(int width, int height, const std::string& title);
+  // Hidden windows still get a context, for rendering offscreen
+  Window(int width, int height, const std::string& title, bool visible = true);
   ~Window();
 
   void swapBuffers();
@@ -0,0 +1,133 @@
+#include "block_compression.h"
+#include "image_util.h"
+#include "texture_container.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+// Smooth gradient with a hard alpha edge, the usual worst case for BC alpha
+std::vector<unsigned char> makeImage(int width, int height)
+{
+  std::vector<unsigned char> rgba(width * height * 4);
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      unsigned char* p = &rgba[(y * width + x) * 4];
+      p[0] = static_cast<unsigned char>(x * 255 / (width - 1));
+      p[1] = static_cast<unsigned char>(y * 255 / (height - 1));
+      p[2] = 96;
+      p[3] = x < width / 2 ? 255 : static_cast<unsigned char>(y * 255 / (height - 1));
+    }
+  }
+  return rgba;
+}
+
+double meanError(const std::vector<unsigned char>& a,
+                 const std::vector<unsigned char>& b,
+                 int channel)
+{
+  double total = 0.0;
+  for (size_t i = channel; i < a.size(); i += 4)
+    total += std::abs(a[i] - b[i]);
+  return total / (a.size() / 4);
+}
+}  // namespace
+
+TEST(BlockCompression, RoundTripStaysClose)
+{
+  // Not a multiple of four, so the padded edge blocks get exercised too
+  const int width = 37;
+  const int height = 22;
+  const auto image = makeImage(width, height);
+
+  using BlockCompression::Format;
+  const auto bc1 = BlockCompression::compress(Format::BC1, image.data(), width, height);
+  ASSERT_EQ(bc1.size(), BlockCompression::compressedSize(Format::BC1, width, height));
+  const auto bc1Decoded = BlockCompression::decompress(Format::BC1, bc1.data(), width, height);
+  // Each block holds a 2D gradient and BC1 only fits a line through it, so this is loose
+  for (int c = 0; c < 3; c++)
+    EXPECT_LT(meanError(image, bc1Decoded, c), 8.0) << "channel " << c;
+
+  const auto bc3 = BlockCompression::compress(Format::BC3, image.data(), width, height);
+  const auto bc3Decoded = BlockCompression::decompress(Format::BC3, bc3.data(), width, height);
+  EXPECT_LT(meanError(image, bc3Decoded, 3), 3.0);
+  EXPECT_EQ(bc3Decoded[3], 255);
+}
+
+TEST(TextureContainer, WriteThenMap)
+{
+  const int width = 16;
+  const int height = 8;
+  auto mips = ImageUtil::buildMipChain(makeImage(width, height), width, height, 4);
+  ASSERT_EQ(static_cast<int>(mips.size()), ImageUtil::mipCount(width, height));
+
+  const auto path = (std::filesystem::temp_directory_path() / "container_tst.tex").string();
+  ASSERT_TRUE(TextureContainer::write(path, TextureContainer::Format::RGBA8, width, height, mips));
+
+  TextureContainer::View view;
+  ASSERT_TRUE(view.open(path));
+  const auto& header = view.getHeader();
+  EXPECT_EQ(header.width, 16u);
+  EXPECT_EQ(header.mipCount, mips.size());
+  for (std::uint32_t level = 0; level < header.mipCount; level++)
+  {
+    EXPECT_EQ(header.mips[level].offset % TextureContainer::DATA_ALIGNMENT, 0u);
+    ASSERT_EQ(header.mips[level].size, mips[level].size());
+    EXPECT_EQ(std::memcmp(view.getMipData(level), mips[level].data(), mips[level].size()), 0);
+  }
+  EXPECT_EQ(header.mips[header.mipCount - 1].width, 1u);
+
+  std::filesystem::remove(path);
+}
+
+TEST(TextureContainer, RejectsHeadersThatDontMatchTheData)
+{
+  const int width = 16;
+  const int height = 8;
+  const auto image = makeImage(width, height);
+  const std::vector<std::vector<unsigned char>> mips = {
+      BlockCompression::compress(BlockCompression::Format::BC1, image.data(), width, height)};
+  const auto path = (std::filesystem::temp_directory_path() / "container_bad_tst.tex").string();
+  ASSERT_TRUE(TextureContainer::write(path, TextureContainer::Format::BC1, width, height, mips));
+
+  // Rewrites the header, opens the file and puts the header back
+  auto openPatched = [&](auto&& patch)
+  {
+    TextureContainer::Header header;
+    {
+      std::ifstream in(path, std::ios::binary);
+      in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+    const TextureContainer::Header original = header;
+    patch(header);
+    std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+
+    TextureContainer::View view;
+    const bool opened = view.open(path);
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&original), sizeof(original));
+    return opened;
+  };
+
+  EXPECT_TRUE(openPatched([](TextureContainer::Header&) {}));
+  EXPECT_FALSE(openPatched([](auto& header) { header.format = TextureContainer::Format(7); }));
+  // A BC1 level of 16x8 takes 8 blocks, anything less would be read past
+  EXPECT_FALSE(openPatched([](auto& header) { header.mips[0].size = 8 * 8 - 1; }));
+  // Dimensions bigger than the data, or not matching the header
+  EXPECT_FALSE(openPatched([](auto& header) { header.mips[0].width = 32; }));
+  EXPECT_FALSE(openPatched([](auto& header) { header.width = 0; }));
+  // Claiming to be RGBA8 needs four times the bytes
+  EXPECT_FALSE(
+      openPatched([](auto& header) { header.format = TextureContainer::Format::RGBA8; }));
+
+  std::filesystem::remove(path);
+}
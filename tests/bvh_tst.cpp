@@ -0,0 +1,176 @@
+#include "bvh.h"
+#include "component/bounds.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+std::vector<AABB> randomBoxes(std::size_t count, unsigned int seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> size(0.1f, 2.0f);
+
+  std::vector<AABB> boxes;
+  for (std::size_t i = 0; i < count; i++)
+  {
+    const glm::vec3 center(position(rng), position(rng), position(rng));
+    boxes.emplace_back(center - glm::vec3(size(rng)), center + glm::vec3(size(rng)));
+  }
+  return boxes;
+}
+
+std::vector<std::uint32_t> overlapping(const DynamicBvh& bvh, const AABB& query)
+{
+  std::vector<std::uint32_t> found;
+  bvh.queryOverlap(query,
+                   [&](std::int32_t proxy)
+                   {
+                     found.push_back(bvh.getUserData(proxy));
+                     return true;
+                   });
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+std::vector<std::uint32_t> bruteForce(const DynamicBvh& bvh,
+                                      const std::vector<std::int32_t>& proxies,
+                                      const AABB& query)
+{
+  std::vector<std::uint32_t> found;
+  for (std::int32_t proxy : proxies)
+  {
+    if (bvh.getFatBounds(proxy).intersects(query))
+      found.push_back(bvh.getUserData(proxy));
+  }
+  std::sort(found.begin(), found.end());
+  return found;
+}
+}  // namespace
+
+TEST(DynamicBvh, OverlapMatchesBruteForceThroughMovesAndRebuilds)
+{
+  auto boxes = randomBoxes(2000, 1);
+  DynamicBvh bvh;
+  std::vector<std::int32_t> proxies;
+  for (std::uint32_t i = 0; i < boxes.size(); i++)
+    proxies.push_back(bvh.createProxy(boxes[i], i));
+
+  // Incremental inserts stay balanced
+  EXPECT_LT(bvh.getHeight(), 32);
+
+  const AABB query(glm::vec3(-20.0f), glm::vec3(20.0f));
+  EXPECT_EQ(overlapping(bvh, query), bruteForce(bvh, proxies, query));
+
+  bvh.update(nullptr);
+  const float builtCost = bvh.getBuildCost();
+  EXPECT_GT(builtCost, 0.0f);
+  EXPECT_EQ(overlapping(bvh, query), bruteForce(bvh, proxies, query));
+
+  // Scramble everything so refits degrade the tree enough to trigger a rebuild
+  auto moved = randomBoxes(boxes.size(), 2);
+  for (std::size_t i = 0; i < proxies.size(); i++)
+    bvh.updateProxy(proxies[i], moved[i]);
+  bvh.refit();
+  EXPECT_GT(bvh.getCost(), builtCost * DynamicBvh::REBUILD_THRESHOLD);
+  EXPECT_EQ(overlapping(bvh, query), bruteForce(bvh, proxies, query));
+
+  bvh.update(nullptr);
+  EXPECT_LE(bvh.getCost(), builtCost * DynamicBvh::REBUILD_THRESHOLD);
+  EXPECT_EQ(overlapping(bvh, query), bruteForce(bvh, proxies, query));
+
+  for (std::size_t i = 0; i < proxies.size(); i += 2)
+    bvh.destroyProxy(proxies[i]);
+  std::erase_if(proxies, [&](std::int32_t proxy) { return proxy % 2 == 0; });
+  EXPECT_EQ(bvh.getProxyCount(), proxies.size());
+  EXPECT_EQ(overlapping(bvh, query), bruteForce(bvh, proxies, query));
+}
+
+TEST(DynamicBvh, RaycastAndNearestFindClosest)
+{
+  const auto boxes = randomBoxes(1000, 3);
+  DynamicBvh bvh;
+  for (std::uint32_t i = 0; i < boxes.size(); i++)
+    bvh.createProxy(boxes[i], i);
+  bvh.rebuild();
+
+  // Exact distance to the tight box, not the fat one stored in the tree
+  auto boxDistance = [&](const glm::vec3& p, std::uint32_t i)
+  {
+    const glm::vec3 outside = glm::max(boxes[i].min - p, p - boxes[i].max);
+    return glm::length(glm::max(outside, glm::vec3(0.0f)));
+  };
+
+  const glm::vec3 point(3.0f, -7.0f, 11.0f);
+  auto distance = [&](std::int32_t proxy) { return boxDistance(point, bvh.getUserData(proxy)); };
+  auto hit = bvh.nearest(point, 1000.0f, distance);
+  ASSERT_TRUE(hit);
+
+  float best = 1000.0f;
+  for (std::uint32_t i = 0; i < boxes.size(); i++)
+    best = std::min(best, boxDistance(point, i));
+  EXPECT_FLOAT_EQ(hit.distance, best);
+
+  // Ray from far outside straight through the centre of one of the boxes
+  const glm::vec3 target = boxes[42].center();
+  const glm::vec3 origin(-150.0f, target.y, target.z);
+  auto ray = bvh.raycast(origin,
+                         glm::vec3(1.0f, 0.0f, 0.0f),
+                         1000.0f,
+                         [&](std::int32_t proxy, float)
+                         {
+                           const AABB& box = boxes[bvh.getUserData(proxy)];
+                           const bool inside = target.y >= box.min.y && target.y <= box.max.y &&
+                                               target.z >= box.min.z && target.z <= box.max.z;
+                           return inside ? box.min.x - origin.x : -1.0f;
+                         });
+  ASSERT_TRUE(ray);
+  EXPECT_LE(ray.distance, boxes[42].min.x - origin.x);
+}
+
+TEST(DynamicBvh, SphereQueriesSeeSpheresBiggerThanTheBox)
+{
+  // A sphere reaching well past its box, like the cubes in main (radius 0.866, extents 0.5)
+  const glm::mat4x3 identity(1.0f);
+  Bounds big{};
+  big.radius = 2.0f;
+  Bounds small{};
+  glm::mat4x3 smallWorld(1.0f);
+  smallWorld[3] = glm::vec3(0.0f, 4.6f, 0.0f);
+  const Bounds::Sphere spheres[2] = {big.worldSphere(identity), small.worldSphere(smallWorld)};
+
+  DynamicBvh bvh;
+  bvh.createProxy(big.worldEnclosing(identity), 0);
+  bvh.createProxy(small.worldEnclosing(smallWorld), 1);
+  bvh.rebuild();
+
+  // Passes over the box but through the sphere
+  auto ray = bvh.raycast(glm::vec3(-10.0f, 1.5f, 0.0f),
+                         glm::vec3(1.0f, 0.0f, 0.0f),
+                         100.0f,
+                         [&](std::int32_t proxy, float)
+                         {
+                           const Bounds::Sphere& sphere = spheres[bvh.getUserData(proxy)];
+                           const float dy = 1.5f - sphere.center.y;
+                           const float r2 = sphere.radius * sphere.radius - dy * dy;
+                           return r2 < 0.0f ? -1.0f : 10.0f - std::sqrt(r2);
+                         });
+  ASSERT_TRUE(ray);
+  EXPECT_EQ(bvh.getUserData(ray.proxy), 0u);
+
+  // 1 from the big sphere and 1.1 from the small one, but 2.4 from the big box
+  const glm::vec3 point(0.0f, 3.0f, 0.0f);
+  auto hit = bvh.nearest(point,
+                         100.0f,
+                         [&](std::int32_t proxy)
+                         {
+                           const Bounds::Sphere& sphere = spheres[bvh.getUserData(proxy)];
+                           return glm::distance(point, sphere.center) - sphere.radius;
+                         });
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(bvh.getUserData(hit.proxy), 0u);
+  EXPECT_NEAR(hit.distance, 1.0f, 1e-5f);
+}
@@ -0,0 +1,116 @@
+#include "frustum.h"
+#include "job_system.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+void expectPlane(const glm::vec4& plane, const glm::vec4& expected)
+{
+  EXPECT_NEAR(plane.x, expected.x, 1e-5f);
+  EXPECT_NEAR(plane.y, expected.y, 1e-5f);
+  EXPECT_NEAR(plane.z, expected.z, 1e-5f);
+  EXPECT_NEAR(plane.w, expected.w, 1e-5f);
+}
+
+// Spheres scattered around and through a frustum looking down -Z, so plenty land on each side
+SphereBatch randomSpheres(std::size_t count, unsigned int seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+  std::uniform_real_distribution<float> radius(0.0f, 3.0f);
+  SphereBatch spheres;
+  for (std::size_t i = 0; i < count; i++)
+    spheres.push(glm::vec3(position(rng), position(rng), position(rng) - 20.0f), radius(rng));
+  return spheres;
+}
+
+Frustum testFrustum()
+{
+  const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 40.0f);
+  const glm::mat4 view =
+      glm::lookAt(glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(0.0f, 0.0f, -20.0f), glm::vec3(0, 1, 0));
+  return Frustum::fromMatrix(projection * view);
+}
+}  // namespace
+
+TEST(FrustumTest, PlanesOfAPerspectiveMatrixAreNormalised)
+{
+  // 90 degrees square from the origin: the side planes are at 45 degrees
+  const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 1.0f, 10.0f);
+  const Frustum frustum = Frustum::fromMatrix(projection);
+  const float h = std::sqrt(0.5f);
+
+  expectPlane(frustum.planes[Frustum::PLANE_LEFT], glm::vec4(h, 0.0f, -h, 0.0f));
+  expectPlane(frustum.planes[Frustum::PLANE_RIGHT], glm::vec4(-h, 0.0f, -h, 0.0f));
+  expectPlane(frustum.planes[Frustum::PLANE_BOTTOM], glm::vec4(0.0f, h, -h, 0.0f));
+  expectPlane(frustum.planes[Frustum::PLANE_TOP], glm::vec4(0.0f, -h, -h, 0.0f));
+  expectPlane(frustum.planes[Frustum::PLANE_NEAR], glm::vec4(0.0f, 0.0f, -1.0f, -1.0f));
+  expectPlane(frustum.planes[Frustum::PLANE_FAR], glm::vec4(0.0f, 0.0f, 1.0f, 10.0f));
+
+  EXPECT_TRUE(frustum.intersectsSphere(glm::vec3(0.0f, 0.0f, -5.0f), 0.1f));
+  EXPECT_FALSE(frustum.intersectsSphere(glm::vec3(0.0f, 0.0f, -12.0f), 1.0f));
+  EXPECT_TRUE(frustum.intersectsSphere(glm::vec3(0.0f, 0.0f, -12.0f), 2.5f));
+  // Just past the left plane, by less than the radius
+  EXPECT_TRUE(frustum.intersectsSphere(glm::vec3(-5.5f, 0.0f, -5.0f), 0.5f));
+  EXPECT_FALSE(frustum.intersectsSphere(glm::vec3(-6.0f, 0.0f, -5.0f), 0.5f));
+}
+
+TEST(FrustumTest, SimdCullingMatchesScalar)
+{
+  const Frustum frustum = testFrustum();
+  const SphereBatch spheres = randomSpheres(1000, 7);
+
+  // The dispatched path, then every kernel this CPU can run, whichever one dispatch picks
+  using Kernel = std::size_t (*)(
+      const Frustum&, const SphereBatch&, std::size_t, std::size_t, std::uint32_t*);
+  std::vector<std::pair<const char*, Kernel>> kernels = {{"dispatched", Culling::cullSpheres}};
+#ifdef CPU_X86_64
+  if (CpuFeatures::hasAVX2())
+    kernels.emplace_back("AVX2", Culling::cullSpheresAVX2);
+  if (CpuFeatures::hasSSE41())
+    kernels.emplace_back("SSE4.1", Culling::cullSpheresSSE41);
+#endif
+
+  // Counts and offsets that leave tails for both the 8 and the 4 wide kernels
+  for (const auto& [name, kernel] : kernels)
+  {
+    for (std::size_t first : {0u, 3u, 8u})
+    {
+      for (std::size_t count : {0u, 1u, 3u, 4u, 7u, 9u, 13u, 101u, 997u})
+      {
+        std::vector<std::uint32_t> simd(count), scalar(count);
+        simd.resize(kernel(frustum, spheres, first, count, simd.data()));
+        scalar.resize(Culling::cullSpheresScalar(frustum, spheres, first, count, scalar.data()));
+        EXPECT_EQ(simd, scalar) << name << " first " << first << " count " << count;
+      }
+    }
+  }
+
+  std::vector<std::uint32_t> all(spheres.size());
+  const std::size_t visible = Culling::cullSpheresScalar(frustum, spheres, 0, 1000, all.data());
+  EXPECT_GT(visible, 0u);
+  EXPECT_LT(visible, 1000u);
+}
+
+TEST(FrustumTest, ParallelCullingJoinsChunksInOrder)
+{
+  // Enough for several job system chunks, and not a multiple of any of them
+  const Frustum frustum = testFrustum();
+  const SphereBatch spheres = randomSpheres(100003, 11);
+
+  JobSystem jobs;
+  std::vector<std::uint32_t> parallel;
+  Culling::cullSpheres(frustum, spheres, parallel, &jobs);
+
+  std::vector<std::uint32_t> scalar(spheres.size());
+  scalar.resize(
+      Culling::cullSpheresScalar(frustum, spheres, 0, spheres.size(), scalar.data()));
+  EXPECT_EQ(parallel, scalar);
+}
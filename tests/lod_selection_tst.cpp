@@ -0,0 +1,47 @@
+#include "lod_selection.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(LodSelectionTest, ScreenSizeFollowsFov)
+{
+  // 90 degrees: the view is 2d tall at distance d, a sphere of radius 1 at 10 covers a tenth
+  const float scale = LodSelection::projectionScale(90.0f);
+  EXPECT_NEAR(LodSelection::screenSize(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f, glm::vec3(0.0f), scale),
+              0.1f,
+              1e-5f);
+  EXPECT_EQ(LodSelection::screenSize(glm::vec3(0.5f), 1.0f, glm::vec3(0.0f), scale), 1.0f);
+
+  SphereBatch spheres;
+  spheres.push(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f);
+  spheres.push(glm::vec3(0.0f, 20.0f, 0.0f), 1.0f);
+  const std::uint32_t visible[] = {1};
+  float size;
+  LodSelection::screenSizes(spheres, visible, 1, glm::vec3(0.0f), scale, &size);
+  EXPECT_NEAR(size, 0.05f, 1e-5f);
+}
+
+TEST(LodSelectionTest, HysteresisKeepsTheLevelAroundThresholds)
+{
+  const std::vector<float> thresholds = {1.0f, 0.2f, 0.05f};
+  constexpr float CULL = 0.01f;
+  constexpr float H = 0.1f;
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.5f, -1, H), 0u);
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.1f, -1, H), 1u);
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.02f, -1, H), 2u);
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.005f, -1, H), 3u);
+
+  // Just under a threshold stays on the finer level, just over it on the coarser one
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.19f, 0, H), 0u);
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.21f, 1, H), 1u);
+  // Past the margin they switch
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.17f, 0, H), 1u);
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.23f, 1, H), 0u);
+  // Big jumps skip levels either way
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.03f, 0, H), 2u);
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.9f, 3, H), 0u);
+  // Hidden comes back only once clearly over the cull size
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.0105f, 3, H), 3u);
+  EXPECT_EQ(LodSelection::select(thresholds, CULL, 0.0115f, 3, H), 2u);
+}
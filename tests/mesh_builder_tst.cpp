@@ -0,0 +1,104 @@
+#include "mesh_builder.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+using Vertex = std::array<float, 3>;
+
+// Unindexed grid of quads, every interior vertex is repeated by up to six triangles
+std::vector<Vertex> makeGrid(int size)
+{
+  std::vector<Vertex> vertices;
+  for (int y = 0; y < size; y++)
+  {
+    for (int x = 0; x < size; x++)
+    {
+      const Vertex a{float(x), float(y), 0.0f};
+      const Vertex b{float(x + 1), float(y), 0.0f};
+      const Vertex c{float(x + 1), float(y + 1), 0.0f};
+      const Vertex d{float(x), float(y + 1), 0.0f};
+      vertices.insert(vertices.end(), {a, b, c, a, c, d});
+    }
+  }
+  return vertices;
+}
+
+Vertex vertexAt(const MeshBuilder& builder, std::uint32_t index)
+{
+  Vertex v;
+  std::memcpy(v.data(), &builder.getVertexData()[index * sizeof(Vertex)], sizeof(Vertex));
+  return v;
+}
+}  // namespace
+
+TEST(MeshBuilder, WeldsIdenticalVertices)
+{
+  const auto grid = makeGrid(4);
+  MeshBuilder builder(sizeof(Vertex));
+  builder.addTriangles(grid.data(), grid.size());
+
+  EXPECT_EQ(builder.getVertexCount(), 25u);
+  EXPECT_EQ(builder.getIndexCount(), grid.size());
+  EXPECT_TRUE(builder.uses16BitIndices());
+  EXPECT_EQ(builder.getIndexData().size(), grid.size() * sizeof(std::uint16_t));
+}
+
+TEST(MeshBuilder, OptimizePreservesTrianglesAndImprovesCache)
+{
+  const auto grid = makeGrid(64);
+  MeshBuilder builder(sizeof(Vertex));
+  builder.addTriangles(grid.data(), grid.size());
+  builder.optimize();
+
+  const auto& stats = builder.getStats();
+  EXPECT_EQ(stats.triangles, grid.size() / 3);
+  EXPECT_LT(stats.acmrAfter, stats.acmrBefore);
+
+  // Every input triangle must still be there, in some order
+  auto key = [](Vertex a, Vertex b, Vertex c)
+  {
+    std::array<Vertex, 3> tri{a, b, c};
+    std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+    return tri;
+  };
+
+  std::vector<std::array<Vertex, 3>> expected;
+  for (size_t i = 0; i < grid.size(); i += 3)
+    expected.push_back(key(grid[i], grid[i + 1], grid[i + 2]));
+
+  std::vector<std::array<Vertex, 3>> actual;
+  const auto& indices = builder.getIndices();
+  for (size_t i = 0; i < indices.size(); i += 3)
+  {
+    actual.push_back(key(vertexAt(builder, indices[i]),
+                         vertexAt(builder, indices[i + 1]),
+                         vertexAt(builder, indices[i + 2])));
+  }
+
+  std::sort(expected.begin(), expected.end());
+  std::sort(actual.begin(), actual.end());
+  EXPECT_EQ(actual, expected);
+
+  // Vertex fetch order: vertices are first referenced in increasing order
+  std::uint32_t highest = 0;
+  for (std::uint32_t index : indices)
+  {
+    EXPECT_LE(index, highest + 1);
+    highest = std::max(highest, index);
+  }
+}
+
+TEST(MeshBuilder, SwitchesTo32BitIndices)
+{
+  MeshBuilder builder(sizeof(std::uint32_t));
+  for (std::uint32_t i = 0; i < 0x10001; i++)
+    builder.addVertex(&i);
+
+  EXPECT_FALSE(builder.uses16BitIndices());
+  EXPECT_EQ(builder.getIndexSize(), 4u);
+}
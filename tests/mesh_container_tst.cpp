@@ -0,0 +1,50 @@
+#include "mesh_container.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+TEST(MeshContainer, RejectsSubmeshesOutsideTheData)
+{
+  // Two LODs of one triangle each
+  MeshContainer::MeshData mesh{};
+  mesh.lodScreenSize = {0.5f, 0.0f};
+  mesh.vertices.resize(6);
+  mesh.indices.assign(6 * 2, 0);
+  mesh.submeshes = {{0, 0, 0, 3, 0, 3}, {1, 0, 3, 3, 3, 3}};
+  const auto path = (std::filesystem::temp_directory_path() / "container_bad_tst.mesh").string();
+  ASSERT_TRUE(MeshContainer::write(path, mesh));
+
+  // Rewrites the last submesh, opens the file and puts it back
+  auto openPatched = [&](auto&& patch)
+  {
+    MeshContainer::Header header;
+    MeshContainer::Submesh submesh;
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    const std::streamoff offset = header.submeshOffset + sizeof(submesh);
+    file.seekg(offset);
+    file.read(reinterpret_cast<char*>(&submesh), sizeof(submesh));
+    const MeshContainer::Submesh original = submesh;
+    patch(submesh);
+    file.seekp(offset);
+    file.write(reinterpret_cast<const char*>(&submesh), sizeof(submesh));
+    file.flush();
+
+    MeshContainer::View view;
+    const bool opened = view.open(path);
+    file.seekp(offset);
+    file.write(reinterpret_cast<const char*>(&original), sizeof(original));
+    return opened;
+  };
+
+  EXPECT_TRUE(openPatched([](MeshContainer::Submesh&) {}));
+  EXPECT_FALSE(openPatched([](auto& submesh) { submesh.lod = 2; }));
+  EXPECT_FALSE(openPatched([](auto& submesh) { submesh.vertexCount = 4; }));
+  EXPECT_FALSE(openPatched([](auto& submesh) { submesh.indexCount = 4; }));
+  // Big enough to wrap around when added to the start
+  EXPECT_FALSE(openPatched([](auto& submesh) { submesh.firstIndex = 0xffffffffu; }));
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,90 @@
+#include "job_system.h"
+#include "sdf_brick_map.h"
+#include "sdf_object.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace
+{
+SDFObject makeScene(float cutterX)
+{
+  SDFObject sdf;
+  Transform cutter{};
+  cutter.position = glm::vec3(cutterX, 0.0f, 0.0f);
+  sdf.subtract(sdf.unite(sdf.box(glm::vec3(1.0f, 0.5f, 0.5f)), sdf.sphere(0.7f), 0.2f),
+               sdf.sphere(0.3f, cutter));
+  return sdf;
+}
+}  // namespace
+
+TEST(SDFBrickMapTest, MatchesTheObjectNearTheSurface)
+{
+  JobSystem jobs(2);
+  const SDFObject sdf = makeScene(1.0f);
+  constexpr float VOXEL = 0.05f;
+
+  for (SDFBrickFormat format : {SDFBrickFormat::R8, SDFBrickFormat::R16})
+  {
+    SDFBrickMap map(VOXEL, 3.0f, format);
+    map.bake(sdf, jobs);
+    ASSERT_GT(map.getBrickCount(), 0u);
+    // Sparse: the bricks away from the surface aren't stored
+    EXPECT_LT(map.getBrickCount(), map.getIndirection().size());
+
+    // Interpolation error is second order in the voxel size, plus a quantisation step
+    const float tolerance = 0.2f * VOXEL + 2.0f * map.getBand() / 255.0f;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-1.5f, 1.5f);
+    int checked = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+      const glm::vec3 p(coord(rng), coord(rng), coord(rng));
+      const float exact = sdf.evaluate(p);
+      const float baked = map.sample(p);
+      if (std::abs(exact) < map.getBand() - VOXEL)
+      {
+        EXPECT_NEAR(baked, exact, tolerance);
+        checked++;
+      }
+      else
+      {
+        // Clamped, but on the right side
+        EXPECT_EQ(baked < 0.0f, exact < 0.0f);
+      }
+    }
+    EXPECT_GT(checked, 100);
+  }
+}
+
+TEST(SDFBrickMapTest, IncrementalUpdateMatchesFullBake)
+{
+  JobSystem jobs(2);
+  SDFBrickMap map(0.05f);
+  map.bake(makeScene(1.0f), jobs);
+  map.clearChanges();
+
+  // Move the cutter, both where it was and where it went changed
+  const SDFObject edited = makeScene(0.6f);
+  map.markDirty(AABB::fromSphere({1.0f, 0.0f, 0.0f}, 0.3f));
+  map.markDirty(AABB::fromSphere({0.6f, 0.0f, 0.0f}, 0.3f));
+  const std::size_t rebaked = map.update(edited, jobs);
+  EXPECT_GT(rebaked, 0u);
+  EXPECT_LT(rebaked, map.getIndirection().size());
+  EXPECT_FALSE(map.isFullyChanged());
+  EXPECT_FALSE(map.getChangedSlots().empty());
+
+  SDFBrickMap fresh(0.05f);
+  fresh.bake(edited, jobs);
+  EXPECT_EQ(map.getIndirection().size(), fresh.getIndirection().size());
+  EXPECT_EQ(map.getBrickCount(), fresh.getBrickCount());
+
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<float> coord(-1.5f, 1.5f);
+  for (int i = 0; i < 5000; i++)
+  {
+    const glm::vec3 p(coord(rng), coord(rng), coord(rng));
+    EXPECT_FLOAT_EQ(map.sample(p), fresh.sample(p));
+  }
+}
@@ -0,0 +1,135 @@
+#include "job_system.h"
+#include "sdf_collision.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+// A floor with its top at y = 0 and a sphere of radius 1 sitting on it at x = 3
+void fillWorld(SDFCollisionWorld& world)
+{
+  SDFObject floor;
+  floor.box(glm::vec3(10.0f, 0.5f, 10.0f));
+  Transform floorTransform{};
+  floorTransform.position = glm::vec3(0.0f, -0.5f, 0.0f);
+  world.add(floor, floorTransform);
+
+  SDFObject ball;
+  ball.sphere(0.5f);
+  Transform ballTransform{};
+  ballTransform.position = glm::vec3(3.0f, 1.0f, 0.0f);
+  ballTransform.scale = glm::vec3(2.0f);
+  world.add(ball, ballTransform);
+}
+}  // namespace
+
+TEST(SDFCollisionTest, DistanceNormalAndSweep)
+{
+  SDFCollisionWorld world;
+  fillWorld(world);
+  EXPECT_NEAR(world.distance(glm::vec3(0.0f, 2.0f, 0.0f)), 2.0f, 1e-4f);
+  // Scaled instances report world distances
+  EXPECT_NEAR(world.distance(glm::vec3(3.0f, 1.0f, 2.0f)), 1.0f, 1e-4f);
+
+  const glm::vec3 normal = world.normal(glm::vec3(3.0f + 1.0f, 1.0f, 0.0f));
+  EXPECT_NEAR(normal.x, 1.0f, 1e-3f);
+
+  SDFCollisionWorld::Hit hit;
+  ASSERT_TRUE(
+      world.sweepSphere(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(6.0f, 1.0f, 0.0f), 0.5f, hit));
+  // Touches the ball at x = 3 - 1 - 0.5
+  EXPECT_NEAR(hit.fraction * 6.0f, 1.5f, 2e-3f);
+  EXPECT_NEAR(hit.normal.x, -1.0f, 1e-2f);
+  EXPECT_FALSE(
+      world.sweepSphere(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 4.0f), 0.5f, hit));
+}
+
+TEST(SDFCollisionTest, ShapesMoveAndChangeInPlace)
+{
+  SDFCollisionWorld world;
+  SDFObject ball;
+  ball.sphere(0.5f);
+  const std::uint32_t index = world.add(ball, glm::mat4(1.0f));
+  EXPECT_NEAR(world.distance(glm::vec3(0.0f, 2.0f, 0.0f)), 1.5f, 1e-4f);
+
+  // Far enough to leave its old fat bounds, so the BVH has to follow
+  world.update(index, glm::translate(glm::mat4(1.0f), glm::vec3(20.0f, 0.0f, 0.0f)));
+  EXPECT_NEAR(world.distance(glm::vec3(20.0f, 2.0f, 0.0f)), 1.5f, 1e-4f);
+  EXPECT_GT(world.distance(glm::vec3(0.0f)), 10.0f);
+
+  SDFObject box;
+  box.box(glm::vec3(1.0f));
+  world.replace(index, box, glm::mat4(1.0f));
+  EXPECT_EQ(world.getShapeCount(), 1u);
+  EXPECT_NEAR(world.distance(glm::vec3(0.0f, 3.0f, 0.0f)), 2.0f, 1e-4f);
+
+  // An empty shape keeps its index but can't be hit
+  world.replace(index, SDFObject(), glm::mat4(1.0f));
+  EXPECT_GT(world.distance(glm::vec3(0.0f)), 1e6f);
+  world.replace(index, ball, glm::mat4(1.0f));
+  EXPECT_NEAR(world.distance(glm::vec3(0.0f, 2.0f, 0.0f)), 1.5f, 1e-4f);
+}
+
+TEST(SDFCollisionTest, MoversSlideAndGetPushedOut)
+{
+  SDFCollisionWorld world;
+  fillWorld(world);
+
+  // Falling diagonally onto the floor keeps the sideways part of the motion
+  SDFCollisionWorld::Mover falling;
+  falling.position = glm::vec3(-3.0f, 1.0f, 0.0f);
+  falling.motion = glm::vec3(1.0f, -2.0f, 0.0f);
+  falling.radius = 0.25f;
+  world.move(falling);
+  EXPECT_TRUE(falling.collided);
+  EXPECT_NEAR(falling.position.y, 0.25f, 0.01f);
+  EXPECT_NEAR(falling.position.x, -2.0f, 0.01f);
+  EXPECT_NEAR(falling.normal.y, 1.0f, 1e-3f);
+
+  // A capsule started halfway into the floor ends up standing on it
+  SDFCollisionWorld::Mover capsule;
+  capsule.position = glm::vec3(-5.0f, 0.5f, 0.0f);
+  capsule.radius = 0.3f;
+  capsule.halfHeight = 0.5f;
+  EXPECT_NEAR(world.penetration(capsule), 0.3f, 1e-3f);
+  world.move(capsule);
+  EXPECT_TRUE(capsule.collided);
+  EXPECT_LE(world.penetration(capsule), 0.0f);
+  EXPECT_NEAR(capsule.position.y, 0.8f, 0.01f);
+}
+
+TEST(SDFCollisionTest, BatchedMatchesOneByOne)
+{
+  SDFCollisionWorld world;
+  fillWorld(world);
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> coord(-4.0f, 4.0f);
+  std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+
+  std::vector<SDFCollisionWorld::Mover> movers(301);
+  for (std::size_t i = 0; i < movers.size(); i++)
+  {
+    movers[i].position = glm::vec3(coord(rng), coord(rng) * 0.5f + 2.0f, coord(rng));
+    movers[i].motion = glm::vec3(step(rng), step(rng) * 3.0f, step(rng));
+    movers[i].radius = 0.2f;
+    movers[i].halfHeight = i % 2 ? 0.3f : 0.0f;
+  }
+  std::vector<SDFCollisionWorld::Mover> single = movers;
+
+  JobSystem jobs(2);
+  world.move(movers, jobs);
+  int collided = 0;
+  for (std::size_t i = 0; i < movers.size(); i++)
+  {
+    world.move(single[i]);
+    EXPECT_EQ(movers[i].collided, single[i].collided);
+    EXPECT_NEAR(glm::length(movers[i].position - single[i].position), 0.0f, 1e-4f);
+    EXPECT_LT(world.penetration(movers[i]), movers[i].radius * SDFCollisionWorld::MIN_STEP);
+    collided += movers[i].collided;
+  }
+  EXPECT_GT(collided, 10);
+}
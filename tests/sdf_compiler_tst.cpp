@@ -0,0 +1,49 @@
+#include "sdf_compiler.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+// Sphere blended into a moved box, the sizes are the only thing that varies
+SDFObject makeBlob(float radius, float offset)
+{
+  SDFObject sdf;
+  Transform transform{};
+  transform.position = glm::vec3(offset, 0.0f, 0.0f);
+  sdf.unite(sdf.sphere(radius), sdf.box(glm::vec3(0.5f), transform), 0.2f);
+  return sdf;
+}
+}  // namespace
+
+TEST(SDFCompilerTest, ParametersDontChangeTheStructure)
+{
+  const SDFObject a = makeBlob(1.0f, 1.0f);
+  const SDFObject b = makeBlob(0.5f, 2.0f);
+  EXPECT_EQ(SDFCompiler::structureKey(a, false), SDFCompiler::structureKey(b, false));
+  EXPECT_EQ(SDFCompiler::generate(a, false), SDFCompiler::generate(b, false));
+
+  // Baked programs are per value
+  EXPECT_NE(SDFCompiler::structureKey(a, true), SDFCompiler::structureKey(b, true));
+
+  // Moving the box back to the origin folds its translation away
+  const SDFObject centered = makeBlob(1.0f, 0.0f);
+  EXPECT_NE(SDFCompiler::structureKey(a, false), SDFCompiler::structureKey(centered, false));
+}
+
+TEST(SDFCompilerTest, ParametersMatchTheBlock)
+{
+  const SDFObject sdf = makeBlob(1.0f, 1.0f);
+  std::vector<glm::vec4> parameters;
+  SDFCompiler::gatherParameters(sdf, parameters);
+  // Sphere size, box offset and size, smoothness
+  ASSERT_EQ(parameters.size(), 4u);
+  EXPECT_EQ(parameters[0].x, 1.0f);
+  EXPECT_EQ(parameters[3].x, 0.2f);
+
+  const std::string code = SDFCompiler::generate(sdf, false);
+  EXPECT_NE(code.find("sdfParameters[4]"), std::string::npos);
+
+  const std::string baked = SDFCompiler::generate(sdf, true);
+  EXPECT_EQ(baked.find("sdfParameters"), std::string::npos);
+  EXPECT_NE(baked.find("opSmoothUnion"), std::string::npos);
+}
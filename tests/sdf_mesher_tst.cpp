@@ -0,0 +1,82 @@
+#include "job_system.h"
+#include "sdf_mesher.h"
+#include "sdf_object.h"
+#include "vertex_format.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <utility>
+
+namespace
+{
+glm::vec3 positionOf(const MeshContainer::Vertex& vertex)
+{
+  return {vertex.position[0], vertex.position[1], vertex.position[2]};
+}
+}  // namespace
+
+TEST(SDFMesherTest, SphereIsClosedAndOnTheSurface)
+{
+  JobSystem jobs(2);
+  SDFObject sdf;
+  sdf.sphere(1.0f);
+  // Over 100 cells across, so the surface runs through several chunks
+  constexpr float VOXEL = 0.02f;
+  const SDFMesher::Level level = SDFMesher::extract(sdf, VOXEL, jobs);
+  ASSERT_FALSE(level.indices.empty());
+
+  for (const auto& vertex : level.vertices)
+  {
+    const glm::vec3 p = positionOf(vertex);
+    EXPECT_LT(std::abs(sdf.evaluate(p)), VOXEL);
+    // Normals point out of the sphere
+    const glm::vec4 normal = VertexFormat::unpackNormal({vertex.normal});
+    EXPECT_GT(glm::dot(glm::vec3(normal), glm::normalize(p)), 0.99f);
+  }
+
+  // Welded across chunks, every edge is shared by exactly two triangles and the faces wind
+  // outwards
+  std::map<std::pair<std::uint32_t, std::uint32_t>, int> edges;
+  int outward = 0;
+  for (std::size_t i = 0; i < level.indices.size(); i += 3)
+  {
+    const std::uint32_t* t = &level.indices[i];
+    for (int k = 0; k < 3; k++)
+    {
+      const std::uint32_t a = t[k];
+      const std::uint32_t b = t[(k + 1) % 3];
+      edges[{std::min(a, b), std::max(a, b)}]++;
+    }
+    const glm::vec3 p0 = positionOf(level.vertices[t[0]]);
+    const glm::vec3 p1 = positionOf(level.vertices[t[1]]);
+    const glm::vec3 p2 = positionOf(level.vertices[t[2]]);
+    outward += glm::dot(glm::cross(p1 - p0, p2 - p0), p0 + p1 + p2) > 0.0f;
+  }
+  for (const auto& [edge, count] : edges)
+    ASSERT_EQ(count, 2);
+  EXPECT_EQ(outward, static_cast<int>(level.indices.size() / 3));
+}
+
+TEST(SDFMesherTest, CoarserLodsHaveFewerTriangles)
+{
+  JobSystem jobs(2);
+  SDFObject sdf;
+  Transform cutter{};
+  cutter.position = glm::vec3(0.8f, 0.0f, 0.0f);
+  sdf.subtract(sdf.torus(0.8f, 0.3f), sdf.sphere(0.4f, cutter), 0.05f);
+
+  const MeshContainer::MeshData data = SDFMesher::build(sdf, 0.02f, 3, jobs);
+  ASSERT_EQ(data.submeshes.size(), 3u);
+  ASSERT_EQ(data.lodScreenSize.size(), 3u);
+  for (std::size_t lod = 1; lod < data.submeshes.size(); lod++)
+  {
+    EXPECT_LT(data.submeshes[lod].indexCount * 3, data.submeshes[lod - 1].indexCount);
+    EXPECT_LT(data.lodScreenSize[lod], data.lodScreenSize[lod - 1]);
+  }
+  EXPECT_EQ(data.indices.size(),
+            (data.submeshes.back().firstIndex + data.submeshes.back().indexCount) *
+                data.indexSize);
+  EXPECT_NEAR(data.boundsMin[0], -1.1f, 0.01f);
+  EXPECT_NEAR(data.boundsMin[1], -0.3f, 0.01f);
+}
@@ -0,0 +1,51 @@
+#include "job_system.h"
+#include "sdf_reference_renderer.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace
+{
+constexpr int SIZE = 64;
+
+// Unit sphere five units in front of the default camera
+std::vector<float> renderSphere(JobSystem& jobs)
+{
+  SDFObject sdf;
+  sdf.sphere(1.0f);
+  SDFReferenceRenderer renderer(jobs);
+  renderer.add(sdf, Transform{}, glm::vec3(1.0f));
+
+  Transform cameraTransform{};
+  cameraTransform.position = glm::vec3(0.0f, 0.0f, 5.0f);
+  return renderer.render(Camera{}, cameraTransform, SIZE, SIZE);
+}
+}  // namespace
+
+TEST(SDFReferenceRendererTest, RendersASphere)
+{
+  JobSystem jobs(2);
+  const std::vector<float> image = renderSphere(jobs);
+  ASSERT_EQ(image.size(), static_cast<std::size_t>(SIZE * SIZE * 3));
+
+  // Facing the camera, lit like the shader does
+  const float* center = &image[(SIZE / 2 * SIZE + SIZE / 2) * 3];
+  const float facing = 0.3f + 0.7f * (1.0f / std::sqrt(3.0f));
+  EXPECT_NEAR(center[0], facing, 0.02f);
+  EXPECT_FLOAT_EQ(image[0], 0.1f);
+
+  // Silhouette radius is tan(asin(1/5)) over tan(fov/2) of half the image
+  const float radius = std::tan(std::asin(0.2f)) / std::tan(glm::radians(22.5f)) * SIZE / 2;
+  int covered = 0;
+  for (int i = 0; i < SIZE * SIZE; i++)
+    covered += image[i * 3] != 0.1f;
+  EXPECT_NEAR(covered, 3.14159f * radius * radius, 0.05f * covered);
+}
+
+TEST(SDFReferenceRendererTest, SameImageOnAnyThreadCount)
+{
+  JobSystem one(1);
+  JobSystem many(4);
+  EXPECT_EQ(renderSphere(one), renderSphere(many));
+}
@@ -0,0 +1,135 @@
+#include "sdf_object.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace
+{
+struct Points
+{
+  std::vector<float> x, y, z;
+
+  glm::vec3 operator[](std::size_t i) const { return {x[i], y[i], z[i]}; }
+};
+
+Points randomPoints(std::size_t count, float range, unsigned int seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> coord(-range, range);
+  Points points;
+  for (std::size_t i = 0; i < count; i++)
+  {
+    points.x.push_back(coord(rng));
+    points.y.push_back(coord(rng));
+    points.z.push_back(coord(rng));
+  }
+  return points;
+}
+
+Transform makeTransform(const glm::vec3& position, float angle, float scale)
+{
+  Transform transform;
+  transform.position = position;
+  transform.rotation = glm::angleAxis(angle, glm::normalize(glm::vec3(1.0f, 2.0f, 0.5f)));
+  transform.scale = glm::vec3(scale);
+  return transform;
+}
+
+// A bit of everything: transformed primitives under sharp and smooth operators
+SDFObject makeScene()
+{
+  SDFObject sdf;
+  const SDFNodeId body = sdf.box({1.0f, 0.5f, 0.75f}, makeTransform({0, 0, 0}, 0.4f, 1.0f));
+  const SDFNodeId ball = sdf.sphere(0.6f, makeTransform({1.0f, 0.3f, 0}, 0.0f, 1.5f));
+  const SDFNodeId ring = sdf.torus(0.8f, 0.2f, makeTransform({-0.5f, 0.5f, 0.2f}, 1.1f, 1.0f));
+  const SDFNodeId pill = sdf.capsule(0.7f, 0.25f, makeTransform({0, -0.4f, 0.4f}, 2.0f, 0.8f));
+  const SDFNodeId blob = sdf.unite(body, ball, 0.3f);
+  const SDFNodeId carved = sdf.subtract(blob, pill, 0.1f);
+  sdf.unite(carved, sdf.intersect(ring, sdf.sphere(1.5f)));
+  return sdf;
+}
+}  // namespace
+
+TEST(SDFObjectTest, PrimitivesMatchShaderFormulas)
+{
+  const Points points = randomPoints(256, 3.0f, 1);
+  const Transform moved = makeTransform({0.5f, -0.25f, 1.0f}, 0.7f, 2.0f);
+
+  SDFObject sphere, box, capsule, torus;
+  sphere.sphere(1.0f, moved);
+  box.box({1.0f, 0.5f, 0.25f}, moved);
+  capsule.capsule(0.5f, 0.3f, moved);
+  torus.torus(1.0f, 0.25f, moved);
+
+  for (std::size_t i = 0; i < points.x.size(); i++)
+  {
+    // What sdf_primitives.glsl computes for the same point in the primitive's local space
+    const glm::vec3 p = glm::conjugate(moved.rotation) * (points[i] - moved.position) / 2.0f;
+
+    const float sphereRef = glm::length(p) - 1.0f;
+
+    const glm::vec3 q = glm::abs(p) - glm::vec3(1.0f, 0.5f, 0.25f);
+    const float boxRef =
+        glm::length(glm::max(q, 0.0f)) + std::min(std::max(q.x, std::max(q.y, q.z)), 0.0f);
+
+    glm::vec3 c = p;
+    c.y -= glm::clamp(c.y, -0.5f, 0.5f);
+    const float capsuleRef = glm::length(c) - 0.3f;
+
+    const glm::vec2 t(glm::length(glm::vec2(p.x, p.z)) - 1.0f, p.y);
+    const float torusRef = glm::length(t) - 0.25f;
+
+    EXPECT_NEAR(sphere.evaluate(points[i]), sphereRef * 2.0f, SDFObject::SHADER_TOLERANCE);
+    EXPECT_NEAR(box.evaluate(points[i]), boxRef * 2.0f, SDFObject::SHADER_TOLERANCE);
+    EXPECT_NEAR(capsule.evaluate(points[i]), capsuleRef * 2.0f, SDFObject::SHADER_TOLERANCE);
+    EXPECT_NEAR(torus.evaluate(points[i]), torusRef * 2.0f, SDFObject::SHADER_TOLERANCE);
+  }
+}
+
+TEST(SDFObjectTest, BatchedMatchesScalar)
+{
+  const SDFObject sdf = makeScene();
+  // None a multiple of the batch width, so the last step is padded with copies of the last
+  // point. The small ones are nothing but that padded step.
+  for (std::size_t count : {1, 5, 1003})
+  {
+    const Points points = randomPoints(count, 3.0f, 2);
+
+    std::vector<float> batched(count), scalar(count);
+    sdf.evaluate(points.x.data(), points.y.data(), points.z.data(), count, batched.data());
+    sdf.evaluateScalar(points.x.data(), points.y.data(), points.z.data(), count, scalar.data());
+
+    for (std::size_t i = 0; i < count; i++)
+      EXPECT_NEAR(batched[i], scalar[i], SDFObject::SHADER_TOLERANCE) << "point " << i;
+  }
+}
+
+TEST(SDFObjectTest, SmoothOperatorsBlend)
+{
+  SDFObject sharp, smooth;
+  sharp.unite(sharp.sphere(1.0f), sharp.sphere(1.0f, makeTransform({1.5f, 0, 0}, 0.0f, 1.0f)));
+  smooth.unite(
+      smooth.sphere(1.0f), smooth.sphere(1.0f, makeTransform({1.5f, 0, 0}, 0.0f, 1.0f)), 0.5f);
+
+  // Between the spheres the blend fills in, far away both agree
+  const glm::vec3 seam(0.75f, 0.9f, 0.0f);
+  EXPECT_LT(smooth.evaluate(seam), sharp.evaluate(seam));
+  EXPECT_NEAR(smooth.evaluate({-3.0f, 0, 0}), sharp.evaluate({-3.0f, 0, 0}), 1e-6f);
+}
+
+TEST(SDFObjectTest, BoundsContainSurface)
+{
+  const SDFObject sdf = makeScene();
+  const AABB bounds = sdf.getBounds();
+  ASSERT_FALSE(bounds.isEmpty());
+
+  const Points points = randomPoints(4096, 4.0f, 3);
+  for (std::size_t i = 0; i < points.x.size(); i++)
+  {
+    if (!bounds.contains(AABB(points[i], points[i])))
+    {
+      EXPECT_GT(sdf.evaluate(points[i]), 0.0f);
+    }
+  }
+}
@@ -0,0 +1,94 @@
+#include "shader_preprocessor.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+class ShaderPreprocessorTest : public ::testing::Test
+{
+  protected:
+  void SetUp() override
+  {
+    m_dir = std::filesystem::temp_directory_path() /
+            ("shader_pp_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    std::filesystem::create_directories(m_dir / "include");
+  }
+
+  void TearDown() override { std::filesystem::remove_all(m_dir); }
+
+  std::string write(const std::string& name, const std::string& contents)
+  {
+    const auto path = (m_dir / name).lexically_normal();
+    std::ofstream(path) << contents;
+    return path.string();
+  }
+
+  std::filesystem::path m_dir;
+};
+}  // namespace
+
+TEST_F(ShaderPreprocessorTest, ExpandsIncludesOncePerStage)
+{
+  const auto common = write("include/common.glsl", "uniform mat4 view;\n");
+  const auto shader = write("test.glsl",
+                            "#shader vertex\n"
+                            "#version 330 core\n"
+                            "#include \"include/common.glsl\"\n"
+                            "  #include \"include/common.glsl\"\n"
+                            "void main() {}\n"
+                            "#shader fragment\n"
+                            "#version 330 core\n"
+                            "#include \"include/common.glsl\"\n"
+                            "void main() {}\n");
+
+  const auto result = ShaderPreprocessor::process(shader);
+  ASSERT_TRUE(result.ok);
+  ASSERT_EQ(result.dependencies.size(), 2u);
+  EXPECT_EQ(result.dependencies[1], common);
+
+  // Included once in each stage, with #line switching into source string 1 and back
+  const auto& vertex = result.source.VertexSource;
+  EXPECT_EQ(vertex.find("uniform mat4 view;"), vertex.rfind("uniform mat4 view;"));
+  EXPECT_NE(vertex.find("#line 1 1\nuniform mat4 view;\n#line 4 0\n"), std::string::npos);
+  EXPECT_EQ(vertex.find("#version 330 core\n"), 0u);
+  EXPECT_NE(result.source.FragmentSource.find("uniform mat4 view;"), std::string::npos);
+  EXPECT_EQ(result.source.FragmentSource.find("#shader"), std::string::npos);
+}
+
+TEST_F(ShaderPreprocessorTest, InjectsDefinesAndCollectsKeywords)
+{
+  const auto shader = write("variants.glsl",
+                            "#shader vertex\n"
+                            "#version 330 core\n"
+                            "void main() {}\n"
+                            "#shader fragment\n"
+                            "#version 330 core\n"
+                            "#pragma keywords FOG  SHADOWS\n"
+                            "void main() {}\n");
+
+  const auto keywords = ShaderPreprocessor::process(shader).keywords;
+  ASSERT_EQ(keywords, (std::vector<std::string>{"FOG", "SHADOWS"}));
+
+  const auto defines = ShaderPreprocessor::keywordDefines(keywords, 0b10);
+  ASSERT_EQ(defines, (std::vector<std::string>{"SHADOWS"}));
+
+  const auto result = ShaderPreprocessor::process(shader, {"SHADOWS", "QUALITY 2"});
+  EXPECT_EQ(result.source.FragmentSource.find("#version 330 core\n"
+                                              "#define SHADOWS\n"
+                                              "#define QUALITY 2\n"
+                                              "#line 6 0\n"),
+            0u);
+  EXPECT_EQ(result.source.FragmentSource.find("#pragma"), std::string::npos);
+}
+
+TEST_F(ShaderPreprocessorTest, ReportsMissingInclude)
+{
+  const auto shader = write("broken.glsl",
+                            "#shader vertex\n"
+                            "#version 330 core\n"
+                            "#include \"include/missing.glsl\"\n");
+  EXPECT_FALSE(ShaderPreprocessor::process(shader).ok);
+}
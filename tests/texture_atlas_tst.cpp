@@ -0,0 +1,99 @@
+#include "image_util.h"
+#include "texture_atlas.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace
+{
+std::vector<unsigned char> solid(int width, int height, unsigned char value)
+{
+  return std::vector<unsigned char>(static_cast<size_t>(width) * height * 4, value);
+}
+}  // namespace
+
+TEST(AtlasPacker, RectsStayInsideAndKeepTheirPadding)
+{
+  const int padding = 4;
+  AtlasPacker packer(256, 256, padding, padding);
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> size(1, 40);
+
+  std::vector<std::pair<glm::ivec2, glm::ivec2>> placed;
+  for (int i = 0; i < 200; i++)
+  {
+    const glm::ivec2 extent(size(rng), size(rng));
+    auto corner = packer.pack(extent.x, extent.y);
+    if (!corner)
+      continue;
+
+    EXPECT_EQ(corner->x % padding, 0);
+    EXPECT_EQ(corner->y % padding, 0);
+    EXPECT_GE(glm::min(corner->x, corner->y), padding);
+    EXPECT_LE(corner->x + extent.x + padding, 256);
+    EXPECT_LE(corner->y + extent.y + padding, 256);
+
+    // Each rect owns its padding, so neighbours end up at least twice the padding apart
+    for (const auto& [otherCorner, otherExtent] : placed)
+    {
+      const bool apart = corner->x + extent.x + 2 * padding <= otherCorner.x ||
+                         otherCorner.x + otherExtent.x + 2 * padding <= corner->x ||
+                         corner->y + extent.y + 2 * padding <= otherCorner.y ||
+                         otherCorner.y + otherExtent.y + 2 * padding <= corner->y;
+      EXPECT_TRUE(apart);
+    }
+    placed.emplace_back(*corner, extent);
+  }
+  EXPECT_GT(placed.size(), 20u);
+}
+
+TEST(TextureAtlas, FullSizeGetsALayerAndSmallOnesShareOne)
+{
+  TextureAtlas atlas(64, 64, 4);
+  const size_t full = atlas.add(solid(64, 64, 10), 64, 64);
+  const size_t small = atlas.add(solid(16, 8, 20), 16, 8);
+  const size_t other = atlas.add(solid(8, 8, 30), 8, 8);
+  const size_t large = atlas.add(solid(128, 128, 40), 128, 128);
+  atlas.build();
+
+  ASSERT_EQ(atlas.getLayerCount(), 3);
+  EXPECT_EQ(atlas.getRegion(full).scale, glm::vec2(1.0f));
+  EXPECT_EQ(atlas.getRegion(large).scale, glm::vec2(1.0f));
+  EXPECT_NE(atlas.getRegion(full).layer, atlas.getRegion(large).layer);
+  EXPECT_EQ(atlas.getRegion(small).layer, atlas.getRegion(other).layer);
+  EXPECT_EQ(atlas.getRegion(small).scale, glm::vec2(16.0f / 64.0f, 8.0f / 64.0f));
+
+  // Mips stop where a texel would cover more than the gutter
+  EXPECT_EQ(atlas.getMipCount(), 3);
+
+  // The texel just outside the region repeats its edge instead of the neighbour's colour
+  const TextureRegion& region = atlas.getRegion(small);
+  const glm::ivec2 corner = glm::ivec2(region.offset * 64.0f);
+  const auto& layer = atlas.getLayer(region.layer);
+  EXPECT_EQ(layer[((corner.y - 1) * 64 + corner.x - 1) * 4], 20);
+  EXPECT_EQ(layer[((corner.y + 8) * 64 + corner.x + 16) * 4], 20);
+}
+
+TEST(TextureAtlas, CoarseMipsStayInsideTheGutter)
+{
+  // 10x5 with an 8 texel gutter takes a 32x24 footprint, more than the gutter alone covers
+  TextureAtlas atlas(64, 64, 8);
+  const size_t id = atlas.add(solid(10, 5, 200), 10, 5);
+  atlas.add(solid(64, 64, 10), 64, 64);
+  atlas.build();
+  ASSERT_EQ(atlas.getMipCount(), 4);
+
+  const TextureRegion& region = atlas.getRegion(id);
+  const auto mips = ImageUtil::buildMipChain(atlas.getLayer(region.layer), 64, 64, 4);
+  const auto& coarsest = mips[atlas.getMipCount() - 1];
+
+  // Bilinear on the region's edges reads the texels on either side, at this level 8 across
+  const glm::ivec2 first = glm::ivec2(glm::floor(region.offset * 8.0f - 0.5f));
+  const glm::ivec2 last = glm::ivec2(glm::floor((region.offset + region.scale) * 8.0f - 0.5f)) + 1;
+  for (int y = first.y; y <= last.y; y++)
+  {
+    for (int x = first.x; x <= last.x; x++)
+      EXPECT_EQ(coarsest[(y * 8 + x) * 4], 200) << x << ", " << y;
+  }
+}
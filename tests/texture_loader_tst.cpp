@@ -0,0 +1,60 @@
+#include "image_util.h"
+#include "texture_loader.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+TEST(TextureLoaderTest, BandsFitTheBudgetOncePadded)
+{
+  // 5 RGB pixels are 15 bytes a row, 3 rows would fit unpadded but take 48 bytes of staging
+  EXPECT_EQ(TextureLoader::bandRows(10, 15, 47), 2);
+  EXPECT_EQ(TextureLoader::bandRows(10, 15, 48), 3);
+  EXPECT_EQ(TextureLoader::bandRows(1, 15, 48), 1);
+  EXPECT_EQ(TextureLoader::bandRows(10, 15, 14), 0);
+  EXPECT_EQ(TextureLoader::stagingBytes(45), 48u);
+  EXPECT_EQ(TextureLoader::stagingBytes(48), 48u);
+}
+
+TEST(TextureLoaderTest, OddWidthRGBStaysInsideTheStagingRegion)
+{
+  // Replays update() over a 37x23 RGB chain, with the offsets StreamBuffer::allocate() hands out
+  const int width = 37;
+  const int height = 23;
+  const unsigned int frameBudget = 1000;
+  const unsigned int regionSize = TextureLoader::stagingBytes(frameBudget);
+
+  int level = ImageUtil::mipCount(width, height) - 1;
+  int row = 0;
+  int frames = 0;
+  while (level >= 0 && frames < 100)
+  {
+    unsigned int budget = frameBudget;
+    unsigned int cursor = 0;
+    while (level >= 0)
+    {
+      const int levelHeight = std::max(1, height >> level);
+      const unsigned int rowBytes = std::max(1, width >> level) * 3;
+      const int rows = TextureLoader::bandRows(levelHeight - row, rowBytes, budget);
+      if (rows <= 0)
+        break;
+
+      const unsigned int bytes = rows * rowBytes;
+      const unsigned int offset = TextureLoader::stagingBytes(cursor);
+      ASSERT_LE(offset + bytes, regionSize);
+      cursor = offset + bytes;
+      budget -= TextureLoader::stagingBytes(bytes);
+
+      row += rows;
+      if (row == levelHeight)
+      {
+        level--;
+        row = 0;
+      }
+    }
+    frames++;
+  }
+  EXPECT_EQ(level, -1);
+  // 111 byte rows: 9 to a frame, level 0 alone takes three
+  EXPECT_GT(frames, 3);
+}
@@ -0,0 +1,73 @@
+#include "mip_residency.h"
+
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <vector>
+
+TEST(MipResidencyTest, SelectMipKeepsAboutOneTexelPerPixel)
+{
+  EXPECT_EQ(MipResidency::selectMip(512, 512, 512.0f), 0);
+  EXPECT_EQ(MipResidency::selectMip(512, 512, 2000.0f), 0);
+  EXPECT_EQ(MipResidency::selectMip(512, 512, 256.0f), 1);
+  // In between it rounds towards the finer level
+  EXPECT_EQ(MipResidency::selectMip(512, 512, 200.0f), 1);
+  EXPECT_EQ(MipResidency::selectMip(512, 512, 64.0f), 3);
+  EXPECT_EQ(MipResidency::selectMip(512, 512, 0.0f), 9);
+  // The longer side decides
+  EXPECT_EQ(MipResidency::selectMip(512, 128, 128.0f), 2);
+
+  // 90 degrees shows 2 units at distance 1
+  EXPECT_NEAR(MipResidency::projectedSize(2.0f, 1.0f, glm::radians(90.0f), 1080.0f),
+              1080.0f,
+              1e-2f);
+}
+
+namespace
+{
+// Four levels, the last two are the tail
+const std::vector<std::size_t> LEVELS = {64, 16, 4, 1};
+
+MipResidency::Item item(int residentMip, int targetMip, std::uint64_t lastUsedFrame)
+{
+  return {LEVELS, residentMip, targetMip, 2, lastUsedFrame};
+}
+}  // namespace
+
+TEST(MipResidencyTest, EvictsSurplusThenLeastRecentlyUsedAndKeepsTheTail)
+{
+  // a holds two levels nobody asks for anymore, b was used before c
+  std::vector<MipResidency::Item> items = {item(0, 2, 10), item(0, 0, 5), item(0, 0, 9)};
+
+  EXPECT_EQ(MipResidency::plan(items, 1000), 3 * 85u);
+  EXPECT_EQ(items[0].plannedMip, 0);
+  EXPECT_EQ(items[1].plannedMip, 0);
+  EXPECT_EQ(items[2].plannedMip, 0);
+
+  // The surplus goes first although a was used most recently
+  EXPECT_EQ(MipResidency::plan(items, 180), 175u);
+  EXPECT_EQ(items[0].plannedMip, 2);
+  EXPECT_EQ(items[1].plannedMip, 0);
+  EXPECT_EQ(items[2].plannedMip, 0);
+
+  // Then the least recently used one
+  EXPECT_EQ(MipResidency::plan(items, 100), 95u);
+  EXPECT_EQ(items[0].plannedMip, 2);
+  EXPECT_EQ(items[1].plannedMip, 2);
+  EXPECT_EQ(items[2].plannedMip, 0);
+
+  // Nothing goes past the tail
+  EXPECT_EQ(MipResidency::plan(items, 0), 3 * 5u);
+  for (const auto& planned : items)
+    EXPECT_EQ(planned.plannedMip, 2);
+}
+
+TEST(MipResidencyTest, PlansTowardsTheTarget)
+{
+  // Nothing resident yet: the target is streamed in, but nothing finer
+  std::vector<MipResidency::Item> items = {item(4, 1, 1), item(4, 3, 1)};
+  MipResidency::plan(items, 1000);
+  EXPECT_EQ(items[0].plannedMip, 1);
+  EXPECT_EQ(items[1].plannedMip, 2);
+}
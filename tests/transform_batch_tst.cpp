@@ -0,0 +1,82 @@
+#include "job_system.h"
+#include "transform_batch.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+// Odd sized, so the SIMD paths leave a tail for the scalar one
+TransformBatch randomBatch(std::size_t count)
+{
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+  TransformBatch batch;
+  for (std::size_t i = 0; i < count; i++)
+  {
+    Transform transform{};
+    transform.position = glm::vec3(value(rng), value(rng), value(rng)) * 50.0f;
+    transform.rotation = glm::angleAxis(
+        value(rng) * 3.0f, glm::normalize(glm::vec3(value(rng), value(rng), value(rng)) + 0.01f));
+    transform.scale = glm::vec3(value(rng), value(rng), value(rng)) * 2.0f;
+    batch.push(transform);
+  }
+  return batch;
+}
+
+Transform transformAt(const TransformBatch& batch, std::size_t i)
+{
+  Transform transform{};
+  transform.position = glm::vec3(batch.px[i], batch.py[i], batch.pz[i]);
+  transform.rotation = glm::quat(batch.qw[i], batch.qx[i], batch.qy[i], batch.qz[i]);
+  transform.scale = glm::vec3(batch.sx[i], batch.sy[i], batch.sz[i]);
+  return transform;
+}
+}  // namespace
+
+TEST(TransformBatchTest, MatchesTransformMatrix)
+{
+  using TransformMatrices::Layout;
+  const TransformBatch batch = randomBatch(37);
+  for (Layout layout : {Layout::MAT4, Layout::AFFINE})
+  {
+    const std::size_t stride = TransformMatrices::floatsPerMatrix(layout);
+    std::vector<float> simd(batch.size() * stride);
+    std::vector<float> scalar(batch.size() * stride);
+    TransformMatrices::write(batch, 0, batch.size(), layout, simd.data());
+    TransformMatrices::writeScalar(batch, 0, batch.size(), layout, scalar.data());
+
+    for (std::size_t i = 0; i < batch.size(); i++)
+    {
+      const glm::mat4 expected = transformAt(batch, i).matrix();
+      for (int column = 0; column < 4; column++)
+      {
+        for (int row = 0; row < 4; row++)
+        {
+          // Affine is the transpose without the last row
+          if (layout == Layout::AFFINE && row == 3)
+            continue;
+          const std::size_t index =
+              i * stride + (layout == Layout::MAT4 ? column * 4 + row : row * 4 + column);
+          EXPECT_NEAR(simd[index], expected[column][row], 1e-4f);
+          EXPECT_NEAR(scalar[index], expected[column][row], 1e-4f);
+        }
+      }
+    }
+  }
+}
+
+TEST(TransformBatchTest, ParallelMatchesSerial)
+{
+  using TransformMatrices::Layout;
+  const TransformBatch batch = randomBatch(100'003);
+  const std::size_t stride = TransformMatrices::floatsPerMatrix(Layout::AFFINE);
+  std::vector<float> serial(batch.size() * stride);
+  std::vector<float> parallel(batch.size() * stride);
+  TransformMatrices::write(batch, Layout::AFFINE, serial.data());
+  JobSystem jobs(2);
+  TransformMatrices::write(batch, Layout::AFFINE, parallel.data(), &jobs);
+  EXPECT_EQ(serial, parallel);
+}
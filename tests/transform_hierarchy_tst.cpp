@@ -0,0 +1,121 @@
+#include "job_system.h"
+#include "transform_hierarchy.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+void expectNear(const glm::mat4x3& a, const glm::mat4x3& b)
+{
+  for (int column = 0; column < 4; column++)
+  {
+    for (int row = 0; row < 3; row++)
+      EXPECT_NEAR(a[column][row], b[column][row], 1e-4f);
+  }
+}
+
+Transform randomTransform(std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+  Transform transform{};
+  transform.position = glm::vec3(value(rng), value(rng), value(rng)) * 3.0f;
+  transform.rotation =
+      glm::angleAxis(value(rng) * 3.0f,
+                     glm::normalize(glm::vec3(value(rng), value(rng), value(rng)) + 0.01f));
+  transform.scale = glm::vec3(1.0f + 0.5f * value(rng));
+  return transform;
+}
+}  // namespace
+
+TEST(TransformHierarchyTest, ChildrenFollowTheirParents)
+{
+  // Listed children first, so the sort has something to do: 2 <- 1 <- 0, 3 is a root
+  TransformHierarchy hierarchy;
+  const std::vector<std::uint32_t> parents = {1, 2, TransformHierarchy::NO_PARENT, 99};
+  hierarchy.build(parents);
+  EXPECT_EQ(hierarchy.getLevelCount(), 3u);
+
+  Transform root{};
+  root.position = glm::vec3(10.0f, 0.0f, 0.0f);
+  root.rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  Transform arm{};
+  arm.position = glm::vec3(0.0f, 0.0f, -1.0f);
+  arm.scale = glm::vec3(2.0f);
+  Transform hand{};
+  hand.position = glm::vec3(1.0f, 0.0f, 0.0f);
+  hierarchy.setLocal(2, root);
+  hierarchy.setLocal(1, arm);
+  hierarchy.setLocal(0, hand);
+  hierarchy.setLocal(3, hand);
+  EXPECT_EQ(hierarchy.update(), 4u);
+
+  const glm::mat4 expected = root.matrix() * arm.matrix() * hand.matrix();
+  const glm::vec3 handPosition = hierarchy.getWorld(0)[3];
+  EXPECT_NEAR(glm::distance(handPosition, glm::vec3(expected[3])), 0.0f, 1e-4f);
+  // -Z turned 90 degrees about Y is -X, then 2 along the scaled arm's +X which is now -Z
+  EXPECT_NEAR(glm::distance(handPosition, glm::vec3(9.0f, 0.0f, -2.0f)), 0.0f, 1e-4f);
+  EXPECT_NEAR(glm::distance(glm::vec3(hierarchy.getWorld(3)[3]), hand.position), 0.0f, 1e-6f);
+}
+
+TEST(TransformHierarchyTest, OnlyChangedSubtreesAreRecomputed)
+{
+  TransformHierarchy hierarchy;
+  const std::vector<std::uint32_t> parents = {
+      TransformHierarchy::NO_PARENT, 0, 1, TransformHierarchy::NO_PARENT, 3};
+  hierarchy.build(parents);
+  Transform identity{};
+  for (std::uint32_t node = 0; node < parents.size(); node++)
+    hierarchy.setLocal(node, identity);
+  hierarchy.update();
+
+  // Nothing moved
+  EXPECT_EQ(hierarchy.update(), 0u);
+
+  // Setting the same transform again isn't a change
+  hierarchy.setLocal(4, identity);
+  EXPECT_EQ(hierarchy.update(), 0u);
+
+  Transform moved{};
+  moved.position = glm::vec3(0.0f, 1.0f, 0.0f);
+  hierarchy.setLocal(1, moved);
+  EXPECT_EQ(hierarchy.update(), 2u);
+  EXPECT_FALSE(hierarchy.wasUpdated(0));
+  EXPECT_TRUE(hierarchy.wasUpdated(1));
+  EXPECT_TRUE(hierarchy.wasUpdated(2));
+  EXPECT_FALSE(hierarchy.wasUpdated(3));
+  EXPECT_NEAR(hierarchy.getWorld(2)[3].y, 1.0f, 1e-6f);
+}
+
+TEST(TransformHierarchyTest, ParallelMatchesComposedMatrices)
+{
+  // Wide enough levels to be split over the job system
+  std::mt19937 rng(5);
+  constexpr std::uint32_t COUNT = 20000;
+  std::vector<std::uint32_t> parents(COUNT);
+  std::vector<Transform> locals(COUNT);
+  for (std::uint32_t node = 0; node < COUNT; node++)
+  {
+    parents[node] = node < 8 ? TransformHierarchy::NO_PARENT : rng() % node;
+    locals[node] = randomTransform(rng);
+  }
+
+  TransformHierarchy hierarchy;
+  hierarchy.build(parents);
+  for (std::uint32_t node = 0; node < COUNT; node++)
+    hierarchy.setLocal(node, locals[node]);
+  JobSystem jobs(2);
+  EXPECT_EQ(hierarchy.update(&jobs), COUNT);
+
+  // Parents come before children here, so the reference is one pass in index order
+  std::vector<glm::mat4x3> world(COUNT);
+  for (std::uint32_t node = 0; node < COUNT; node++)
+  {
+    world[node] = parents[node] == TransformHierarchy::NO_PARENT
+                      ? locals[node].affine()
+                      : TransformHierarchy::compose(world[parents[node]], locals[node].affine());
+    expectNear(hierarchy.getWorld(node), world[node]);
+  }
+}
@@ -1 +1,23 @@
 #include "component/transform.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(TransformTest, AffineMatchesTranslateRotateScale)
+{
+  Transform transform{};
+  transform.position = glm::vec3(1.0f, -2.0f, 3.0f);
+  transform.rotation = glm::angleAxis(0.7f, glm::normalize(glm::vec3(1.0f, 2.0f, -0.5f)));
+  transform.scale = glm::vec3(0.5f, 2.0f, 3.0f);
+
+  const glm::mat4 expected = glm::translate(glm::mat4(1.0f), transform.position) *
+                             glm::mat4_cast(transform.rotation) *
+                             glm::scale(glm::mat4(1.0f), transform.scale);
+  const glm::mat4 matrix = transform.matrix();
+  for (int column = 0; column < 4; column++)
+  {
+    for (int row = 0; row < 4; row++)
+      EXPECT_NEAR(matrix[column][row], expected[column][row], 1e-5f);
+  }
+}
@@ -0,0 +1,130 @@
+#include "vertex_format.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace VertexFormat;
+
+TEST(VertexFormatTest, HalfRoundTripsEveryValue)
+{
+  for (std::uint32_t bits = 0; bits <= 0xFFFF; bits++)
+  {
+    const auto half = static_cast<std::uint16_t>(bits);
+    const bool nan = (half & 0x7C00u) == 0x7C00u && (half & 0x3FFu);
+    if (nan)
+      EXPECT_TRUE(std::isnan(halfToFloat(half))) << std::hex << bits;
+    else
+      EXPECT_EQ(floatToHalf(halfToFloat(half)), half) << std::hex << bits;
+  }
+}
+
+TEST(VertexFormatTest, HalfSpecialValues)
+{
+  EXPECT_EQ(floatToHalf(1.0f), 0x3C00);
+  EXPECT_EQ(floatToHalf(-2.0f), 0xC000);
+  EXPECT_EQ(floatToHalf(-0.0f), 0x8000);
+  EXPECT_EQ(floatToHalf(65504.0f), 0x7BFF);
+
+  // Past the largest half is infinity, infinities and NaN stay what they are
+  EXPECT_EQ(floatToHalf(1e6f), 0x7C00);
+  EXPECT_EQ(floatToHalf(-1e6f), 0xFC00);
+  EXPECT_EQ(floatToHalf(std::numeric_limits<float>::infinity()), 0x7C00);
+  EXPECT_EQ(floatToHalf(-std::numeric_limits<float>::infinity()), 0xFC00);
+  const std::uint16_t nan = floatToHalf(std::numeric_limits<float>::quiet_NaN());
+  EXPECT_EQ(nan & 0x7C00, 0x7C00);
+  EXPECT_NE(nan & 0x3FF, 0);
+
+  // Denormals: the smallest, the largest and the first normal
+  EXPECT_EQ(floatToHalf(std::ldexp(1.0f, -24)), 0x0001);
+  EXPECT_EQ(floatToHalf(std::ldexp(1023.0f, -24)), 0x03FF);
+  EXPECT_EQ(floatToHalf(std::ldexp(1.0f, -14)), 0x0400);
+  EXPECT_EQ(halfToFloat(0x0001), std::ldexp(1.0f, -24));
+  EXPECT_EQ(halfToFloat(0x8200), -std::ldexp(512.0f, -24));
+  // Below half the smallest denormal it's zero
+  EXPECT_EQ(floatToHalf(std::ldexp(1.0f, -26)), 0x0000);
+  EXPECT_EQ(floatToHalf(-std::ldexp(1.0f, -26)), 0x8000);
+}
+
+TEST(VertexFormatTest, HalfRoundsToNearestEven)
+{
+  // Ties go to the even mantissa
+  EXPECT_EQ(floatToHalf(1.0f + std::ldexp(1.0f, -11)), 0x3C00);
+  EXPECT_EQ(floatToHalf(1.0f + std::ldexp(3.0f, -11)), 0x3C02);
+  EXPECT_EQ(floatToHalf(std::ldexp(1.0f, -25)), 0x0000);
+  EXPECT_EQ(floatToHalf(std::ldexp(3.0f, -25)), 0x0002);
+  // Anything past the tie goes up
+  EXPECT_EQ(floatToHalf(1.0f + std::ldexp(1.0f, -11) + std::ldexp(1.0f, -20)), 0x3C01);
+  EXPECT_EQ(floatToHalf(std::ldexp(1.5f, -25)), 0x0001);
+  // Carrying out of the mantissa bumps the exponent, up to infinity
+  EXPECT_EQ(floatToHalf(2.0f - std::ldexp(1.0f, -12)), 0x4000);
+  EXPECT_EQ(floatToHalf(65520.0f), 0x7C00);
+  EXPECT_EQ(floatToHalf(65519.0f), 0x7BFF);
+}
+
+TEST(VertexFormatTest, PackedNormalRoundTrip)
+{
+  EXPECT_EQ(packNormal(glm::vec3(1.0f, 0.0f, 0.0f)).bits, 511u);
+  EXPECT_EQ(packNormal(glm::vec3(0.0f, 1.0f, 0.0f)).bits, 511u << 10);
+  EXPECT_EQ(unpackNormal(packNormal(glm::vec4(-1.0f, 0.0f, 1.0f, -1.0f))),
+            glm::vec4(-1.0f, 0.0f, 1.0f, -1.0f));
+  EXPECT_EQ(unpackNormal(packNormal(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f))).w, 1.0f);
+  // Out of range components are clamped
+  EXPECT_EQ(unpackNormal(packNormal(glm::vec3(2.0f, -3.0f, 0.0f))),
+            glm::vec4(1.0f, -1.0f, 0.0f, 0.0f));
+
+  // Every component comes back within half a step
+  std::mt19937 rng(3);
+  std::normal_distribution<float> axis;
+  for (int i = 0; i < 1000; i++)
+  {
+    const glm::vec3 normal = glm::normalize(glm::vec3(axis(rng), axis(rng), axis(rng)));
+    const glm::vec4 unpacked = unpackNormal(packNormal(glm::vec4(normal, i % 2 ? 1.0f : -1.0f)));
+    for (int c = 0; c < 3; c++)
+      EXPECT_NEAR(unpacked[c], normal[c], 0.5f / 511.0f + 1e-6f);
+    EXPECT_EQ(unpacked.w, i % 2 ? 1.0f : -1.0f);
+  }
+}
+
+TEST(VertexFormatTest, PackedUVsKeepTiling)
+{
+  // Tiled and negative coordinates come back instead of being clamped to [0, 1]
+  for (const glm::vec2 uv :
+       {glm::vec2(0.0f, 1.0f), glm::vec2(0.25f, 0.75f), glm::vec2(4.0f, -3.5f)})
+    EXPECT_EQ(unpackUV(packUV(uv)), uv);
+  // Otherwise within a half float step
+  const glm::vec2 uv(0.3f, 7.1f);
+  const glm::vec2 unpacked = unpackUV(packUV(uv));
+  EXPECT_NEAR(unpacked.x, uv.x, 0.3f / 2048.0f);
+  EXPECT_NEAR(unpacked.y, uv.y, 7.1f / 2048.0f);
+}
+
+TEST(VertexFormatTest, QuantizedPositionsRoundTrip)
+{
+  const AABB bounds(glm::vec3(-2.0f, 0.0f, 10.0f), glm::vec3(2.0f, 0.5f, 30.0f));
+  const PositionQuantizer quantizer(bounds);
+  EXPECT_EQ(quantizer.encode(bounds.min), (std::array<std::uint16_t, 3>{0, 0, 0}));
+  EXPECT_EQ(quantizer.encode(bounds.max), (std::array<std::uint16_t, 3>{65535, 65535, 65535}));
+
+  // Decoding and the dequantize matrix agree, and stay within the advertised precision
+  const glm::mat4 dequantize = quantizer.getDequantizeMatrix();
+  const glm::vec3 precision = quantizer.getPrecision();
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<float> t(0.0f, 1.0f);
+  for (int i = 0; i < 1000; i++)
+  {
+    const glm::vec3 position = bounds.min + glm::vec3(t(rng), t(rng), t(rng)) * bounds.size();
+    const auto encoded = quantizer.encode(position);
+    const glm::vec3 decoded = quantizer.decode(encoded);
+    const glm::vec3 viaMatrix = glm::vec3(
+        dequantize * glm::vec4(glm::vec3(encoded[0], encoded[1], encoded[2]) / 65535.0f, 1.0f));
+    for (int c = 0; c < 3; c++)
+    {
+      EXPECT_NEAR(decoded[c], position[c], precision[c] * 1.01f);
+      EXPECT_NEAR(viaMatrix[c], decoded[c], 1e-4f);
+    }
+  }
+}
@@ -0,0 +1,420 @@
+#include "json.h"
+#include "mesh_importer.h"
+
+#include "mapped_file.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+constexpr std::uint32_t GLB_MAGIC = 0x46546C67;  // "glTF"
+constexpr std::uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+constexpr std::uint32_t GLB_CHUNK_BIN = 0x004E4942;
+constexpr int MAX_NODE_DEPTH = 64;
+
+struct Document
+{
+  JsonValue json;
+  std::vector<std::vector<unsigned char>> buffers;
+};
+
+bool decodeBase64(std::string_view text, std::vector<unsigned char>& out)
+{
+  auto value = [](char c) -> int
+  {
+    if (c >= 'A' && c <= 'Z')
+      return c - 'A';
+    if (c >= 'a' && c <= 'z')
+      return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+      return c - '0' + 52;
+    if (c == '+')
+      return 62;
+    if (c == '/')
+      return 63;
+    return -1;
+  };
+
+  unsigned int bits = 0;
+  int bitCount = 0;
+  for (char c : text)
+  {
+    if (c == '=')
+      break;
+    const int v = value(c);
+    if (v < 0)
+      return false;
+    bits = (bits << 6) | v;
+    bitCount += 6;
+    if (bitCount >= 8)
+    {
+      bitCount -= 8;
+      out.push_back(static_cast<unsigned char>(bits >> bitCount));
+    }
+  }
+  return true;
+}
+
+bool loadBuffers(const std::filesystem::path& directory,
+                 std::vector<unsigned char> glbBinary,
+                 Document& document)
+{
+  const JsonValue& buffers = document.json["buffers"];
+  for (size_t i = 0; i < buffers.size(); i++)
+  {
+    auto& data = document.buffers.emplace_back();
+    const std::string& uri = buffers[i]["uri"].asString();
+    if (uri.empty())
+    {
+      // Only the first buffer of a .glb may leave out its uri
+      data = std::move(glbBinary);
+    }
+    else if (uri.starts_with("data:"))
+    {
+      const size_t comma = uri.find(',');
+      if (comma == std::string::npos ||
+          !decodeBase64(std::string_view(uri).substr(comma + 1), data))
+        return false;
+    }
+    else
+    {
+      MappedFile file((directory / uri).string());
+      if (!file.isOpen())
+        return false;
+      data.assign(file.data(), file.data() + file.size());
+    }
+
+    if (data.size() < static_cast<size_t>(buffers[i]["byteLength"].asNumber()))
+      return false;
+  }
+  return true;
+}
+
+int componentCount(const std::string& type)
+{
+  if (type == "SCALAR")
+    return 1;
+  if (type == "VEC2")
+    return 2;
+  if (type == "VEC3")
+    return 3;
+  if (type == "VEC4")
+    return 4;
+  if (type == "MAT4")
+    return 16;
+  return 0;
+}
+
+int componentSize(int componentType)
+{
+  switch (componentType)
+  {
+    case 5120:  // BYTE
+    case 5121:  // UNSIGNED_BYTE
+      return 1;
+    case 5122:  // SHORT
+    case 5123:  // UNSIGNED_SHORT
+      return 2;
+    case 5125:  // UNSIGNED_INT
+    case 5126:  // FLOAT
+      return 4;
+  }
+  return 0;
+}
+
+double readComponent(const unsigned char* data, int componentType, bool normalized)
+{
+  switch (componentType)
+  {
+    case 5120:
+    {
+      const auto v = static_cast<std::int8_t>(*data);
+      return normalized ? std::max(v / 127.0, -1.0) : v;
+    }
+    case 5121:
+      return normalized ? *data / 255.0 : *data;
+    case 5122:
+    {
+      std::int16_t v;
+      std::memcpy(&v, data, 2);
+      return normalized ? std::max(v / 32767.0, -1.0) : v;
+    }
+    case 5123:
+    {
+      std::uint16_t v;
+      std::memcpy(&v, data, 2);
+      return normalized ? v / 65535.0 : v;
+    }
+    case 5125:
+    {
+      std::uint32_t v;
+      std::memcpy(&v, data, 4);
+      return v;
+    }
+    case 5126:
+    {
+      float v;
+      std::memcpy(&v, data, 4);
+      return v;
+    }
+  }
+  return 0.0;
+}
+
+// Reads `components` values per element, doubles hold 32-bit indices exactly
+bool readAccessor(const Document& document,
+                  int index,
+                  int components,
+                  std::vector<double>& out)
+{
+  const JsonValue& accessor = document.json["accessors"][index];
+  const int count = accessor["count"].asInt(-1);
+  const int componentType = accessor["componentType"].asInt();
+  const int typeComponents = componentCount(accessor["type"].asString());
+  const int size = componentSize(componentType);
+  if (count < 0 || size == 0 || typeComponents == 0)
+    return false;
+
+  out.assign(static_cast<size_t>(count) * components, 0.0);
+  // Accessors without a buffer view are all zeros
+  if (!accessor.contains("bufferView"))
+    return true;
+
+  const JsonValue& view = document.json["bufferViews"][accessor["bufferView"].asInt()];
+  const int bufferIndex = view["buffer"].asInt(-1);
+  if (bufferIndex < 0 || bufferIndex >= static_cast<int>(document.buffers.size()))
+    return false;
+
+  const auto& buffer = document.buffers[bufferIndex];
+  const size_t elementSize = static_cast<size_t>(size) * typeComponents;
+  const size_t stride = view["byteStride"].asInt(0) ? view["byteStride"].asInt() : elementSize;
+  const size_t offset = static_cast<size_t>(view["byteOffset"].asNumber()) +
+                        static_cast<size_t>(accessor["byteOffset"].asNumber());
+  if (count > 0 && offset + stride * (count - 1) + elementSize > buffer.size())
+    return false;
+
+  const bool normalized = accessor["normalized"].asBool();
+  const int read = std::min(components, typeComponents);
+  for (int i = 0; i < count; i++)
+  {
+    const unsigned char* element = buffer.data() + offset + stride * i;
+    for (int c = 0; c < read; c++)
+      out[i * components + c] = readComponent(element + c * size, componentType, normalized);
+  }
+  return true;
+}
+
+glm::mat4 localMatrix(const JsonValue& node)
+{
+  const JsonValue& matrix = node["matrix"];
+  if (matrix.size() == 16)
+  {
+    // Column major, like glm
+    glm::mat4 result;
+    for (int column = 0; column < 4; column++)
+    {
+      for (int row = 0; row < 4; row++)
+        result[column][row] = static_cast<float>(matrix[column * 4 + row].asNumber());
+    }
+    return result;
+  }
+
+  const JsonValue& t = node["translation"];
+  const JsonValue& r = node["rotation"];
+  const JsonValue& s = node["scale"];
+  const glm::vec3 translation(t[0].asNumber(), t[1].asNumber(), t[2].asNumber());
+  const glm::quat rotation(static_cast<float>(r[3].asNumber(1.0)),
+                           static_cast<float>(r[0].asNumber()),
+                           static_cast<float>(r[1].asNumber()),
+                           static_cast<float>(r[2].asNumber()));
+  const glm::vec3 scale(s[0].asNumber(1.0), s[1].asNumber(1.0), s[2].asNumber(1.0));
+
+  glm::mat4 result = glm::mat4_cast(rotation);
+  for (int k = 0; k < 3; k++)
+    result[k] *= scale[k];
+  result[3] = glm::vec4(translation, 1.0f);
+  return result;
+}
+
+bool addPrimitive(const Document& document,
+                  const JsonValue& primitive,
+                  const glm::mat4& world,
+                  ImportedMesh& mesh)
+{
+  // Points and lines have nothing to cook
+  if (primitive["mode"].asInt(4) != 4)
+    return true;
+
+  const JsonValue& attributes = primitive["attributes"];
+  std::vector<double> positions, normals, uvs, indices;
+  if (!readAccessor(document, attributes["POSITION"].asInt(-1), 3, positions))
+    return false;
+  const size_t vertexCount = positions.size() / 3;
+
+  const bool hasNormals = attributes.contains("NORMAL");
+  if (hasNormals && !readAccessor(document, attributes["NORMAL"].asInt(), 3, normals))
+    return false;
+  if (attributes.contains("TEXCOORD_0") &&
+      !readAccessor(document, attributes["TEXCOORD_0"].asInt(), 2, uvs))
+    return false;
+
+  if (primitive.contains("indices"))
+  {
+    if (!readAccessor(document, primitive["indices"].asInt(), 1, indices))
+      return false;
+  }
+  else
+  {
+    for (size_t i = 0; i < vertexCount; i++)
+      indices.push_back(static_cast<double>(i));
+  }
+
+  std::string material;
+  if (primitive.contains("material"))
+  {
+    const int index = primitive["material"].asInt();
+    material = document.json["materials"][index]["name"].asString();
+    if (material.empty())
+      material = "material" + std::to_string(index);
+  }
+
+  ImportedSubmesh& submesh = mesh.submeshFor(material);
+  submesh.hasNormals &= hasNormals;
+
+  const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+  // Mirrored transforms flip the winding, swap two corners to keep faces counter-clockwise
+  const bool mirrored = glm::determinant(glm::mat3(world)) < 0.0f;
+  for (size_t i = 0; i + 2 < indices.size(); i += 3)
+  {
+    for (int corner : {0, mirrored ? 2 : 1, mirrored ? 1 : 2})
+    {
+      const auto index = static_cast<size_t>(indices[i + corner]);
+      if (index >= vertexCount)
+        return false;
+
+      ImportedVertex& vertex = submesh.vertices.emplace_back();
+      const glm::vec3 position(
+          positions[index * 3], positions[index * 3 + 1], positions[index * 3 + 2]);
+      vertex.position = glm::vec3(world * glm::vec4(position, 1.0f));
+      if (hasNormals)
+      {
+        const glm::vec3 normal(normals[index * 3], normals[index * 3 + 1], normals[index * 3 + 2]);
+        vertex.normal = glm::normalize(normalMatrix * normal);
+      }
+      if (!uvs.empty())
+        vertex.uv = glm::vec2(uvs[index * 2], 1.0 - uvs[index * 2 + 1]);
+    }
+  }
+  return true;
+}
+
+bool visitNode(const Document& document,
+               int index,
+               const glm::mat4& parent,
+               int depth,
+               ImportedMesh& mesh)
+{
+  const JsonValue& node = document.json["nodes"][index];
+  if (node.isNull() || depth > MAX_NODE_DEPTH)
+    return false;
+
+  const glm::mat4 world = parent * localMatrix(node);
+  if (node.contains("mesh"))
+  {
+    const JsonValue& primitives = document.json["meshes"][node["mesh"].asInt()]["primitives"];
+    for (size_t i = 0; i < primitives.size(); i++)
+    {
+      if (!addPrimitive(document, primitives[i], world, mesh))
+        return false;
+    }
+  }
+
+  const JsonValue& children = node["children"];
+  for (size_t i = 0; i < children.size(); i++)
+  {
+    if (!visitNode(document, children[i].asInt(), world, depth + 1, mesh))
+      return false;
+  }
+  return true;
+}
+}  // namespace
+
+namespace GltfImporter
+{
+bool load(const std::string& filepath, ImportedMesh& mesh)
+{
+  MappedFile file(filepath);
+  if (!file.isOpen())
+  {
+    std::cerr << "ERROR::MESH::LOAD_FAILED " << filepath << std::endl;
+    return false;
+  }
+
+  std::string_view json(reinterpret_cast<const char*>(file.data()), file.size());
+  std::vector<unsigned char> binary;
+
+  std::uint32_t magic = 0;
+  if (file.size() >= 12)
+    std::memcpy(&magic, file.data(), 4);
+  if (magic == GLB_MAGIC)
+  {
+    // 12 byte header, then chunks of {length, type, data}: JSON first, optional BIN after
+    json = {};
+    for (size_t offset = 12; offset + 8 <= file.size();)
+    {
+      std::uint32_t length, type;
+      std::memcpy(&length, file.data() + offset, 4);
+      std::memcpy(&type, file.data() + offset + 4, 4);
+      const unsigned char* chunk = file.data() + offset + 8;
+      if (length > file.size() - offset - 8)
+        break;
+      if (type == GLB_CHUNK_JSON)
+        json = std::string_view(reinterpret_cast<const char*>(chunk), length);
+      else if (type == GLB_CHUNK_BIN)
+        binary.assign(chunk, chunk + length);
+      offset += 8 + length;
+    }
+  }
+
+  Document document;
+  if (!JsonValue::parse(json, document.json) ||
+      !loadBuffers(std::filesystem::path(filepath).parent_path(), std::move(binary), document))
+  {
+    std::cerr << "ERROR::MESH::BAD_GLTF " << filepath << std::endl;
+    return false;
+  }
+
+  bool ok = true;
+  const JsonValue& scene = document.json["scenes"][document.json["scene"].asInt(0)];
+  if (scene.isNull())
+  {
+    // No scene graph, take the meshes as they are
+    const JsonValue& meshes = document.json["meshes"];
+    for (size_t i = 0; ok && i < meshes.size(); i++)
+    {
+      const JsonValue& primitives = meshes[i]["primitives"];
+      for (size_t p = 0; ok && p < primitives.size(); p++)
+        ok = addPrimitive(document, primitives[p], glm::mat4(1.0f), mesh);
+    }
+  }
+  else
+  {
+    const JsonValue& nodes = scene["nodes"];
+    for (size_t i = 0; ok && i < nodes.size(); i++)
+      ok = visitNode(document, nodes[i].asInt(), glm::mat4(1.0f), 0, mesh);
+  }
+
+  if (!ok || mesh.submeshes.empty())
+  {
+    std::cerr << "ERROR::MESH::BAD_GLTF " << filepath << std::endl;
+    return false;
+  }
+  return true;
+}
+}  // namespace GltfImporter
@@ -0,0 +1,248 @@
+#include "json.h"
+
+#include <charconv>
+#include <cstdlib>
+
+namespace
+{
+const JsonValue& nullValue()
+{
+  static const JsonValue value;
+  return value;
+}
+}  // namespace
+
+class JsonParser
+{
+  public:
+  explicit JsonParser(std::string_view text) : m_text(text), m_pos(0) {}
+
+  bool parseDocument(JsonValue& out)
+  {
+    if (!parseValue(out))
+      return false;
+    skipWhitespace();
+    return m_pos == m_text.size();
+  }
+
+  private:
+  void skipWhitespace()
+  {
+    while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\t' ||
+                                     m_text[m_pos] == '\n' || m_text[m_pos] == '\r'))
+      m_pos++;
+  }
+
+  bool consume(std::string_view token)
+  {
+    if (m_text.substr(m_pos, token.size()) != token)
+      return false;
+    m_pos += token.size();
+    return true;
+  }
+
+  bool parseValue(JsonValue& out)
+  {
+    skipWhitespace();
+    if (m_pos >= m_text.size())
+      return false;
+
+    switch (m_text[m_pos])
+    {
+      case '{':
+        return parseObject(out);
+      case '[':
+        return parseArray(out);
+      case '"':
+        out.m_type = JsonValue::Type::String;
+        return parseString(out.m_string);
+      case 't':
+        out.m_type = JsonValue::Type::Bool;
+        out.m_bool = true;
+        return consume("true");
+      case 'f':
+        out.m_type = JsonValue::Type::Bool;
+        out.m_bool = false;
+        return consume("false");
+      case 'n':
+        out.m_type = JsonValue::Type::Null;
+        return consume("null");
+      default:
+        return parseNumber(out);
+    }
+  }
+
+  bool parseNumber(JsonValue& out)
+  {
+    // strtod rather than from_chars, it takes the leading '+' free exponent forms JSON allows
+    const std::string number(m_text.substr(m_pos, 64));
+    char* end = nullptr;
+    out.m_number = std::strtod(number.c_str(), &end);
+    if (end == number.c_str())
+      return false;
+    out.m_type = JsonValue::Type::Number;
+    m_pos += end - number.c_str();
+    return true;
+  }
+
+  bool parseString(std::string& out)
+  {
+    m_pos++;  // opening quote
+    while (m_pos < m_text.size())
+    {
+      const char c = m_text[m_pos++];
+      if (c == '"')
+        return true;
+      if (c != '\\')
+      {
+        out += c;
+        continue;
+      }
+      if (m_pos >= m_text.size())
+        return false;
+
+      const char escaped = m_text[m_pos++];
+      switch (escaped)
+      {
+        case 'b':
+          out += '\b';
+          break;
+        case 'f':
+          out += '\f';
+          break;
+        case 'n':
+          out += '\n';
+          break;
+        case 'r':
+          out += '\r';
+          break;
+        case 't':
+          out += '\t';
+          break;
+        case 'u':
+        {
+          // Basic multilingual plane only, encoded back to UTF-8
+          unsigned int code = 0;
+          if (m_pos + 4 > m_text.size() ||
+              std::from_chars(&m_text[m_pos], &m_text[m_pos + 4], code, 16).ec != std::errc())
+            return false;
+          m_pos += 4;
+          if (code < 0x80)
+          {
+            out += static_cast<char>(code);
+          }
+          else if (code < 0x800)
+          {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+          }
+          else
+          {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+          }
+          break;
+        }
+        default:
+          out += escaped;  // \" \\ and \/
+      }
+    }
+    return false;
+  }
+
+  bool parseArray(JsonValue& out)
+  {
+    out.m_type = JsonValue::Type::Array;
+    m_pos++;
+    skipWhitespace();
+    if (consume("]"))
+      return true;
+
+    while (true)
+    {
+      if (!parseValue(out.m_array.emplace_back()))
+        return false;
+      skipWhitespace();
+      if (consume("]"))
+        return true;
+      if (!consume(","))
+        return false;
+    }
+  }
+
+  bool parseObject(JsonValue& out)
+  {
+    out.m_type = JsonValue::Type::Object;
+    m_pos++;
+    skipWhitespace();
+    if (consume("}"))
+      return true;
+
+    while (true)
+    {
+      skipWhitespace();
+      auto& member = out.m_object.emplace_back();
+      if (m_pos >= m_text.size() || m_text[m_pos] != '"' || !parseString(member.first))
+        return false;
+      skipWhitespace();
+      if (!consume(":") || !parseValue(member.second))
+        return false;
+      skipWhitespace();
+      if (consume("}"))
+        return true;
+      if (!consume(","))
+        return false;
+    }
+  }
+
+  std::string_view m_text;
+  size_t m_pos;
+};
+
+bool JsonValue::parse(std::string_view text, JsonValue& out)
+{
+  out = {};
+  return JsonParser(text).parseDocument(out);
+}
+
+double JsonValue::asNumber(double fallback) const
+{
+  return m_type == Type::Number ? m_number : fallback;
+}
+
+bool JsonValue::asBool(bool fallback) const
+{
+  return m_type == Type::Bool ? m_bool : fallback;
+}
+
+const std::string& JsonValue::asString() const
+{
+  static const std::string empty;
+  return m_type == Type::String ? m_string : empty;
+}
+
+size_t JsonValue::size() const
+{
+  return m_type == Type::Array ? m_array.size() : m_type == Type::Object ? m_object.size() : 0;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const
+{
+  return m_type == Type::Array && index < m_array.size() ? m_array[index] : nullValue();
+}
+
+const JsonValue& JsonValue::operator[](std::string_view key) const
+{
+  for (const auto& [name, value] : m_object)
+  {
+    if (name == key)
+      return value;
+  }
+  return nullValue();
+}
+
+bool JsonValue::contains(std::string_view key) const
+{
+  return !(*this)[key].isNull();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Just enough JSON for reading glTF. Lookups of missing keys or out of range indices return
+// a null value instead of throwing, so optional glTF properties read naturally.
+class JsonValue
+{
+  public:
+  enum class Type
+  {
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object
+  };
+
+  // Nothing on a syntax error
+  static bool parse(std::string_view text, JsonValue& out);
+
+  inline Type getType() const { return m_type; }
+  inline bool isNull() const { return m_type == Type::Null; }
+  inline bool isObject() const { return m_type == Type::Object; }
+  inline bool isArray() const { return m_type == Type::Array; }
+
+  double asNumber(double fallback = 0.0) const;
+  int asInt(int fallback = 0) const { return static_cast<int>(asNumber(fallback)); }
+  bool asBool(bool fallback = false) const;
+  const std::string& asString() const;
+
+  // Array length, or member count for objects
+  size_t size() const;
+  const JsonValue& operator[](size_t index) const;
+  const JsonValue& operator[](std::string_view key) const;
+  bool contains(std::string_view key) const;
+
+  private:
+  friend class JsonParser;
+
+  Type m_type = Type::Null;
+  bool m_bool = false;
+  double m_number = 0.0;
+  std::string m_string;
+  std::vector<JsonValue> m_array;
+  std::vector<std::pair<std::string, JsonValue>> m_object;
+};
@@ -0,0 +1,52 @@
+// Converts OBJ and glTF files into .mesh containers that Mesh can map and upload directly.
+//   mesh_cooker [--lods N] [--no-optimize] <input> <output>
+#include "mesh_cooker.h"
+
+#include <charconv>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+int usage()
+{
+  std::cerr << "usage: mesh_cooker [--lods 1-4] [--no-optimize] <input.obj|.gltf|.glb> <output>"
+            << std::endl;
+  return 2;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  MeshCookOptions options;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string_view arg = argv[i];
+    if (arg == "--no-optimize")
+    {
+      options.optimize = false;
+    }
+    else if (arg == "--lods" && i + 1 < argc)
+    {
+      const std::string_view count = argv[++i];
+      if (std::from_chars(count.data(), count.data() + count.size(), options.lods).ec !=
+              std::errc() ||
+          options.lods < 1 || options.lods > static_cast<int>(MeshContainer::MAX_LODS))
+        return usage();
+    }
+    else if (arg.starts_with("--"))
+    {
+      return usage();
+    }
+    else
+    {
+      paths.emplace_back(arg);
+    }
+  }
+
+  if (paths.size() != 2)
+    return usage();
+
+  return MeshCooker::cook(paths[0], paths[1], options) ? 0 : 1;
+}
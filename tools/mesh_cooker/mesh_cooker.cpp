@@ -0,0 +1,273 @@
+#include "mesh_cooker.h"
+
+#include "aabb.h"
+#include "mesh_builder.h"
+#include "vertex_format.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace
+{
+using MeshContainer::Vertex;
+
+// One submesh at one LOD, indices relative to its own vertices
+struct Level
+{
+  std::vector<Vertex> vertices;
+  std::vector<std::uint32_t> indices;
+};
+
+// Cells across the largest axis for the first clustered LOD, halved for each coarser try.
+// A LOD is only kept when it at least halves the triangles of the previous one.
+constexpr int FIRST_CLUSTER_GRID = 64;
+// Screen size thresholds assume each cluster cell may cover this many pixels of a 1080p view
+constexpr float CLUSTER_PIXELS = 2.0f;
+constexpr float REFERENCE_HEIGHT = 1080.0f;
+
+Vertex packVertex(const glm::vec3& position, const glm::vec3& normal, const glm::vec2& uv)
+{
+  Vertex vertex{};
+  for (int k = 0; k < 3; k++)
+    vertex.position[k] = position[k];
+  const auto packedUV = VertexFormat::packUV(uv);
+  vertex.uv[0] = packedUV[0];
+  vertex.uv[1] = packedUV[1];
+  vertex.normal = VertexFormat::packNormal(normal).bits;
+  return vertex;
+}
+
+glm::vec3 positionOf(const Vertex& vertex)
+{
+  return {vertex.position[0], vertex.position[1], vertex.position[2]};
+}
+
+Level finish(MeshBuilder& builder, bool optimize)
+{
+  if (optimize)
+    builder.optimize();
+
+  Level level;
+  const auto& vertexData = builder.getVertexData();
+  level.vertices.resize(builder.getVertexCount());
+  std::memcpy(level.vertices.data(), vertexData.data(), vertexData.size());
+  level.indices = builder.getIndices();
+  return level;
+}
+
+Level buildBaseLevel(const ImportedSubmesh& submesh, bool optimize)
+{
+  std::vector<Vertex> corners;
+  corners.reserve(submesh.vertices.size());
+  for (size_t i = 0; i + 2 < submesh.vertices.size(); i += 3)
+  {
+    const ImportedVertex* triangle = &submesh.vertices[i];
+
+    // Files without normals get flat ones, smoothing would need crease information we lack
+    glm::vec3 faceNormal = glm::cross(triangle[1].position - triangle[0].position,
+                                      triangle[2].position - triangle[0].position);
+    const float length = glm::length(faceNormal);
+    faceNormal = length > 0.0f ? faceNormal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+
+    for (int corner = 0; corner < 3; corner++)
+    {
+      const ImportedVertex& v = triangle[corner];
+      corners.push_back(packVertex(v.position, submesh.hasNormals ? v.normal : faceNormal, v.uv));
+    }
+  }
+
+  MeshBuilder builder(sizeof(Vertex));
+  builder.addTriangles(corners.data(), static_cast<unsigned int>(corners.size()));
+  return finish(builder, optimize);
+}
+
+// Vertex clustering: every vertex in a grid cell collapses onto one, triangles that lose a
+// corner disappear. Crude next to edge collapse, but fast and it never fails.
+Level clusterLevel(const Level& base, const AABB& bounds, float cellSize, bool optimize)
+{
+  auto cellKey = [&](const glm::vec3& position)
+  {
+    const glm::uvec3 cell((position - bounds.min) / cellSize);
+    return (std::uint64_t(cell.x) << 42) | (std::uint64_t(cell.y) << 21) | cell.z;
+  };
+
+  // Clusters sit at the average of their vertices, other attributes come from the first one
+  std::unordered_map<std::uint64_t, std::uint32_t> clusterOf;
+  std::vector<glm::vec3> sums;
+  std::vector<std::uint32_t> counts;
+  std::vector<Vertex> clusters;
+  std::vector<std::uint32_t> remap(base.vertices.size());
+  for (size_t i = 0; i < base.vertices.size(); i++)
+  {
+    const glm::vec3 position = positionOf(base.vertices[i]);
+    auto [it, inserted] =
+        clusterOf.try_emplace(cellKey(position), static_cast<std::uint32_t>(clusters.size()));
+    if (inserted)
+    {
+      clusters.push_back(base.vertices[i]);
+      sums.emplace_back(0.0f);
+      counts.push_back(0);
+    }
+    remap[i] = it->second;
+    sums[it->second] += position;
+    counts[it->second]++;
+  }
+  for (size_t c = 0; c < clusters.size(); c++)
+  {
+    const glm::vec3 average = sums[c] / static_cast<float>(counts[c]);
+    for (int k = 0; k < 3; k++)
+      clusters[c].position[k] = average[k];
+  }
+
+  MeshBuilder builder(sizeof(Vertex));
+  for (size_t i = 0; i + 2 < base.indices.size(); i += 3)
+  {
+    const std::uint32_t a = remap[base.indices[i]];
+    const std::uint32_t b = remap[base.indices[i + 1]];
+    const std::uint32_t c = remap[base.indices[i + 2]];
+    if (a == b || b == c || a == c)
+      continue;
+    builder.addTriangle(builder.addVertex(&clusters[a]),
+                        builder.addVertex(&clusters[b]),
+                        builder.addVertex(&clusters[c]));
+  }
+  return finish(builder, optimize);
+}
+
+size_t triangleCount(const std::vector<Level>& levels)
+{
+  size_t count = 0;
+  for (const Level& level : levels)
+    count += level.indices.size() / 3;
+  return count;
+}
+}  // namespace
+
+namespace MeshCooker
+{
+bool import(const std::string& filepath, ImportedMesh& mesh)
+{
+  if (filepath.ends_with(".obj"))
+    return ObjImporter::load(filepath, mesh);
+  if (filepath.ends_with(".gltf") || filepath.ends_with(".glb"))
+    return GltfImporter::load(filepath, mesh);
+
+  std::cerr << "ERROR::MESH::UNKNOWN_FORMAT " << filepath << std::endl;
+  return false;
+}
+
+MeshContainer::MeshData build(const ImportedMesh& mesh, const MeshCookOptions& options)
+{
+  AABB bounds;
+  for (const auto& submesh : mesh.submeshes)
+  {
+    for (const auto& vertex : submesh.vertices)
+      bounds.expand(vertex.position);
+  }
+  if (bounds.isEmpty())
+    bounds = AABB(glm::vec3(0.0f), glm::vec3(0.0f));
+
+  // lods[lod][submesh]
+  std::vector<std::vector<Level>> lods(1);
+  for (const auto& submesh : mesh.submeshes)
+    lods[0].push_back(buildBaseLevel(submesh, options.optimize));
+
+  std::vector<float> screenSizes = {1.0f};
+  const float extent = std::max(glm::max(bounds.size().x, bounds.size().y), bounds.size().z);
+  int grid = FIRST_CLUSTER_GRID;
+  const int lodLimit = std::min<int>(options.lods, MeshContainer::MAX_LODS);
+  while (static_cast<int>(lods.size()) < lodLimit && grid >= 2 && extent > 0.0f)
+  {
+    // Always cluster the full detail mesh, errors don't pile up from one LOD to the next
+    std::vector<Level> levels;
+    for (const Level& base : lods[0])
+      levels.push_back(clusterLevel(base, bounds, extent / grid, options.optimize));
+
+    const bool halved = triangleCount(levels) * 2 <= triangleCount(lods.back());
+    if (halved)
+    {
+      lods.push_back(std::move(levels));
+      screenSizes.push_back(CLUSTER_PIXELS * grid / REFERENCE_HEIGHT);
+    }
+    grid /= 2;
+  }
+
+  MeshContainer::MeshData data;
+  for (int k = 0; k < 3; k++)
+  {
+    data.boundsMin[k] = bounds.min[k];
+    data.boundsMax[k] = bounds.max[k];
+  }
+  data.lodScreenSize = screenSizes;
+
+  size_t largestRange = 0;
+  std::vector<std::uint32_t> indices;
+  for (std::uint32_t lod = 0; lod < lods.size(); lod++)
+  {
+    for (std::uint32_t material = 0; material < lods[lod].size(); material++)
+    {
+      const Level& level = lods[lod][material];
+      if (level.indices.empty())
+        continue;
+
+      data.submeshes.push_back({lod,
+                                material,
+                                static_cast<std::uint32_t>(data.vertices.size()),
+                                static_cast<std::uint32_t>(level.vertices.size()),
+                                static_cast<std::uint32_t>(indices.size()),
+                                static_cast<std::uint32_t>(level.indices.size())});
+      data.vertices.insert(data.vertices.end(), level.vertices.begin(), level.vertices.end());
+      indices.insert(indices.end(), level.indices.begin(), level.indices.end());
+      largestRange = std::max(largestRange, level.vertices.size());
+    }
+  }
+
+  // Indices are relative to each range, so 16 bits only have to cover the largest one
+  data.indexSize = largestRange <= 0x10000 ? 2 : 4;
+  data.indices.resize(indices.size() * data.indexSize);
+  for (size_t i = 0; i < indices.size(); i++)
+  {
+    if (data.indexSize == 2)
+    {
+      const auto index = static_cast<std::uint16_t>(indices[i]);
+      std::memcpy(&data.indices[i * 2], &index, 2);
+    }
+    else
+    {
+      std::memcpy(&data.indices[i * 4], &indices[i], 4);
+    }
+  }
+  return data;
+}
+
+bool cook(const std::string& input, const std::string& output, const MeshCookOptions& options)
+{
+  ImportedMesh mesh;
+  if (!import(input, mesh))
+    return false;
+
+  const MeshContainer::MeshData data = build(mesh, options);
+  if (!MeshContainer::write(output, data))
+  {
+    std::cerr << "ERROR::MESH::WRITE_FAILED " << output << std::endl;
+    return false;
+  }
+
+  for (size_t lod = 0; lod < data.lodScreenSize.size(); lod++)
+  {
+    size_t triangles = 0, vertices = 0;
+    for (const auto& submesh : data.submeshes)
+    {
+      if (submesh.lod != lod)
+        continue;
+      triangles += submesh.indexCount / 3;
+      vertices += submesh.vertexCount;
+    }
+    std::cout << output << " lod " << lod << ": " << triangles << " triangles, " << vertices
+              << " vertices" << std::endl;
+  }
+  return true;
+}
+}  // namespace MeshCooker
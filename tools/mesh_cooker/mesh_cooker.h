@@ -0,0 +1,24 @@
+#pragma once
+
+#include "mesh_container.h"
+#include "mesh_importer.h"
+
+#include <string>
+
+struct MeshCookOptions
+{
+  // Including LOD 0. Fewer are written once simplifying stops paying off.
+  int lods = 3;
+  bool optimize = true;
+};
+
+namespace MeshCooker
+{
+// Picks the importer by extension: .obj, .gltf or .glb
+bool import(const std::string& filepath, ImportedMesh& mesh);
+
+// Welds and optimizes every submesh, then builds the coarser LODs by vertex clustering
+MeshContainer::MeshData build(const ImportedMesh& mesh, const MeshCookOptions& options);
+
+bool cook(const std::string& input, const std::string& output, const MeshCookOptions& options);
+}  // namespace MeshCooker
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+struct ImportedVertex
+{
+  glm::vec3 position{0.0f};
+  glm::vec3 normal{0.0f};
+  glm::vec2 uv{0.0f};
+};
+
+// Unindexed triangle list per material, welding happens later in the cooker
+struct ImportedSubmesh
+{
+  std::string material;
+  std::vector<ImportedVertex> vertices;
+  bool hasNormals = true;
+};
+
+struct ImportedMesh
+{
+  std::vector<ImportedSubmesh> submeshes;
+
+  // Finds or adds the submesh for a material, primitives sharing one end up in one draw
+  ImportedSubmesh& submeshFor(const std::string& material)
+  {
+    for (auto& submesh : submeshes)
+    {
+      if (submesh.material == material)
+        return submesh;
+    }
+    auto& submesh = submeshes.emplace_back();
+    submesh.material = material;
+    return submesh;
+  }
+};
+
+// Wavefront OBJ: positions, UVs, normals and usemtl groups. Polygons are fan triangulated.
+namespace ObjImporter
+{
+bool load(const std::string& filepath, ImportedMesh& mesh);
+}
+
+// glTF 2.0, .gltf with external or embedded buffers and .glb. Triangle primitives of every
+// node in the default scene, baked into world space. UVs are flipped to match the GL origin.
+namespace GltfImporter
+{
+bool load(const std::string& filepath, ImportedMesh& mesh);
+}
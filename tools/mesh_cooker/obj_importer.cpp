@@ -0,0 +1,148 @@
+#include "mesh_importer.h"
+
+#include "mapped_file.h"
+
+#include <charconv>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+// Splits off the next whitespace separated token
+std::string_view nextToken(std::string_view& line)
+{
+  const size_t begin = line.find_first_not_of(" \t\r");
+  if (begin == std::string_view::npos)
+  {
+    line = {};
+    return {};
+  }
+  const size_t end = line.find_first_of(" \t\r", begin);
+  const std::string_view token = line.substr(begin, end - begin);
+  line = end == std::string_view::npos ? std::string_view{} : line.substr(end);
+  return token;
+}
+
+float parseFloat(std::string_view token)
+{
+  float value = 0.0f;
+  std::from_chars(token.data(), token.data() + token.size(), value);
+  return value;
+}
+
+// OBJ indices are 1-based, negative ones count back from the end. Returns -1 when absent.
+int resolveIndex(std::string_view token, size_t count)
+{
+  int index = 0;
+  if (token.empty() ||
+      std::from_chars(token.data(), token.data() + token.size(), index).ec != std::errc())
+    return -1;
+  const int resolved = index < 0 ? static_cast<int>(count) + index : index - 1;
+  return resolved >= 0 && resolved < static_cast<int>(count) ? resolved : -1;
+}
+}  // namespace
+
+namespace ObjImporter
+{
+bool load(const std::string& filepath, ImportedMesh& mesh)
+{
+  MappedFile file(filepath);
+  if (!file.isOpen())
+  {
+    std::cerr << "ERROR::MESH::LOAD_FAILED " << filepath << std::endl;
+    return false;
+  }
+
+  std::vector<glm::vec3> positions;
+  std::vector<glm::vec3> normals;
+  std::vector<glm::vec2> uvs;
+  ImportedSubmesh* submesh = nullptr;
+  std::vector<ImportedVertex> polygon;
+  bool polygonHasNormals = true;
+
+  std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+  while (!text.empty())
+  {
+    const size_t newline = text.find('\n');
+    std::string_view line = text.substr(0, newline);
+    text = newline == std::string_view::npos ? std::string_view{} : text.substr(newline + 1);
+
+    const std::string_view keyword = nextToken(line);
+    if (keyword == "v")
+    {
+      glm::vec3& p = positions.emplace_back();
+      for (int k = 0; k < 3; k++)
+        p[k] = parseFloat(nextToken(line));
+    }
+    else if (keyword == "vn")
+    {
+      glm::vec3& n = normals.emplace_back();
+      for (int k = 0; k < 3; k++)
+        n[k] = parseFloat(nextToken(line));
+    }
+    else if (keyword == "vt")
+    {
+      glm::vec2& uv = uvs.emplace_back();
+      for (int k = 0; k < 2; k++)
+        uv[k] = parseFloat(nextToken(line));
+    }
+    else if (keyword == "usemtl")
+    {
+      submesh = &mesh.submeshFor(std::string(nextToken(line)));
+    }
+    else if (keyword == "f")
+    {
+      polygon.clear();
+      polygonHasNormals = true;
+      for (std::string_view corner = nextToken(line); !corner.empty(); corner = nextToken(line))
+      {
+        // v, v/vt, v//vn or v/vt/vn
+        const size_t slash = corner.find('/');
+        const size_t secondSlash =
+            slash == std::string_view::npos ? slash : corner.find('/', slash + 1);
+
+        ImportedVertex& vertex = polygon.emplace_back();
+        const int position = resolveIndex(corner.substr(0, slash), positions.size());
+        if (position < 0)
+        {
+          std::cerr << "ERROR::MESH::BAD_FACE " << filepath << std::endl;
+          return false;
+        }
+        vertex.position = positions[position];
+
+        if (slash != std::string_view::npos)
+        {
+          const auto uvField = corner.substr(slash + 1, secondSlash - slash - 1);
+          const int uv = resolveIndex(uvField, uvs.size());
+          if (uv >= 0)
+            vertex.uv = uvs[uv];
+        }
+        const int normal = secondSlash == std::string_view::npos
+                               ? -1
+                               : resolveIndex(corner.substr(secondSlash + 1), normals.size());
+        if (normal >= 0)
+          vertex.normal = normals[normal];
+        else
+          polygonHasNormals = false;
+      }
+
+      if (!submesh)
+        submesh = &mesh.submeshFor("");
+      submesh->hasNormals &= polygonHasNormals;
+      for (size_t i = 2; i < polygon.size(); i++)
+      {
+        submesh->vertices.push_back(polygon[0]);
+        submesh->vertices.push_back(polygon[i - 1]);
+        submesh->vertices.push_back(polygon[i]);
+      }
+    }
+  }
+
+  if (mesh.submeshes.empty())
+  {
+    std::cerr << "ERROR::MESH::NO_FACES " << filepath << std::endl;
+    return false;
+  }
+  return true;
+}
+}  // namespace ObjImporter
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "sdf_reference_renderer.h"
+
+#include <cmath>
+
+// The SDF shapes main puts in the world, at time 0, seen from the camera's starting point
+namespace DemoScene
+{
+inline void addShapes(SDFReferenceRenderer& renderer)
+{
+  {
+    SDFObject sdf;
+    Transform offset{};
+    offset.position = glm::vec3(0.0f, 0.5f, 0.0f);
+    sdf.unite(sdf.box(glm::vec3(0.4f)), sdf.sphere(0.4f, offset), 0.3f);
+    Transform transform{};
+    transform.position = glm::vec3(-1.2f, 1.0f, 2.0f);
+    renderer.add(sdf, transform, glm::vec3(0.0f, 0.0f, 1.0f));
+  }
+  {
+    SDFObject sdf;
+    sdf.subtract(sdf.torus(0.7f, 0.2f), sdf.capsule(0.4f, 0.25f), 0.05f);
+    Transform transform{};
+    transform.position = glm::vec3(2.5f, 1.0f, 0.0f);
+    renderer.add(sdf, transform, glm::vec3(0.2f, 0.6f, 0.8f));
+  }
+  {
+    SDFObject sdf;
+    SDFNodeId node = sdf.torus(0.8f, 0.15f);
+    for (int i = 0; i < 12; i++)
+    {
+      const float angle = glm::radians(30.0f * i);
+      Transform spike{};
+      spike.position = glm::vec3(std::cos(angle) * 0.8f, 0.3f, std::sin(angle) * 0.8f);
+      node = sdf.unite(node, sdf.capsule(0.25f, 0.08f, spike), 0.1f);
+      spike.position.y = 0.6f;
+      node = sdf.unite(node, sdf.sphere(0.12f, spike), 0.05f);
+    }
+    Transform transform{};
+    transform.position = glm::vec3(-3.0f, 1.0f, -3.0f);
+    renderer.add(sdf, transform, glm::vec3(0.9f, 0.7f, 0.2f));
+  }
+}
+
+inline Transform cameraTransform()
+{
+  Transform transform{};
+  transform.position = glm::vec3(0.0f, 2.0f, 5.0f);
+  return transform;
+}
+}  // namespace DemoScene
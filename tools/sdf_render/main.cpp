@@ -0,0 +1,74 @@
+// Renders the demo SDF shapes on the CPU, as a reference image for the shader path.
+//   sdf_render [--width 1920] [--height 1080] [--threads N] <output.png|output.exr>
+#include "demo_scene.h"
+#include "image_util.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace
+{
+int usage()
+{
+  std::cerr << "usage: sdf_render [--width W] [--height H] [--threads N] <output.png|output.exr>"
+            << std::endl;
+  return 2;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int width = 1920;
+  int height = 1080;
+  unsigned int threads = 0;
+  std::string output;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string_view arg = argv[i];
+    if (arg == "--width" && i + 1 < argc)
+      width = std::atoi(argv[++i]);
+    else if (arg == "--height" && i + 1 < argc)
+      height = std::atoi(argv[++i]);
+    else if (arg == "--threads" && i + 1 < argc)
+      threads = static_cast<unsigned int>(std::atoi(argv[++i]));
+    else if (arg.starts_with("--") || !output.empty())
+      return usage();
+    else
+      output = arg;
+  }
+  const bool exr = output.ends_with(".exr");
+  if (output.empty() || width <= 0 || height <= 0 || (!exr && !output.ends_with(".png")))
+    return usage();
+
+  JobSystem jobs;
+  SDFReferenceRenderer renderer(jobs);
+  renderer.setMaxThreads(threads);
+  DemoScene::addShapes(renderer);
+
+  const auto start = std::chrono::steady_clock::now();
+  const std::vector<float> image =
+      renderer.render(Camera{}, DemoScene::cameraTransform(), width, height);
+  const double ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  const unsigned int used = threads > 0 ? std::min(threads, jobs.getConcurrency())
+                                        : jobs.getConcurrency();
+  std::cout << width << "x" << height << " on " << used << " threads in " << ms
+            << " ms, " << renderer.getTileCount() << " tiles, " << renderer.getStealCount()
+            << " steals" << std::endl;
+
+  const bool written =
+      exr ? ImageUtil::writeEXR(output, image.data(), width, height)
+          : ImageUtil::writePNG(
+                output, ImageUtil::toUnorm8(image.data(), image.size()).data(), width, height, 3);
+  if (!written)
+  {
+    std::cerr << "ERROR::SDF_RENDER::WRITE_FAILED " << output << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,67 @@
+// Converts source images into .tex containers that Texture can map and upload directly.
+//   texture_cooker [--format auto|rgba8|rgb8|bc1|bc3] [--no-mips] [--no-flip] <input> <output>
+#include "texture_cooker.h"
+
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+int usage()
+{
+  std::cerr << "usage: texture_cooker [--format auto|rgba8|rgb8|bc1|bc3] [--no-mips] [--no-flip]"
+               " <input> <output>"
+            << std::endl;
+  return 2;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  using TextureContainer::Format;
+
+  CookOptions options;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string_view arg = argv[i];
+    if (arg == "--no-mips")
+    {
+      options.mips = false;
+    }
+    else if (arg == "--no-flip")
+    {
+      options.flip = false;
+    }
+    else if (arg == "--format" && i + 1 < argc)
+    {
+      const std::string_view name = argv[++i];
+      if (name == "auto")
+        options.format.reset();
+      else if (name == "rgba8")
+        options.format = Format::RGBA8;
+      else if (name == "rgb8")
+        options.format = Format::RGB8;
+      else if (name == "bc1")
+        options.format = Format::BC1;
+      else if (name == "bc3")
+        options.format = Format::BC3;
+      else
+        return usage();
+    }
+    else if (arg.starts_with("--"))
+    {
+      return usage();
+    }
+    else
+    {
+      paths.emplace_back(arg);
+    }
+  }
+
+  if (paths.size() != 2)
+    return usage();
+
+  return TextureCooker::cook(paths[0], paths[1], options) ? 0 : 1;
+}
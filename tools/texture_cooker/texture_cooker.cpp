@@ -0,0 +1,87 @@
+#include "texture_cooker.h"
+
+#include "block_compression.h"
+#include "image_util.h"
+
+#include <algorithm>
+#include <iostream>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace TextureCooker
+{
+bool cook(const std::string& input, const std::string& output, const CookOptions& options)
+{
+  using TextureContainer::Format;
+
+  int width, height, channels;
+  stbi_set_flip_vertically_on_load(options.flip);
+  unsigned char* pixels = stbi_load(input.c_str(), &width, &height, &channels, 0);
+  if (!pixels)
+  {
+    std::cerr << "Failed to load " << input << ": " << stbi_failure_reason() << std::endl;
+    return false;
+  }
+
+  std::vector<unsigned char> rgba = ImageUtil::toRGBA(pixels, width, height, channels);
+  stbi_image_free(pixels);
+
+  Format format = Format::BC1;
+  if (options.format)
+  {
+    format = *options.format;
+  }
+  else
+  {
+    for (size_t i = 3; i < rgba.size(); i += 4)
+    {
+      if (rgba[i] != 255)
+      {
+        format = Format::BC3;
+        break;
+      }
+    }
+  }
+
+  auto mips = options.mips ? ImageUtil::buildMipChain(std::move(rgba), width, height, 4)
+                           : std::vector<std::vector<unsigned char>>{std::move(rgba)};
+  if (mips.size() > TextureContainer::MAX_MIPS)
+  {
+    std::cerr << input << " is too large, " << mips.size() << " mips" << std::endl;
+    return false;
+  }
+
+  for (size_t level = 0; level < mips.size(); level++)
+  {
+    const int mipWidth = std::max(1, width >> level);
+    const int mipHeight = std::max(1, height >> level);
+    auto& mip = mips[level];
+    switch (format)
+    {
+      case Format::BC1:
+        mip = BlockCompression::compress(
+            BlockCompression::Format::BC1, mip.data(), mipWidth, mipHeight);
+        break;
+      case Format::BC3:
+        mip = BlockCompression::compress(
+            BlockCompression::Format::BC3, mip.data(), mipWidth, mipHeight);
+        break;
+      case Format::RGB8:
+        for (size_t i = 0; i < static_cast<size_t>(mipWidth) * mipHeight; i++)
+          std::copy_n(&mip[i * 4], 3, &mip[i * 3]);
+        mip.resize(static_cast<size_t>(mipWidth) * mipHeight * 3);
+        break;
+      case Format::RGBA8:
+        break;
+    }
+  }
+
+  if (!TextureContainer::write(output, format, width, height, mips))
+  {
+    std::cerr << "Failed to write " << output << std::endl;
+    return false;
+  }
+  return true;
+}
+}  // namespace TextureCooker
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "texture_container.h"
+
+#include <optional>
+#include <string>
+
+struct CookOptions
+{
+  // Unset picks BC3 for images with any transparency and BC1 otherwise
+  std::optional<TextureContainer::Format> format;
+  bool mips = true;
+  // Match Texture/TextureLoader, which flip on load so row 0 is the bottom of the image
+  bool flip = true;
+};
+
+namespace TextureCooker
+{
+bool cook(const std::string& input, const std::string& output, const CookOptions& options);
+}